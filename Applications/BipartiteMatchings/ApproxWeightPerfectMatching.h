@@ -138,7 +138,7 @@ std::vector<std::tuple<IT,IT,IT,NT>> ExchangeData1(std::vector<std::vector<std::
 // remember that getnrow() and getncol() require collectives
 // Hence, we save them once and pass them to this function
 template <class IT, class NT,class DER>
-int OwnerProcs(SpParMat < IT, NT, DER > & A, IT grow, IT gcol, IT nrows, IT ncols)
+int OwnerProcs(const SpParMat < IT, NT, DER > & A, IT grow, IT gcol, IT nrows, IT ncols)
 {
 	auto commGrid = A.getcommgrid();
 	int procrows = commGrid->GetGridRows();
@@ -162,7 +162,7 @@ int OwnerProcs(SpParMat < IT, NT, DER > & A, IT grow, IT gcol, IT nrows, IT ncol
 /*
 // Hence, we save them once and pass them to this function
 template <class IT, class NT,class DER>
-int OwnerProcs(SpParMat < IT, NT, DER > & A, IT grow, IT gcol, IT nrows, IT ncols)
+int OwnerProcs(const SpParMat < IT, NT, DER > & A, IT grow, IT gcol, IT nrows, IT ncols)
 {
 
     
@@ -270,7 +270,7 @@ void ReplicateMateWeights( const AWPM_param<IT>& param, Dcsc<IT, NT>*dcsc, const
 
 
 template <class IT, class NT,class DER>
-NT Trace( SpParMat < IT, NT, DER > & A, IT& rettrnnz=0)
+NT Trace( const SpParMat < IT, NT, DER > & A, IT& rettrnnz=0)
 {
 	
 	IT nrows = A.getnrow();
@@ -289,7 +289,7 @@ NT Trace( SpParMat < IT, NT, DER > & A, IT& rettrnnz=0)
 	int colrank = commGrid->GetRankInProcCol();
 	IT m_perproc = nrows / pr;
 	IT n_perproc = ncols / pc;
-	DER* spSeq = A.seqptr(); // local submatrix
+	const DER* spSeq = A.seqptr(); // local submatrix
 	IT localRowStart = colrank * m_perproc; // first row in this process
 	IT localColStart = rowrank * n_perproc; // first col in this process
 	
@@ -789,7 +789,7 @@ std::vector<std::vector<std::tuple<IT,IT, IT, NT>>> Phase2_old(const AWPM_param<
 }
 
 template <class IT, class NT, class DER>
-void TwoThirdApprox(SpParMat < IT, NT, DER > & A, FullyDistVec<IT, IT>& mateRow2Col, FullyDistVec<IT, IT>& mateCol2Row)
+void TwoThirdApprox(const SpParMat < IT, NT, DER > & A, FullyDistVec<IT, IT>& mateRow2Col, FullyDistVec<IT, IT>& mateCol2Row)
 {
 	
 	// Information about CommGrid and matrix layout
@@ -814,7 +814,7 @@ void TwoThirdApprox(SpParMat < IT, NT, DER > & A, FullyDistVec<IT, IT>& mateRow2
     IT nnz = A.getnnz();
 	IT m_perproc = nrows / pr;
 	IT n_perproc = ncols / pc;
-	DER* spSeq = A.seqptr(); // local submatrix
+	const DER* spSeq = A.seqptr(); // local submatrix
 	Dcsc<IT, NT>* dcsc = spSeq->GetDCSC();
 	IT lnrow = spSeq->getnrow();
 	IT lncol = spSeq->getncol();
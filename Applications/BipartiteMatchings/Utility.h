@@ -141,7 +141,7 @@ bool CheckMatching(FullyDistVec<IT,IT> & mateRow2Col, FullyDistVec<IT,IT> & mate
 
 // Gievn a matrix and matching vectors, returns the weight of the matching 
 template <class IT, class NT, class DER>
-NT MatchingWeight( SpParMat < IT, NT, DER > & A, FullyDistVec<IT,IT> mateRow2Col, FullyDistVec<IT,IT>& mateCol2Row)
+NT MatchingWeight( const SpParMat < IT, NT, DER > & A, FullyDistVec<IT,IT> mateRow2Col, FullyDistVec<IT,IT>& mateCol2Row)
 {
 	
 	auto commGrid = A.getcommgrid();
@@ -163,7 +163,7 @@ NT MatchingWeight( SpParMat < IT, NT, DER > & A, FullyDistVec<IT,IT> mateRow2Col
 	IT ncols = A.getncol();
 	IT m_perproc = nrows / pr;
 	IT n_perproc = ncols / pc;
-	DER* spSeq = A.seqptr(); // local submatrix
+	const DER* spSeq = A.seqptr(); // local submatrix
 	Dcsc<IT, NT>* dcsc = spSeq->GetDCSC();
 	IT lnrow = spSeq->getnrow();
 	IT lncol = spSeq->getncol();
@@ -239,9 +239,7 @@ void Symmetricize(PARMAT & A)
 {
 	// boolean addition is practically a "logical or"
 	// therefore this doesn't destruct any links
-	PARMAT AT = A;
-	AT.Transpose();
-	A += AT;
+	A.Symmetrize();	// A += A' without forming A'
 }
 
 }
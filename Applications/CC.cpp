@@ -144,12 +144,10 @@ int main(int argc, char* argv[])
             A.ReadGeneralizedTuples(ifilename,  maximum<double>());
         A.PrintInfo();
         
-        Dist::MPI_DCCols AT = A;
-        AT.Transpose();
-        if(!(AT == A))
+        if(!(A.T() == A))
         {
             SpParHelper::Print("Symmatricizing an unsymmetric input matrix.\n");
-            A += AT;
+            A += A.T();
         }
         A.PrintInfo();
         
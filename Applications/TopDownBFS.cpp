@@ -85,9 +85,7 @@ void Symmetricize(PARMAT & A)
 {
 	// boolean addition is practically a "logical or"
 	// therefore this doesn't destruct any links
-	PARMAT AT = A;
-	AT.Transpose();
-	A += AT;
+	A.Symmetrize();	// A += A' without forming A'
 }
 
 /**
@@ -0,0 +1,108 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 10/09/2015 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc, Adam Lugowski ------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2015, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#include <mpi.h>
+#include <iostream>
+#include <functional>
+#include <algorithm>
+#include <vector>
+#include <sstream>
+#include "CombBLAS/CombBLAS.h"
+
+using namespace std;
+using namespace combblas;
+
+// Checks GGet/GSet through a DistVecAggregator that outlives the calls:
+// results match the one-shot versions, repeated gathers within an epoch are served
+// from the cache, and EndEpoch() makes later updates of the vector visible
+int main(int argc, char* argv[])
+{
+	int nprocs, myrank;
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+	MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
+	int errors = 0;
+	{
+		shared_ptr<CommGrid> fullWorld;
+		fullWorld.reset( new CommGrid(MPI_COMM_WORLD, 0, 0) );
+		const int64_t n = 1000;
+		auto select = [](int64_t p, int64_t i){ return p; };
+
+		FullyDistVec<int64_t,int64_t> v(fullWorld);
+		v.iota(n, 0);
+		v.Apply([](int64_t x){ return 3*x; });
+
+		// every entry asks for one of a few hot entries spread over all processors, plus one out of range
+		FullyDistVec<int64_t,int64_t> hot(fullWorld);
+		hot.iota(n, 0);
+		hot.Apply([n](int64_t x){ return x == n-1 ? n : (x % 8) * (n/8); });
+		FullyDistSpVec<int64_t,int64_t> req(hot, [](int64_t x){ return true; });
+
+		FullyDistSpVec<int64_t,int64_t> once = v.GGet(req, select, static_cast<int64_t>(-1));
+		DistVecAggregator<int64_t,int64_t> reader(v);
+		FullyDistSpVec<int64_t,int64_t> first = v.GGet(req, select, static_cast<int64_t>(-1), reader);
+		FullyDistSpVec<int64_t,int64_t> second = v.GGet(req, select, static_cast<int64_t>(-1), reader);
+
+		vector<int64_t> reqnum = req.GetLocalNum();
+		vector<int64_t> oncenum = once.GetLocalNum();
+		vector<int64_t> firstnum = first.GetLocalNum();
+		vector<int64_t> secondnum = second.GetLocalNum();
+		for(size_t k=0; k< reqnum.size(); ++k)
+		{
+			int64_t expected = reqnum[k] < n ? 3*reqnum[k] : -1;
+			if(oncenum[k] != expected || firstnum[k] != expected || secondnum[k] != expected)
+				++errors;
+		}
+		// each processor has at least one remote hot entry, which the second gather must find in the cache
+		size_t hits = reader.CacheHits();
+		if(nprocs > 1 && hits == 0)
+			++errors;
+
+		// update the hot entries, then gather again in a new epoch
+		reader.EndEpoch();	// everybody is done reading
+		FullyDistSpVec<int64_t,int64_t> upd(hot, [n](int64_t x){ return x < n; });
+		v.GSet(upd, select, [](int64_t p, int64_t i){ return -p; }, reader);
+		reader.EndEpoch();	// every processor's puts have completed
+		FullyDistSpVec<int64_t,int64_t> third = v.GGet(req, select, static_cast<int64_t>(-1), reader);
+		vector<int64_t> thirdnum = third.GetLocalNum();
+		for(size_t k=0; k< reqnum.size(); ++k)
+		{
+			int64_t expected = reqnum[k] < n ? -reqnum[k] : -1;
+			if(thirdnum[k] != expected)
+				++errors;
+		}
+	}
+	MPI_Allreduce(MPI_IN_PLACE, &errors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+	if(errors == 0)
+		SpParHelper::Print("DistVecAggregator working correctly\n");
+	else
+		SpParHelper::Print("ERROR in DistVecAggregator, go fix it!\n");
+	MPI_Finalize();
+	return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,105 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 10/09/2015 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc, Adam Lugowski ------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2015, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#include <mpi.h>
+#include <iostream>
+#include <vector>
+#include <numeric>
+#include <sstream>
+#include "CombBLAS/CombBLAS.h"
+
+using namespace std;
+using namespace combblas;
+
+// Forces each exchange of SpParHelper::Alltoallv and compares it with MPI_Alltoallv,
+// on a dense pattern of small messages and on a sparse pattern with many empty pairs.
+// With 4 processors and a node size of 2, the hierarchical exchange runs on 2 "nodes"
+int CheckExchange(const vector<int> & sendcnt, MPI_Comm comm, const string & name)
+{
+	int nprocs, myrank;
+	MPI_Comm_size(comm, &nprocs);
+	MPI_Comm_rank(comm, &myrank);
+	vector<int> recvcnt(nprocs), sdispls(nprocs, 0), rdispls(nprocs, 0);
+	MPI_Alltoall(sendcnt.data(), 1, MPI_INT, recvcnt.data(), 1, MPI_INT, comm);
+	partial_sum(sendcnt.begin(), sendcnt.end()-1, sdispls.begin()+1);
+	partial_sum(recvcnt.begin(), recvcnt.end()-1, rdispls.begin()+1);
+	int totsend = accumulate(sendcnt.begin(), sendcnt.end(), 0);
+	int totrecv = accumulate(recvcnt.begin(), recvcnt.end(), 0);
+
+	vector<int64_t> sendbuf(totsend);
+	for(int i=0; i<nprocs; ++i)
+		for(int j=0; j<sendcnt[i]; ++j)
+			sendbuf[sdispls[i]+j] = (static_cast<int64_t>(myrank) << 40) + (static_cast<int64_t>(i) << 20) + j;
+	vector<int64_t> expected(totrecv), received(totrecv, -1);
+	MPI_Alltoallv(sendbuf.data(), const_cast<int*>(sendcnt.data()), sdispls.data(), MPIType<int64_t>(), expected.data(), recvcnt.data(), rdispls.data(), MPIType<int64_t>(), comm);
+	SpParHelper::Alltoallv(sendbuf.data(), const_cast<int*>(sendcnt.data()), sdispls.data(), received.data(), recvcnt.data(), rdispls.data(), comm);
+
+	int errors = (expected == received) ? 0 : 1;
+	MPI_Allreduce(MPI_IN_PLACE, &errors, 1, MPI_INT, MPI_SUM, comm);
+	if(errors > 0)
+		SpParHelper::Print("ERROR in Alltoallv (" + name + "), go fix it!\n");
+	return errors;
+}
+
+int main(int argc, char* argv[])
+{
+	int nprocs, myrank;
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+	MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
+	int errors = 0;
+	{
+		SpParHelper::SetAlltoallvNodeSize(2);
+		SpParHelper::SetAlltoallvMinProcs(1);
+
+		vector<int> dense(nprocs), sparse(nprocs, 0);
+		for(int i=0; i<nprocs; ++i)
+			dense[i] = 1 + (myrank * 7 + i * 3) % 11;
+		sparse[(myrank + 1) % nprocs] = 5 + myrank;	// one message per processor, and some self data
+		sparse[myrank] = 2;
+
+		const SpParHelper::AlltoallvAlgorithm algorithms[] = {SpParHelper::A2AV_AUTO, SpParHelper::A2AV_MPI,
+			SpParHelper::A2AV_SPARSE, SpParHelper::A2AV_KWAY, SpParHelper::A2AV_HIERARCHICAL};
+		const string names[] = {"auto", "mpi", "sparse", "k-way", "hierarchical"};
+		for(int a=0; a<5; ++a)
+		{
+			SpParHelper::SetAlltoallvAlgorithm(algorithms[a]);
+			MPI_Comm comm;	// a fresh communicator also exercises freeing a cached topology
+			MPI_Comm_dup(MPI_COMM_WORLD, &comm);
+			errors += CheckExchange(dense, comm, names[a] + ", dense");
+			errors += CheckExchange(sparse, comm, names[a] + ", sparse");
+			MPI_Comm_free(&comm);
+		}
+		SpParHelper::FreeDeferredComms();
+	}
+	if(errors == 0)
+		SpParHelper::Print("Alltoallv working correctly\n");
+	MPI_Finalize();
+	return (errors == 0) ? 0 : 1;
+}
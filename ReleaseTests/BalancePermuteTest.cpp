@@ -0,0 +1,96 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 10/09/2015 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc, Adam Lugowski ------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2015, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#include <mpi.h>
+#include <iostream>
+#include <vector>
+#include <sstream>
+#include "CombBLAS/CombBLAS.h"
+
+using namespace std;
+using namespace combblas;
+
+typedef SpParMat <int64_t, double, SpDCCols<int64_t,double> > PARDBMAT;
+
+// perm is a permutation of 0..n-1
+bool IsPermutation(const FullyDistVec<int64_t,int64_t> & perm, int64_t n)
+{
+	FullyDistVec<int64_t,int64_t> sorted(perm);
+	sorted.sort();
+	FullyDistVec<int64_t,int64_t> ident(perm.getcommgrid());
+	ident.iota(n, 0);
+	return (perm.TotalLength() == n && sorted == ident);
+}
+
+// Permutes an unscrambled (hence skewed) R-MAT matrix in both modes of BalancePermute
+// and checks that the load imbalance drops and that the result is A(rowperm, colperm)
+int main(int argc, char* argv[])
+{
+	int nprocs, myrank;
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+	MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
+	int errors = 0;
+	{
+		double initiator[4] = {.57, .19, .19, .05};
+		DistEdgeList<int64_t> * DEL = new DistEdgeList<int64_t>();
+		DEL->GenGraph500Data(initiator, 12, 16, false, false);	// no scrambling: the hubs have the smallest ids
+		PARDBMAT A(*DEL, false);
+		delete DEL;
+		float before = A.LoadImbalance();
+
+		bool modes[] = {false, true};
+		for(bool degreeaware : modes)
+		{
+			PARDBMAT B = A;
+			FullyDistVec<int64_t,int64_t> rowperm(A.getcommgrid()), colperm(A.getcommgrid());
+			B.BalancePermute(rowperm, colperm, degreeaware);
+			float after = B.LoadImbalance();
+
+			bool bad = false;
+			if(nprocs > 1 && !(after < before))	bad = true;	// one processor is always balanced
+			if(!IsPermutation(rowperm, A.getnrow()) || !IsPermutation(colperm, A.getncol()))	bad = true;
+			if(!(B == A(rowperm, colperm)))	bad = true;
+			if(B.getnnz() != A.getnnz())	bad = true;
+
+			ostringstream outs;
+			outs << (degreeaware? "Degree-aware" : "Random") << " permutation: load imbalance " << before << " -> " << after << endl;
+			SpParHelper::Print(outs.str());
+			if(bad)
+			{
+				SpParHelper::Print("ERROR in BalancePermute, go fix it!\n");
+				++errors;
+			}
+		}
+	}
+	if(errors == 0)
+		SpParHelper::Print("BalancePermute working correctly\n");
+	MPI_Finalize();
+	return (errors == 0) ? 0 : 1;
+}
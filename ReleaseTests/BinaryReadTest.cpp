@@ -0,0 +1,107 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 10/09/2015 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc, Adam Lugowski ------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2015, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#include <mpi.h>
+#include <iostream>
+#include <cstdio>
+#include "CombBLAS/CombBLAS.h"
+
+using namespace std;
+using namespace combblas;
+
+typedef SpParMat <int64_t, double, SpDCCols<int64_t,double> > PARDBMAT;
+
+// kth (row, column, value) of the test input; every 10th record repeats an earlier position
+void Record(int64_t k, int64_t n, int64_t & row, int64_t & col, double & val)
+{
+	int64_t p = (k % 10 == 9) ? k / 2 : k;
+	row = static_cast<int64_t>((static_cast<uint64_t>(p) * 0x9E3779B97F4A7C15ULL >> 20) % n);
+	col = static_cast<int64_t>((static_cast<uint64_t>(p) * 0xC2B2AE3D27D4EB4FULL >> 24) % n);
+	val = (k % 97) / 4.0 + 1;
+}
+
+// HKDT header (see ParseHeader) and packed records
+void WriteBinary(const string & filename, int64_t n, int64_t nnz)
+{
+	FILE * f = fopen(filename.c_str(), "wb");
+	uint64_t header[6] = { 1, 2*sizeof(int64_t) + sizeof(double), 0, static_cast<uint64_t>(n), static_cast<uint64_t>(n), static_cast<uint64_t>(nnz) };
+	fwrite("HKDT", 1, 4, f);
+	fwrite(header, sizeof(uint64_t), 6, f);
+	for(int64_t k = 0; k < nnz; ++k)
+	{
+		int64_t rc[2];
+		double val;
+		Record(k, n, rc[0], rc[1], val);
+		fwrite(rc, sizeof(int64_t), 2, f);
+		fwrite(&val, sizeof(double), 1, f);
+	}
+	fclose(f);
+}
+
+// ParallelReadBinary gives the matrix built from the same (row, column, value) triples, duplicates summed
+int main(int argc, char* argv[])
+{
+	int nprocs, myrank;
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+	MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
+	int errors = 0;
+	{
+		const int64_t n = 1000, nnz = 5003;
+		const string filename = "binaryread.bin";
+		if(myrank == 0)	WriteBinary(filename, n, nnz);
+		MPI_Barrier(MPI_COMM_WORLD);
+
+		shared_ptr<CommGrid> fullWorld;
+		fullWorld.reset( new CommGrid(MPI_COMM_WORLD, 0, 0) );
+		FullyDistVec<int64_t,int64_t> rows(fullWorld), cols(fullWorld);
+		rows.iota(nnz, 0);
+		cols.iota(nnz, 0);
+		rows.Apply([n](int64_t k){ int64_t r, c; double v; Record(k, n, r, c, v); return r; });
+		cols.Apply([n](int64_t k){ int64_t r, c; double v; Record(k, n, r, c, v); return c; });
+		FullyDistVec<int64_t,double> vals(fullWorld);
+		vals.iota(nnz, 0);
+		vals.Apply([n](double k){ int64_t r, c; double v; Record(static_cast<int64_t>(k), n, r, c, v); return v; });
+		PARDBMAT E(n, n, rows, cols, vals, true);
+
+		PARDBMAT A(fullWorld);
+		A.ParallelReadBinary(filename, plus<double>());
+		if(A.getnrow() != n || A.getncol() != n || !(A == E))
+		{
+			SpParHelper::Print("ERROR in reading a binary file with a header, go fix it!\n");
+			++errors;
+		}
+		MPI_Barrier(MPI_COMM_WORLD);
+		if(myrank == 0)	remove(filename.c_str());
+	}
+	if(errors == 0)
+		SpParHelper::Print("Binary readers working correctly\n");
+	MPI_Finalize();
+	return (errors == 0) ? 0 : 1;
+}
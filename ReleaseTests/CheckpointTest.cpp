@@ -0,0 +1,149 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 10/09/2015 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc, Adam Lugowski ------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2015, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#include <mpi.h>
+#include <iostream>
+#include <cstdio>
+#include <cmath>
+#include "CombBLAS/CombBLAS.h"
+
+using namespace std;
+using namespace combblas;
+
+typedef SpDCCols<int64_t,double> DCCOL;
+typedef SpParMat <int64_t, double, DCCOL > PARDBMAT;
+
+// the same matrix on any grid
+PARDBMAT Generate(shared_ptr<CommGrid> grid, int64_t n, int64_t nnz)
+{
+	FullyDistVec<int64_t,int64_t> rows(grid), cols(grid);
+	rows.iota(nnz, 0);
+	cols.iota(nnz, 0);
+	rows.Apply([n](int64_t k){ return static_cast<int64_t>((static_cast<uint64_t>(k) * 0x9E3779B97F4A7C15ULL >> 20) % n); });
+	cols.Apply([n](int64_t k){ return static_cast<int64_t>((static_cast<uint64_t>(k) * 0xC2B2AE3D27D4EB4FULL >> 24) % n); });
+	FullyDistVec<int64_t,double> vals(rows);
+	vals.Apply([](double r){ return r / 7 + 1; });
+	return PARDBMAT(n, n, rows, cols, vals, true);
+}
+
+// 1 if the loaded matrix equals the original and its local block chose the same lookups
+int SameAfterLoad(const PARDBMAT & A, const string & filename, shared_ptr<CommGrid> grid)
+{
+	PARDBMAT B(grid);
+	B.LoadCheckpoint(filename);
+	const Dcsc<int64_t,double> * a = A.seq().GetDCSC();
+	const Dcsc<int64_t,double> * b = B.seq().GetDCSC();
+	int same = (A == B);
+	if((a == NULL) != (b == NULL) || (a != NULL && (a->IsCSC() != b->IsCSC() || (a->ir16 == NULL) != (b->ir16 == NULL))))
+		same = 0;
+	MPI_Allreduce(MPI_IN_PLACE, &same, 1, MPI_INT, MPI_MIN, grid->GetWorld());
+	return same;
+}
+
+// Checkpoints are read back on the grid they were written from and on a grid of a different size (both ways),
+// and the header records the byte order and format version
+int main(int argc, char* argv[])
+{
+	int nprocs, myrank;
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+	MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
+	int errors = 0;
+	{
+		const int64_t n = 3000;
+		const string fullname = "checkpoint_full.bin";
+		const string subname = "checkpoint_sub.bin";
+		shared_ptr<CommGrid> fullWorld;
+		fullWorld.reset( new CommGrid(MPI_COMM_WORLD, 0, 0) );
+
+		// the smaller square grid: 1 process out of 4, 4 out of 9
+		int side = static_cast<int>(std::sqrt(static_cast<double>(nprocs)) + 0.5);
+		int subprocs = (side > 1) ? (side-1) * (side-1) : 1;
+		MPI_Comm subcomm;
+		MPI_Comm_split(MPI_COMM_WORLD, (myrank < subprocs) ? 0 : 1, myrank, &subcomm);
+
+		PARDBMAT A = Generate(fullWorld, n, 60000);	// dense enough for CSC layout
+		PARDBMAT H = Generate(fullWorld, n, 500);	// hypersparse
+		A.SaveCheckpoint(fullname);
+		if(!SameAfterLoad(A, fullname, fullWorld))
+		{
+			SpParHelper::Print("ERROR in reading a checkpoint on the grid that wrote it, go fix it!\n");
+			++errors;
+		}
+		H.SaveCheckpoint(subname);
+		if(!SameAfterLoad(H, subname, fullWorld))
+		{
+			SpParHelper::Print("ERROR in reading a hypersparse checkpoint, go fix it!\n");
+			++errors;
+		}
+
+		int64_t nnz = A.getnnz();
+		if(myrank == 0)
+		{
+			CheckpointHeader header;
+			FILE * f = fopen(fullname.c_str(), "rb");
+			if(f == NULL || fread(&header, sizeof(header), 1, f) != 1 || header.byteorder != CHECKPOINT_BYTEORDER
+				|| header.version != CHECKPOINT_VERSION || header.nprocs != static_cast<uint32_t>(nprocs) || header.nnz != static_cast<uint64_t>(nnz))
+			{
+				cout << "ERROR in the checkpoint header, go fix it!" << endl;
+				++errors;
+			}
+			if(f != NULL)	fclose(f);
+		}
+
+		int fromfull = 1, tosub = 1;
+		if(myrank < subprocs)
+		{
+			shared_ptr<CommGrid> subWorld;
+			subWorld.reset( new CommGrid(subcomm, 0, 0) );
+			PARDBMAT S = Generate(subWorld, n, 60000);
+			fromfull = SameAfterLoad(S, fullname, subWorld);	// written by nprocs, read by subprocs
+			S.SaveCheckpoint(subname);
+		}
+		MPI_Barrier(MPI_COMM_WORLD);
+		tosub = SameAfterLoad(A, subname, fullWorld);			// written by subprocs, read by nprocs
+		MPI_Allreduce(MPI_IN_PLACE, &fromfull, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+		if(!fromfull || !tosub)
+		{
+			SpParHelper::Print("ERROR in reading a checkpoint on a different number of processes, go fix it!\n");
+			++errors;
+		}
+		MPI_Comm_free(&subcomm);
+		if(myrank == 0)
+		{
+			remove(fullname.c_str());
+			remove(subname.c_str());
+		}
+	}
+	MPI_Allreduce(MPI_IN_PLACE, &errors, 1, MPI_INT, MPI_SUM, MPI_COMM_WORLD);
+	if(errors == 0)
+		SpParHelper::Print("Checkpoints working correctly\n");
+	MPI_Finalize();
+	return (errors == 0) ? 0 : 1;
+}
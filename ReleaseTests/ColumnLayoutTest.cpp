@@ -0,0 +1,178 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 10/09/2015 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc, Adam Lugowski ------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2015, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#include <mpi.h>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <sstream>
+#include "CombBLAS/CombBLAS.h"
+
+using namespace std;
+using namespace combblas;
+
+typedef SpDCCols<int64_t,double> DCCOL;
+typedef SpParMat <int64_t, double, DCCOL > PARDBMAT;
+typedef SpDCCols<int64_t,bool> BOOLDCCOL;
+typedef SpParMat <int64_t, bool, BOOLDCCOL > PARBOOLMAT;
+
+// 1 if every nonempty local block has CSC layout with a correct dense column pointer, 0 if none has it, -1 otherwise
+template <class NT>
+int LayoutState(const SpParMat<int64_t, NT, SpDCCols<int64_t,NT> > & A)
+{
+	const Dcsc<int64_t,NT> * dcsc = A.seq().GetDCSC();
+	int csc = 1, dcscl = 1;	
+	if(dcsc != NULL && dcsc->nzc > 0)
+	{
+		if(!dcsc->IsCSC())	csc = 0;
+		else
+		{
+			dcscl = 0;
+			if(dcsc->ncol != A.seq().getncol())	csc = 0;
+			for(int64_t c=0; c < dcsc->ncol && csc; ++c)
+			{
+				int64_t pos = lower_bound(dcsc->jc, dcsc->jc + dcsc->nzc, c) - dcsc->jc;
+				bool found = (pos < dcsc->nzc && dcsc->jc[pos] == c);
+				if(dcsc->dcp[c] != pos || (dcsc->dcp[c+1] > pos) != found)	csc = 0;
+			}
+		}
+	}
+	MPI_Allreduce(MPI_IN_PLACE, &csc, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+	MPI_Allreduce(MPI_IN_PLACE, &dcscl, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+	return csc? 1 : (dcscl? 0 : -1);
+}
+
+// copy of A in plain DCSC layout, the reference for the CSC lookups
+template <class NT>
+SpParMat<int64_t, NT, SpDCCols<int64_t,NT> > AsDcsc(const SpParMat<int64_t, NT, SpDCCols<int64_t,NT> > & A)
+{
+	SpParMat<int64_t, NT, SpDCCols<int64_t,NT> > W = A;
+	if(W.seqptr()->GetDCSC() != NULL)	W.seqptr()->GetDCSC()->DropColumnLayout();
+	return W;
+}
+
+// entries with value = column id + 1, so pruning by value empties whole columns; with holes every fourth column is empty
+PARDBMAT Generate(shared_ptr<CommGrid> grid, int64_t n, int64_t nnz, bool holes = false)
+{
+	FullyDistVec<int64_t,int64_t> rows(grid), cols(grid);
+	rows.iota(nnz, 0);
+	cols.iota(nnz, 0);
+	rows.Apply([n](int64_t k){ return static_cast<int64_t>((static_cast<uint64_t>(k) * 0x9E3779B97F4A7C15ULL >> 20) % n); });
+	cols.Apply([n](int64_t k){ return static_cast<int64_t>((static_cast<uint64_t>(k) * 0xC2B2AE3D27D4EB4FULL >> 24) % n); });
+	if(holes)	cols.Apply([n](int64_t c){ return (c % 4 == 0)? (c + 1) % n : c; });
+	FullyDistVec<int64_t,double> vals(cols);
+	vals.Apply([](double c){ return c + 1; });
+	return PARDBMAT(n, n, rows, cols, vals, true);
+}
+
+// Runs the column lookups (sparse SpMV, local SpGEMM, SUMMA) on A and on a DCSC copy of it
+bool SameProducts(const PARDBMAT & A, shared_ptr<CommGrid> grid)
+{
+	int64_t n = A.getncol();
+	int bad = 0;
+	PARDBMAT W = AsDcsc(A);
+	PARBOOLMAT B(A);
+	PARBOOLMAT BW(W);
+	if(BW.seqptr()->GetDCSC() != NULL)	BW.seqptr()->GetDCSC()->DropColumnLayout();
+	FullyDistVec<int64_t,int64_t> xd(grid);
+	xd.iota(n, 0);
+	for(int64_t stride : {1, 3, 97})	// dense and sparse frontiers
+	{
+		FullyDistSpVec<int64_t,int64_t> xs = xd.Find([stride](int64_t v){ return v % stride == 0; });
+		FullyDistSpVec<int64_t,int64_t> ys(grid, n), ysw(grid, n);
+		SpMV< SelectMaxSRing<bool,int64_t> >(B, xs, ys, false);
+		SpMV< SelectMaxSRing<bool,int64_t> >(BW, xs, ysw, false);
+		if(!(ys == ysw))	bad = 1;
+	}
+
+	const DCCOL & L = A.seq();
+	DCCOL LT = L.TransposeConst();
+	SpTuples<int64_t,double> * c = LocalHybridSpGEMM< PlusTimesSRing<double,double>, double >(L, LT, false, false);
+	SpTuples<int64_t,double> * cw = LocalHybridSpGEMM< PlusTimesSRing<double,double>, double >(W.seq(), LT, false, false);
+	if(!(DCCOL(*c, false) == DCCOL(*cw, false)))	bad = 1;
+	delete c;
+	delete cw;
+
+	PARDBMAT A2 = A;
+	PARDBMAT W2 = W;
+	PARDBMAT C = Mult_AnXBn_Synch< PlusTimesSRing<double,double>, double, DCCOL >(A, A2);
+	PARDBMAT CW = Mult_AnXBn_Synch< PlusTimesSRing<double,double>, double, DCCOL >(W, W2);
+	if(!(C == CW))	bad = 1;
+	MPI_Allreduce(MPI_IN_PLACE, &bad, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+	return !bad;
+}
+
+// Blocks with most of their columns nonempty get CSC layout (a dense column pointer) when they are built,
+// the layout is chosen again after members that change the columns, and both layouts give the same products
+int main(int argc, char* argv[])
+{
+	int nprocs, myrank;
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+	MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
+	int errors = 0;
+	{
+		shared_ptr<CommGrid> fullWorld;
+		fullWorld.reset( new CommGrid(MPI_COMM_WORLD, 0, 0) );
+		const int64_t n = 2000;
+		PARDBMAT D = Generate(fullWorld, n, 40000);	// every column nonempty
+		PARDBMAT H = Generate(fullWorld, n, 200);	// hypersparse
+		PARDBMAT E = Generate(fullWorld, n, 40000, true);	// dense, but with empty columns
+		PARDBMAT DT = D;
+		DT.Transpose();
+		if(LayoutState(D) != 1 || LayoutState(DT) != 1 || LayoutState(E) != 1 || LayoutState(H) != 0)
+		{
+			SpParHelper::Print("ERROR: layouts are not chosen by column density, go fix it!\n");
+			++errors;
+		}
+
+		PARDBMAT DP = D;
+		DP.Prune([n](double v){ return v > n/10; });	// empties most columns
+		int pruned = LayoutState(DP);
+		DP += D;					// and fills them again
+		int readded = LayoutState(DP);
+		PARDBMAT HD = H;
+		HD += D;
+		if(pruned != 0 || readded != 1 || LayoutState(HD) != 1)
+		{
+			SpParHelper::Print("ERROR: layouts are not chosen again after Prune and +=, go fix it!\n");
+			++errors;
+		}
+
+		if(!SameProducts(D, fullWorld) || !SameProducts(E, fullWorld) || !SameProducts(H, fullWorld))
+		{
+			SpParHelper::Print("ERROR in products of CSC layout blocks, go fix it!\n");
+			++errors;
+		}
+	}
+	if(errors == 0)
+		SpParHelper::Print("Column layouts working correctly\n");
+	MPI_Finalize();
+	return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,104 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 10/09/2015 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc, Adam Lugowski ------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2015, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#include <mpi.h>
+#include <iostream>
+#include <vector>
+#include <sstream>
+#include "CombBLAS/CombBLAS.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace combblas;
+
+typedef SpParMat <int64_t, int64_t, SpDCCols<int64_t,int64_t> > PARMAT;
+
+// every column of every local block lists its rows in increasing order
+bool LocallySorted(PARMAT & A)
+{
+	Dcsc<int64_t,int64_t> * dcsc = A.seqptr()->GetDCSC();
+	if(dcsc == NULL)	return true;
+	for(int64_t i=0; i < dcsc->nzc; ++i)
+		for(int64_t j=dcsc->cp[i]+1; j < dcsc->cp[i+1]; ++j)
+			if(dcsc->ir[j-1] >= dcsc->ir[j])	return false;
+	return true;
+}
+
+// Checks the counting-sort transpose against building the transposed matrix from swapped tuples,
+// with several thread counts, on a rectangular matrix whose rows are heavily skewed
+int main(int argc, char* argv[])
+{
+	int nprocs, myrank;
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+	MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
+	int errors = 0;
+	{
+		shared_ptr<CommGrid> fullWorld;
+		fullWorld.reset( new CommGrid(MPI_COMM_WORLD, 0, 0) );
+		const int64_t m = 5000, n = 3000, nnz = 60000;
+
+		FullyDistVec<int64_t,int64_t> rows(fullWorld), cols(fullWorld), vals(fullWorld);
+		rows.iota(nnz, 0);
+		cols.iota(nnz, 0);
+		vals.iota(nnz, 1);
+		// a third of the entries fall in 16 hot rows; the rest are spread by a multiplicative hash
+		rows.Apply([m](int64_t k){ uint64_t h = static_cast<uint64_t>(k) * 0x9E3779B97F4A7C15ULL; return (k % 3 == 0) ? static_cast<int64_t>((h >> 40) % 16) : static_cast<int64_t>((h >> 20) % m); });
+		cols.Apply([n](int64_t k){ uint64_t h = static_cast<uint64_t>(k) * 0xC2B2AE3D27D4EB4FULL; return static_cast<int64_t>((h >> 24) % n); });
+
+		PARMAT A(m, n, rows, cols, vals, true);
+		PARMAT AT(n, m, cols, rows, vals, true);
+		int threadcounts[] = {1, 3, 4};
+		for(int t : threadcounts)
+		{
+#ifdef _OPENMP
+			omp_set_num_threads(t);
+#endif
+			PARMAT B = A;
+			B.Transpose();
+			int bad = (B == AT && LocallySorted(B)) ? 0 : 1;
+			B.Transpose();
+			if(!(B == A))	bad = 1;
+			MPI_Allreduce(MPI_IN_PLACE, &bad, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+			if(bad)
+			{
+				ostringstream outs;
+				outs << "ERROR in transpose with " << t << " threads, go fix it!" << endl;
+				SpParHelper::Print(outs.str());
+			}
+			errors += bad;
+		}
+	}
+	if(errors == 0)
+		SpParHelper::Print("Counting sort transpose working correctly\n");
+	MPI_Finalize();
+	return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,170 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 10/09/2015 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc, Adam Lugowski ------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2015, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#define MMREADCHUNK 64	// many chunks even for a small file, and lines longer than a chunk
+
+#include <mpi.h>
+#include <iostream>
+#include <fstream>
+#include <cstdio>
+#include "CombBLAS/CombBLAS.h"
+
+using namespace std;
+using namespace combblas;
+
+typedef SpParMat <int64_t, double, SpDCCols<int64_t,double> > PARDBMAT;
+
+// the text of value v in one of the formats that Matrix Market writers use
+string FormatValue(int64_t k, double v)
+{
+	char buf[64];
+	switch(k % 5)
+	{
+		case 0: snprintf(buf, sizeof(buf), "%g", v); break;
+		case 1: snprintf(buf, sizeof(buf), "%.17e", v); break;
+		case 2: snprintf(buf, sizeof(buf), "%+.3E", v); break;
+		case 3: snprintf(buf, sizeof(buf), "%.6f", v); break;
+		default: snprintf(buf, sizeof(buf), "%lld", static_cast<long long>(v)); break;
+	}
+	return string(buf);
+}
+
+// every kth line gets the separators of a hand-edited file, some longer than MMREADCHUNK
+string Separator(int64_t k)
+{
+	if(k % 7 == 0)	return "\t";
+	if(k % 11 == 0)	return string(70, ' ');
+	return " ";
+}
+
+// A general real file with the comments at the top (what ReadDistribute reads), and a symmetric integer one with
+// comments and blank lines among the entries, written with both halves into a general file for ReadDistribute
+void WriteFiles(const string & general, const string & symmetric, const string & expanded, int64_t n, int64_t nnz)
+{
+	ofstream gen(general.c_str()), sym(symmetric.c_str()), exp(expanded.c_str());
+	gen << "%%MatrixMarket matrix coordinate real general\n% written by MMReaderTest\n%\n" << n << " " << n << " " << nnz << "\n";
+	for(int64_t k = 0; k < nnz; ++k)
+	{
+		int64_t col = k % n;
+		int64_t row = (k * 37 + k / n) % n;	// distinct for every k < n*n
+		double v = ((k * 7919) % 2001 - 1000) / 8.0 + (k % 3) * 1e-7;
+		if(k % 5 == 4)	v = static_cast<int64_t>(v);
+		gen << (k % 13 == 0 ? "  " : "") << row + 1 << Separator(k) << col + 1 << Separator(k+1) << FormatValue(k, v) << (k % 17 == 0 ? "\r\n" : "\n");
+	}
+	vector< tuple<int64_t,int64_t,int64_t> > lower;
+	for(int64_t k = 0; k < nnz; ++k)
+	{
+		int64_t i = (k * 37 + k / n) % n, j = k % n;
+		if(i >= j)	lower.push_back(make_tuple(i, j, (k * 31) % 1000 - 500));
+	}
+	int64_t offdiag = 0;
+	for(auto & t : lower)	if(get<0>(t) != get<1>(t))	++offdiag;
+	sym << "%%MatrixMarket matrix coordinate integer symmetric\n" << n << " " << n << " " << lower.size() << "\n";
+	exp << "%%MatrixMarket matrix coordinate real general\n" << n << " " << n << " " << lower.size() + offdiag << "\n";
+	for(size_t k = 0; k < lower.size(); ++k)
+	{
+		if(k % 50 == 0)	sym << "% a comment among the entries\n\n";
+		sym << get<0>(lower[k]) + 1 << Separator(k) << get<1>(lower[k]) + 1 << Separator(k+3) << get<2>(lower[k]) << "\n";
+		exp << get<0>(lower[k]) + 1 << " " << get<1>(lower[k]) + 1 << " " << get<2>(lower[k]) << "\n";
+		if(get<0>(lower[k]) != get<1>(lower[k]))
+			exp << get<1>(lower[k]) + 1 << " " << get<0>(lower[k]) + 1 << " " << get<2>(lower[k]) << "\n";
+	}
+}
+
+// ParseMMLines stops at the first line that is not an entry and returns it
+bool FindsBadLines()
+{
+	const char * lines[] = { "1 2 3.5\n% comment\n\n4 5 x\n6 7 8\n",	// real with a word as value
+				 "1 2 3\n4 5 2.5\n",				// integer with a real value
+				 "1 2\n3\n",					// a missing index
+				 "1 2 3.5 4\n",					// an extra field
+				 "1\t2\t-3e-2 \r\n% c\n  \n" };			// valid
+	int types[] = { 0, 1, 2, 0, 0 };
+	int badat[] = { 19, 6, 4, 0, -1 };
+	for(int i = 0; i < 5; ++i)
+	{
+		vector<int64_t> rows, cols;
+		vector<double> vals;
+		const char * bad = SpHelper::ParseMMLines(lines[i], lines[i] + strlen(lines[i]), rows, cols, vals, 0, types[i]);
+		if(badat[i] < 0 ? (bad != NULL || rows.size() != 1 || vals[0] != -3e-2) : (bad != lines[i] + badat[i]))
+			return false;
+	}
+	return true;
+}
+
+// ParallelReadMM, reading in many chunks, gives the same matrices as ReadDistribute
+int main(int argc, char* argv[])
+{
+	int nprocs, myrank;
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+	MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
+	int errors = 0;
+	{
+		const string general = "mmreader_general.mtx";
+		const string symmetric = "mmreader_symmetric.mtx";
+		const string expanded = "mmreader_expanded.mtx";
+		if(myrank == 0)	WriteFiles(general, symmetric, expanded, 101, 700);
+		MPI_Barrier(MPI_COMM_WORLD);
+
+		shared_ptr<CommGrid> fullWorld;
+		fullWorld.reset( new CommGrid(MPI_COMM_WORLD, 0, 0) );
+		PARDBMAT A(fullWorld), AR(fullWorld), S(fullWorld), SR(fullWorld);
+		A.ParallelReadMM(general, true, maximum<double>());
+		AR.ReadDistribute(general, 0);
+		S.ParallelReadMM(symmetric, true, maximum<double>());
+		SR.ReadDistribute(expanded, 0);
+		if(A.getnnz() != 700 || !(A == AR))
+		{
+			SpParHelper::Print("ERROR in reading a general Matrix Market file in chunks, go fix it!\n");
+			++errors;
+		}
+		if(!(S == SR))
+		{
+			SpParHelper::Print("ERROR in reading a symmetric Matrix Market file in chunks, go fix it!\n");
+			++errors;
+		}
+		if(!FindsBadLines())
+		{
+			SpParHelper::Print("ERROR in finding Matrix Market lines that can not be parsed, go fix it!\n");
+			++errors;
+		}
+		MPI_Barrier(MPI_COMM_WORLD);
+		if(myrank == 0)
+		{
+			remove(general.c_str());
+			remove(symmetric.c_str());
+			remove(expanded.c_str());
+		}
+	}
+	if(errors == 0)
+		SpParHelper::Print("Matrix Market reader working correctly\n");
+	MPI_Finalize();
+	return (errors == 0) ? 0 : 1;
+}
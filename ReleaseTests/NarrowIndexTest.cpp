@@ -0,0 +1,170 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 10/09/2015 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc, Adam Lugowski ------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2015, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#include <mpi.h>
+#include <iostream>
+#include <vector>
+#include <sstream>
+#include "CombBLAS/CombBLAS.h"
+
+using namespace std;
+using namespace combblas;
+
+typedef SpDCCols<int64_t,double> DCCOL;
+typedef SpParMat <int64_t, double, DCCOL > PARDBMAT;
+typedef SpDCCols<int64_t,bool> BOOLDCCOL;
+typedef SpParMat <int64_t, bool, BOOLDCCOL > PARBOOLMAT;
+
+// 1 if every nonempty local block keeps 16-bit row ids equal to ir, 0 if none does, -1 otherwise
+template <class NT>
+int NarrowState(const SpParMat<int64_t, NT, SpDCCols<int64_t,NT> > & A)
+{
+	const Dcsc<int64_t,NT> * dcsc = A.seq().GetDCSC();
+	int narrow = 1, wide = 1;	
+	if(dcsc != NULL && dcsc->nz > 0)
+	{
+		if(dcsc->ir16 == NULL)	narrow = 0;
+		else
+		{
+			wide = 0;
+			for(int64_t i=0; i< dcsc->nz; ++i)
+				if(dcsc->ir16[i] != dcsc->ir[i])	narrow = 0;
+		}
+	}
+	MPI_Allreduce(MPI_IN_PLACE, &narrow, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+	MPI_Allreduce(MPI_IN_PLACE, &wide, 1, MPI_INT, MPI_MIN, MPI_COMM_WORLD);
+	return narrow? 1 : (wide? 0 : -1);
+}
+
+// copy of A that only has full-width row ids, the reference for the narrowed kernels
+template <class NT>
+SpParMat<int64_t, NT, SpDCCols<int64_t,NT> > Widened(const SpParMat<int64_t, NT, SpDCCols<int64_t,NT> > & A)
+{
+	SpParMat<int64_t, NT, SpDCCols<int64_t,NT> > W = A;
+	if(W.seqptr()->GetDCSC() != NULL)	W.seqptr()->GetDCSC()->DropNarrowRowIndices();
+	return W;
+}
+
+PARDBMAT Generate(shared_ptr<CommGrid> grid, int64_t m, int64_t n, int64_t nnz)
+{
+	FullyDistVec<int64_t,int64_t> rows(grid), cols(grid);
+	FullyDistVec<int64_t,double> vals(grid);
+	rows.iota(nnz, 0);
+	cols.iota(nnz, 0);
+	vals.iota(nnz, 0);
+	rows.Apply([m](int64_t k){ return static_cast<int64_t>((static_cast<uint64_t>(k) * 0x9E3779B97F4A7C15ULL >> 20) % m); });
+	cols.Apply([n](int64_t k){ return static_cast<int64_t>((static_cast<uint64_t>(k) * 0xC2B2AE3D27D4EB4FULL >> 24) % n); });
+	vals.Apply([](double k){ return static_cast<double>(static_cast<int64_t>(k) % 5 + 1); });	// small integers, so sums are exact
+	return PARDBMAT(m, n, rows, cols, vals, true);
+}
+
+// Local blocks with at most 65536 rows are given 16-bit row ids when they are built or redistributed,
+// keep them through the members that rewrite ir, and SpMV/SpGEMM give the same results with them
+int main(int argc, char* argv[])
+{
+	int nprocs, myrank;
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+	MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
+	int errors = 0;
+	{
+		shared_ptr<CommGrid> fullWorld;
+		fullWorld.reset( new CommGrid(MPI_COMM_WORLD, 0, 0) );
+		const int64_t n = 1000;
+		PARDBMAT A = Generate(fullWorld, n, n, 100000);
+		PARDBMAT AT = A;
+		AT.Transpose();
+		PARDBMAT AP = A;
+		AP.Prune([](double v){ return v > 3; });
+		PARDBMAT AS = A;
+		AS += AT;
+		if(NarrowState(A) != 1 || NarrowState(AT) != 1 || NarrowState(AP) != 1 || NarrowState(AS) != 1)
+		{
+			SpParHelper::Print("ERROR: built, transposed or pruned blocks lack 16-bit row ids, go fix it!\n");
+			++errors;
+		}
+		PARDBMAT tall = Generate(fullWorld, 70000 * fullWorld->GetGridRows(), n, 5000);
+		if(NarrowState(tall) != 0)
+		{
+			SpParHelper::Print("ERROR: blocks with more than 65536 rows got 16-bit row ids, go fix it!\n");
+			++errors;
+		}
+
+		PARDBMAT W = Widened(A);
+		FullyDistVec<int64_t,double> x(fullWorld);
+		x.iota(n, 1);
+		FullyDistVec<int64_t,double> y = SpMV< PlusTimesSRing<double,double> >(A, x);
+		FullyDistVec<int64_t,double> yw = SpMV< PlusTimesSRing<double,double> >(W, x);
+		if(NarrowState(W) != 0 || !(y == yw))
+		{
+			SpParHelper::Print("ERROR in SpMV with 16-bit row ids, go fix it!\n");
+			++errors;
+		}
+
+		PARBOOLMAT B(A);
+		PARBOOLMAT BW = Widened(B);
+		FullyDistVec<int64_t,int64_t> xd(fullWorld);
+		xd.iota(n, 0);
+		FullyDistSpVec<int64_t,int64_t> xs = xd.Find([](int64_t v){ return v % 7 == 0; });
+		FullyDistSpVec<int64_t,int64_t> ys(fullWorld, n), ysw(fullWorld, n);
+		SpMV< SelectMaxSRing<bool,int64_t> >(B, xs, ys, false);
+		SpMV< SelectMaxSRing<bool,int64_t> >(BW, xs, ysw, false);
+		if(NarrowState(B) != 1 || !(ys == ysw))
+		{
+			SpParHelper::Print("ERROR in sparse SpMV with 16-bit row ids, go fix it!\n");
+			++errors;
+		}
+
+		// local kernel, on both of its numeric paths (A is dense enough for the hash path), then SUMMA
+		int bad = 0;
+		const DCCOL & L = A.seq();
+		const DCCOL & LW = W.seq();
+		DCCOL LT = L.TransposeConst();
+		SpTuples<int64_t,double> * c = LocalHybridSpGEMM< PlusTimesSRing<double,double>, double >(L, LT, false, false);
+		SpTuples<int64_t,double> * cw = LocalHybridSpGEMM< PlusTimesSRing<double,double>, double >(LW, LT, false, false);
+		if(!(DCCOL(*c, false) == DCCOL(*cw, false)))	bad = 1;
+		delete c;
+		delete cw;
+		PARDBMAT A2 = A;
+		PARDBMAT W2 = W;
+		PARDBMAT C = Mult_AnXBn_Synch< PlusTimesSRing<double,double>, double, DCCOL >(A, A2);
+		PARDBMAT CW = Mult_AnXBn_Synch< PlusTimesSRing<double,double>, double, DCCOL >(W, W2);
+		if(!(C == CW) || NarrowState(C) != 1)	bad = 1;
+		MPI_Allreduce(MPI_IN_PLACE, &bad, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+		if(bad)
+		{
+			SpParHelper::Print("ERROR in SpGEMM with 16-bit row ids, go fix it!\n");
+			++errors;
+		}
+	}
+	if(errors == 0)
+		SpParHelper::Print("16-bit row indices working correctly\n");
+	MPI_Finalize();
+	return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,131 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 10/09/2015 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc, Adam Lugowski ------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2015, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#include <mpi.h>
+#include <iostream>
+#include <vector>
+#include <sstream>
+#include "CombBLAS/CombBLAS.h"
+
+using namespace std;
+using namespace combblas;
+
+typedef SpDCCols<int64_t,bool> BOOLDCCOL;
+typedef SpDCCols<int64_t,Pattern> PATDCCOL;
+typedef SpParMat <int64_t, bool, BOOLDCCOL > PARBOOLMAT;
+typedef SpParMat <int64_t, Pattern, PATDCCOL > PARPATMAT;
+
+int64_t CountFalse(const PARBOOLMAT & A)
+{
+	FullyDistVec<int64_t,int64_t> colfalse(A.getcommgrid());
+	A.Reduce(colfalse, Column, plus<int64_t>(), static_cast<int64_t>(0), [](bool v){ return static_cast<int64_t>(!v); });
+	return colfalse.Reduce(plus<int64_t>(), static_cast<int64_t>(0));
+}
+
+// Boolean matrices keep explicit false entries through the exchanges, and pattern matrices 
+// (opt-in, through the Pattern value type) have no value arrays but give the same products
+int main(int argc, char* argv[])
+{
+	int nprocs, myrank;
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+	MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
+	int errors = 0;
+	{
+		shared_ptr<CommGrid> fullWorld;
+		fullWorld.reset( new CommGrid(MPI_COMM_WORLD, 0, 0) );
+		const int64_t n = 3000, nnz = 30000;
+		FullyDistVec<int64_t,int64_t> rows(fullWorld), cols(fullWorld), vals(fullWorld);
+		rows.iota(nnz, 0);
+		cols.iota(nnz, 0);
+		vals.iota(nnz, 0);
+		rows.Apply([n](int64_t k){ return static_cast<int64_t>((static_cast<uint64_t>(k) * 0x9E3779B97F4A7C15ULL >> 20) % n); });
+		cols.Apply([n](int64_t k){ return static_cast<int64_t>((static_cast<uint64_t>(k) * 0xC2B2AE3D27D4EB4FULL >> 24) % n); });
+		vals.Apply([](int64_t k){ return static_cast<int64_t>(k % 3 != 0); });	// every third entry is an explicit zero
+
+		PARBOOLMAT A(SpParMat<int64_t, int64_t, SpDCCols<int64_t,int64_t> >(n, n, rows, cols, vals, false));	// zeros become explicit false entries
+		int64_t falses = CountFalse(A);
+		if(falses == 0)
+		{
+			SpParHelper::Print("ERROR: no explicit false entries to begin with, go fix it!\n");
+			++errors;
+		}
+		PARBOOLMAT AT = A;
+		AT.Transpose();
+		if(CountFalse(AT) != falses)
+		{
+			SpParHelper::Print("ERROR in boolean transpose: explicit false entries are lost, go fix it!\n");
+			++errors;
+		}
+		FullyDistVec<int64_t,int64_t> diag(fullWorld);
+		diag.iota(n, 0);
+		PARBOOLMAT I(SpParMat<int64_t, int64_t, SpDCCols<int64_t,int64_t> >(n, n, diag, diag, static_cast<int64_t>(1)));
+		PARBOOLMAT AI = Mult_AnXBn_Synch<PlusTimesSRing<bool,bool>, bool, BOOLDCCOL>(A, I);	// SUMMA broadcasts of A
+		if(!(AI == A) || CountFalse(AI) != falses)
+		{
+			SpParHelper::Print("ERROR in boolean SpGEMM: explicit false entries are lost, go fix it!\n");
+			++errors;
+		}
+
+		// the pattern of A, and A with all of its values true
+		PARPATMAT P(A);
+		PARBOOLMAT S = A;
+		S.Apply([](bool v){ return true; });
+		int bad = (P.getnnz() == A.getnnz())? 0 : 1;
+		const Dcsc<int64_t,Pattern> * pdcsc = P.seq().GetDCSC();
+		if(pdcsc != NULL && pdcsc->numx != NULL)	bad = 1;	// no value array
+		PARPATMAT PT = P;
+		PT.Transpose();
+		PT.Transpose();
+		if(!(PT == P))	bad = 1;
+
+		FullyDistVec<int64_t,int64_t> x(fullWorld);
+		x.iota(n, 0);
+		FullyDistVec<int64_t,int64_t> yp = SpMV< SelectMaxSRing<bool,int64_t> >(P, x);
+		FullyDistVec<int64_t,int64_t> ys = SpMV< SelectMaxSRing<bool,int64_t> >(S, x);
+		if(!(yp == ys))	bad = 1;
+
+		PARBOOLMAT S2 = S;
+		PARBOOLMAT PP = Mult_AnXBn_Synch<PlusTimesSRing<bool,bool>, bool, BOOLDCCOL>(P, PT);	// PT == P
+		PARBOOLMAT SS = Mult_AnXBn_Synch<PlusTimesSRing<bool,bool>, bool, BOOLDCCOL>(S, S2);
+		if(!(PP == SS))	bad = 1;
+		PARBOOLMAT B(P);	// back to boolean: every entry true
+		if(!(B == S) || CountFalse(B) != 0)	bad = 1;
+		MPI_Allreduce(MPI_IN_PLACE, &bad, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+		if(bad)
+		{
+			SpParHelper::Print("ERROR in pattern matrices, go fix it!\n");
+			++errors;
+		}
+	}
+	if(errors == 0)
+		SpParHelper::Print("Boolean and pattern matrices working correctly\n");
+	MPI_Finalize();
+	return (errors == 0) ? 0 : 1;
+}
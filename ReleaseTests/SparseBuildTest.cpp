@@ -0,0 +1,122 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 10/09/2015 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc, Adam Lugowski ------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2015, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#include <mpi.h>
+#include <iostream>
+#include <vector>
+#include <map>
+#include <sstream>
+#include "CombBLAS/CombBLAS.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+using namespace std;
+using namespace combblas;
+
+typedef SpParMat <int64_t, double, SpDCCols<int64_t,double> > PARDBMAT;
+
+int64_t HashRow(int64_t k, int64_t m, int64_t distinct) { return static_cast<int64_t>((static_cast<uint64_t>(k % distinct) * 0x9E3779B97F4A7C15ULL >> 20) % m); }
+int64_t HashCol(int64_t k, int64_t n, int64_t distinct) { return static_cast<int64_t>((static_cast<uint64_t>(k % distinct) * 0xC2B2AE3D27D4EB4FULL >> 24) % n); }
+// floating point addition is not associative, so the sums of duplicates depend on their order
+double Value(int64_t k) { return (k % 3 == 0)? 1e17 : ((k % 3 == 1)? 1.0 : -1e17); }
+
+// Builds an m-by-n matrix out of nnz tuples (only "distinct" positions, so most are duplicates, and every 
+// 50th tuple deleted with the (-1,-1) marker) and checks that every sum of duplicates is the one in input order
+int CheckBuild(shared_ptr<CommGrid> grid, int64_t m, int64_t n, int64_t nnz, int64_t distinct)
+{
+	FullyDistVec<int64_t,int64_t> rows(grid), cols(grid);
+	FullyDistVec<int64_t,double> vals(grid);
+	rows.iota(nnz, 0);
+	cols.iota(nnz, 0);
+	vals.iota(nnz, 0);
+	rows.Apply([m, distinct](int64_t k){ return (k % 50 == 49)? -1 : HashRow(k, m, distinct); });
+	cols.Apply([n, distinct](int64_t k){ return (k % 50 == 49)? -1 : HashCol(k, n, distinct); });
+	vals.Apply([](double k){ return Value(static_cast<int64_t>(k)); });
+
+	map< pair<int64_t,int64_t>, double > expected;
+	for(int64_t k=0; k < nnz; ++k)
+	{
+		if(k % 50 == 49)	continue;
+		pair<int64_t,int64_t> key(HashRow(k, m, distinct), HashCol(k, n, distinct));
+		auto it = expected.find(key);
+		if(it == expected.end())	expected[key] = Value(k);
+		else	it->second = it->second + Value(k);
+	}
+
+	PARDBMAT A(m, n, rows, cols, vals, true);
+	FullyDistVec<int64_t,int64_t> frows(grid), fcols(grid);
+	FullyDistVec<int64_t,double> fvals(grid);
+	A.Find(frows, fcols, fvals);
+
+	int bad = (A.getnnz() == static_cast<int64_t>(expected.size()))? 0 : 1;
+	const int64_t * lrows = frows.GetLocArr();
+	const int64_t * lcols = fcols.GetLocArr();
+	const double * lvals = fvals.GetLocArr();
+	for(int64_t i=0; i < frows.LocArrSize(); ++i)
+	{
+		auto it = expected.find(make_pair(lrows[i], lcols[i]));
+		if(it == expected.end() || it->second != lvals[i])	bad = 1;
+	}
+	MPI_Allreduce(MPI_IN_PLACE, &bad, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+	return bad;
+}
+
+int main(int argc, char* argv[])
+{
+	int nprocs, myrank;
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+	MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
+	int errors = 0;
+	{
+		shared_ptr<CommGrid> fullWorld;
+		fullWorld.reset( new CommGrid(MPI_COMM_WORLD, 0, 0) );
+		int threadcounts[] = {1, 3, 4};
+		for(int t : threadcounts)
+		{
+#ifdef _OPENMP
+			omp_set_num_threads(t);
+#endif
+			int bad = CheckBuild(fullWorld, 700, 500, 30000, 4000);	// counting sort on columns
+			bad += CheckBuild(fullWorld, 1000000, 1000000, 3000, 400);	// hypersparse: comparison sort
+			if(bad)
+			{
+				ostringstream outs;
+				outs << "ERROR in sparse matrix construction with " << t << " threads, go fix it!" << endl;
+				SpParHelper::Print(outs.str());
+			}
+			errors += bad;
+		}
+	}
+	if(errors == 0)
+		SpParHelper::Print("Sparse matrix construction working correctly\n");
+	MPI_Finalize();
+	return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,130 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 10/09/2015 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc, Adam Lugowski ------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2015, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#include <mpi.h>
+#include <iostream>
+#include <vector>
+#include <sstream>
+#include "CombBLAS/CombBLAS.h"
+
+using namespace std;
+using namespace combblas;
+
+typedef SpDCCols<int64_t,double> DCCOLS;
+typedef SpParMat <int64_t, double, DCCOLS > PARMAT;
+typedef PlusTimesSRing<double, double> PTDD;
+
+int errors = 0;
+
+void Check(bool ok, const string & what)
+{
+	int bad = ok ? 0 : 1;
+	MPI_Allreduce(MPI_IN_PLACE, &bad, 1, MPI_INT, MPI_MAX, MPI_COMM_WORLD);
+	if(bad)
+		SpParHelper::Print("ERROR in cached transpose: " + what + ", go fix it!\n");
+	errors += bad;
+}
+
+PARMAT Explicit(const PARMAT & A)
+{
+	PARMAT AT(A);
+	AT.FreeTranspose();
+	AT.Transpose();
+	return AT;
+}
+
+// Checks that SpParMat::T() is reused by read-only uses (const access, SpMV, SpGEMM inputs)
+// and dropped by changes to the matrix, and that it always equals the explicit transpose
+int main(int argc, char* argv[])
+{
+	int nprocs, myrank;
+	MPI_Init(&argc, &argv);
+	MPI_Comm_size(MPI_COMM_WORLD,&nprocs);
+	MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
+	{
+		shared_ptr<CommGrid> fullWorld;
+		fullWorld.reset( new CommGrid(MPI_COMM_WORLD, 0, 0) );
+		const int64_t n = 2000, nnz = 20000;
+		FullyDistVec<int64_t,int64_t> rows(fullWorld), cols(fullWorld);
+		FullyDistVec<int64_t,double> vals(fullWorld);
+		rows.iota(nnz, 0);
+		cols.iota(nnz, 0);
+		vals.iota(nnz, 1.0);
+		rows.Apply([n](int64_t k){ return static_cast<int64_t>((static_cast<uint64_t>(k) * 0x9E3779B97F4A7C15ULL >> 24) % n); });
+		cols.Apply([n](int64_t k){ return static_cast<int64_t>((static_cast<uint64_t>(k) * 0xC2B2AE3D27D4EB4FULL >> 24) % n); });
+		vals.Apply([](double v){ return static_cast<double>(static_cast<int64_t>(v) % 7 + 1); });
+		PARMAT A(n, n, rows, cols, vals, true);
+		PARMAT B(n, n, cols, rows, vals, true);
+		PARMAT AT = Explicit(A);
+
+		const PARMAT * cached = &A.T();
+		Check(A.HasTranspose() && &A.T() == cached, "second T() was not a hit");
+		Check(A.T() == AT, "T() differs from the explicit transpose");
+
+		const PARMAT & constA = A;
+		int64_t locnnz = constA.seqptr()->getnnz() + constA.seq().getnnz();
+		Check(locnnz == 2*A.getlocalnnz() && A.HasTranspose(), "const seq()/seqptr() dropped the cache");
+
+		PARMAT C = Mult_AnXBn_Synch<PTDD, double, DCCOLS>(A.T(), B);
+		PARMAT Ccontrol = Mult_AnXBn_Synch<PTDD, double, DCCOLS>(AT, B);
+		Check(C == Ccontrol, "A.T()*B differs");
+		PARMAT D = Mult_AnXBn_DoubleBuff<PTDD, double, DCCOLS>(B, A.T());
+		PARMAT Dcontrol = Mult_AnXBn_DoubleBuff<PTDD, double, DCCOLS>(B, AT);
+		Check(D == Dcontrol, "B*A.T() differs");
+		Check(&A.T() == cached && A.T() == AT, "SpGEMM dropped or changed the cache");
+
+		FullyDistVec<int64_t,double> x(fullWorld, n, 1.0);
+		FullyDistVec<int64_t,double> y = SpMV<PTDD>(A.T(), x);
+		FullyDistVec<int64_t,double> ycontrol = SpMV<PTDD>(AT, x);
+		Check(y == ycontrol && &A.T() == cached, "SpMV with A.T()");
+
+		A.Apply([](double v){ return 2*v; });
+		Check(!A.HasTranspose(), "Apply kept a stale transpose");
+		AT = Explicit(A);
+		Check(A.T() == AT, "rebuilt T() differs");
+
+		A.seq();
+		Check(!A.HasTranspose(), "non-const seq() kept the cache");
+
+		PARMAT Sum(A);
+		Sum += AT;
+		A.T();
+		A += A.T();
+		Check(A == Sum && !A.HasTranspose(), "A += A.T()");
+
+		PARMAT Original(A);
+		A.T();
+		A.Transpose();	// swaps with the cache
+		Check(A == Explicit(Original) && A.T() == Original, "Transpose() with a cached T()");
+	}
+	if(errors == 0)
+		SpParHelper::Print("Cached transpose working correctly\n");
+	MPI_Finalize();
+	return (errors == 0) ? 0 : 1;
+}
@@ -0,0 +1,111 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 6/15/2017 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc  --------------------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2017, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#ifndef _ARENA_H_
+#define _ARENA_H_
+
+#include <cstddef>
+#include <new>			// For "placement new"
+#include <type_traits>
+
+namespace combblas {
+
+/**
+  * Size-class allocator for the large, short-lived arrays of the library (Dcsc and SpTuples storage, SpGEMM
+  * outputs and heaps, communication buffers), which iterative algorithms allocate and free over and over
+  * A freed block is kept by its calling thread and, once the thread's cache is full (ARENA_THREAD_CACHE_BYTES),
+  * by a cache shared by all threads (ARENA_SHARED_CACHE_BYTES); it goes back to the system only when both are full,
+  * so later allocations of a similar size reuse memory that is already mapped instead of faulting in new pages
+  * Sizes are rounded up to one of four classes per power of two (at most 25% waste), and blocks of at least
+  * ARENA_HUGEPAGE_BYTES are mapped directly and backed by transparent huge pages where available
+  * Every block records its class, so it can be freed by any thread and without its size, and the operation
+  * it is charged to (see MemoryTracker.h)
+  */
+class Arena
+{
+public:
+	//! Counterparts of ::operator new / ::operator delete (no constructors or destructors are run)
+	static void * Allocate(size_t bytes);
+	static void Deallocate(void * ptr);
+	static size_t Size(const void * ptr);	//!< bytes requested when ptr was allocated
+
+	static size_t CachedBytes();		//!< bytes kept by the calling thread and by the shared cache
+	static void Trim();			//!< returns those blocks to the system
+};
+
+//! Arena counterpart of new T[n]: class types are default constructed, others are left uninitialized
+template <typename T>
+T * ArenaNew(size_t n)
+{
+	T * ptr = static_cast<T*>(Arena::Allocate(n * sizeof(T)));
+	if(!std::is_trivially_default_constructible<T>::value)
+	{
+		for(size_t i=0; i< n; ++i)
+			new (ptr+i) T();
+	}
+	return ptr;
+}
+
+//! Arena counterpart of delete [] ptr, for arrays from ArenaNew (or raw blocks from Arena::Allocate of trivially destructible types)
+template <typename T>
+void ArenaDelete(T * ptr)
+{
+	if(ptr == NULL)	return;
+	if(!std::is_trivially_destructible<T>::value)
+	{
+		size_t n = Arena::Size(ptr) / sizeof(T);
+		for(size_t i=0; i< n; ++i)
+			ptr[i].~T();
+	}
+	Arena::Deallocate(ptr);
+}
+
+//! std::allocator compatible interface to the arena (e.g. std::vector< T, ArenaAllocator<T> >)
+template <typename T>
+class ArenaAllocator
+{
+public:
+	typedef T value_type;
+
+	ArenaAllocator() {}
+	template <typename U>
+	ArenaAllocator(const ArenaAllocator<U> &) {}
+
+	T * allocate(size_t n) { return static_cast<T*>(Arena::Allocate(n * sizeof(T))); }
+	void deallocate(T * ptr, size_t) { Arena::Deallocate(ptr); }
+};
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T> &, const ArenaAllocator<U> &) { return true; }
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T> &, const ArenaAllocator<U> &) { return false; }
+
+}
+
+#endif
@@ -0,0 +1,132 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 6/15/2017 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc  --------------------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2017, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#ifndef _ASYNC_WRITE_H_
+#define _ASYNC_WRITE_H_
+
+#include <mpi.h>
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <functional>
+#include <algorithm>
+#include <stdint.h>
+#include "MPIType.h"
+
+namespace combblas {
+
+/**
+  * Handle to a text file that the processes of a communicator write in the background
+  * Every process produces its part of the text with a formatter that runs on a helper thread (so it should only
+  * touch data that the caller has copied), and the parts are written back to back in rank order with nonblocking MPI-IO
+  * If MPI was initialized with MPI_THREAD_MULTIPLE, the helper thread writes as well; otherwise the write happens in Wait
+  * Wait is collective, and so is the destructor of a handle that has not been waited on
+  */
+class AsyncWrite
+{
+public:
+	AsyncWrite() {};
+	AsyncWrite(const std::string & filename, std::function<void(std::string &)> format, MPI_Comm world): state(new State)
+	{
+		int provided;
+		MPI_Query_thread(&provided);
+		state->filename = filename;
+		state->threaded = (provided == MPI_THREAD_MULTIPLE);
+		MPI_Comm_dup(world, &state->comm);	// keeps the write's collectives apart from the caller's
+
+		State * s = state.get();
+		worker = std::thread([s, format]()
+		{
+			format(s->text);
+			if(s->threaded)	Write(*s);
+		});
+	}
+	AsyncWrite(AsyncWrite && rhs) = default;
+	AsyncWrite & operator=(AsyncWrite && rhs)
+	{
+		Wait();
+		worker = std::move(rhs.worker);
+		state = std::move(rhs.state);
+		return *this;
+	}
+	~AsyncWrite() { Wait(); }
+
+	bool Pending() const { return (state != nullptr); }
+
+	//! Returns when the file is complete
+	void Wait()
+	{
+		if(!state)	return;
+		worker.join();
+		if(!state->threaded)	Write(*state);
+		MPI_Comm_free(&state->comm);
+		state.reset();
+	}
+
+private:
+	struct State
+	{
+		std::string filename;
+		std::string text;
+		MPI_Comm comm;
+		bool threaded;
+	};
+
+	static void Write(State & s)
+	{
+		int myrank;
+		MPI_Comm_rank(s.comm, &myrank);
+		int64_t bytes = s.text.size();
+		int64_t bytesuntil = 0, bytestotal = 0;
+		MPI_Exscan(&bytes, &bytesuntil, 1, MPIType<int64_t>(), MPI_SUM, s.comm);
+		MPI_Allreduce(&bytes, &bytestotal, 1, MPIType<int64_t>(), MPI_SUM, s.comm);
+		if(myrank == 0) bytesuntil = 0;	// because MPI_Exscan says the recvbuf in process 0 is undefined
+
+		MPI_File thefile;
+		MPI_File_open(s.comm, const_cast<char*>(s.filename.c_str()), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &thefile);
+		MPI_File_set_size(thefile, bytestotal);	// drops the tail of an older, longer file
+		const int64_t batchSize = 256 * 1024 * 1024;	// counts are ints
+		std::vector<MPI_Request> requests;
+		for(int64_t done = 0; done < bytes; done += batchSize)
+		{
+			requests.push_back(MPI_REQUEST_NULL);
+			MPI_File_iwrite_at(thefile, bytesuntil + done, &s.text[done], static_cast<int>(std::min(batchSize, bytes - done)), MPI_CHAR, &requests.back());
+		}
+		MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+		MPI_File_close(&thefile);
+		std::string().swap(s.text);
+	}
+
+	std::thread worker;
+	std::unique_ptr<State> state;
+};
+
+}
+
+#endif
@@ -227,6 +227,7 @@ void MergeContributions(FullyDistSpVec<IU,VT> & y, int * & recvcnt, int * & rdis
 	double t0=MPI_Wtime();
 #endif
 	// free memory of y, in case it was aliased
+	y.ClearDense();
 	std::vector<IU>().swap(y.ind);
 	std::vector<VT>().swap(y.num);
 	
@@ -376,8 +377,8 @@ FullyDistSpVec<IT,VT>  SpMV (const SpParMat<IT,bool,UDER> & A, const FullyDistSp
 #endif
 	if(optbuf.totmax > 0 )	// graph500 optimization enabled
 	{
-        MPI_Alltoallv(optbuf.inds, sendcnt, optbuf.dspls, MPIType<int32_t>(), recvindbuf, recvcnt, rdispls, MPIType<int32_t>(), RowWorld);  
-		MPI_Alltoallv(optbuf.nums, sendcnt, optbuf.dspls, MPIType<VT>(), recvnumbuf, recvcnt, rdispls, MPIType<VT>(), RowWorld);  
+        SpParHelper::Alltoallv(optbuf.inds, sendcnt, optbuf.dspls, recvindbuf, recvcnt, rdispls, RowWorld);  
+		SpParHelper::Alltoallv(optbuf.nums, sendcnt, optbuf.dspls, recvnumbuf, recvcnt, rdispls, RowWorld);  
 		delete [] sendcnt;
 	}
 	else
@@ -394,7 +395,7 @@ FullyDistSpVec<IT,VT>  SpMV (const SpParMat<IT,bool,UDER> & A, const FullyDistSp
 }
 
 template <typename VT, typename IT, typename UDER>
-SpDCCols<int,bool>::SpColIter* CalcSubStarts(SpParMat<IT,bool,UDER> & A, FullyDistSpVec<IT,VT> & x, BitMapCarousel<IT,VT> &done) {
+SpDCCols<int,bool>::SpColIter* CalcSubStarts(const SpParMat<IT,bool,UDER> & A, FullyDistSpVec<IT,VT> & x, BitMapCarousel<IT,VT> &done) {
 	std::shared_ptr<CommGrid> cg = A.getcommgrid();
 	IT rowuntil = x.LengthUntil();
 	MPI_Comm RowWorld = cg->GetRowWorld();
@@ -455,7 +456,7 @@ void UpdateParents(MPI_Comm & RowWorld, std::pair<IT,IT> *updates, int num_updat
 
 
 template <typename VT, typename IT, typename UDER>
-void BottomUpStep(SpParMat<IT,bool,UDER> & A, FullyDistSpVec<IT,VT> & x, BitMapFringe<int64_t,int64_t> &bm_fringe, FullyDistVec<IT,VT> & parents, BitMapCarousel<IT,VT> &done, SpDCCols<int,bool>::SpColIter* starts)
+void BottomUpStep(const SpParMat<IT,bool,UDER> & A, FullyDistSpVec<IT,VT> & x, BitMapFringe<int64_t,int64_t> &bm_fringe, FullyDistVec<IT,VT> & parents, BitMapCarousel<IT,VT> &done, SpDCCols<int,bool>::SpColIter* starts)
 {
 	std::shared_ptr<CommGrid> cg = A.getcommgrid();
 	MPI_Comm World = cg->GetWorld();
@@ -117,6 +117,7 @@ class EWiseExtToPlainAdapter
 };
 
 #include "SpDefs.h"
+#include "MemoryTracker.h"
 #include "BitMap.h"
 #include "SpTuples.h"
 #include "SpDCCols.h"
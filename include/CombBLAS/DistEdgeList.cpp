@@ -31,6 +31,7 @@
 #include "SpParMat.h"
 #include "ParFriends.h"
 #include "Operations.h"
+#include "FileHeader.h"
 
 #ifndef GRAPH_GENERATOR_SEQ
 #define GRAPH_GENERATOR_SEQ
@@ -158,6 +159,103 @@ void DistEdgeList<IT>::Dump32bit(string filename)
 }	
 #endif
 
+/**
+ * Writes the edges in the block-compressed edge list format (see EdgeListHeader), as a globalV x globalV pattern
+ * Each block of EDGEBLOCKSIZE edges is sorted by (destination, source) before it is encoded; deleted edges are left out
+ **/
+template <typename IT>
+void DistEdgeList<IT>::DumpCompressed(std::string filename)
+{
+	std::vector< std::pair<IT,IT> > valid;	// (destination, source)
+	valid.reserve(nedges);
+	for(IT i=0; i< nedges; ++i)
+	{
+		IT fr = (pedges != NULL)? get_v0_from_edge(pedges + i) : edges[2*i+0];
+		IT to = (pedges != NULL)? get_v1_from_edge(pedges + i) : edges[2*i+1];
+		if(fr >= 0 && to >= 0)
+			valid.push_back(std::make_pair(to, fr));
+	}
+
+	int64_t nblocks = (static_cast<int64_t>(valid.size()) + EDGEBLOCKSIZE - 1) / EDGEBLOCKSIZE;
+	std::vector< std::vector<unsigned char> > encoded(nblocks);
+	std::vector<uint64_t> blockbytes(nblocks), blockedges(nblocks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for(int64_t b = 0; b < nblocks; ++b)
+	{
+		auto first = valid.begin() + b * EDGEBLOCKSIZE;
+		auto last = valid.begin() + std::min(static_cast<size_t>((b+1) * EDGEBLOCKSIZE), valid.size());
+		std::sort(first, last);
+		std::vector<IT> rows, cols;
+		for(auto it = first; it != last; ++it)
+		{
+			rows.push_back(it->second);
+			cols.push_back(it->first);
+		}
+		SpHelper::EncodeEdgeBlock(rows.data(), cols.data(), NULL, 0, rows.size(), encoded[b]);
+		blockbytes[b] = encoded[b].size();
+		blockedges[b] = rows.size();
+	}
+	std::vector<unsigned char> blocks;
+	for(int64_t b = 0; b < nblocks; ++b)
+	{
+		blocks.insert(blocks.end(), encoded[b].begin(), encoded[b].end());
+		std::vector<unsigned char>().swap(encoded[b]);
+	}
+
+	EdgeListHeader header;
+	memset(&header, 0, sizeof(header));
+	header.m = globalV;
+	header.n = globalV;
+	WriteEdgeBlocks(filename, header, blocks, blockbytes, blockedges, commGrid->GetWorld());
+}
+
+/**
+ * Reads a block-compressed edge list of a square matrix (see DumpCompressed), replacing the current edges
+ * Every process maps and decodes its share of the blocks; rows become sources and columns destinations
+ **/
+template <typename IT>
+void DistEdgeList<IT>::ReadCompressed(std::string filename)
+{
+	EdgeListHeader header;
+	std::vector<uint64_t> blockoffsets, blockedges;
+	void * mapbase;
+	size_t maplength;
+	const unsigned char * blocks = MapEdgeBlocks(filename, header, blockoffsets, blockedges, mapbase, maplength, commGrid->GetWorld());
+	if(header.m != header.n)
+	{
+		SpParHelper::Print("COMBBLAS: Edge list " + filename + " is not square\n");
+		MPI_Abort(MPI_COMM_WORLD, NOTSQUARE);
+	}
+
+	int64_t nblocks = blockedges.size();
+	std::vector<uint64_t> firstedge(nblocks+1, 0);
+	std::partial_sum(blockedges.begin(), blockedges.end(), firstedge.begin()+1);
+	if(pedges)
+	{
+		delete [] pedges;
+		pedges = NULL;
+	}
+	SetMemSize(firstedge[nblocks]);
+	nedges = firstedge[nblocks];
+	globalV = header.m;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for(int64_t b = 0; b < nblocks; ++b)
+	{
+		std::vector<IT> rows(blockedges[b]), cols(blockedges[b]);
+		SpHelper::DecodeEdgeBlock(blocks + blockoffsets[b], blockedges[b], rows.data(), cols.data());
+		for(uint64_t i = 0; i < blockedges[b]; ++i)
+		{
+			edges[2*(firstedge[b]+i)+0] = rows[i];
+			edges[2*(firstedge[b]+i)+1] = cols[i];
+		}
+	}
+	SpParHelper::UnmapFileRange(mapbase, maplength);
+}
+
 template <typename IT>
 DistEdgeList<IT>::~DistEdgeList()
 {
@@ -320,19 +418,19 @@ void PermEdges(DistEdgeList<IT> & DEL)
 		IT n_sofar = s*perstage;
 		IT n_thisstage = ((s==(stages-1))? (maxedges - n_sofar): perstage);
 
-		std::pair<double, std::pair<IT,IT> >* vecpair = new std::pair<double, std::pair<IT,IT> >[n_thisstage];
+		std::pair<uint64_t, std::pair<IT,IT> >* vecpair = new std::pair<uint64_t, std::pair<IT,IT> >[n_thisstage];
 		dist[rank] = n_thisstage;
 		MPI_Allgather(MPI_IN_PLACE, 1, MPIType<IT>(), dist, 1, MPIType<IT>(), DEL.commGrid->GetWorld());
 
 		for (IT i = 0; i < n_thisstage; i++)
 		{
-			vecpair[i].first = M.rand();
+			vecpair[i].first = (static_cast<uint64_t>(M.randInt()) << 32) | static_cast<uint64_t>(M.randInt());	// integer keys: radix sortable
 			vecpair[i].second.first = DEL.edges[2*(i+n_sofar)];
 			vecpair[i].second.second = DEL.edges[2*(i+n_sofar)+1];
 		}
 
 		// less< pair<T1,T2> > works correctly (sorts w.r.t. first element of type T1)	
-		SpParHelper::MemoryEfficientPSort(vecpair, n_thisstage, dist, DEL.commGrid->GetWorld());
+		SpParHelper::RadixPSort(vecpair, n_thisstage, dist, DEL.commGrid->GetWorld());
 		// SpParHelper::DebugPrintKeys(vecpair, n_thisstage, dist, DEL.commGrid->GetWorld());
 		for (IT i = 0; i < n_thisstage; i++)
 		{
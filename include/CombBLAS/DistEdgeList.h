@@ -89,6 +89,8 @@ public:
 
 	void Dump64bit(std::string filename);
 	void Dump32bit(std::string filename);
+	void DumpCompressed(std::string filename);
+	void ReadCompressed(std::string filename);
 	void GenGraph500Data(double initiator[4], int log_numverts, int edgefactor, bool scramble =false, bool packed=false);
 	void CleanupEmpties();
 	
@@ -0,0 +1,382 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 6/15/2017 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc  --------------------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2017, The Regents of the University of California
+
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#ifndef _DIST_VEC_AGGREGATOR_H_
+#define _DIST_VEC_AGGREGATOR_H_
+
+#include <vector>
+#include <unordered_map>
+#include <utility>
+#include <numeric>
+#include <mpi.h>
+#include "SpDefs.h"
+#include "MPIType.h"
+#include "Deleter.h"
+
+namespace combblas {
+
+template <class IT, class NT>
+class FullyDistVec;
+
+/**
+  * Aggregates element-wise reads (Get) and writes (Put) on a FullyDistVec.
+  * Requests are binned by owner and deduplicated, so each remote index is fetched
+  * (or written) at most once per flush, and every owner is contacted with a single
+  * message: an MPI_Get/MPI_Accumulate over an indexed datatype (ONESIDED, not collective)
+  * or one round of all-to-all (ALLTOALL, collective over the vector's world).
+  * Local requests are served immediately.
+  *
+  * Remote values fetched by a flush are cached until EndEpoch(), so entries that are
+  * requested over and over (e.g. the parents of the roots in connected components)
+  * do not hit the network again. The caller guarantees that remote entries it reads
+  * do not change during an epoch; Puts issued through this object invalidate their own entries.
+  *
+  * An aggregator is meant to outlive many GGet/GSet calls (see Applications/CC.h): its window
+  * is created once, so vec must not be resized or reassigned to a different length meanwhile.
+  * Gets and puts are one-sided, so the epoch has to be ended (EndEpoch) between reading vec
+  * and modifying it, also when it is modified by other means.
+  */
+template <class IT, class NT>
+class DistVecAggregator
+{
+public:
+	enum Transport { ONESIDED, ALLTOALL };
+
+	//! if win is MPI_WIN_NULL and transport is ONESIDED, the constructor and destructor
+	//! create and free a window over vec (and hence are collective)
+	DistVecAggregator(FullyDistVec<IT,NT> & vec, Transport trans = ONESIDED, MPI_Win win = MPI_WIN_NULL);
+	~DistVecAggregator();
+
+	//! returns a ticket whose value is available via Value() after FlushGets(),
+	//! and stays valid until the first Get after that flush
+	IT Get(IT globind);
+	NT Value(IT ticket) const { return values[ticket]; }
+	void FlushGets();
+
+	//! vec[globind] = __binop(vec[globind], val); repeated puts to one index are combined locally
+	template <typename _BinaryOperation>
+	void Put(IT globind, NT val, _BinaryOperation __binop);
+
+	//! ONESIDED applies mpiop at the target (must be MPI_REPLACE or a predefined op matching __binop)
+	//! ALLTOALL applies __binop at the owner
+	template <typename _BinaryOperation>
+	void FlushPuts(_BinaryOperation __binop, MPI_Op mpiop = MPI_REPLACE);
+
+	//! ends the epoch in which vec did not change: collective over vec's world, so call it after the
+	//! last read and before vec is modified (by anyone); the window, if any, stays open for the next epoch
+	void EndEpoch();
+	bool Serves(const FullyDistVec<IT,NT> & rvec) const { return &vec == &rvec; }
+	void SetCacheCapacity(size_t entries) { cachecap = entries; if(cache.size() > cachecap) cache.clear(); }
+	size_t CacheHits() const { return hits; }
+
+private:
+	void InsertCache(IT globind, NT val);
+	MPI_Datatype IndexedType(const std::vector<IT> & locinds) const;
+
+	FullyDistVec<IT,NT> & vec;
+	Transport trans;
+	MPI_Win win;
+	bool ownwin;
+	int nprocs;
+	int myrank;
+
+	// pending reads, one slot per distinct global index
+	std::vector<NT> values;					// indexed by ticket
+	std::unordered_map<IT,IT> ticketof;			// global index -> ticket
+	std::vector< std::vector<IT> > getind;		// per owner: local indices to fetch
+	std::vector< std::vector<IT> > getticket;	// per owner: where the fetched values go
+	bool flushed;
+
+	// pending writes
+	std::unordered_map<IT,IT> putslot;			// global index -> position in putind/putval of its owner
+	std::vector< std::vector<IT> > putind;
+	std::vector< std::vector<NT> > putval;
+
+	std::unordered_map<IT, std::pair<NT,IT> > cache;	// global index -> (value, hit count)
+	size_t cachecap;
+	size_t hits;
+};
+
+
+template <class IT, class NT>
+DistVecAggregator<IT,NT>::DistVecAggregator(FullyDistVec<IT,NT> & rvec, Transport rtrans, MPI_Win rwin)
+: vec(rvec), trans(rtrans), win(rwin), ownwin(false), flushed(false), cachecap(AGGREGATOR_CACHE_ENTRIES), hits(0)
+{
+	MPI_Comm World = vec.commGrid->GetWorld();
+	MPI_Comm_size(World, &nprocs);
+	MPI_Comm_rank(World, &myrank);
+	getind.resize(nprocs);
+	getticket.resize(nprocs);
+	putind.resize(nprocs);
+	putval.resize(nprocs);
+
+	if(trans == ONESIDED && win == MPI_WIN_NULL)
+	{
+		MPI_Win_create(vec.arr.data(), vec.arr.size() * sizeof(NT), sizeof(NT), MPI_INFO_NULL, World, &win);
+		ownwin = true;
+	}
+}
+
+template <class IT, class NT>
+DistVecAggregator<IT,NT>::~DistVecAggregator()
+{
+	if(ownwin)
+		MPI_Win_free(&win);
+}
+
+template <class IT, class NT>
+void DistVecAggregator<IT,NT>::EndEpoch()
+{
+	cache.clear();
+	MPI_Barrier(vec.commGrid->GetWorld());	// nobody reads entries that are about to change
+}
+
+template <class IT, class NT>
+IT DistVecAggregator<IT,NT>::Get(IT globind)
+{
+	if(flushed)	// start a new batch
+	{
+		values.clear();
+		ticketof.clear();
+		flushed = false;
+	}
+	IT locind;
+	int owner = vec.Owner(globind, locind);
+	IT ticket = values.size();
+	if(owner == myrank)
+	{
+		values.push_back(vec.arr[locind]);
+		return ticket;
+	}
+	auto cached = cache.find(globind);
+	if(cached != cache.end())
+	{
+		++(cached->second.second);
+		++hits;
+		values.push_back(cached->second.first);
+		return ticket;
+	}
+	auto pending = ticketof.find(globind);
+	if(pending != ticketof.end())
+		return pending->second;
+
+	ticketof[globind] = ticket;
+	values.push_back(NT());
+	getind[owner].push_back(locind);
+	getticket[owner].push_back(ticket);
+	return ticket;
+}
+
+// an indexed datatype that picks locinds out of the target's window, in order
+template <class IT, class NT>
+MPI_Datatype DistVecAggregator<IT,NT>::IndexedType(const std::vector<IT> & locinds) const
+{
+	std::vector<MPI_Aint> displs(locinds.size());
+	for(size_t j=0; j< locinds.size(); ++j)
+		displs[j] = static_cast<MPI_Aint>(locinds[j]) * sizeof(NT);
+	MPI_Datatype indexed;
+	MPI_Type_create_hindexed_block(static_cast<int>(locinds.size()), 1, displs.data(), MPIType<NT>(), &indexed);
+	MPI_Type_commit(&indexed);
+	return indexed;
+}
+
+template <class IT, class NT>
+void DistVecAggregator<IT,NT>::FlushGets()
+{
+	std::vector< std::vector<NT> > fetched(nprocs);
+	if(trans == ONESIDED)
+	{
+		std::vector<MPI_Datatype> types;
+		MPI_Win_lock_all(MPI_MODE_NOCHECK, win);
+		for(int i=0; i<nprocs; ++i)
+		{
+			if(getind[i].empty())	continue;
+			fetched[i].resize(getind[i].size());
+			types.push_back(IndexedType(getind[i]));
+			MPI_Get(fetched[i].data(), static_cast<int>(fetched[i].size()), MPIType<NT>(), i, 0, 1, types.back(), win);
+		}
+		MPI_Win_unlock_all(win);
+		for(size_t t=0; t< types.size(); ++t)
+			MPI_Type_free(&types[t]);
+	}
+	else
+	{
+		MPI_Comm World = vec.commGrid->GetWorld();
+		int * sendcnt = new int[nprocs];
+		int * recvcnt = new int[nprocs];
+		int * sdispls = new int[nprocs]();
+		int * rdispls = new int[nprocs]();
+		for(int i=0; i<nprocs; ++i)
+			sendcnt[i] = static_cast<int>(getind[i].size());
+		MPI_Alltoall(sendcnt, 1, MPI_INT, recvcnt, 1, MPI_INT, World);
+		std::partial_sum(sendcnt, sendcnt+nprocs-1, sdispls+1);
+		std::partial_sum(recvcnt, recvcnt+nprocs-1, rdispls+1);
+		IT totsend = std::accumulate(sendcnt, sendcnt+nprocs, static_cast<IT>(0));
+		IT totrecv = std::accumulate(recvcnt, recvcnt+nprocs, static_cast<IT>(0));
+
+		std::vector<IT> sendind(totsend);
+		for(int i=0; i<nprocs; ++i)
+			std::copy(getind[i].begin(), getind[i].end(), sendind.begin() + sdispls[i]);
+		std::vector<IT> recvind(totrecv);
+		MPI_Alltoallv(sendind.data(), sendcnt, sdispls, MPIType<IT>(), recvind.data(), recvcnt, rdispls, MPIType<IT>(), World);
+
+		std::vector<NT> reply(totrecv);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for(IT j=0; j< totrecv; ++j)
+			reply[j] = vec.arr[recvind[j]];
+
+		std::vector<NT> answers(totsend);
+		MPI_Alltoallv(reply.data(), recvcnt, rdispls, MPIType<NT>(), answers.data(), sendcnt, sdispls, MPIType<NT>(), World);
+		for(int i=0; i<nprocs; ++i)
+			fetched[i].assign(answers.begin() + sdispls[i], answers.begin() + sdispls[i] + sendcnt[i]);
+		DeleteAll(sendcnt, recvcnt, sdispls, rdispls);
+	}
+
+	for(int i=0; i<nprocs; ++i)
+	{
+		for(size_t j=0; j< fetched[i].size(); ++j)
+			values[getticket[i][j]] = fetched[i][j];
+		getind[i].clear();
+		getticket[i].clear();
+	}
+	for(auto it = ticketof.begin(); it != ticketof.end(); ++it)
+		InsertCache(it->first, values[it->second]);
+	flushed = true;
+}
+
+// keep newly fetched entries while there is room; when full,
+// drop everything that was never hit and age the survivors
+template <class IT, class NT>
+void DistVecAggregator<IT,NT>::InsertCache(IT globind, NT val)
+{
+	if(cachecap == 0)	return;
+	if(cache.size() >= cachecap)
+	{
+		for(auto it = cache.begin(); it != cache.end(); )
+		{
+			if(it->second.second == 0)
+				it = cache.erase(it);
+			else
+			{
+				it->second.second /= 2;
+				++it;
+			}
+		}
+		if(cache.size() >= cachecap)	return;
+	}
+	cache[globind] = std::make_pair(val, static_cast<IT>(0));
+}
+
+template <class IT, class NT>
+template <typename _BinaryOperation>
+void DistVecAggregator<IT,NT>::Put(IT globind, NT val, _BinaryOperation __binop)
+{
+	IT locind;
+	int owner = vec.Owner(globind, locind);
+	if(owner == myrank)
+	{
+		vec.arr[locind] = __binop(vec.arr[locind], val);
+		return;
+	}
+	cache.erase(globind);
+	auto pending = putslot.find(globind);
+	if(pending != putslot.end())
+	{
+		NT & prev = putval[owner][pending->second];
+		prev = __binop(prev, val);
+	}
+	else
+	{
+		putslot[globind] = putind[owner].size();
+		putind[owner].push_back(locind);
+		putval[owner].push_back(val);
+	}
+}
+
+template <class IT, class NT>
+template <typename _BinaryOperation>
+void DistVecAggregator<IT,NT>::FlushPuts(_BinaryOperation __binop, MPI_Op mpiop)
+{
+	if(trans == ONESIDED)
+	{
+		std::vector<MPI_Datatype> types;
+		MPI_Win_lock_all(MPI_MODE_NOCHECK, win);
+		for(int i=0; i<nprocs; ++i)
+		{
+			if(putind[i].empty())	continue;
+			types.push_back(IndexedType(putind[i]));
+			MPI_Accumulate(putval[i].data(), static_cast<int>(putval[i].size()), MPIType<NT>(), i, 0, 1, types.back(), mpiop, win);
+		}
+		MPI_Win_unlock_all(win);
+		for(size_t t=0; t< types.size(); ++t)
+			MPI_Type_free(&types[t]);
+	}
+	else
+	{
+		MPI_Comm World = vec.commGrid->GetWorld();
+		int * sendcnt = new int[nprocs];
+		int * recvcnt = new int[nprocs];
+		int * sdispls = new int[nprocs]();
+		int * rdispls = new int[nprocs]();
+		for(int i=0; i<nprocs; ++i)
+			sendcnt[i] = static_cast<int>(putind[i].size());
+		MPI_Alltoall(sendcnt, 1, MPI_INT, recvcnt, 1, MPI_INT, World);
+		std::partial_sum(sendcnt, sendcnt+nprocs-1, sdispls+1);
+		std::partial_sum(recvcnt, recvcnt+nprocs-1, rdispls+1);
+		IT totsend = std::accumulate(sendcnt, sendcnt+nprocs, static_cast<IT>(0));
+		IT totrecv = std::accumulate(recvcnt, recvcnt+nprocs, static_cast<IT>(0));
+
+		std::vector<IT> sendind(totsend);
+		std::vector<NT> sendval(totsend);
+		for(int i=0; i<nprocs; ++i)
+		{
+			std::copy(putind[i].begin(), putind[i].end(), sendind.begin() + sdispls[i]);
+			std::copy(putval[i].begin(), putval[i].end(), sendval.begin() + sdispls[i]);
+		}
+		std::vector<IT> recvind(totrecv);
+		std::vector<NT> recvval(totrecv);
+		MPI_Alltoallv(sendind.data(), sendcnt, sdispls, MPIType<IT>(), recvind.data(), recvcnt, rdispls, MPIType<IT>(), World);
+		MPI_Alltoallv(sendval.data(), sendcnt, sdispls, MPIType<NT>(), recvval.data(), recvcnt, rdispls, MPIType<NT>(), World);
+		for(IT j=0; j< totrecv; ++j)	// in rank order, so the outcome is deterministic
+			vec.arr[recvind[j]] = __binop(vec.arr[recvind[j]], recvval[j]);
+		DeleteAll(sendcnt, recvcnt, sdispls, rdispls);
+	}
+	for(int i=0; i<nprocs; ++i)
+	{
+		putind[i].clear();
+		putval[i].clear();
+	}
+	putslot.clear();
+}
+
+}
+
+#endif
@@ -48,6 +48,57 @@ struct HeaderInfo
 	uint64_t nnz;
 };
 	
+#define CHECKPOINT_BYTEORDER 0x01020304	// as written by the host, so a file from a host of the other byte order reads 0x04030201
+#define CHECKPOINT_VERSION 2		// bumped whenever the layout of the header, the block arrays or the block index changes
+
+//! Header of the native binary checkpoint written by SpParMat::SaveCheckpoint
+//! It is followed by the arrays of every local block (in rank order) and by the block index
+struct CheckpointHeader
+{
+	char magic[8];		// "CBCKPT1"
+	uint32_t byteorder;	// CHECKPOINT_BYTEORDER
+	uint32_t version;	// CHECKPOINT_VERSION
+	uint32_t itsize;	// sizeof(IT)
+	uint32_t litsize;	// sizeof(DER::LocalIT)
+	uint32_t ntsize;	// sizeof(NT), 0 for pattern matrices whose values are not stored
+	uint32_t esscount;	// essentials per block
+	uint32_t nprocs;	// number of blocks
+	uint32_t gridrows;
+	uint32_t gridcols;
+	uint32_t reserved;
+	uint64_t m;
+	uint64_t n;
+	uint64_t nnz;
+	uint64_t indexoffset;	// byte offset of the block index: per block, its offset, row offset, column offset and essentials
+};
+
+//! Header of the block-compressed edge list written by SpParMat::SaveCompressedEdges and DistEdgeList::DumpCompressed
+//! It is followed by the blocks (see SpHelper::EncodeEdgeBlock) and by the block index: per block, its byte offset and number of edges
+struct EdgeListHeader
+{
+	char magic[8];		// "CBEDGZ1"
+	uint32_t ntsize;	// bytes of the value stored after the indices of every edge; 0 if there are no values
+	uint32_t reserved;
+	uint64_t m;
+	uint64_t n;
+	uint64_t nedges;
+	uint64_t nblocks;
+	uint64_t indexoffset;	// byte offset of the block index
+};
+
+//! Header of the binary vector file written by FullyDistVec::ParallelBinaryWrite and FullyDistSpVec::ParallelBinaryWrite
+//! A dense vector is followed by its glen values in index order; a sparse one by its nnz global indices (sorted) and then its nnz values
+struct VectorFileHeader
+{
+	char magic[8];		// "CBVEC1"
+	uint32_t itsize;	// sizeof(IT)
+	uint32_t ntsize;	// sizeof(NT)
+	uint32_t sparse;	// 1 if the indices are stored
+	uint32_t reserved;
+	uint64_t glen;
+	uint64_t nnz;		// number of stored values (glen for a dense vector)
+};
+
 // cout's are OK because ParseHeader is run by a single processor only
 inline HeaderInfo ParseHeader(const std::string & inputname, FILE * & f, int & seeklength)
 {
@@ -102,6 +153,188 @@ inline HeaderInfo ParseHeader(const std::string & inputname, FILE * & f, int & s
 	seeklength = 4 + 6 * sizeof(uint64_t);
 	return hinfo;
 }
+
+/**
+ * Writes a compressed edge list collectively: every process contributes its encoded blocks (concatenated, with the
+ * bytes and edges of each), which are laid out in rank order after the header and followed by the block index
+ * header supplies m, n and ntsize; the rest is filled in here
+ **/
+inline void WriteEdgeBlocks(const std::string & filename, EdgeListHeader header, const std::vector<unsigned char> & blocks,
+				const std::vector<uint64_t> & blockbytes, const std::vector<uint64_t> & blockedges, MPI_Comm comm)
+{
+	int myrank, nprocs;
+	MPI_Comm_rank(comm, &myrank);
+	MPI_Comm_size(comm, &nprocs);
+
+	int64_t mybytes = blocks.size();
+	int64_t bytesuntil = 0, bytestotal = 0;
+	MPI_Exscan(&mybytes, &bytesuntil, 1, MPIType<int64_t>(), MPI_SUM, comm);
+	if(myrank == 0) bytesuntil = 0;    // because MPI_Exscan says the recvbuf in process 0 is undefined
+	MPI_Allreduce(&mybytes, &bytestotal, 1, MPIType<int64_t>(), MPI_SUM, comm);
+
+	int myblocks = blockbytes.size();
+	std::vector<uint64_t> myindex(2*myblocks);	// (offset, edges) of every block
+	uint64_t offset = sizeof(EdgeListHeader) + bytesuntil;
+	uint64_t counts[2] = {0, static_cast<uint64_t>(myblocks)};	// edges, blocks
+	for(int b=0; b<myblocks; ++b)
+	{
+		myindex[2*b] = offset;
+		myindex[2*b+1] = blockedges[b];
+		offset += blockbytes[b];
+		counts[0] += blockedges[b];
+	}
+	MPI_Allreduce(MPI_IN_PLACE, counts, 2, MPIType<uint64_t>(), MPI_SUM, comm);
+
+	int mycount = 2*myblocks;
+	std::vector<int> recvcnt(nprocs), displs(nprocs, 0);
+	MPI_Gather(&mycount, 1, MPI_INT, recvcnt.data(), 1, MPI_INT, 0, comm);
+	std::partial_sum(recvcnt.begin(), recvcnt.end()-1, displs.begin()+1);
+	std::vector<uint64_t> index((myrank == 0)? 2*counts[1] : 0);
+	MPI_Gatherv(myindex.data(), mycount, MPIType<uint64_t>(), index.data(), recvcnt.data(), displs.data(), MPIType<uint64_t>(), 0, comm);
+
+	strncpy(header.magic, "CBEDGZ1", sizeof(header.magic));
+	header.nedges = counts[0];
+	header.nblocks = counts[1];
+	header.indexoffset = sizeof(EdgeListHeader) + bytestotal;
+
+	MPI_File thefile;
+	if(MPI_File_open(comm, (char*) filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &thefile) != MPI_SUCCESS)
+	{
+		SpParHelper::Print("COMBBLAS: Edge list " + filename + " can not be created\n", comm);
+		MPI_Abort(MPI_COMM_WORLD, NOFILE);
+	}
+	MPI_File_set_size(thefile, 0);	// drop the contents of an older file
+	if(myrank == 0)
+	{
+		MPI_File_write_at(thefile, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+		MPI_File_write_at(thefile, header.indexoffset, index.data(), index.size(), MPIType<uint64_t>(), MPI_STATUS_IGNORE);
+	}
+	SpParHelper::FileAccessAll(thefile, sizeof(EdgeListHeader) + bytesuntil, const_cast<unsigned char *>(blocks.data()), mybytes, true, comm);
+	MPI_File_close(&thefile);
+}
+
+/**
+ * Creates (or truncates) a binary vector file collectively; process 0 writes the header, which is completed here
+ * @return the open file, to be filled with SpParHelper::FileAccessAll and closed by the caller
+ **/
+inline MPI_File CreateVectorFile(const std::string & filename, VectorFileHeader header, MPI_Comm comm)
+{
+	int myrank;
+	MPI_Comm_rank(comm, &myrank);
+	strncpy(header.magic, "CBVEC1", sizeof(header.magic));
+
+	MPI_File thefile;
+	if(MPI_File_open(comm, (char*) filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &thefile) != MPI_SUCCESS)
+	{
+		SpParHelper::Print("COMBBLAS: Vector file " + filename + " can not be created\n", comm);
+		MPI_Abort(MPI_COMM_WORLD, NOFILE);
+	}
+	MPI_File_set_size(thefile, 0);	// drop the contents of an older file
+	if(myrank == 0)
+		MPI_File_write_at(thefile, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+	return thefile;
+}
+
+/**
+ * Opens a binary vector file collectively and returns its header (read by process 0 and broadcast)
+ * Aborts if the file is missing or was written with different index or value types
+ **/
+inline VectorFileHeader OpenVectorFile(const std::string & filename, uint32_t itsize, uint32_t ntsize, MPI_File & thefile, MPI_Comm comm)
+{
+	int myrank;
+	MPI_Comm_rank(comm, &myrank);
+	if(MPI_File_open(comm, (char*) filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &thefile) != MPI_SUCCESS)
+	{
+		SpParHelper::Print("COMBBLAS: Vector file " + filename + " can not be found\n", comm);
+		MPI_Abort(MPI_COMM_WORLD, NOFILE);
+	}
+	VectorFileHeader header;
+	memset(&header, 0, sizeof(header));
+	if(myrank == 0)
+		MPI_File_read_at(thefile, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+	MPI_Bcast(&header, sizeof(header), MPI_BYTE, 0, comm);
+
+	header.magic[sizeof(header.magic)-1] = '\0';
+	if(strcmp(header.magic, "CBVEC1") != 0)
+	{
+		SpParHelper::Print("COMBBLAS: " + filename + " is not a binary vector file\n", comm);
+		MPI_Abort(MPI_COMM_WORLD, NOFILE);
+	}
+	if(header.itsize != itsize || header.ntsize != ntsize)
+	{
+		SpParHelper::Print("COMBBLAS: Vector file " + filename + " was written with different index or value types\n", comm);
+		MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+	}
+	return header;
+}
+
+/**
+ * Memory-maps the share of this process of a compressed edge list: a contiguous range of blocks, balanced by edges
+ * @return the address of its first block, to which blockoffsets are relative (NULL if the share is empty)
+ * @param[out] mapbase, maplength {the mapping, to be released with SpParHelper::UnmapFileRange}
+ **/
+inline const unsigned char * MapEdgeBlocks(const std::string & filename, EdgeListHeader & header, std::vector<uint64_t> & blockoffsets,
+				std::vector<uint64_t> & blockedges, void * & mapbase, size_t & maplength, MPI_Comm comm)
+{
+	int myrank, nprocs;
+	MPI_Comm_rank(comm, &myrank);
+	MPI_Comm_size(comm, &nprocs);
+
+	memset(&header, 0, sizeof(header));
+	std::vector<uint64_t> index;
+	if(myrank == 0)
+	{
+		FILE * f = fopen(filename.c_str(), "rb");
+		if(f != NULL)
+		{
+			if(fread(&header, sizeof(header), 1, f) == 1 && strncmp(header.magic, "CBEDGZ1", sizeof(header.magic)) == 0)
+			{
+				index.resize(2*header.nblocks);
+				fseek(f, header.indexoffset, SEEK_SET);
+				if(fread(index.data(), sizeof(uint64_t), index.size(), f) != index.size())
+					header.magic[0] = '\0';
+			}
+			else
+				header.magic[0] = '\0';
+			fclose(f);
+		}
+	}
+	MPI_Bcast(&header, sizeof(header), MPI_BYTE, 0, comm);
+	if(strncmp(header.magic, "CBEDGZ1", sizeof(header.magic)) != 0)
+	{
+		SpParHelper::Print("COMBBLAS: " + filename + " is not a readable compressed edge list\n", comm);
+		MPI_Abort(MPI_COMM_WORLD, NOFILE);
+	}
+	index.resize(2*header.nblocks);
+	MPI_Bcast(index.data(), index.size(), MPIType<uint64_t>(), 0, comm);
+
+	// this process decodes the blocks that start in its share of the edges
+	uint64_t edgebegin = header.nedges * myrank / nprocs;
+	uint64_t edgeend = header.nedges * (myrank+1) / nprocs;
+	uint64_t first = header.nblocks, last = header.nblocks, edgesbefore = 0;
+	for(uint64_t b = 0; b < header.nblocks; ++b)
+	{
+		if(first == header.nblocks && edgesbefore >= edgebegin)	first = b;
+		if(edgesbefore >= edgeend)
+		{
+			last = b;
+			break;
+		}
+		edgesbefore += index[2*b+1];
+	}
+	if(first > last) first = last;
+
+	blockoffsets.clear();
+	blockedges.clear();
+	uint64_t startbyte = (first < header.nblocks)? index[2*first] : header.indexoffset;
+	uint64_t endbyte = (last < header.nblocks)? index[2*last] : header.indexoffset;
+	for(uint64_t b = first; b < last; ++b)
+	{
+		blockoffsets.push_back(index[2*b] - startbyte);
+		blockedges.push_back(index[2*b+1]);
+	}
+	return reinterpret_cast<const unsigned char *>(SpParHelper::MapFileRange(filename, startbyte, endbyte - startbyte, mapbase, maplength));
+}
 				  
 
 }
@@ -60,20 +60,26 @@ class Dcsc;
 
 
 //! SpMV with dense vector
+//! Row ids are read from the 16-bit ir16 when the block keeps it (see Dcsc::NarrowRowIndices), this and the kernels below
 template <typename SR, typename IU, typename NU, typename RHS, typename LHS>
 void dcsc_gespmv (const SpDCCols<IU, NU> & A, const RHS * x, LHS * y)
 {
 	if(A.nnz > 0)
 	{	
-		for(IU j =0; j<A.dcsc->nzc; ++j)	// for all nonzero columns
+		auto spmv = [&](const auto * rowids)
 		{
-			IU colid = A.dcsc->jc[j];
-			for(IU i = A.dcsc->cp[j]; i< A.dcsc->cp[j+1]; ++i)
+			for(IU j =0; j<A.dcsc->nzc; ++j)	// for all nonzero columns
 			{
-				IU rowid = A.dcsc->ir[i];
-				SR::axpy(A.dcsc->numx[i], x[colid], y[rowid]);
+				IU colid = A.dcsc->jc[j];
+				for(IU i = A.dcsc->cp[j]; i< A.dcsc->cp[j+1]; ++i)
+				{
+					IU rowid = rowids[i];
+					SR::axpy(A.dcsc->numx[i], x[colid], y[rowid]);
+				}
 			}
-		}
+		};
+		if(A.dcsc->ir16 != NULL)	spmv(A.dcsc->ir16);
+		else	spmv(A.dcsc->ir);
 	}
 }
 
@@ -100,23 +106,28 @@ void dcsc_gespmv_threaded_nosplit (const SpDCCols<IU, NU> & A, const RHS * x, LH
 			std::fill_n(tomerge[i], nlocrows, id);		
 		}
 
-		#pragma omp parallel for
-		for(IU j =0; j<A.dcsc->nzc; ++j)	// for all nonzero columns
+		auto spmv = [&](const auto * rowids)
 		{
-			int curthread = 1;
-			#ifdef _OPENMP
-			curthread = omp_get_thread_num();
-			#endif
+			#pragma omp parallel for
+			for(IU j =0; j<A.dcsc->nzc; ++j)	// for all nonzero columns
+			{
+				int curthread = 1;
+				#ifdef _OPENMP
+				curthread = omp_get_thread_num();
+				#endif
 			
-			LHS * loc2merge = tomerge[curthread];
+				LHS * loc2merge = tomerge[curthread];
 
-			IU colid = A.dcsc->jc[j];
-			for(IU i = A.dcsc->cp[j]; i< A.dcsc->cp[j+1]; ++i)
-			{
-				IU rowid = A.dcsc->ir[i];
-				SR::axpy(A.dcsc->numx[i], x[colid], loc2merge[rowid]);
+				IU colid = A.dcsc->jc[j];
+				for(IU i = A.dcsc->cp[j]; i< A.dcsc->cp[j+1]; ++i)
+				{
+					IU rowid = rowids[i];
+					SR::axpy(A.dcsc->numx[i], x[colid], loc2merge[rowid]);
+				}
 			}
-		}
+		};
+		if(A.dcsc->ir16 != NULL)	spmv(A.dcsc->ir16);
+		else	spmv(A.dcsc->ir);
 
 		#pragma omp parallel for
 		for(IU j=0; j < nlocrows; ++j)
@@ -155,15 +166,20 @@ void dcsc_gespmv_threaded_nosplit (const SpDCCols<IU, NU> & A, const RHS * x, LH
                 for(int s=0; s<splits; ++s)
                 {
                     Dcsc<IU, NU> * dcsc = A.GetInternal(s);
-                    for(IU j =0; j<dcsc->nzc; ++j)    // for all nonzero columns
+                    auto spmv = [&](const auto * rowids)
                     {
-                        IU colid = dcsc->jc[j];
-                        for(IU i = dcsc->cp[j]; i< dcsc->cp[j+1]; ++i)
+                        for(IU j =0; j<dcsc->nzc; ++j)    // for all nonzero columns
                         {
-                            IU rowid = dcsc->ir[i] + disp[s];
-                            SR::axpy(dcsc->numx[i], x[colid], y[rowid]);
+                            IU colid = dcsc->jc[j];
+                            for(IU i = dcsc->cp[j]; i< dcsc->cp[j+1]; ++i)
+                            {
+                                IU rowid = rowids[i] + disp[s];
+                                SR::axpy(dcsc->numx[i], x[colid], y[rowid]);
+                            }
                         }
-                    }
+                    };
+                    if(dcsc->ir16 != NULL)  spmv(dcsc->ir16);
+                    else    spmv(dcsc->ir);
                 }
             }
             else
@@ -546,6 +562,8 @@ void BooleanRowSplit(SpDCCols<IU, bool> & A, int numsplits)
                 }
             }
             A.dcscarr[i]->cp[curnzc] = nnzs[i];
+            A.dcscarr[i]->NarrowRowIndices(i < A.splits-1 ? perpiece : A.m - (A.splits-1)*perpiece);
+            A.dcscarr[i]->ChooseColumnLayout(A.n);
         }
         else
         {
@@ -659,6 +677,7 @@ SpTuples<IU, NUO> * Tuples_AtXBn
 template<class SR, class IU, class NU>
 SpTuples<IU,NU> MergeAll( const std::vector<SpTuples<IU,NU> *> & ArrSpTups, IU mstar = 0, IU nstar = 0, bool delarrs = false )
 {
+	MemoryTracker::Scope scope(MEM_MERGE);
 	int hsize =  ArrSpTups.size();		
 	if(hsize == 0)
 	{
@@ -741,248 +760,238 @@ SpTuples<IU,NU> MergeAll( const std::vector<SpTuples<IU,NU> *> & ArrSpTups, IU m
 }
 
 /**
- * @param[in]   exclude if false,
- *      \n              then operation is A = A .* B
- *      \n              else operation is A = A .* not(B) 
+ * Column-parallel driver of the element-wise operations on two Dcsc's (either can be NULL, i.e. empty)
+ * Nonzero columns of A and B are matched by a sequential merge of their jc's and the matched columns are split 
+ * into ranges of equal total nonzeros, one per thread. In the first pass colop counts the output of each column; 
+ * the counts are prefix summed, dropping the empty columns, and in the second pass colop writes each column at its offset
+ * @param[in]	keepAOnly,keepBOnly whether a column that only exists in A (resp. B) can produce any output
+ * @param[in]	colop colop(ia, ib, outir, outnumx) handles column ia of A and column ib of B, where ia == A.nzc 
+ *	\n		(ib == B.nzc) if the column is empty in A (B). It returns the number of outputs and writes them iff outir != NULL
+ * \remarks colop (hence the user's operations) is called concurrently by multiple threads
  **/
-template <typename IU, typename NU1, typename NU2>
-Dcsc<IU, typename promote_trait<NU1,NU2>::T_promote> EWiseMult(const Dcsc<IU,NU1> & A, const Dcsc<IU,NU2> * B, bool exclude)
+template <typename RETT, typename IU, typename NU1, typename NU2, typename _ColumnOperation>
+Dcsc<IU,RETT> EWiseColumns(const Dcsc<IU,NU1> * Ap, const Dcsc<IU,NU2> * Bp, bool keepAOnly, bool keepBOnly, _ColumnOperation colop)
 {
-	typedef typename promote_trait<NU1,NU2>::T_promote N_promote;
-	IU estnzc, estnz;
-	if(exclude)
-	{	
-		estnzc = A.nzc;
-		estnz = A.nz; 
-	} 
-	else
-	{
-		estnzc = std::min(A.nzc, B->nzc);
-		estnz  = std::min(A.nz, B->nz);
-	}
-
-	Dcsc<IU,N_promote> temp(estnz, estnzc);
-
-	IU curnzc = 0;
-	IU curnz = 0;
+	IU anzc = (Ap == NULL)? 0 : Ap->nzc;
+	IU bnzc = (Bp == NULL)? 0 : Bp->nzc;
+	std::vector<IU> mjc, colA, colB;
 	IU i = 0;
 	IU j = 0;
-	temp.cp[0] = 0;
-	
-	if(!exclude)	// A = A .* B
+	while(i < anzc || j < bnzc)
 	{
-		while(i< A.nzc && B != NULL && j<B->nzc)
+		if((j == bnzc && !keepAOnly) || (i == anzc && !keepBOnly))
+			break;
+		if(j == bnzc || (i < anzc && Ap->jc[i] < Bp->jc[j]))
 		{
-			if(A.jc[i] > B->jc[j]) 		++j;
-			else if(A.jc[i] < B->jc[j]) 	++i;
-			else
+			if(keepAOnly)
 			{
-				IU ii = A.cp[i];
-				IU jj = B->cp[j];
-				IU prevnz = curnz;		
-				while (ii < A.cp[i+1] && jj < B->cp[j+1])
-				{
-					if (A.ir[ii] < B->ir[jj])	++ii;
-					else if (A.ir[ii] > B->ir[jj])	++jj;
-					else
-					{
-						temp.ir[curnz] = A.ir[ii];
-						temp.numx[curnz++] = A.numx[ii++] * B->numx[jj++];	
-					}
-				}
-				if(prevnz < curnz)	// at least one nonzero exists in this column
-				{
-					temp.jc[curnzc++] = A.jc[i];	
-					temp.cp[curnzc] = temp.cp[curnzc-1] + curnz-prevnz;
-				}
-				++i;
-				++j;
+				mjc.push_back(Ap->jc[i]);
+				colA.push_back(i);
+				colB.push_back(bnzc);
 			}
+			++i;
 		}
-	}
-	else	// A = A .* not(B)
-	{
-		while(i< A.nzc && B != NULL && j< B->nzc)
+		else if(i == anzc || Ap->jc[i] > Bp->jc[j])
 		{
-			if(A.jc[i] > B->jc[j])		++j;
-			else if(A.jc[i] < B->jc[j])
+			if(keepBOnly)
 			{
-				temp.jc[curnzc++] = A.jc[i++];
-				for(IU k = A.cp[i-1]; k< A.cp[i]; k++)	
-				{
-					temp.ir[curnz] 		= A.ir[k];
-					temp.numx[curnz++] 	= A.numx[k];
-				}
-				temp.cp[curnzc] = temp.cp[curnzc-1] + (A.cp[i] - A.cp[i-1]);
-			}
-			else
-			{
-				IU ii = A.cp[i];
-				IU jj = B->cp[j];
-				IU prevnz = curnz;		
-				while (ii < A.cp[i+1] && jj < B->cp[j+1])
-				{
-					if (A.ir[ii] > B->ir[jj])	++jj;
-					else if (A.ir[ii] < B->ir[jj])
-					{
-						temp.ir[curnz] = A.ir[ii];
-						temp.numx[curnz++] = A.numx[ii++];
-					}
-					else	// eliminate those existing nonzeros
-					{
-						++ii;	
-						++jj;	
-					}
-				}
-				while (ii < A.cp[i+1])
-				{
-					temp.ir[curnz] = A.ir[ii];
-					temp.numx[curnz++] = A.numx[ii++];
-				}
-
-				if(prevnz < curnz)	// at least one nonzero exists in this column
-				{
-					temp.jc[curnzc++] = A.jc[i];	
-					temp.cp[curnzc] = temp.cp[curnzc-1] + curnz-prevnz;
-				}
-				++i;
-				++j;
+				mjc.push_back(Bp->jc[j]);
+				colA.push_back(anzc);
+				colB.push_back(j);
 			}
+			++j;
 		}
-		while(i< A.nzc)
+		else
 		{
-			temp.jc[curnzc++] = A.jc[i++];
-			for(IU k = A.cp[i-1]; k< A.cp[i]; ++k)
-			{
-				temp.ir[curnz] 	= A.ir[k];
-				temp.numx[curnz++] = A.numx[k];
-			}
-			temp.cp[curnzc] = temp.cp[curnzc-1] + (A.cp[i] - A.cp[i-1]);
+			mjc.push_back(Ap->jc[i]);
+			colA.push_back(i++);
+			colB.push_back(j++);
 		}
 	}
-
-	temp.Resize(curnzc, curnz);
-	return temp;
-}	
-
-template <typename N_promote, typename IU, typename NU1, typename NU2, typename _BinaryOperation>
-Dcsc<IU, N_promote> EWiseApply(const Dcsc<IU,NU1> & A, const Dcsc<IU,NU2> * B, _BinaryOperation __binary_op, bool notB, const NU2& defaultBVal)
-{
-	//typedef typename promote_trait<NU1,NU2>::T_promote N_promote;
-	IU estnzc, estnz;
-	if(notB)
-	{	
-		estnzc = A.nzc;
-		estnz = A.nz; 
-	} 
-	else
+	IU mnzc = static_cast<IU>(mjc.size());
+	std::vector<IU> work(mnzc+1, 0);
+	for(IU k=0; k < mnzc; ++k)
 	{
-		estnzc = std::min(A.nzc, B->nzc);
-		estnz  = std::min(A.nz, B->nz);
+		IU wk = 0;
+		if(colA[k] < anzc)	wk += Ap->cp[colA[k]+1] - Ap->cp[colA[k]];
+		if(colB[k] < bnzc)	wk += Bp->cp[colB[k]+1] - Bp->cp[colB[k]];
+		work[k+1] = work[k] + wk;
 	}
+	int nthreads = 1;
+#ifdef _OPENMP
+	nthreads = omp_get_max_threads();
+#endif
+	std::vector<IU> splits = SpHelper::PartitionByWork(work, nthreads);
 
-	Dcsc<IU,N_promote> temp(estnz, estnzc);
+	std::vector<IU> mcp(mnzc+1, 0);	// output count, and then the output offset, of each matched column
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+	for(int t=0; t < nthreads; ++t)
+	{
+		for(IU k=splits[t]; k < splits[t+1]; ++k)
+			mcp[k] = colop(colA[k], colB[k], static_cast<IU*>(NULL), static_cast<RETT*>(NULL));
+	}
+	IU nzc = 0;
+	IU nz = 0;
+	for(IU k=0; k < mnzc; ++k)
+	{
+		IU count = mcp[k];
+		mcp[k] = nz;
+		if(count > 0)	++nzc;
+		nz += count;
+	}
+	mcp[mnzc] = nz;
+	if(nz == 0)
+		return Dcsc<IU,RETT>();
 
+	Dcsc<IU,RETT> temp(nz, nzc);
 	IU curnzc = 0;
-	IU curnz = 0;
-	IU i = 0;
-	IU j = 0;
-	temp.cp[0] = 0;
-	
-	if(!notB)	// A = A .* B
+	for(IU k=0; k < mnzc; ++k)
 	{
-		while(i< A.nzc && B != NULL && j<B->nzc)
+		if(mcp[k+1] > mcp[k])
 		{
-			if(A.jc[i] > B->jc[j]) 		++j;
-			else if(A.jc[i] < B->jc[j]) 	++i;
-			else
+			temp.jc[curnzc] = mjc[k];
+			temp.cp[curnzc++] = mcp[k];
+		}
+	}
+	temp.cp[nzc] = nz;
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+	for(int t=0; t < nthreads; ++t)
+	{
+		for(IU k=splits[t]; k < splits[t+1]; ++k)
+		{
+			if(mcp[k+1] > mcp[k])
+				colop(colA[k], colB[k], temp.ir + mcp[k], temp.numx + mcp[k]);
+		}
+	}
+	return temp;
+}
+
+/**
+ * @param[in]   exclude if false,
+ *      \n              then operation is A = A .* B
+ *      \n              else operation is A = A .* not(B) 
+ **/
+template <typename IU, typename NU1, typename NU2>
+Dcsc<IU, typename promote_trait<NU1,NU2>::T_promote> EWiseMult(const Dcsc<IU,NU1> & A, const Dcsc<IU,NU2> * B, bool exclude)
+{
+	typedef typename promote_trait<NU1,NU2>::T_promote N_promote;
+	IU bnzc = (B == NULL)? 0 : B->nzc;
+	return EWiseColumns<N_promote>(&A, B, exclude, false, [&A, B, bnzc, exclude](IU i, IU j, IU * outir, N_promote * outnumx)
+	{
+		IU curnz = 0;
+		IU ii = A.cp[i];
+		if(j < bnzc)
+		{
+			IU jj = B->cp[j];
+			while (ii < A.cp[i+1] && jj < B->cp[j+1])
 			{
-				IU ii = A.cp[i];
-				IU jj = B->cp[j];
-				IU prevnz = curnz;		
-				while (ii < A.cp[i+1] && jj < B->cp[j+1])
+				if (A.ir[ii] < B->ir[jj])
 				{
-					if (A.ir[ii] < B->ir[jj])	++ii;
-					else if (A.ir[ii] > B->ir[jj])	++jj;
-					else
+					if(exclude)
 					{
-						temp.ir[curnz] = A.ir[ii];
-						temp.numx[curnz++] = __binary_op(A.numx[ii++], B->numx[jj++]);	
+						if(outir != NULL)
+						{
+							outir[curnz] = A.ir[ii];
+							outnumx[curnz] = A.numx[ii];
+						}
+						++curnz;
 					}
+					++ii;
 				}
-				if(prevnz < curnz)	// at least one nonzero exists in this column
+				else if (A.ir[ii] > B->ir[jj])	++jj;
+				else
 				{
-					temp.jc[curnzc++] = A.jc[i];	
-					temp.cp[curnzc] = temp.cp[curnzc-1] + curnz-prevnz;
+					if(!exclude)
+					{
+						if(outir != NULL)
+						{
+							outir[curnz] = A.ir[ii];
+							outnumx[curnz] = A.numx[ii] * B->numx[jj];
+						}
+						++curnz;
+					}
+					++ii;	// with exclude, eliminate those existing nonzeros
+					++jj;
 				}
-				++i;
-				++j;
 			}
 		}
-	}
-	else	// A = A .* not(B)
-	{
-		while(i< A.nzc && B != NULL && j< B->nzc)
+		if(exclude)
 		{
-			if(A.jc[i] > B->jc[j])		++j;
-			else if(A.jc[i] < B->jc[j])
+			for(; ii < A.cp[i+1]; ++ii)
 			{
-				temp.jc[curnzc++] = A.jc[i++];
-				for(IU k = A.cp[i-1]; k< A.cp[i]; k++)	
+				if(outir != NULL)
 				{
-					temp.ir[curnz] 		= A.ir[k];
-					temp.numx[curnz++] 	= __binary_op(A.numx[k], defaultBVal);
+					outir[curnz] = A.ir[ii];
+					outnumx[curnz] = A.numx[ii];
 				}
-				temp.cp[curnzc] = temp.cp[curnzc-1] + (A.cp[i] - A.cp[i-1]);
+				++curnz;
 			}
-			else
+		}
+		return curnz;
+	});
+}	
+
+template <typename N_promote, typename IU, typename NU1, typename NU2, typename _BinaryOperation>
+Dcsc<IU, N_promote> EWiseApply(const Dcsc<IU,NU1> & A, const Dcsc<IU,NU2> * B, _BinaryOperation __binary_op, bool notB, const NU2& defaultBVal)
+{
+	IU bnzc = (B == NULL)? 0 : B->nzc;
+	return EWiseColumns<N_promote>(&A, B, notB, false, [&A, B, bnzc, notB, &defaultBVal, &__binary_op](IU i, IU j, IU * outir, N_promote * outnumx)
+	{
+		IU curnz = 0;
+		IU ii = A.cp[i];
+		if(j < bnzc)
+		{
+			IU jj = B->cp[j];
+			while (ii < A.cp[i+1] && jj < B->cp[j+1])
 			{
-				IU ii = A.cp[i];
-				IU jj = B->cp[j];
-				IU prevnz = curnz;		
-				while (ii < A.cp[i+1] && jj < B->cp[j+1])
+				if (A.ir[ii] < B->ir[jj])
 				{
-					if (A.ir[ii] > B->ir[jj])	++jj;
-					else if (A.ir[ii] < B->ir[jj])
-					{
-						temp.ir[curnz] = A.ir[ii];
-						temp.numx[curnz++] = __binary_op(A.numx[ii++], defaultBVal);
-					}
-					else	// eliminate those existing nonzeros
+					if(notB)
 					{
-						++ii;	
-						++jj;	
+						if(outir != NULL)
+						{
+							outir[curnz] = A.ir[ii];
+							outnumx[curnz] = __binary_op(A.numx[ii], defaultBVal);
+						}
+						++curnz;
 					}
+					++ii;
 				}
-				while (ii < A.cp[i+1])
-				{
-					temp.ir[curnz] = A.ir[ii];
-					temp.numx[curnz++] = __binary_op(A.numx[ii++], defaultBVal);
-				}
-
-				if(prevnz < curnz)	// at least one nonzero exists in this column
+				else if (A.ir[ii] > B->ir[jj])	++jj;
+				else
 				{
-					temp.jc[curnzc++] = A.jc[i];	
-					temp.cp[curnzc] = temp.cp[curnzc-1] + curnz-prevnz;
+					if(!notB)
+					{
+						if(outir != NULL)
+						{
+							outir[curnz] = A.ir[ii];
+							outnumx[curnz] = __binary_op(A.numx[ii], B->numx[jj]);
+						}
+						++curnz;
+					}
+					++ii;	// with notB, eliminate those existing nonzeros
+					++jj;
 				}
-				++i;
-				++j;
 			}
 		}
-		while(i< A.nzc)
+		if(notB)
 		{
-			temp.jc[curnzc++] = A.jc[i++];
-			for(IU k = A.cp[i-1]; k< A.cp[i]; ++k)
+			for(; ii < A.cp[i+1]; ++ii)
 			{
-				temp.ir[curnz] 	= A.ir[k];
-				temp.numx[curnz++] = __binary_op(A.numx[k], defaultBVal);
+				if(outir != NULL)
+				{
+					outir[curnz] = A.ir[ii];
+					outnumx[curnz] = __binary_op(A.numx[ii], defaultBVal);
+				}
+				++curnz;
 			}
-			temp.cp[curnzc] = temp.cp[curnzc-1] + (A.cp[i] - A.cp[i-1]);
 		}
-	}
-
-	temp.Resize(curnzc, curnz);
-	return temp;
+		return curnz;
+	});
 }
 
 
@@ -994,20 +1003,17 @@ SpDCCols<IU, typename promote_trait<NU1,NU2>::T_promote > EWiseMult (const SpDCC
 	assert(A.n == B.n);
 
 	Dcsc<IU, N_promote> * tdcsc = NULL;
-	if(A.nnz > 0 && B.nnz > 0)
+	if(A.nnz > 0 && (B.nnz > 0 || exclude))
 	{ 
-		tdcsc = new Dcsc<IU, N_promote>(EWiseMult(*(A.dcsc), B.dcsc, exclude));
-		return 	SpDCCols<IU, N_promote> (A.m , A.n, tdcsc);
-	}
-	else if (A.nnz > 0 && exclude) // && B.nnz == 0
-	{
-		tdcsc = new Dcsc<IU, N_promote>(EWiseMult(*(A.dcsc), (const Dcsc<IU,NU2>*)NULL, exclude));
-		return 	SpDCCols<IU, N_promote> (A.m , A.n, tdcsc);
-	}
-	else
-	{
-		return 	SpDCCols<IU, N_promote> (A.m , A.n, tdcsc);
+		const Dcsc<IU,NU2> * Bdcsc = (B.nnz > 0)? B.dcsc : NULL;
+		tdcsc = new Dcsc<IU, N_promote>(EWiseMult(*(A.dcsc), Bdcsc, exclude));
+		if(tdcsc->nz == 0)
+		{
+			delete tdcsc;
+			tdcsc = NULL;
+		}
 	}
+	return 	SpDCCols<IU, N_promote> (A.m , A.n, tdcsc);
 }
 
 
@@ -1019,24 +1025,20 @@ SpDCCols<IU, N_promote> EWiseApply (const SpDCCols<IU,NU1> & A, const SpDCCols<I
 	assert(A.n == B.n);
 
 	Dcsc<IU, N_promote> * tdcsc = NULL;
-	if(A.nnz > 0 && B.nnz > 0)
+	if(A.nnz > 0 && (B.nnz > 0 || notB))
 	{ 
-		tdcsc = new Dcsc<IU, N_promote>(EWiseApply<N_promote>(*(A.dcsc), B.dcsc, __binary_op, notB, defaultBVal));
-		return 	SpDCCols<IU, N_promote> (A.m , A.n, tdcsc);
-	}
-	else if (A.nnz > 0 && notB) // && B.nnz == 0
-	{
-		tdcsc = new Dcsc<IU, N_promote>(EWiseApply<N_promote>(*(A.dcsc), (const Dcsc<IU,NU2>*)NULL, __binary_op, notB, defaultBVal));
-		return 	SpDCCols<IU, N_promote> (A.m , A.n, tdcsc);
-	}
-	else
-	{
-		return 	SpDCCols<IU, N_promote> (A.m , A.n, tdcsc);
+		const Dcsc<IU,NU2> * Bdcsc = (B.nnz > 0)? B.dcsc : NULL;
+		tdcsc = new Dcsc<IU, N_promote>(EWiseApply<N_promote>(*(A.dcsc), Bdcsc, __binary_op, notB, defaultBVal));
+		if(tdcsc->nz == 0)
+		{
+			delete tdcsc;
+			tdcsc = NULL;
+		}
 	}
+	return 	SpDCCols<IU, N_promote> (A.m , A.n, tdcsc);
 }
 
 /** 
- * Implementation based on operator +=
  * Element wise apply with the following constraints
  * The operation to be performed is __binary_op
  * The operation `c = __binary_op(a, b)` is only performed if `do_op(a, b)` returns true
@@ -1047,232 +1049,84 @@ SpDCCols<IU, N_promote> EWiseApply (const SpDCCols<IU,NU1> & A, const SpDCCols<I
 template <typename RETT, typename IU, typename NU1, typename NU2, typename _BinaryOperation, typename _BinaryPredicate>
 Dcsc<IU, RETT> EWiseApply(const Dcsc<IU,NU1> * Ap, const Dcsc<IU,NU2> * Bp, _BinaryOperation __binary_op, _BinaryPredicate do_op, bool allowANulls, bool allowBNulls, const NU1& ANullVal, const NU2& BNullVal, const bool allowIntersect)
 {
-	if (Ap == NULL && Bp == NULL)
-		return Dcsc<IU,RETT>(0, 0);
-	
-	if (Ap == NULL && Bp != NULL)
+	IU anzc = (Ap == NULL)? 0 : Ap->nzc;
+	IU bnzc = (Bp == NULL)? 0 : Bp->nzc;
+	return EWiseColumns<RETT>(Ap, Bp, allowBNulls, allowANulls, [&](IU i, IU j, IU * outir, RETT * outnumx)
 	{
-		if (!allowANulls)
-			return Dcsc<IU,RETT>(0, 0);
-			
-		const Dcsc<IU,NU2> & B = *Bp;
-		IU estnzc = B.nzc;
-		IU estnz  = B.nz;
-		Dcsc<IU,RETT> temp(estnz, estnzc);
-	
-		IU curnzc = 0;
-		IU curnz = 0;
-		//IU i = 0;
-		IU j = 0;
-		temp.cp[0] = 0;
-		while(j<B.nzc)
-		{
-			// Based on the if statement below which handles A null values.
-			j++;
-			IU prevnz = curnz;		
-			temp.jc[curnzc++] = B.jc[j-1];
-			for(IU k = B.cp[j-1]; k< B.cp[j]; ++k)
-			{
-				if (do_op(ANullVal, B.numx[k], true, false))
-				{
-					temp.ir[curnz] 		= B.ir[k];
-					temp.numx[curnz++] 	= __binary_op(ANullVal, B.numx[k], true, false);
-				}
-			}
-			//temp.cp[curnzc] = temp.cp[curnzc-1] + (B.cp[j] - B.cp[j-1]);
-			temp.cp[curnzc] = temp.cp[curnzc-1] + curnz-prevnz;
-		}
-		temp.Resize(curnzc, curnz);
-		return temp;
-	}
-	
-	if (Ap != NULL && Bp == NULL)
-	{
-		if (!allowBNulls)
-			return Dcsc<IU,RETT>(0, 0);
-
-		const Dcsc<IU,NU1> & A = *Ap;
-		IU estnzc = A.nzc;
-		IU estnz  = A.nz;
-		Dcsc<IU,RETT> temp(estnz, estnzc);
-	
-		IU curnzc = 0;
 		IU curnz = 0;
-		IU i = 0;
-		//IU j = 0;
-		temp.cp[0] = 0;
-		while(i< A.nzc)
+		IU ii = (i < anzc)? Ap->cp[i] : 0;
+		IU iend = (i < anzc)? Ap->cp[i+1] : 0;
+		IU jj = (j < bnzc)? Bp->cp[j] : 0;
+		IU jend = (j < bnzc)? Bp->cp[j+1] : 0;
+		while (ii < iend && jj < jend)
 		{
-			i++;
-			IU prevnz = curnz;		
-			temp.jc[curnzc++] = A.jc[i-1];
-			for(IU k = A.cp[i-1]; k< A.cp[i]; k++)
+			if (Ap->ir[ii] < Bp->ir[jj])
 			{
-				if (do_op(A.numx[k], BNullVal, false, true))
+				if (allowBNulls && do_op(Ap->numx[ii], BNullVal, false, true))
 				{
-					temp.ir[curnz] 		= A.ir[k];
-					temp.numx[curnz++] 	= __binary_op(A.numx[k], BNullVal, false, true);
-				}
-			}
-			//temp.cp[curnzc] = temp.cp[curnzc-1] + (A.cp[i] - A.cp[i-1]);
-			temp.cp[curnzc] = temp.cp[curnzc-1] + curnz-prevnz;
-		}
-		temp.Resize(curnzc, curnz);
-		return temp;
-	}
-	
-	// both A and B are non-NULL at this point
-	const Dcsc<IU,NU1> & A = *Ap;
-	const Dcsc<IU,NU2> & B = *Bp;
-	
-	IU estnzc = A.nzc + B.nzc;
-	IU estnz  = A.nz + B.nz;
-	Dcsc<IU,RETT> temp(estnz, estnzc);
-
-	IU curnzc = 0;
-	IU curnz = 0;
-	IU i = 0;
-	IU j = 0;
-	temp.cp[0] = 0;
-	while(i< A.nzc && j<B.nzc)
-	{
-		if(A.jc[i] > B.jc[j])
-		{
-			j++;
-			if (allowANulls)
-			{
-				IU prevnz = curnz;		
-				temp.jc[curnzc++] = B.jc[j-1];
-				for(IU k = B.cp[j-1]; k< B.cp[j]; ++k)
-				{
-					if (do_op(ANullVal, B.numx[k], true, false))
+					if(outir != NULL)
 					{
-						temp.ir[curnz] 		= B.ir[k];
-						temp.numx[curnz++] 	= __binary_op(ANullVal, B.numx[k], true, false);
+						outir[curnz] = Ap->ir[ii];
+						outnumx[curnz] = __binary_op(Ap->numx[ii], BNullVal, false, true);
 					}
+					++curnz;
 				}
-				//temp.cp[curnzc] = temp.cp[curnzc-1] + (B.cp[j] - B.cp[j-1]);
-				temp.cp[curnzc] = temp.cp[curnzc-1] + curnz-prevnz;
+				++ii;
 			}
-		}
-		else if(A.jc[i] < B.jc[j])
-		{
-			i++;
-			if (allowBNulls)
+			else if (Ap->ir[ii] > Bp->ir[jj])
 			{
-				IU prevnz = curnz;		
-				temp.jc[curnzc++] = A.jc[i-1];
-				for(IU k = A.cp[i-1]; k< A.cp[i]; k++)
+				if (allowANulls && do_op(ANullVal, Bp->numx[jj], true, false))
 				{
-					if (do_op(A.numx[k], BNullVal, false, true))
+					if(outir != NULL)
 					{
-						temp.ir[curnz] 		= A.ir[k];
-						temp.numx[curnz++] 	= __binary_op(A.numx[k], BNullVal, false, true);
+						outir[curnz] = Bp->ir[jj];
+						outnumx[curnz] = __binary_op(ANullVal, Bp->numx[jj], true, false);
 					}
+					++curnz;
 				}
-				//temp.cp[curnzc] = temp.cp[curnzc-1] + (A.cp[i] - A.cp[i-1]);
-				temp.cp[curnzc] = temp.cp[curnzc-1] + curnz-prevnz;
+				++jj;
 			}
-		}
-		else
-		{
-			temp.jc[curnzc++] = A.jc[i];
-			IU ii = A.cp[i];
-			IU jj = B.cp[j];
-			IU prevnz = curnz;		
-			while (ii < A.cp[i+1] && jj < B.cp[j+1])
+			else
 			{
-				if (A.ir[ii] < B.ir[jj])
-				{
-					if (allowBNulls && do_op(A.numx[ii], BNullVal, false, true))
-					{
-						temp.ir[curnz] = A.ir[ii];
-						temp.numx[curnz++] = __binary_op(A.numx[ii++], BNullVal, false, true);
-					}
-					else
-						ii++;
-				}
-				else if (A.ir[ii] > B.ir[jj])
+				if (allowIntersect && do_op(Ap->numx[ii], Bp->numx[jj], false, false))
 				{
-					if (allowANulls && do_op(ANullVal, B.numx[jj], true, false))
+					if(outir != NULL)
 					{
-						temp.ir[curnz] = B.ir[jj];
-						temp.numx[curnz++] = __binary_op(ANullVal, B.numx[jj++], true, false);
+						outir[curnz] = Ap->ir[ii];
+						outnumx[curnz] = __binary_op(Ap->numx[ii], Bp->numx[jj], false, false);	// might include zeros
 					}
-					else
-						jj++;
+					++curnz;
 				}
-				else
-				{
-					if (allowIntersect && do_op(A.numx[ii], B.numx[jj], false, false))
-					{
-						temp.ir[curnz] = A.ir[ii];
-						temp.numx[curnz++] = __binary_op(A.numx[ii++], B.numx[jj++], false, false);	// might include zeros
-					}
-					else
-					{
-						ii++;
-						jj++;
-					}
-				}
-			}
-			while (ii < A.cp[i+1])
-			{
-				if (allowBNulls && do_op(A.numx[ii], BNullVal, false, true))
-				{
-					temp.ir[curnz] = A.ir[ii];
-					temp.numx[curnz++] = __binary_op(A.numx[ii++], BNullVal, false, true);
-				}
-				else
-					ii++;
+				++ii;
+				++jj;
 			}
-			while (jj < B.cp[j+1])
-			{
-				if (allowANulls && do_op(ANullVal, B.numx[jj], true, false))
-				{
-					temp.ir[curnz] = B.ir[jj];
-					temp.numx[curnz++] = __binary_op(ANullVal, B.numx[jj++], true, false);
-				}
-				else
-					jj++;
-			}
-			temp.cp[curnzc] = temp.cp[curnzc-1] + curnz-prevnz;
-			++i;
-			++j;
 		}
-	}
-	while(allowBNulls && i< A.nzc) // remaining A elements after B ran out
-	{
-		IU prevnz = curnz;		
-		temp.jc[curnzc++] = A.jc[i++];
-		for(IU k = A.cp[i-1]; k< A.cp[i]; ++k)
+		for(; allowBNulls && ii < iend; ++ii)	// remaining A elements after B ran out
 		{
-			if (do_op(A.numx[k], BNullVal, false, true))
+			if (do_op(Ap->numx[ii], BNullVal, false, true))
 			{
-				temp.ir[curnz] 	= A.ir[k];
-				temp.numx[curnz++] = __binary_op(A.numx[k], BNullVal, false, true);
+				if(outir != NULL)
+				{
+					outir[curnz] = Ap->ir[ii];
+					outnumx[curnz] = __binary_op(Ap->numx[ii], BNullVal, false, true);
+				}
+				++curnz;
 			}
 		}
-		//temp.cp[curnzc] = temp.cp[curnzc-1] + (A.cp[i] - A.cp[i-1]);
-		temp.cp[curnzc] = temp.cp[curnzc-1] + curnz-prevnz;
-	}
-	while(allowANulls && j < B.nzc) // remaining B elements after A ran out
-	{
-		IU prevnz = curnz;		
-		temp.jc[curnzc++] = B.jc[j++];
-		for(IU k = B.cp[j-1]; k< B.cp[j]; ++k)
+		for(; allowANulls && jj < jend; ++jj)	// remaining B elements after A ran out
 		{
-			if (do_op(ANullVal, B.numx[k], true, false))
+			if (do_op(ANullVal, Bp->numx[jj], true, false))
 			{
-				temp.ir[curnz] 	= B.ir[k];
-				temp.numx[curnz++] 	= __binary_op(ANullVal, B.numx[k], true, false);
+				if(outir != NULL)
+				{
+					outir[curnz] = Bp->ir[jj];
+					outnumx[curnz] = __binary_op(ANullVal, Bp->numx[jj], true, false);
+				}
+				++curnz;
 			}
 		}
-		//temp.cp[curnzc] = temp.cp[curnzc-1] + (B.cp[j] - B.cp[j-1]);
-		temp.cp[curnzc] = temp.cp[curnzc-1] + curnz-prevnz;
-	}
-	temp.Resize(curnzc, curnz);
-	return temp;
+		return curnz;
+	});
 }
 
 template <typename RETT, typename IU, typename NU1, typename NU2, typename _BinaryOperation, typename _BinaryPredicate> 
@@ -1281,7 +1135,14 @@ SpDCCols<IU,RETT> EWiseApply (const SpDCCols<IU,NU1> & A, const SpDCCols<IU,NU2>
 	assert(A.m == B.m);
 	assert(A.n == B.n);
 
-	Dcsc<IU, RETT> * tdcsc = new Dcsc<IU, RETT>(EWiseApply<RETT>(A.dcsc, B.dcsc, __binary_op, do_op, allowANulls, allowBNulls, ANullVal, BNullVal, allowIntersect));
+	const Dcsc<IU,NU1> * Adcsc = (A.nnz > 0)? A.dcsc : NULL;
+	const Dcsc<IU,NU2> * Bdcsc = (B.nnz > 0)? B.dcsc : NULL;
+	Dcsc<IU, RETT> * tdcsc = new Dcsc<IU, RETT>(EWiseApply<RETT>(Adcsc, Bdcsc, __binary_op, do_op, allowANulls, allowBNulls, ANullVal, BNullVal, allowIntersect));
+	if(tdcsc->nz == 0)
+	{
+		delete tdcsc;
+		tdcsc = NULL;
+	}
 	return 	SpDCCols<IU, RETT> (A.m , A.n, tdcsc);
 }
 
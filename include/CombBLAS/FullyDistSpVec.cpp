@@ -74,6 +74,11 @@ FullyDistSpVec<IT,NT> &  FullyDistSpVec<IT,NT>::operator=(const FullyDistSpVec<
 		FullyDist<IT,NT,typename combblas::disable_if< combblas::is_boolean<NT>::value, NT >::type>::operator= (rhs);	// to update glen and commGrid
 		ind = rhs.ind;
 		num = rhs.num;
+		dense = rhs.dense;
+		densethreshold = rhs.densethreshold;
+		bmap = rhs.bmap;
+		dnum = rhs.dnum;
+		dnnz = rhs.dnnz;
 	}
 	return *this;
 }
@@ -184,6 +189,7 @@ FullyDistSpVec<IT,NT> &  FullyDistSpVec<IT,NT>::operator=(const FullyDistVec< IT
 {
 	FullyDist<IT,NT,typename combblas::disable_if< combblas::is_boolean<NT>::value, NT >::type>::operator= (rhs);	// to update glen and commGrid
 
+	ClearDense();
 	std::vector<IT>().swap(ind);
 	std::vector<NT>().swap(num);
 	IT vecsize = rhs.LocArrSize();
@@ -193,6 +199,7 @@ FullyDistSpVec<IT,NT> &  FullyDistSpVec<IT,NT>::operator=(const FullyDistVec< IT
 		ind.push_back(i);
 		num.push_back(rhs.arr[i]);
 	}
+	AutoFormat();
 	return *this;
 }
 
@@ -329,6 +336,7 @@ template <class IT, class NT>
 template <typename _Predicate>
 FullyDistVec<IT,NT> FullyDistSpVec<IT,NT>::FindVals(_Predicate pred) const
 {
+	ToList();
     FullyDistVec<IT,NT> found(commGrid);
     MPI_Comm World = commGrid->GetWorld();
     int nprocs = commGrid->GetSize();
@@ -393,6 +401,7 @@ template <class IT, class NT>
 template <typename _Predicate>
 FullyDistVec<IT,IT> FullyDistSpVec<IT,NT>::FindInds(_Predicate pred) const
 {
+	ToList();
     FullyDistVec<IT,IT> found(commGrid);
     MPI_Comm World = commGrid->GetWorld();
     int nprocs = commGrid->GetSize();
@@ -458,6 +467,111 @@ void FullyDistSpVec<IT,NT>::stealFrom(FullyDistSpVec<IT,NT> & victim)
 	FullyDist<IT,NT,typename combblas::disable_if< combblas::is_boolean<NT>::value, NT >::type>::operator= (victim);	// to update glen and commGrid
 	ind.swap(victim.ind);
 	num.swap(victim.num);
+	std::swap(dense, victim.dense);
+	std::swap(densethreshold, victim.densethreshold);
+	bmap.swap(victim.bmap);
+	dnum.swap(victim.dnum);
+	std::swap(dnnz, victim.dnnz);
+}
+
+template <class IT, class NT>
+void FullyDistSpVec<IT,NT>::Densify()
+{
+	if(dense) return;
+	IT loclen = MyLocLength();
+	bmap.assign((loclen + 63) / 64, 0);
+	dnum.resize(loclen);
+	dnnz = ind.size();
+	IT spsize = ind.size();
+	// several nonzeros share a bitmap word, so set the bits serially and copy values in parallel
+	for(IT i=0; i < spsize; ++i)
+		bmap[WORD_OFFSET(ind[i])] |= (static_cast<uint64_t>(1) << BIT_OFFSET(ind[i]));
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(IT i=0; i < spsize; ++i)
+		dnum[ind[i]] = num[i];
+
+	std::vector<IT>().swap(ind);
+	std::vector<NT>().swap(num);
+	dense = true;
+}
+
+template <class IT, class NT>
+void FullyDistSpVec<IT,NT>::Sparsify()
+{
+	if(!dense) return;
+	ind.resize(dnnz);
+	num.resize(dnnz);
+	DenseExtract(ind.data(), num.data());
+	dense = false;
+	dnnz = 0;
+	std::vector<uint64_t>().swap(bmap);
+	std::vector<NT>().swap(dnum);
+}
+
+template <class IT, class NT>
+template <typename IND>
+void FullyDistSpVec<IT,NT>::DenseExtract(IND * inds, NT * nums) const
+{
+	IT nwords = bmap.size();
+	int nthreads = 1;
+#ifdef _OPENMP
+#pragma omp parallel
+	{
+		nthreads = omp_get_num_threads();
+	}
+#endif
+	// two passes over contiguous word ranges: count, then fill at the prefix-summed offsets
+	std::vector<IT> tdisp(nthreads+1, 0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		int curthread = 0;
+#ifdef _OPENMP
+		curthread = omp_get_thread_num();
+#endif
+		IT wbeg = (nwords * curthread) / nthreads;
+		IT wend = (nwords * (curthread+1)) / nthreads;
+		IT cnt = 0;
+		for(IT w = wbeg; w < wend; ++w)
+			cnt += PopCount(bmap[w]);
+		tdisp[curthread+1] = cnt;
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp single
+#endif
+		std::partial_sum(tdisp.begin(), tdisp.end(), tdisp.begin());
+
+		IT k = tdisp[curthread];
+		for(IT w = wbeg; w < wend; ++w)
+		{
+			uint64_t word = bmap[w];
+			while(word)
+			{
+				IT i = w*64 + LowestBit(word);
+				inds[k] = static_cast<IND>(i);
+				if(nums != NULL) nums[k] = dnum[i];
+				++k;
+				word &= (word - 1);
+			}
+		}
+	}
+}
+
+template <class IT, class NT>
+void FullyDistSpVec<IT,NT>::AutoFormat()
+{
+	IT loclen = MyLocLength();
+	if(densethreshold > 1.0 || loclen == 0)	// automatic switching disabled
+		return;
+	double density = static_cast<double>(getlocnnz()) / static_cast<double>(loclen);
+	// a little hysteresis so that vectors hovering at the threshold do not flip-flop
+	if(!dense && density >= densethreshold)
+		Densify();
+	else if(dense && density < densethreshold / 2)
+		Sparsify();
 }
 
 template <class IT, class NT>
@@ -469,16 +583,24 @@ NT FullyDistSpVec<IT,NT>::operator[](IT indx)
 	int found = 0;
 	if(commGrid->GetRank() == owner)
 	{
-		typename std::vector<IT>::const_iterator it = std::lower_bound(ind.begin(), ind.end(), locind);	// ind is a sorted vector
-		if(it != ind.end() && locind == (*it))	// found
+		if(dense)
 		{
-			val = num[it-ind.begin()];
-			found = 1;
+			found = (bmap[WORD_OFFSET(locind)] >> BIT_OFFSET(locind)) & 1;
+			val = found? dnum[locind] : NT();
 		}
 		else
 		{
-			val = NT();	// return NULL
-			found = 0;
+			typename std::vector<IT>::const_iterator it = std::lower_bound(ind.begin(), ind.end(), locind);	// ind is a sorted vector
+			if(it != ind.end() && locind == (*it))	// found
+			{
+				val = num[it-ind.begin()];
+				found = 1;
+			}
+			else
+			{
+				val = NT();	// return NULL
+				found = 0;
+			}
 		}
 	}
 	MPI_Bcast(&found, 1, MPI_INT, owner, commGrid->GetWorld());
@@ -494,6 +616,16 @@ NT FullyDistSpVec<IT,NT>::GetLocalElement(IT indx)
 	IT locind;
 	int owner = Owner(indx, locind);
 	int found = 0;
+	if(dense)
+	{
+		if(commGrid->GetRank() == owner && ((bmap[WORD_OFFSET(locind)] >> BIT_OFFSET(locind)) & 1))
+		{
+			val = dnum[locind];
+			found = 1;
+		}
+		wasFound = found;
+		return val;
+	}
 	typename std::vector<IT>::const_iterator it = std::lower_bound(ind.begin(), ind.end(), locind);	// ind is a sorted vector
 	if(commGrid->GetRank() == owner) {
 		if(it != ind.end() && locind == (*it))	// found
@@ -515,7 +647,17 @@ void FullyDistSpVec<IT,NT>::SetElement (IT indx, NT numx)
 
 	IT locind;
 	int owner = Owner(indx, locind);
-	if(commGrid->GetRank() == owner)
+	if(commGrid->GetRank() == owner && dense)
+	{
+		uint64_t mask = static_cast<uint64_t>(1) << BIT_OFFSET(locind);
+		if(!(bmap[WORD_OFFSET(locind)] & mask))
+		{
+			bmap[WORD_OFFSET(locind)] |= mask;
+			++dnnz;
+		}
+		dnum[locind] = numx;
+	}
+	else if(commGrid->GetRank() == owner)
 	{
 		typename std::vector<IT>::iterator iter = std::lower_bound(ind.begin(), ind.end(), locind);
 		if(iter == ind.end())	// beyond limits, insert from back
@@ -542,7 +684,16 @@ void FullyDistSpVec<IT,NT>::DelElement (IT indx)
 {
 	IT locind;
 	int owner = Owner(indx, locind);
-	if(commGrid->GetRank() == owner)
+	if(commGrid->GetRank() == owner && dense)
+	{
+		uint64_t mask = static_cast<uint64_t>(1) << BIT_OFFSET(locind);
+		if(bmap[WORD_OFFSET(locind)] & mask)
+		{
+			bmap[WORD_OFFSET(locind)] &= ~mask;
+			--dnnz;
+		}
+	}
+	else if(commGrid->GetRank() == owner)
 	{
 		typename std::vector<IT>::iterator iter = std::lower_bound(ind.begin(), ind.end(), locind);
 		if(iter != ind.end() && !(locind < *iter))
@@ -564,6 +715,7 @@ void FullyDistSpVec<IT,NT>::DelElement (IT indx)
 template <class IT, class NT>
 FullyDistVec<IT,NT> FullyDistSpVec<IT,NT>::operator() (const FullyDistVec<IT,IT> & ri) const
 {
+	ToList();
 	MPI_Comm World = commGrid->GetWorld();
 	FullyDistVec<IT,NT> Indexed(ri.commGrid, ri.glen, NT());	// NT() is the initial value
 	int nprocs;
@@ -676,6 +828,7 @@ template <class IT, class NT>
 void FullyDistSpVec<IT,NT>::iota(IT globalsize, NT first)
 {
 	glen = globalsize;
+	ClearDense();
 	IT length = MyLocLength();
 	ind.resize(length);
 	num.resize(length);
@@ -688,6 +841,7 @@ void FullyDistSpVec<IT,NT>::iota(IT globalsize, NT first)
 template <class IT, class NT>
 void FullyDistSpVec<IT,NT>::nziota(NT first)
 {
+	ToList();
     std::iota(num.begin(), num.end(), NnzUntil() + first);	// global across processors
 }
 
@@ -695,7 +849,7 @@ void FullyDistSpVec<IT,NT>::nziota(NT first)
 template <class IT, class NT>
 IT FullyDistSpVec<IT,NT>::NnzUntil() const
 {
-    IT mynnz = ind.size();
+    IT mynnz = getlocnnz();
     IT prevnnz = 0;
     MPI_Scan(&mynnz, &prevnnz, 1, MPIType<IT>(), MPI_SUM, commGrid->GetWorld());
     return (prevnnz - mynnz);
@@ -711,6 +865,7 @@ IT FullyDistSpVec<IT,NT>::NnzUntil() const
 template <class IT, class NT>
 FullyDistSpVec<IT, IT> FullyDistSpVec<IT, NT>::sort()
 {
+	ToList();
     MPI_Comm World = commGrid->GetWorld();
     FullyDistSpVec<IT,IT> temp(commGrid);
     if(getnnz()==0) return temp;
@@ -768,6 +923,7 @@ FullyDistSpVec<IT, IT> FullyDistSpVec<IT, NT>::sort()
 template <class IT, class NT>
 FullyDistSpVec<IT, IT> FullyDistSpVec<IT, NT>::sort()
 {
+	ToList();
 	MPI_Comm World = commGrid->GetWorld();
 	FullyDistSpVec<IT,IT> temp(commGrid);
     if(getnnz()==0) return temp;
@@ -793,7 +949,16 @@ FullyDistSpVec<IT, IT> FullyDistSpVec<IT, NT>::sort()
 		vecpair[i].second = ind[i] + until;
 
 	}
-	std::vector<std::pair<NT,IT>> sorted = SpParHelper::KeyValuePSort(vecpair, nnz, dist, World);
+	std::vector<std::pair<NT,IT>> sorted;
+	if(std::is_integral<NT>::value)
+	{
+		SpParHelper::RadixPSort(vecpair, nnz, dist, World);	// keeps the distribution in dist
+		sorted.assign(vecpair, vecpair+nnz);
+	}
+	else
+	{
+		sorted = SpParHelper::KeyValuePSort(vecpair, nnz, dist, World);
+	}
 
     nnz = sorted.size();
     temp.num.resize(nnz);
@@ -827,6 +992,7 @@ FullyDistSpVec<IT, IT> FullyDistSpVec<IT, NT>::sort()
 template <class IT, class NT>
 FullyDistSpVec<IT, IT> FullyDistSpVec<IT, NT>::sort()
 {
+	ToList();
     MPI_Comm World = commGrid->GetWorld();
     FullyDistSpVec<IT,IT> temp(commGrid);
     if(getnnz()==0) return temp;
@@ -889,6 +1055,7 @@ template <class IT, class NT>
 template <typename _BinaryOperation >
 FullyDistSpVec<IT,NT> FullyDistSpVec<IT, NT>::UniqAll2All(_BinaryOperation __binary_op, MPI_Op mympiop)
 {
+	ToList();
     MPI_Comm World = commGrid->GetWorld();
 	int nprocs = commGrid->GetSize();
 
@@ -938,11 +1105,11 @@ FullyDistSpVec<IT,NT> FullyDistSpVec<IT, NT>::UniqAll2All(_BinaryOperation __bin
 	}
     IT totrecv = std::accumulate(recvcnt,recvcnt+nprocs, static_cast<IT>(0));
 	NT * recvdatbuf = new NT[totrecv];
-	MPI_Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
+	SpParHelper::Alltoallv(datbuf, sendcnt, sdispls, recvdatbuf, recvcnt, rdispls, World);
     delete [] datbuf;
 
     IT * recvindbuf = new IT[totrecv];
-    MPI_Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
+    SpParHelper::Alltoallv(indbuf, sendcnt, sdispls, recvindbuf, recvcnt, rdispls, World);
     delete [] indbuf;
 
     std::vector< std::pair<NT,IT> > tosort;   // in fact, tomerge would be a better name but it is unlikely to be faster
@@ -993,11 +1160,11 @@ FullyDistSpVec<IT,NT> FullyDistSpVec<IT, NT>::UniqAll2All(_BinaryOperation __bin
     totrecv = std::accumulate(recvcnt,recvcnt+nprocs, static_cast<IT>(0));   // update value
 
     recvdatbuf = new NT[totrecv];
-	MPI_Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
+	SpParHelper::Alltoallv(datbuf, sendcnt, sdispls, recvdatbuf, recvcnt, rdispls, World);
     delete [] datbuf;
 
     recvindbuf = new IT[totrecv];
-    MPI_Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
+    SpParHelper::Alltoallv(indbuf, sendcnt, sdispls, recvindbuf, recvcnt, rdispls, World);
     delete [] indbuf;
 
     FullyDistSpVec<IT,NT> Indexed(commGrid, glen);	// length(Indexed) = length(glen) = length(*this)
@@ -1034,6 +1201,8 @@ FullyDistSpVec<IT,NT> FullyDistSpVec<IT, NT>::Uniq(_BinaryOperation __binary_op,
 template <class IT, class NT>
 FullyDistSpVec<IT,NT> & FullyDistSpVec<IT, NT>::operator+=(const FullyDistSpVec<IT,NT> & rhs)
 {
+	ToList();
+	rhs.ToList();
 	if(this != &rhs)
 	{
 		if(glen != rhs.glen)
@@ -1093,6 +1262,8 @@ FullyDistSpVec<IT,NT> & FullyDistSpVec<IT, NT>::operator+=(const FullyDistSpVec<
 template <class IT, class NT>
 FullyDistSpVec<IT,NT> & FullyDistSpVec<IT, NT>::operator-=(const FullyDistSpVec<IT,NT> & rhs)
 {
+	ToList();
+	rhs.ToList();
 	if(this != &rhs)
 	{
 		if(glen != rhs.glen)
@@ -1153,6 +1324,7 @@ template <class IT, class NT>
 template <typename _BinaryOperation>
 void FullyDistSpVec<IT,NT>::SparseCommon(std::vector< std::vector < std::pair<IT,NT> > > & data, _BinaryOperation BinOp)
 {
+	ClearDense();
 	int nprocs = commGrid->GetSize();
 	int * sendcnt = new int[nprocs];
 	int * recvcnt = new int[nprocs];
@@ -1174,15 +1346,10 @@ void FullyDistSpVec<IT,NT>::SparseCommon(std::vector< std::vector < std::pair<IT
     std::copy(data[i].begin(), data[i].end(), senddata+sdispls[i]);
 		std::vector< std::pair<IT,NT> >().swap(data[i]);	// clear memory
 	}
-	MPI_Datatype MPI_pair;
-	MPI_Type_contiguous(sizeof(std::tuple<IT,NT>), MPI_CHAR, &MPI_pair);
-	MPI_Type_commit(&MPI_pair);
-
 	std::pair<IT,NT> * recvdata = new std::pair<IT,NT>[totrecv];
-	MPI_Alltoallv(senddata, sendcnt, sdispls, MPI_pair, recvdata, recvcnt, rdispls, MPI_pair, commGrid->GetWorld());
+	SpParHelper::Alltoallv(senddata, sendcnt, sdispls, recvdata, recvcnt, rdispls, commGrid->GetWorld());
 
 	DeleteAll(senddata, sendcnt, recvcnt, sdispls, rdispls);
-	MPI_Type_free(&MPI_pair);
 
 	if(!is_sorted(recvdata, recvdata+totrecv))
 		std::sort(recvdata, recvdata+totrecv);
@@ -1208,6 +1375,7 @@ template <class IT, class NT>
 template <typename _BinaryOperation>
 void FullyDistSpVec<IT,NT>::ParallelRead (const std::string & filename, bool onebased, _BinaryOperation BinOp)
 {
+	ClearDense();
     int64_t gnnz;	// global nonzeros (glen is already declared as part of this class's private data)
     int64_t linesread = 0;
 
@@ -1309,6 +1477,7 @@ template <class IT, class NT>
 template <class HANDLER>
 void FullyDistSpVec<IT,NT>::ParallelWrite(const std::string & filename, bool onebased, HANDLER handler, bool includeindices, bool includeheader)
 {
+	ToList();
        	int myrank = commGrid->GetRank();
     	int nprocs = commGrid->GetSize();
 	IT totalLength = TotalLength();
@@ -1390,12 +1559,103 @@ void FullyDistSpVec<IT,NT>::ParallelWrite(const std::string & filename, bool one
 	delete [] bytes;
 }
 
+template <class IT, class NT>
+void FullyDistSpVec<IT,NT>::ParallelBinaryWrite(const std::string & filename) const
+{
+	static_assert(std::is_trivially_copyable<NT>::value, "ParallelBinaryWrite stores values as raw bytes");
+	ToList();
+	MPI_Comm World = commGrid->GetWorld();
+	int myrank = commGrid->GetRank();
+	int64_t locnnz = ind.size(), nnzuntil = 0, gnnz = 0;
+	MPI_Exscan(&locnnz, &nnzuntil, 1, MPIType<int64_t>(), MPI_SUM, World);
+	if(myrank == 0) nnzuntil = 0;	// because MPI_Exscan says the recvbuf in process 0 is undefined
+	MPI_Allreduce(&locnnz, &gnnz, 1, MPIType<int64_t>(), MPI_SUM, World);
+
+	VectorFileHeader header;
+	memset(&header, 0, sizeof(header));
+	header.itsize = sizeof(IT);
+	header.ntsize = sizeof(NT);
+	header.sparse = 1;
+	header.glen = glen;
+	header.nnz = gnnz;
+
+	IT lengthuntil = LengthUntil();
+	std::vector<IT> globind(locnnz);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(int64_t i=0; i< locnnz; ++i)
+		globind[i] = ind[i] + lengthuntil;
+
+	MPI_File thefile = CreateVectorFile(filename, header, World);
+	MPI_Offset indoffset = sizeof(VectorFileHeader);
+	MPI_Offset numoffset = indoffset + static_cast<MPI_Offset>(gnnz) * sizeof(IT);
+	SpParHelper::FileAccessAll(thefile, indoffset + nnzuntil * sizeof(IT), globind.data(), locnnz * sizeof(IT), true, World);
+	SpParHelper::FileAccessAll(thefile, numoffset + nnzuntil * sizeof(NT), const_cast<NT*>(num.data()), locnnz * sizeof(NT), true, World);
+	MPI_File_close(&thefile);
+}
+
+template <class IT, class NT>
+void FullyDistSpVec<IT,NT>::ParallelBinaryRead(const std::string & filename)
+{
+	static_assert(std::is_trivially_copyable<NT>::value, "ParallelBinaryRead reads values as raw bytes");
+	MPI_Comm World = commGrid->GetWorld();
+	int myrank = commGrid->GetRank();
+	int nprocs = commGrid->GetSize();
+	MPI_File thefile;
+	VectorFileHeader header = OpenVectorFile(filename, sizeof(IT), sizeof(NT), thefile, World);
+
+	ClearDense();
+	glen = header.glen;
+	int64_t gnnz = header.nnz;
+	int64_t first = gnnz * myrank / nprocs;
+	int64_t count = gnnz * (myrank+1) / nprocs - first;
+	std::vector<IT> readind(count);
+	std::vector<NT> readnum(count);
+	MPI_Offset numoffset = sizeof(VectorFileHeader);
+	if(header.sparse)
+	{
+		SpParHelper::FileAccessAll(thefile, numoffset + first * sizeof(IT), readind.data(), count * sizeof(IT), false, World);
+		numoffset += static_cast<MPI_Offset>(gnnz) * sizeof(IT);
+	}
+	else
+	{
+		SpHelper::iota(readind.begin(), readind.end(), static_cast<IT>(first));	// a dense file stores every index
+	}
+	SpParHelper::FileAccessAll(thefile, numoffset + first * sizeof(NT), readnum.data(), count * sizeof(NT), false, World);
+	MPI_File_close(&thefile);
+
+	// indices are sorted, so the entries of each owner are contiguous and arrive sorted
+	int * sendcnt = new int[nprocs]();
+	for(int64_t i=0; i< count; ++i)
+	{
+		IT locind;
+		int owner = Owner(readind[i], locind);
+		readind[i] = locind;
+		++sendcnt[owner];
+	}
+	int * recvcnt = new int[nprocs];
+	MPI_Alltoall(sendcnt, 1, MPI_INT, recvcnt, 1, MPI_INT, World);
+	int * sdispls = new int[nprocs]();
+	int * rdispls = new int[nprocs]();
+	std::partial_sum(sendcnt, sendcnt+nprocs-1, sdispls+1);
+	std::partial_sum(recvcnt, recvcnt+nprocs-1, rdispls+1);
+	IT totrecv = rdispls[nprocs-1]+recvcnt[nprocs-1];
+
+	ind.resize(totrecv);
+	num.resize(totrecv);
+	SpParHelper::Alltoallv(readind.data(), sendcnt, sdispls, ind.data(), recvcnt, rdispls, World);
+	SpParHelper::Alltoallv(readnum.data(), sendcnt, sdispls, num.data(), recvcnt, rdispls, World);
+	DeleteAll(sendcnt, recvcnt, sdispls, rdispls);
+}
+
 //! Called on an existing object
 //! ABAB: Obsolete, will be deleted once moved to Github (and becomes independent of KDT)
 template <class IT, class NT>
 template <class HANDLER>
 std::ifstream& FullyDistSpVec<IT,NT>::ReadDistribute (std::ifstream& infile, int master, HANDLER handler)
 {
+	ClearDense();
 	IT total_nnz;
 	MPI_Comm World = commGrid->GetWorld();
 	int neighs = commGrid->GetSize();  // number of neighbors (including oneself)
@@ -1528,6 +1788,7 @@ template <class IT, class NT>
 template <class HANDLER>
 void FullyDistSpVec<IT,NT>::SaveGathered(std::ofstream& outfile, int master, HANDLER handler, bool printProcSplits)
 {
+	ToList();
 	int rank, nprocs;
 	MPI_Comm World = commGrid->GetWorld();
 	MPI_Comm_rank(World, &rank);
@@ -1638,7 +1899,22 @@ template <class IT, class NT>
 template <typename _Predicate>
 IT FullyDistSpVec<IT,NT>::Count(_Predicate pred) const
 {
-	IT local = count_if( num.begin(), num.end(), pred );
+	IT local = 0;
+	if(dense)
+	{
+		IT nwords = bmap.size();
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:local)
+#endif
+		for(IT w=0; w < nwords; ++w)
+		{
+			for(uint64_t word = bmap[w]; word; word &= (word - 1))
+				if(pred(dnum[w*64 + LowestBit(word)]))
+					++local;
+		}
+	}
+	else
+		local = count_if( num.begin(), num.end(), pred );
 	IT whole = 0;
 	MPI_Allreduce( &local, &whole, 1, MPIType<IT>(), MPI_SUM, commGrid->GetWorld());
 	return whole;
@@ -1651,7 +1927,15 @@ NT FullyDistSpVec<IT,NT>::Reduce(_BinaryOperation __binary_op, NT init) const
 {
 	// std::accumulate returns init for empty sequences
 	// the semantics are init + num[0] + ... + num[n]
-	NT localsum = std::accumulate( num.begin(), num.end(), init, __binary_op);
+	NT localsum = init;
+	if(dense)	// sequential in index order, as __binary_op need not be commutative
+	{
+		for(IT w=0; w < static_cast<IT>(bmap.size()); ++w)
+			for(uint64_t word = bmap[w]; word; word &= (word - 1))
+				localsum = __binary_op(localsum, dnum[w*64 + LowestBit(word)]);
+	}
+	else
+		localsum = std::accumulate( num.begin(), num.end(), init, __binary_op);
 
 	NT totalsum = init;
 	MPI_Allreduce( &localsum, &totalsum, 1, MPIType<NT>(), MPIOp<_BinaryOperation, NT>::op(), commGrid->GetWorld());
@@ -1665,7 +1949,13 @@ OUT FullyDistSpVec<IT,NT>::Reduce(_BinaryOperation __binary_op, OUT default_val,
 	// std::accumulate returns identity for empty sequences
 	OUT localsum = default_val;
 
-	if (num.size() > 0)
+	if(dense)
+	{
+		for(IT w=0; w < static_cast<IT>(bmap.size()); ++w)
+			for(uint64_t word = bmap[w]; word; word &= (word - 1))
+				localsum = __binary_op(localsum, __unary_op(dnum[w*64 + LowestBit(word)]));
+	}
+	else if (num.size() > 0)
 	{
 		typename std::vector< NT >::const_iterator iter = num.begin();
 		//localsum = __unary_op(*iter);
@@ -1693,6 +1983,7 @@ void FullyDistSpVec<IT,NT>::PrintInfo(std::string vectorname) const
 template <class IT, class NT>
 void FullyDistSpVec<IT,NT>::DebugPrint()
 {
+	ToList();
 	int rank, nprocs;
 	MPI_Comm World = commGrid->GetWorld();
 	MPI_Comm_rank(World, &rank);
@@ -1774,6 +2065,7 @@ void FullyDistSpVec<IT,NT>::DebugPrint()
 template <class IT, class NT>
 void FullyDistSpVec<IT,NT>::Reset()
 {
+	ClearDense();
 	ind.resize(0);
 	num.resize(0);
 }
@@ -1781,6 +2073,7 @@ void FullyDistSpVec<IT,NT>::Reset()
 // Assigns given locations their value, needs to be sorted
 template <class IT, class NT>
 void FullyDistSpVec<IT,NT>::BulkSet(IT inds[], int count) {
+	ClearDense();
 	ind.resize(count);
 	num.resize(count);
 	std::copy(inds, inds+count, ind.data());
@@ -1799,6 +2092,7 @@ void FullyDistSpVec<IT,NT>::BulkSet(IT inds[], int count) {
 template <class IT, class NT>
 FullyDistSpVec<IT,NT> FullyDistSpVec<IT,NT>::Invert (IT globallen)
 {
+	ToList();
     FullyDistSpVec<IT,NT> Inverted(commGrid, globallen);
     IT max_entry = Reduce(maximum<IT>(), (IT) 0 ) ;
     if(max_entry >= globallen)
@@ -1851,11 +2145,11 @@ FullyDistSpVec<IT,NT> FullyDistSpVec<IT,NT>::Invert (IT globallen)
 	}
     IT totrecv = accumulate(recvcnt,recvcnt+nprocs, static_cast<IT>(0));
 	NT * recvdatbuf = new NT[totrecv];
-	MPI_Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
+	SpParHelper::Alltoallv(datbuf, sendcnt, sdispls, recvdatbuf, recvcnt, rdispls, World);
     delete [] datbuf;
 
     IT * recvindbuf = new IT[totrecv];
-    MPI_Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
+    SpParHelper::Alltoallv(indbuf, sendcnt, sdispls, recvindbuf, recvcnt, rdispls, World);
     delete [] indbuf;
 
 
@@ -1900,6 +2194,7 @@ FullyDistSpVec<IT,NT> FullyDistSpVec<IT,NT>::Invert (IT globallen)
 template <class IT, class NT>
 FullyDistSpVec<IT,NT> FullyDistSpVec<IT,NT>::Invert (IT globallen)
 {
+	ToList();
     FullyDistSpVec<IT,NT> Inverted(commGrid, globallen);
     IT max_entry = Reduce(maximum<IT>(), (IT) 0 ) ;
     if(max_entry >= globallen)
@@ -1969,11 +2264,11 @@ FullyDistSpVec<IT,NT> FullyDistSpVec<IT,NT>::Invert (IT globallen)
 
     IT totrecv = rdispls[nprocs];
 	NT * recvdatbuf = new NT[totrecv];
-	MPI_Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
+	SpParHelper::Alltoallv(datbuf, sendcnt, sdispls, recvdatbuf, recvcnt, rdispls, World);
     delete [] datbuf;
 
     IT * recvindbuf = new IT[totrecv];
-    MPI_Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
+    SpParHelper::Alltoallv(indbuf, sendcnt, sdispls, recvindbuf, recvcnt, rdispls, World);
     delete [] indbuf;
 
 
@@ -2027,6 +2322,7 @@ template <typename _BinaryOperationIdx, typename _BinaryOperationVal, typename _
 FullyDistSpVec<IT,NT> FullyDistSpVec<IT,NT>::Invert (IT globallen, _BinaryOperationIdx __binopIdx, _BinaryOperationVal __binopVal, _BinaryOperationDuplicate __binopDuplicate)
 
 {
+	ToList();
 
     FullyDistSpVec<IT,NT> Inverted(commGrid, globallen);
 
@@ -2111,11 +2407,11 @@ FullyDistSpVec<IT,NT> FullyDistSpVec<IT,NT>::Invert (IT globallen, _BinaryOperat
 
     IT totrecv = rdispls[nprocs];
     NT * recvdatbuf = new NT[totrecv];
-    MPI_Alltoallv(datbuf, sendcnt, sdispls, MPIType<NT>(), recvdatbuf, recvcnt, rdispls, MPIType<NT>(), World);
+    SpParHelper::Alltoallv(datbuf, sendcnt, sdispls, recvdatbuf, recvcnt, rdispls, World);
     delete [] datbuf;
 
     IT * recvindbuf = new IT[totrecv];
-    MPI_Alltoallv(indbuf, sendcnt, sdispls, MPIType<IT>(), recvindbuf, recvcnt, rdispls, MPIType<IT>(), World);
+    SpParHelper::Alltoallv(indbuf, sendcnt, sdispls, recvindbuf, recvcnt, rdispls, World);
     delete [] indbuf;
 
 
@@ -2172,6 +2468,7 @@ template <typename _BinaryOperationIdx, typename _BinaryOperationVal>
 FullyDistSpVec<IT,NT> FullyDistSpVec<IT,NT>::InvertRMA (IT globallen, _BinaryOperationIdx __binopIdx, _BinaryOperationVal __binopVal)
 
 {
+	ToList();
 
     FullyDistSpVec<IT,NT> Inverted(commGrid, globallen);
     int myrank;
@@ -2369,6 +2666,29 @@ void FullyDistSpVec<IT,NT>::Select (const FullyDistVec<IT,NT1> & denseVec, _Unar
 		else
 		{
 
+			if(dense)	// clear the bits of rejected entries, one thread per bitmap word
+			{
+				IT nwords = bmap.size();
+				IT removed = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:removed)
+#endif
+				for(IT w=0; w < nwords; ++w)
+				{
+					for(uint64_t word = bmap[w]; word; word &= (word - 1))
+					{
+						int b = LowestBit(word);
+						if(!__unop(denseVec.arr[w*64 + b]))
+						{
+							bmap[w] &= ~(static_cast<uint64_t>(1) << b);
+							++removed;
+						}
+					}
+				}
+				dnnz -= removed;
+				AutoFormat();
+				return;
+			}
 			IT spsize = getlocnnz();
             IT k = 0;
             // iterate over the sparse vector
@@ -2399,6 +2719,8 @@ template <typename IT, typename NT>
 template <typename NT1>
 void FullyDistSpVec<IT,NT>::Setminus (const FullyDistSpVec<IT,NT1> & other)
 {
+    ToList();
+    other.ToList();
     if(*commGrid == *(other.commGrid))
     {
         if(TotalLength() != other.TotalLength())
@@ -2465,6 +2787,32 @@ void FullyDistSpVec<IT,NT>::SelectApply (const FullyDistVec<IT,NT1> & denseVec,
 		else
 		{
 
+			if(dense)
+			{
+				IT nwords = bmap.size();
+				IT removed = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(+:removed)
+#endif
+				for(IT w=0; w < nwords; ++w)
+				{
+					for(uint64_t word = bmap[w]; word; word &= (word - 1))
+					{
+						int b = LowestBit(word);
+						IT i = w*64 + b;
+						if(__unop(denseVec.arr[i]))
+							dnum[i] = __binop(dnum[i], denseVec.arr[i]);
+						else
+						{
+							bmap[w] &= ~(static_cast<uint64_t>(1) << b);
+							++removed;
+						}
+					}
+				}
+				dnnz -= removed;
+				AutoFormat();
+				return;
+			}
 			IT spsize = getlocnnz();
             IT k = 0;
             // iterate over the sparse vector
@@ -2516,6 +2864,8 @@ template <class IT, class NT>
 template <typename _UnaryOperation>
 void FullyDistSpVec<IT,NT>::FilterByVal (FullyDistSpVec<IT,IT> Selector, _UnaryOperation __unop, bool filterByIndex)
 {
+    ToList();
+    Selector.ToList();
     if(*commGrid != *(Selector.commGrid))
     {
         std::ostringstream outs;
@@ -2587,4 +2937,175 @@ void FullyDistSpVec<IT,NT>::FilterByVal (FullyDistSpVec<IT,IT> Selector, _UnaryO
 
 }
 
+
+template <class IT, class NT>
+template <typename _BinaryOperation>
+void FullyDistSpVec<IT,NT>::Assign (const FullyDistSpVec<IT,IT> & inds, const FullyDistSpVec<IT,NT> & val, _BinaryOperation __binop)
+{
+	inds.ToList();
+	val.ToList();
+	if(inds.num.size() != val.num.size())
+	{
+		SpParHelper::Print("Assign error: Index and value vectors have different size !!!\n");
+		MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+	}
+	AssignImpl(inds, val.num.data(), NT(), __binop);
+}
+
+template <class IT, class NT>
+template <typename _BinaryOperation>
+void FullyDistSpVec<IT,NT>::Assign (const FullyDistSpVec<IT,IT> & inds, NT val, _BinaryOperation __binop)
+{
+	AssignImpl(inds, (const NT *) NULL, val, __binop);
+}
+
+// vals == NULL means every entry of inds carries val
+template <class IT, class NT>
+template <typename _BinaryOperation>
+void FullyDistSpVec<IT,NT>::AssignImpl (const FullyDistSpVec<IT,IT> & inds, const NT * vals, NT val, _BinaryOperation __binop)
+{
+	if(*commGrid != *(inds.commGrid))
+	{
+		SpParHelper::Print("Grids are not comparable for Assign\n");
+		MPI_Abort(MPI_COMM_WORLD, GRIDMISMATCH);
+	}
+	inds.ToList();
+	ClearDense();
+	MPI_Comm World = commGrid->GetWorld();
+	int nprocs = commGrid->GetSize();
+	int myrank = commGrid->GetRank();
+
+	// entries for the same index are combined before they leave this processor
+	IT loclen = inds.num.size();
+	std::vector< std::vector<IT> > indBuf(nprocs);
+	std::vector< std::vector<NT> > valBuf(nprocs);
+	std::unordered_map<IT,IT> slot;
+	for(IT i=0; i < loclen; ++i)
+	{
+		IT globind = inds.num[i];
+		if(globind >= glen)
+		{
+			std::ostringstream outs;
+			outs << "Assign: index " << globind << " is out of range (" << glen << ")\n";
+			SpParHelper::Print(outs.str());
+			MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+		}
+		NT v = (vals != NULL)? vals[i] : val;
+		IT locind;
+		int owner = Owner(globind, locind);
+		auto found = slot.find(globind);
+		if(found != slot.end())
+		{
+			valBuf[owner][found->second] = __binop(valBuf[owner][found->second], v);
+		}
+		else
+		{
+			slot[globind] = indBuf[owner].size();
+			indBuf[owner].push_back(locind);
+			valBuf[owner].push_back(v);
+		}
+	}
+	std::unordered_map<IT,IT>().swap(slot);
+
+	int * sendcnt = new int[nprocs];
+	int * recvcnt = new int[nprocs];
+	int * sdispls = new int[nprocs]();
+	int * rdispls = new int[nprocs]();
+	for(int i=0; i<nprocs; ++i)
+		sendcnt[i] = (int) indBuf[i].size();
+	MPI_Alltoall(sendcnt, 1, MPI_INT, recvcnt, 1, MPI_INT, World);
+
+	// a reduction over my piece costs ~ MyLocLength() * log(p), receiving costs ~ the number of entries
+	MPI_Op mpiop = PredefinedMPIOp<_BinaryOperation,NT>();
+	NT identity = NT();
+	bool reducible = (mpiop != MPI_OP_NULL) && MPIOpIdentity(mpiop, identity);
+	IT totrecv = std::accumulate(recvcnt, recvcnt+nprocs, static_cast<IT>(0));
+	IT reducesize = (reducible && MyLocLength() * std::log2(nprocs) < totrecv)? MyLocLength() : 0;
+	std::vector<IT> reducecnt(nprocs);
+	MPI_Allgather(&reducesize, 1, MPIType<IT>(), reducecnt.data(), 1, MPIType<IT>(), World);
+
+	std::vector< std::vector<NT> > redval(nprocs);
+	std::vector< std::vector<uint8_t> > redflag(nprocs);	// which entries were written at all
+	std::vector<MPI_Request> requests;
+	for(int i=0; i<nprocs; ++i)
+	{
+		if(reducecnt[i] == 0)	continue;
+		redval[i].assign(reducecnt[i], identity);
+		redflag[i].assign(reducecnt[i], 0);
+		for(size_t j=0; j< indBuf[i].size(); ++j)
+		{
+			redval[i][indBuf[i][j]] = valBuf[i][j];
+			redflag[i][indBuf[i][j]] = 1;
+		}
+		requests.resize(requests.size()+2);
+		if(i == myrank)
+		{
+			MPI_Ireduce(MPI_IN_PLACE, redval[i].data(), reducecnt[i], MPIType<NT>(), mpiop, i, World, &requests[requests.size()-2]);
+			MPI_Ireduce(MPI_IN_PLACE, redflag[i].data(), reducecnt[i], MPIType<uint8_t>(), MPI_BOR, i, World, &requests.back());
+			std::fill_n(recvcnt, nprocs, 0);
+		}
+		else
+		{
+			MPI_Ireduce(redval[i].data(), NULL, reducecnt[i], MPIType<NT>(), mpiop, i, World, &requests[requests.size()-2]);
+			MPI_Ireduce(redflag[i].data(), NULL, reducecnt[i], MPIType<uint8_t>(), MPI_BOR, i, World, &requests.back());
+		}
+		sendcnt[i] = 0;		// delivered by the reduction
+	}
+
+	std::partial_sum(sendcnt, sendcnt+nprocs-1, sdispls+1);
+	std::partial_sum(recvcnt, recvcnt+nprocs-1, rdispls+1);
+	IT totsend = std::accumulate(sendcnt, sendcnt+nprocs, static_cast<IT>(0));
+	totrecv = std::accumulate(recvcnt, recvcnt+nprocs, static_cast<IT>(0));
+	std::vector<IT> sendInd(totsend);
+	std::vector<NT> sendVal(totsend);
+	for(int i=0; i<nprocs; ++i)
+	{
+		if(sendcnt[i] > 0)
+		{
+			std::copy(indBuf[i].begin(), indBuf[i].end(), sendInd.begin()+sdispls[i]);
+			std::copy(valBuf[i].begin(), valBuf[i].end(), sendVal.begin()+sdispls[i]);
+		}
+		std::vector<IT>().swap(indBuf[i]);
+		std::vector<NT>().swap(valBuf[i]);
+	}
+	std::vector<IT> recvInd(totrecv);
+	std::vector<NT> recvVal(totrecv);
+	SpParHelper::Alltoallv(sendInd.data(), sendcnt, sdispls, recvInd.data(), recvcnt, rdispls, World);
+	SpParHelper::Alltoallv(sendVal.data(), sendcnt, sdispls, recvVal.data(), recvcnt, rdispls, World);
+	DeleteAll(sendcnt, recvcnt, sdispls, rdispls);
+	MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+
+	ind.clear();
+	num.clear();
+	if(reducecnt[myrank] > 0)
+	{
+		for(IT i=0; i< reducecnt[myrank]; ++i)
+		{
+			if(redflag[myrank][i])
+			{
+				ind.push_back(i);
+				num.push_back(redval[myrank][i]);
+			}
+		}
+	}
+	else
+	{
+		// combine in order of arrival (source rank), so the outcome does not depend on timing
+		std::vector<IT> perm(totrecv);
+		std::iota(perm.begin(), perm.end(), static_cast<IT>(0));
+		std::stable_sort(perm.begin(), perm.end(), [&recvInd](IT a, IT b) { return recvInd[a] < recvInd[b]; });
+		for(IT k=0; k< totrecv; ++k)
+		{
+			IT locind = recvInd[perm[k]];
+			if(!ind.empty() && ind.back() == locind)
+				num.back() = __binop(num.back(), recvVal[perm[k]]);
+			else
+			{
+				ind.push_back(locind);
+				num.push_back(recvVal[perm[k]]);
+			}
+		}
+	}
+}
+
 }
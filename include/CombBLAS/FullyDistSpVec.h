@@ -92,6 +92,15 @@ public:
     template <typename _BinaryOperationIdx, typename _BinaryOperationVal>
     FullyDistSpVec<IT,NT> InvertRMA (IT globallen, _BinaryOperationIdx __binopIdx, _BinaryOperationVal __binopVal);
 
+	//! Indexed scatter: (*this)[inds[i]] = val[i] for every nonzero i of inds, replacing the contents of *this
+	//! Values that land on the same index are combined with __binop. Owners that would receive more entries
+	//! than a reduction over their local piece costs are reduced to instead (hot keys); this path needs
+	//! __binop to map to a predefined MPI_Op (see MPIOp) and an arithmetic NT
+	template <typename _BinaryOperation>
+	void Assign (const FullyDistSpVec<IT,IT> & inds, const FullyDistSpVec<IT,NT> & val, _BinaryOperation __binop);
+	template <typename _BinaryOperation>
+	void Assign (const FullyDistSpVec<IT,IT> & inds, NT val, _BinaryOperation __binop);
+
     
     template <typename NT1, typename _UnaryOperation>
     void Select (const FullyDistVec<IT,NT1> & denseVec, _UnaryOperation unop);
@@ -115,6 +124,11 @@ public:
 	FullyDistSpVec<IT,NT> &  operator=(const FullyDistVec< IT,NT > & rhs);	// convert from dense
     FullyDistSpVec<IT,NT> &  operator=(NT fixedval) // assign fixed value
     {
+        if(dense)
+        {
+            DenseScan([&](IT i) { dnum[i] = fixedval; });
+            return *this;
+        }
 #ifdef _OPENMP
 #pragma omp parallel for
 #endif
@@ -153,6 +167,12 @@ public:
     	template <typename _BinaryOperation>
    	void ParallelRead (const std::string & filename, bool onebased, _BinaryOperation BinOp);
 
+	//! Binary I/O with collective MPI-IO: a VectorFileHeader (see FileHeader.h), the sorted global indices and the values
+	//! On reading, every process takes an even share of the entries and sends them to their owners, so a file can be
+	//! read back by any number of processes; a file written by FullyDistVec::ParallelBinaryWrite is read as well
+	void ParallelBinaryWrite(const std::string & filename) const;
+	void ParallelBinaryRead(const std::string & filename);
+
 
     	//! Totally obsolete version that only accepts an ifstream object and ascii files
 	template <class HANDLER>
@@ -166,7 +186,9 @@ public:
 
 	template <typename NNT> operator FullyDistSpVec< IT,NNT > () const	//!< Type conversion operator
 	{
+		ToList();
 		FullyDistSpVec<IT,NNT> CVT(commGrid);
+		CVT.densethreshold = densethreshold;
 		CVT.ind = std::vector<IT>(ind.begin(), ind.end());
 		CVT.num = std::vector<NNT>(num.begin(), num.end());
 		CVT.glen = glen;
@@ -203,12 +225,12 @@ public:
 
 	IT getlocnnz() const 
 	{
-		return ind.size();
+		return dense? dnnz : ind.size();
 	}
 	IT getnnz() const
 	{
 		IT totnnz = 0;
-		IT locnnz = ind.size();
+		IT locnnz = getlocnnz();
 		MPI_Allreduce( &locnnz, &totnnz, 1, MPIType<IT>(), MPI_SUM, commGrid->GetWorld());
 		return totnnz;
 	}
@@ -219,9 +241,28 @@ public:
 	using FullyDist<IT,NT,typename combblas::disable_if< combblas::is_boolean<NT>::value, NT >::type>::Owner;
 	using FullyDist<IT,NT,typename combblas::disable_if< combblas::is_boolean<NT>::value, NT >::type>::RowLenUntil;
 
+	/**
+	 * Hybrid storage: when the local density (nnz / local length) exceeds the dense threshold,
+	 * the local piece is kept as a bitmap plus a dense value array instead of a sorted (ind,num) list.
+	 * Apply, Count, Reduce, Select, EWiseApply (with a dense operand) and the SpMV inputs/outputs work
+	 * on both forms directly; every other operation converts back to the list form on entry.
+	 * The switch is purely local (no communication) and is off unless the threshold is <= 1.
+	 **/
+	bool IsDense() const { return dense; }
+	void Densify();		//!< switch the local piece to bitmap + dense values
+	void Sparsify();	//!< switch the local piece back to a sorted (ind,num) list
+	void AutoFormat();	//!< pick the form based on the current local density
+	void SetDenseThreshold(double threshold) { densethreshold = threshold; AutoFormat(); }
+	double GetDenseThreshold() const { return densethreshold; }
+
 	void setNumToInd()
 	{
 		IT offset = LengthUntil();
+		if(dense)
+		{
+			DenseScan([&](IT i) { dnum[i] = i + offset; });
+			return;
+		}
 		IT spsize = ind.size();
 		#ifdef _OPENMP
 		#pragma omp parallel for
@@ -236,6 +277,11 @@ public:
 	template <typename _UnaryOperation>
 	void Apply(_UnaryOperation __unary_op)
 	{
+		if(dense)
+		{
+			DenseScan([&](IT i) { dnum[i] = __unary_op(dnum[i]); });
+			return;
+		}
 		//transform(num.begin(), num.end(), num.begin(), __unary_op);
         IT spsize = num.size();
 #ifdef _OPENMP
@@ -249,6 +295,11 @@ public:
 	void ApplyInd(_BinaryOperation __binary_op)
 	{
 		IT offset = LengthUntil();
+		if(dense)
+		{
+			DenseScan([&](IT i) { dnum[i] = __binary_op(dnum[i], i + offset); });
+			return;
+		}
 		IT spsize = ind.size();
 		#ifdef _OPENMP
 		#pragma omp parallel for
@@ -271,8 +322,8 @@ public:
 	void Reset();
 	NT GetLocalElement(IT indx);
 	void BulkSet(IT inds[], int count);
-    std::vector<IT> GetLocalInd (){std::vector<IT> rind = ind; return rind;};
-    std::vector<NT> GetLocalNum (){std::vector<NT> rnum = num; return rnum;};
+    std::vector<IT> GetLocalInd (){ToList(); std::vector<IT> rind = ind; return rind;};
+    std::vector<NT> GetLocalNum (){ToList(); std::vector<NT> rnum = num; return rnum;};
     
     template <typename _Predicate>
     FullyDistVec<IT,IT> FindInds(_Predicate pred) const;
@@ -288,7 +339,77 @@ private:
 	std::vector< IT > ind;	// ind.size() give the number of nonzeros
 	std::vector< NT > num;
 	bool wasFound; // true if the last GetElement operation returned an actual value
-   
+
+	bool dense = false;		// true if the local piece is stored in bmap/dnum instead of ind/num
+	double densethreshold = SPVEC_DENSE_THRESHOLD;
+	std::vector<uint64_t> bmap;	// dense form: bit i is set iff local index i is a nonzero
+	std::vector<NT> dnum;		// dense form: dnum[i] is meaningful only if bit i is set
+	IT dnnz = 0;			// dense form: number of set bits
+
+	//! Operations that only know the list form call this first.
+	//! Logically const: the represented vector does not change, only its local storage.
+	void ToList() const
+	{
+		if(dense)
+			const_cast< FullyDistSpVec<IT,NT> * >(this)->Sparsify();
+	}
+
+	//! For operations that overwrite the local piece from scratch (it ends up in list form)
+	void ClearDense()
+	{
+		dense = false;
+		dnnz = 0;
+		std::vector<uint64_t>().swap(bmap);
+		std::vector<NT>().swap(dnum);
+	}
+
+	//! Calls visit(i) for every local nonzero index i of a dense-form vector, threaded over bitmap words
+	template <typename _Visitor>
+	void DenseScan(_Visitor visit) const
+	{
+		IT nwords = bmap.size();
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+		for(IT w=0; w < nwords; ++w)
+		{
+			uint64_t word = bmap[w];
+			while(word)
+			{
+				visit(static_cast<IT>(w*64 + LowestBit(word)));
+				word &= (word - 1);	// clear lowest set bit
+			}
+		}
+	}
+
+	//! Writes the dense-form nonzeros in index order into inds (and nums, unless it is NULL)
+	template <typename IND>
+	void DenseExtract(IND * inds, NT * nums) const;
+
+	template <typename _BinaryOperation>
+	void AssignImpl (const FullyDistSpVec<IT,IT> & inds, const NT * vals, NT val, _BinaryOperation __binop);
+
+	static int LowestBit(uint64_t word)
+	{
+#if defined(__GNUC__)
+		return __builtin_ctzll(word);
+#else
+		int b = 0;
+		while(!(word & 1)) { word >>= 1; ++b; }
+		return b;
+#endif
+	}
+
+	static int PopCount(uint64_t word)
+	{
+#if defined(__GNUC__)
+		return __builtin_popcountll(word);
+#else
+		int c = 0;
+		for(; word; word &= (word - 1)) ++c;
+		return c;
+#endif
+	}
 
 	template <typename _BinaryOperation>
 	void SparseCommon(std::vector< std::vector < std::pair<IT,NT> > > & data, _BinaryOperation BinOp);
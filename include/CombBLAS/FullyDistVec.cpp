@@ -29,6 +29,7 @@
 #include "FullyDistVec.h"
 #include "FullyDistSpVec.h"
 #include "Operations.h"
+#include "FileHeader.h"
 
 namespace combblas {
 
@@ -275,6 +276,11 @@ FullyDistVec< IT,NT > &  FullyDistVec<IT,NT>::operator=(const FullyDistSpVec< IT
 	arr.resize(rhs.MyLocLength());
 	std::fill(arr.begin(), arr.end(), NT());	
 
+	if(rhs.dense)
+	{
+		rhs.DenseScan([&](IT i) { arr[i] = rhs.dnum[i]; });
+		return *this;
+	}
 	IT spvecsize = rhs.getlocnnz();
 	for(IT i=0; i< spvecsize; ++i)
 	{
@@ -296,6 +302,7 @@ FullyDistVec< IT,NT > &  FullyDistVec<IT,NT>::operator=(const FullyDistSpVec< IT
 template <class IT, class NT>
 FullyDistVec< IT,NT > &  FullyDistVec<IT,NT>::operator+=(const FullyDistSpVec< IT,NT > & rhs)		
 {
+	rhs.ToList();
 	IT spvecsize = rhs.getlocnnz();
 	#ifdef _OPENMP
 	#pragma omp parallel for
@@ -315,6 +322,7 @@ FullyDistVec< IT,NT > &  FullyDistVec<IT,NT>::operator+=(const FullyDistSpVec< I
 template <class IT, class NT>
 FullyDistVec< IT,NT > &  FullyDistVec<IT,NT>::operator-=(const FullyDistSpVec< IT,NT > & rhs)		
 {
+	rhs.ToList();
 	IT spvecsize = rhs.getlocnnz();
 	for(IT i=0; i< spvecsize; ++i)
 	{
@@ -527,6 +535,46 @@ void FullyDistVec<IT,NT>::SaveGathered(std::ofstream& outfile, int master, HANDL
 	tmpSpVec.SaveGathered(outfile, master, handler, printProcSplits);
 }
 
+template <class IT, class NT>
+void FullyDistVec<IT,NT>::ParallelBinaryWrite(const std::string & filename) const
+{
+	static_assert(std::is_trivially_copyable<NT>::value, "ParallelBinaryWrite stores values as raw bytes");
+	MPI_Comm World = commGrid->GetWorld();
+	VectorFileHeader header;
+	memset(&header, 0, sizeof(header));
+	header.itsize = sizeof(IT);
+	header.ntsize = sizeof(NT);
+	header.glen = glen;
+	header.nnz = glen;
+
+	MPI_File thefile = CreateVectorFile(filename, header, World);
+	MPI_Offset offset = sizeof(VectorFileHeader) + static_cast<MPI_Offset>(LengthUntil()) * sizeof(NT);
+	SpParHelper::FileAccessAll(thefile, offset, const_cast<NT*>(arr.data()), arr.size() * sizeof(NT), true, World);
+	MPI_File_close(&thefile);
+}
+
+template <class IT, class NT>
+void FullyDistVec<IT,NT>::ParallelBinaryRead(const std::string & filename)
+{
+	static_assert(std::is_trivially_copyable<NT>::value, "ParallelBinaryRead reads values as raw bytes");
+	MPI_Comm World = commGrid->GetWorld();
+	MPI_File thefile;
+	VectorFileHeader header = OpenVectorFile(filename, sizeof(IT), sizeof(NT), thefile, World);
+	if(header.sparse)
+	{
+		MPI_File_close(&thefile);
+		FullyDistSpVec<IT,NT> tmpSpVec(commGrid);	// delegate
+		tmpSpVec.ParallelBinaryRead(filename);
+		*this = tmpSpVec;	// sparse -> dense conversion
+		return;
+	}
+	glen = header.glen;
+	arr.resize(MyLocLength());
+	MPI_Offset offset = sizeof(VectorFileHeader) + static_cast<MPI_Offset>(LengthUntil()) * sizeof(NT);
+	SpParHelper::FileAccessAll(thefile, offset, arr.data(), arr.size() * sizeof(NT), false, World);
+	MPI_File_close(&thefile);
+}
+
 template <class IT, class NT>
 void FullyDistVec<IT,NT>::SetElement (IT indx, NT numx)
 {
@@ -651,6 +699,7 @@ template <class IT, class NT>
 template <typename _UnaryOperation, typename IRRELEVANT_NT>
 void FullyDistVec<IT,NT>::Apply(_UnaryOperation __unary_op, const FullyDistSpVec<IT,IRRELEVANT_NT> & mask)
 {
+	mask.ToList();
 	typename std::vector< IT >::const_iterator miter = mask.ind.begin();
 	while (miter < mask.ind.end())
 	{
@@ -710,6 +759,7 @@ void FullyDistVec<IT,NT>::EWiseApply(const FullyDistSpVec<IT,NT2> & other, _Bina
 		}
 		else
 		{
+			other.ToList();
 			typename std::vector< IT >::const_iterator otherInd = other.ind.begin();
 			typename std::vector< NT2 >::const_iterator otherNum = other.num.begin();
 			
@@ -779,7 +829,7 @@ FullyDistVec<IT, IT> FullyDistVec<IT, NT>::sort()
 		vecpair[i].first = arr[i];	// we'll sort wrt numerical values
 		vecpair[i].second = i + sizeuntil;	
 	}
-	SpParHelper::MemoryEfficientPSort(vecpair, nnz, dist, World);
+	SpParHelper::RadixPSort(vecpair, nnz, dist, World);	// psort for non-integer values
 
 	std::vector< IT > narr(nnz);
 	for(IT i=0; i< nnz; ++i)
@@ -1052,6 +1102,10 @@ void FullyDistVec<IT,NT>::Set(const FullyDistSpVec< IT,NT > & other)
             std::cerr << "Vector dimensions don't match (" << glen << " vs " << other.glen << ") for FullyDistVec::Set\n";
             MPI_Abort(MPI_COMM_WORLD, GRIDMISMATCH);
         }
+        else if(other.dense)
+        {
+            other.DenseScan([&](IT i) { arr[i] = other.dnum[i]; });
+        }
         else
         {
             
@@ -1076,71 +1130,49 @@ void FullyDistVec<IT,NT>::Set(const FullyDistSpVec< IT,NT > & other)
 
 
 // General purpose set operation on dense vector by a sparse vector
+// Remote writes are deduplicated per target index (last one wins) and sent
+// with one MPI_Accumulate(MPI_REPLACE) per owner through the given window
 
 template <class IT, class NT>
 template <class NT1, typename _BinaryOperationIdx, typename _BinaryOperationVal>
 void FullyDistVec<IT,NT>::GSet (const FullyDistSpVec<IT,NT1> & spVec, _BinaryOperationIdx __binopIdx, _BinaryOperationVal __binopVal, MPI_Win win)
+{
+    DistVecAggregator<IT,NT> aggregator(*this, DistVecAggregator<IT,NT>::ONESIDED, win);    // collective if win is MPI_WIN_NULL
+    GSet(spVec, __binopIdx, __binopVal, aggregator);
+}
+
+template <class IT, class NT>
+template <class NT1, typename _BinaryOperationIdx, typename _BinaryOperationVal>
+void FullyDistVec<IT,NT>::GSet (const FullyDistSpVec<IT,NT1> & spVec, _BinaryOperationIdx __binopIdx, _BinaryOperationVal __binopVal, DistVecAggregator<IT,NT> & aggregator)
 {
     if(*(commGrid) != *(spVec.commGrid))
     {
         std::cout << "Grids are not comparable for GSet" << std::endl;
         MPI_Abort(MPI_COMM_WORLD, GRIDMISMATCH);
     }
+    if(!aggregator.Serves(*this))
+    {
+        SpParHelper::Print("GSet: the aggregator was created over a different vector\n");
+        MPI_Abort(MPI_COMM_WORLD, GRIDMISMATCH);
+    }
     
+    spVec.ToList();
     IT spVecSize = spVec.getlocnnz();
     if(spVecSize==0) return;
     
-    
-    MPI_Comm World = commGrid->GetWorld();
-    int nprocs = commGrid->GetSize();
-    int myrank;
-    MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
-
-
-    std::vector< std::vector< NT > > datsent(nprocs);
-    std::vector< std::vector< IT > > indsent(nprocs);
+    auto replace = [](NT prev, NT val){ return val; };
     IT lengthUntil = spVec.LengthUntil();
-   
     for(IT k=0; k < spVecSize; ++k)
     {
-        IT locind;
         // get global index of the dense vector from the value. Most often a select operator.
         // If the first operand is selected, then invert; otherwise, EwiseApply.
         IT globind = __binopIdx(spVec.num[k], spVec.ind[k] + lengthUntil);
-        int owner = Owner(globind, locind); // get local index
-        NT val = __binopVal(spVec.num[k], spVec.ind[k] + lengthUntil);
         if(globind < glen) // prevent index greater than size of the composed vector
         {
-            datsent[owner].push_back(val);
-            indsent[owner].push_back(locind);   // so that we don't need no correction at the recipient
+            aggregator.Put(globind, __binopVal(spVec.num[k], spVec.ind[k] + lengthUntil), replace);   // local entries are set directly
         }
     }
-    
-    
-    for(int j = 0; j < datsent[myrank].size(); ++j)	// directly set local entries
-    {
-        arr[indsent[myrank][j]] = datsent[myrank][j];
-    }
-    
-    
-    //MPI_Win win;
-    //MPI_Win_create(&arr[0], LocArrSize() * sizeof(NT), sizeof(NT), MPI_INFO_NULL, World, &win);
-    //MPI_Win_fence(0, win);
-    for(int i=0; i<nprocs; ++i)
-    {
-        if(i!=myrank)
-        {
-            MPI_Win_lock(MPI_LOCK_SHARED,i,MPI_MODE_NOCHECK,win);
-            for(int j = 0; j < datsent[i].size(); ++j)
-            {
-                MPI_Put(&datsent[i][j], 1, MPIType<NT>(), i, indsent[i][j], 1, MPIType<NT>(), win);
-            }
-            MPI_Win_unlock(i, win);
-        }
-    }
-    //MPI_Win_fence(0, win);
-    //MPI_Win_free(&win);
-
+    aggregator.FlushPuts(replace, MPI_REPLACE);
 }
 
 
@@ -1148,75 +1180,181 @@ void FullyDistVec<IT,NT>::GSet (const FullyDistSpVec<IT,NT1> & spVec, _BinaryOpe
 // General purpose get operation on dense vector by a sparse vector
 // Get the element of the dense vector indexed by the value of the sparse vector
 // invert and get might not work in the presence of repeated values
+// Each distinct remote entry is fetched once, with one MPI_Get per owner
 
 template <class IT, class NT>
 template <class NT1, typename _BinaryOperationIdx>
  FullyDistSpVec<IT,NT> FullyDistVec<IT,NT>::GGet (const FullyDistSpVec<IT,NT1> & spVec, _BinaryOperationIdx __binopIdx, NT nullValue)
+{
+    DistVecAggregator<IT,NT> aggregator(*this);    // collective: creates the window over arr
+    return GGet(spVec, __binopIdx, nullValue, aggregator);
+}
+
+template <class IT, class NT>
+template <class NT1, typename _BinaryOperationIdx>
+ FullyDistSpVec<IT,NT> FullyDistVec<IT,NT>::GGet (const FullyDistSpVec<IT,NT1> & spVec, _BinaryOperationIdx __binopIdx, NT nullValue, DistVecAggregator<IT,NT> & aggregator)
 {
     if(*(commGrid) != *(spVec.commGrid))
     {
         std::cout << "Grids are not comparable for GGet" << std::endl;
         MPI_Abort(MPI_COMM_WORLD, GRIDMISMATCH);
     }
+    if(!aggregator.Serves(*this))
+    {
+        SpParHelper::Print("GGet: the aggregator was created over a different vector\n");
+        MPI_Abort(MPI_COMM_WORLD, GRIDMISMATCH);
+    }
     
-    MPI_Comm World = commGrid->GetWorld();
-    int nprocs = commGrid->GetSize();
-    int myrank;
-    MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
-    
-    
-    std::vector< std::vector< NT > > spIdx(nprocs);
-    std::vector< std::vector< IT > > indsent(nprocs);
     IT lengthUntil = spVec.LengthUntil();
+    spVec.ToList();
     IT spVecSize = spVec.getlocnnz();
     
     FullyDistSpVec<IT, NT> res(spVec.commGrid, spVec.TotalLength());
     res.ind.resize(spVecSize);
     res.num.resize(spVecSize);
-    
+    const IT outofrange = std::numeric_limits<IT>::max();
+    std::vector<IT> tickets(spVecSize, outofrange);
     
     for(IT k=0; k < spVecSize; ++k)
     {
-        IT locind;
         // get global index of the dense vector from the value. Most often a select operator.
         // If the first operand is selected, then invert; otherwise, EwiseApply.
         IT globind = __binopIdx(spVec.num[k], spVec.ind[k] + lengthUntil);
-        int owner = Owner(globind, locind); // get local index
-        //NT val = __binopVal(spVec.num[k], spVec.ind[k] + lengthUntil);
         if(globind < glen) // prevent index greater than size of the composed vector
-        {
-            spIdx[owner].push_back(k); // position of spVec
-            indsent[owner].push_back(locind);   // so that we don't need no correction at the recipient
-        }
+            tickets[k] = aggregator.Get(globind);
         else
             res.num[k] = nullValue;
         res.ind[k] = spVec.ind[k];
     }
-    
-    
-    for(int j = 0; j < indsent[myrank].size(); ++j)	// directly get local entries
-    {
-        res.num[spIdx[myrank][j]] = arr[indsent[myrank][j]];
-    }
-    
-    
-    MPI_Win win;
-    MPI_Win_create(&arr[0], LocArrSize() * sizeof(NT), sizeof(NT), MPI_INFO_NULL, World, &win);
-    for(int i=0; i<nprocs; ++i)
+    aggregator.FlushGets();
+    for(IT k=0; k < spVecSize; ++k)
     {
-        if(i!=myrank)
-        {
-            MPI_Win_lock(MPI_LOCK_SHARED,i,MPI_MODE_NOCHECK,win);
-            for(int j = 0; j < indsent[i].size(); ++j)
-            {
-                MPI_Get(&res.num[spIdx[i][j]], 1, MPIType<NT>(), i, indsent[i][j], 1, MPIType<NT>(), win);
-            }
-            MPI_Win_unlock(i, win);
-        }
+        if(tickets[k] != outofrange)
+            res.num[k] = aggregator.Value(tickets[k]);
     }
-    MPI_Win_free(&win);
-    
     return res;
 }
 
+template <class IT, class NT>
+FullyDistSpVec<IT,NT> FullyDistVec<IT,NT>::Extract (const FullyDistSpVec<IT,IT> & ri) const
+{
+	if(*(commGrid) != *(ri.commGrid))
+	{
+		std::cout << "Grids are not comparable for Extract" << std::endl;
+		MPI_Abort(MPI_COMM_WORLD, GRIDMISMATCH);
+	}
+	ri.ToList();
+	MPI_Comm World = commGrid->GetWorld();
+	int nprocs = commGrid->GetSize();
+	int myrank = commGrid->GetRank();
+
+	// deduplicated requests per owner; reqpos[i] is the position of ri's i^th request in its owner's list
+	IT riloclen = ri.num.size();
+	std::vector< std::vector<IT> > data_req(nprocs);
+	std::vector<int> reqowner(riloclen);
+	std::vector<IT> reqpos(riloclen);
+	std::vector<IT> reqloc(riloclen);
+	std::unordered_map<IT,IT> seen;
+	for(IT i=0; i < riloclen; ++i)
+	{
+		if(ri.num[i] >= glen)
+		{
+			std::ostringstream outs;
+			outs << "Extract: index " << ri.num[i] << " is out of range (" << glen << ")\n";
+			SpParHelper::Print(outs.str());
+			MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+		}
+		IT locind;
+		int owner = Owner(ri.num[i], locind);
+		reqowner[i] = owner;
+		reqloc[i] = locind;
+		auto found = seen.find(ri.num[i]);
+		if(found != seen.end())
+		{
+			reqpos[i] = found->second;
+		}
+		else
+		{
+			reqpos[i] = data_req[owner].size();
+			seen[ri.num[i]] = reqpos[i];
+			data_req[owner].push_back(locind);
+		}
+	}
+	std::unordered_map<IT,IT>().swap(seen);
+
+	int * sendcnt = new int[nprocs];
+	int * recvcnt = new int[nprocs];
+	int * sdispls = new int[nprocs]();
+	int * rdispls = new int[nprocs]();
+	for(int i=0; i<nprocs; ++i)
+		sendcnt[i] = (int) data_req[i].size();
+	MPI_Alltoall(sendcnt, 1, MPI_INT, recvcnt, 1, MPI_INT, World);  // share the request counts
+
+	// broadcasting my piece costs ~ LocArrSize() * log(p), serving requests costs ~ their number
+	IT totrecv = std::accumulate(recvcnt, recvcnt+nprocs, static_cast<IT>(0));
+	IT bcastsize = (LocArrSize() * std::log2(nprocs) < totrecv)? LocArrSize() : 0;
+	std::vector<IT> bcastcnt(nprocs);
+	MPI_Allgather(&bcastsize, 1, MPIType<IT>(), bcastcnt.data(), 1, MPIType<IT>(), World);
+
+	std::vector< std::vector<NT> > bcastBuffer(nprocs);
+	std::vector<MPI_Request> requests;
+	for(int i=0; i<nprocs; ++i)
+	{
+		if(bcastcnt[i] > 0)
+		{
+			bcastBuffer[i].resize(bcastcnt[i]);
+			if(i == myrank)	std::copy(arr.begin(), arr.end(), bcastBuffer[i].begin());
+			requests.push_back(MPI_Request());
+			MPI_Ibcast(bcastBuffer[i].data(), bcastcnt[i], MPIType<NT>(), i, World, &requests.back());
+			sendcnt[i] = 0;		// served by the broadcast
+			if(i == myrank)	std::fill_n(recvcnt, nprocs, 0);
+		}
+	}
+
+	std::partial_sum(sendcnt, sendcnt+nprocs-1, sdispls+1);
+	std::partial_sum(recvcnt, recvcnt+nprocs-1, rdispls+1);
+	IT totsend = std::accumulate(sendcnt, sendcnt+nprocs, static_cast<IT>(0));
+	totrecv = std::accumulate(recvcnt, recvcnt+nprocs, static_cast<IT>(0));
+
+	IT * sendbuf = new IT[totsend];
+	for(int i=0; i<nprocs; ++i)
+	{
+		if(sendcnt[i] > 0)
+			std::copy(data_req[i].begin(), data_req[i].end(), sendbuf+sdispls[i]);
+		std::vector<IT>().swap(data_req[i]);
+	}
+	IT * recvbuf = new IT[totrecv];
+	SpParHelper::Alltoallv(sendbuf, sendcnt, sdispls, recvbuf, recvcnt, rdispls, World);
+	delete [] sendbuf;
+
+	NT * databack = new NT[totrecv];
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(IT i=0; i<totrecv; ++i)
+		databack[i] = arr[recvbuf[i]];
+	delete [] recvbuf;
+
+	NT * databuf = new NT[totsend];	// the response counts are the same as the request counts
+	SpParHelper::Alltoallv(databack, recvcnt, rdispls, databuf, sendcnt, sdispls, World);
+	MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+
+	FullyDistSpVec<IT,NT> indexed(commGrid, ri.TotalLength());
+	indexed.ind = ri.ind;
+	indexed.num.resize(riloclen);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(IT i=0; i < riloclen; ++i)
+	{
+		int owner = reqowner[i];
+		if(bcastcnt[owner] > 0)
+			indexed.num[i] = bcastBuffer[owner][reqloc[i]];
+		else
+			indexed.num[i] = databuf[sdispls[owner] + reqpos[i]];
+	}
+	DeleteAll(sendcnt, recvcnt, sdispls, rdispls, databack, databuf);
+	return indexed;
+}
+
 }
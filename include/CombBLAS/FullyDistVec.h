@@ -40,6 +40,7 @@
 #include "CommGrid.h"
 #include "FullyDist.h"
 #include "Exception.h"
+#include "AsyncWrite.h"
 
 namespace combblas {
 
@@ -55,6 +56,9 @@ class DistEdgeList;
 template <class IU, class NU>
 class DenseVectorLocalIterator;
 
+template <class IU, class NU>
+class DistVecAggregator;
+
 // ABAB: As opposed to SpParMat, IT here is used to encode global size and global indices;
 // therefore it can not be 32-bits, in general.
 template <class IT, class NT>
@@ -99,6 +103,27 @@ public:
         	tmpSpVec.ParallelWrite(filename, onebased, handler, includeindices);
 	}  
 	void ParallelWrite(const std::string & filename, bool onebased, bool includeindices = true) { ParallelWrite(filename, onebased, ScalarReadSaveHandler(), includeindices); };
+
+	//! Like ParallelWrite, but formats and writes a copy of the local entries in the background (see AsyncWrite)
+	template <class HANDLER>
+	AsyncWrite ParallelWriteAsync(const std::string & filename, bool onebased, HANDLER handler, bool includeindices = true)
+	{
+		std::shared_ptr< std::vector<NT> > snapshot = std::make_shared< std::vector<NT> >(arr);
+		IT offset = LengthUntil() + (onebased? 1 : 0);
+		return AsyncWrite(filename, [snapshot, offset, handler, includeindices](std::string & text) mutable
+		{
+			std::stringstream ss;
+			for(size_t i=0; i< snapshot->size(); ++i)
+			{
+				IT index = offset + static_cast<IT>(i);
+				if(includeindices)	ss << index << '\t';
+				handler.save(ss, (*snapshot)[i], index);
+				ss << '\n';
+			}
+			text = ss.str();
+		}, commGrid->GetWorld());
+	}
+	AsyncWrite ParallelWriteAsync(const std::string & filename, bool onebased, bool includeindices = true) { return ParallelWriteAsync(filename, onebased, ScalarReadSaveHandler(), includeindices); };
 	
 
 	template <typename _BinaryOperation>
@@ -109,6 +134,12 @@ public:
 		*this = tmpSpVec;	// sparse -> dense conversion
 	}  
 
+	//! Binary I/O with collective MPI-IO: a VectorFileHeader (see FileHeader.h) followed by the values in index order
+	//! Every process reads its own range, so a file can be read back by any number of processes
+	//! A file written by FullyDistSpVec::ParallelBinaryWrite is read as well (missing entries become NT())
+	void ParallelBinaryWrite(const std::string & filename) const;
+	void ParallelBinaryRead(const std::string & filename);
+
 	template <class HANDLER>
 	std::ifstream& ReadDistribute (std::ifstream& infile, int master, HANDLER handler);	
 	std::ifstream& ReadDistribute (std::ifstream& infile, int master) { return ReadDistribute(infile, master, ScalarReadSaveHandler()); }
@@ -154,6 +185,18 @@ public:
     template <class NT1, typename _BinaryOperationIdx>
     FullyDistSpVec<IT,NT> GGet (const FullyDistSpVec<IT,NT1> & spVec, _BinaryOperationIdx __binopIdx, NT nullValue);
 
+    //! Same as above, through a caller-owned aggregator over *this that outlives the call,
+    //! so its window is created once and fetched entries stay cached until its EndEpoch()
+    template <class NT1, typename _BinaryOperationIdx, typename _BinaryOperationVal>
+    void GSet (const FullyDistSpVec<IT,NT1> & spVec, _BinaryOperationIdx __binopIdx, _BinaryOperationVal __binopVal, DistVecAggregator<IT,NT> & aggregator);
+    template <class NT1, typename _BinaryOperationIdx>
+    FullyDistSpVec<IT,NT> GGet (const FullyDistSpVec<IT,NT1> & spVec, _BinaryOperationIdx __binopIdx, NT nullValue, DistVecAggregator<IT,NT> & aggregator);
+
+	//! Indexed gather: out[i] = (*this)[ri[i]] for every nonzero i of ri
+	//! Repeated indices are requested once per processor, and owners that would serve more
+	//! requests than broadcasting their local piece costs broadcast it instead (hot keys)
+	FullyDistSpVec<IT,NT> Extract (const FullyDistSpVec<IT,IT> & ri) const;
+
 	void iota(IT globalsize, NT first);
 	void RandPerm();	// randomly permute the vector
 	FullyDistVec<IT,IT> sort();	// sort and return the permutation
@@ -294,6 +337,9 @@ private:
 	template <class IU, class NU>
 	friend class DenseVectorLocalIterator;
 
+	template <class IU, class NU>
+	friend class DistVecAggregator;
+
 	template <typename SR, typename IU, typename NUM, typename NUV, typename UDER> 
 	friend FullyDistVec<IU,typename promote_trait<NUM,NUV>::T_promote> 
 	SpMV (const SpParMat<IU,NUM,UDER> & A, const FullyDistVec<IU,NUV> & x );
@@ -332,6 +378,7 @@ private:
 
 }
 
+#include "DistVecAggregator.h"
 #include "FullyDistVec.cpp"
 
 #endif
@@ -5,6 +5,8 @@
 #include <typeinfo>
 #include <map>
 #include <functional>
+#include <limits>
+#include <type_traits>
 #include <mpi.h>
 #include <stdint.h>
 #include "Operations.h"
@@ -108,6 +110,38 @@ template<typename T> struct MPIOp< bitwise_and<T>,T,typename std::enable_if<std:
 template<typename T> struct MPIOp< bitwise_or<T>,T,typename std::enable_if<std::is_pod<T>::value, void>::type > {  static MPI_Op op() { return MPI_BOR; } };
 template<typename T> struct MPIOp< bitwise_xor<T>,T,typename std::enable_if<std::is_pod<T>::value, void>::type > { static MPI_Op op() { return MPI_BXOR; } };
 
+
+// Whether MPIOp maps Op to a predefined MPI_Op (the generic template, which creates
+// a user-defined op, is the only one with a funcmpi member)
+template <typename Op, typename T, typename Enable = void>
+struct is_predefined_mpiop : std::true_type {};
+template <typename Op, typename T>
+struct is_predefined_mpiop<Op, T, decltype((void) &MPIOp<Op,T>::funcmpi)> : std::false_type {};
+
+template <typename Op, typename T>
+MPI_Op PredefinedMPIOp(std::true_type) { return MPIOp<Op,T>::op(); }
+template <typename Op, typename T>
+MPI_Op PredefinedMPIOp(std::false_type) { return MPI_OP_NULL; }
+
+// The predefined MPI_Op for Op, or MPI_OP_NULL; never creates a user-defined op
+template <typename Op, typename T>
+MPI_Op PredefinedMPIOp() { return PredefinedMPIOp<Op,T>(is_predefined_mpiop<Op,T>()); }
+
+// Identity element of a predefined MPI_Op on an arithmetic type
+// Returns false for user-defined ops, whose identity is unknown
+template <typename T>
+bool MPIOpIdentity(MPI_Op op, T & identity)
+{
+    if(!std::is_arithmetic<T>::value)   return false;
+    if(op == MPI_MIN)       identity = std::numeric_limits<T>::max();
+    else if(op == MPI_MAX)  identity = std::numeric_limits<T>::lowest();
+    else if(op == MPI_SUM || op == MPI_LOR || op == MPI_LXOR || op == MPI_BOR || op == MPI_BXOR)  identity = static_cast<T>(0);
+    else if(op == MPI_PROD || op == MPI_LAND)   identity = static_cast<T>(1);
+    else if(op == MPI_BAND && std::is_integral<T>::value)   identity = static_cast<T>(-1);   // all bits set
+    else return false;
+    return true;
+}
+
 }
 
 #endif
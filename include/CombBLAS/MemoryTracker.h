@@ -0,0 +1,102 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 6/15/2017 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc  --------------------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2017, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#ifndef _MEMORY_TRACKER_H_
+#define _MEMORY_TRACKER_H_
+
+#include <mpi.h>
+#include <cstddef>
+#include <stdint.h>
+
+namespace combblas {
+
+//! Operations that memory is charged to; a block stays charged to the operation that allocated it until it is freed
+enum MemTag
+{
+MEM_OTHER,
+MEM_SPGEMM,		// SpGEMM drivers: operand copies, symbolic phase and the product matrix
+MEM_SPGEMM_BCAST,	// pieces of A and B received in SUMMA stages
+MEM_SPGEMM_LOCAL,	// outputs and heaps/hash tables of the local multiplications
+MEM_MERGE,		// merging the stage outputs
+MEM_KSELECT,
+MEM_TRANSPOSE,
+MEM_IO,
+MEM_NUMTAGS
+};
+
+/**
+  * Per-rank accounting of the memory held by the library, by operation
+  * Arena blocks (Dcsc and SpTuples storage, SpGEMM, merge and communication buffers) are charged automatically
+  * to the operation that is running when they are allocated; other large allocations can be charged explicitly
+  * Threads post their charges in batches of MEMTRACK_BATCH_BYTES, so the totals seen by other threads and the
+  * peaks lag by at most that much per thread
+  * With a budget set, an allocation that would take the rank over it aborts the run with a report of what
+  * holds the memory, and MemEfficientSpGEMM picks its number of phases from the budget
+  */
+class MemoryTracker
+{
+public:
+	//! Charges the allocations made during its lifetime (by any thread) to tag; create outside of parallel regions
+	class Scope
+	{
+	public:
+		explicit Scope(MemTag tag);
+		~Scope();
+	private:
+		int previous;
+		bool active;
+	};
+
+	static MemTag CurrentTag();
+	static const char * TagName(int tag);
+
+	static void Charge(int tag, int64_t bytes);	//!< bytes allocated outside the arena
+	static void Release(int tag, int64_t bytes);
+
+	static int64_t CurrentBytes();			//!< charged to all operations on this rank
+	static int64_t CurrentBytes(MemTag tag);
+	static int64_t PeakBytes();
+	static int64_t PeakBytes(MemTag tag);
+	static void ResetPeaks();			//!< peaks restart from the current values, e.g. to measure one operation
+
+	//! Per-rank limit in bytes (0: unlimited); call with the same value on all ranks, since phase counts derive from it
+	static void SetBudget(int64_t bytes);
+	static int64_t Budget();
+	static int64_t Available();			//!< budget minus current bytes (INT64_MAX when unlimited)
+
+	static int64_t ResidentBytes();			//!< resident set size of the process, from /proc/self/statm
+	static int64_t PeakResidentBytes();		//!< high water mark of the resident set, from /proc/self/status
+
+	//! Collective: reduces the counters of all ranks of comm and prints a table on its rank 0
+	static void Report(MPI_Comm comm = MPI_COMM_WORLD, const char * label = NULL);
+};
+
+}
+
+#endif
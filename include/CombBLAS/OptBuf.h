@@ -30,6 +30,7 @@
 #ifndef _OPT_BUF_H
 #define _OPT_BUF_H
 #include "BitMap.h"
+#include "Arena.h"
 
 namespace combblas {
 
@@ -56,10 +57,11 @@ public:
 	{
 		p_c =  maxsizes.size(); 
 		totmax = std::accumulate(maxsizes.begin(), maxsizes.end(), 0);
-		inds = new IT[totmax];
+		inds = ArenaNew<IT>(totmax);
 		std::fill_n(inds, totmax, -1);
-		nums = new NT[totmax];
-		dspls = new int[p_c]();
+		nums = ArenaNew<NT>(totmax);
+		dspls = ArenaNew<int>(p_c);
+		std::fill_n(dspls, p_c, 0);
     std::partial_sum(maxsizes.begin(), maxsizes.end()-1, dspls+1);
 		localm = mA;
 		
@@ -73,20 +75,21 @@ public:
 		
 		if(totmax > 0)
 		{
-			delete [] inds;
-			delete [] nums;
+			ArenaDelete(inds);
+			ArenaDelete(nums);
 		}
 		if(p_c > 0)
-			delete [] dspls;
+			ArenaDelete(dspls);
 	}
 	OptBuf(const OptBuf<IT,NT> & rhs)
 	{
 		p_c = rhs.p_c;
 		totmax = rhs.totmax;
 		localm = rhs.localm;
-		inds = new IT[totmax];
-		nums = new NT[totmax];
-		dspls = new int[p_c]();
+		inds = ArenaNew<IT>(totmax);
+		nums = ArenaNew<NT>(totmax);
+		dspls = ArenaNew<int>(p_c);
+		std::fill_n(dspls, p_c, 0);
 		isthere = new BitMap(localm);
 	}
 	OptBuf<IT,NT> & operator=(const OptBuf<IT,NT> & rhs)
@@ -99,18 +102,19 @@ public:
 			}
 			if(totmax > 0)
 			{
-				delete [] inds;
-				delete [] nums;
+				ArenaDelete(inds);
+				ArenaDelete(nums);
 			}
 			if(p_c > 0)
-				delete [] dspls;
+				ArenaDelete(dspls);
 	
 			p_c = rhs.p_c;
 			totmax = rhs.totmax;
 			localm = rhs.localm;
-			inds = new IT[totmax];
-			nums = new NT[totmax];
-			dspls = new int[p_c]();	
+			inds = ArenaNew<IT>(totmax);
+			nums = ArenaNew<NT>(totmax);
+			dspls = ArenaNew<int>(p_c);
+			std::fill_n(dspls, p_c, 0);
 			isthere = new BitMap(*(rhs.isthere));
 		}
 		return *this;
@@ -34,13 +34,13 @@
 #include <iostream>
 #include <cstdarg>
 #include "SpParMat.h"	
+#include "mtSpGEMM.h"		// before SpParMat3D.h, whose implementation uses the local kernels
+#include "MultiwayMerge.h"
 #include "SpParMat3D.h"	
 #include "SpParHelper.h"
 #include "MPIType.h"
 #include "Friends.h"
 #include "OptBuf.h"
-#include "mtSpGEMM.h"
-#include "MultiwayMerge.h"
 #include <unistd.h>
 #include <type_traits>
 
@@ -185,6 +185,7 @@ bool CheckSpGEMMCompliance(const MATRIXA & A, const MATRIXB & B)
 template <typename IT, typename NT, typename DER>
 void MCLPruneRecoverySelect(SpParMat<IT,NT,DER> & A, NT hardThreshold, IT selectNum, IT recoverNum, NT recoverPct, int kselectVersion)
 {
+    MemoryTracker::Scope scope(MEM_KSELECT);
     int myrank;
     MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
     
@@ -354,7 +355,7 @@ void MCLPruneRecoverySelect(SpParMat<IT,NT,DER> & A, NT hardThreshold, IT select
 
 template <typename SR, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB> 
 IU EstimateFLOP 
-		(SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B, bool clearA = false, bool clearB = false)
+		(const SpParMat<IU,NU1,UDERA> & A, const SpParMat<IU,NU2,UDERB> & B, bool clearA = false, bool clearB = false)
 
 {
     int myrank;
@@ -397,6 +398,7 @@ IU EstimateFLOP
 			ARecv = new UDERA();				// first, create the object
 		}
 		SpParHelper::BCastMatrix(GridC->GetRowWorld(), *ARecv, ess, i);	// then, receive its elements
+		if(i != Aself) ARecv->ChooseLayout();	// lookups of the local multiply for the received piece (see SpDCCols::ChooseLayout)
 		ess.clear();
 		
 		if(i == Bself)
@@ -422,11 +424,11 @@ IU EstimateFLOP
 
 	if(clearA && A.spSeq != NULL) {	
 		delete A.spSeq;
-		A.spSeq = NULL;
+		const_cast< SpParMat<IU,NU1,UDERA> & >(A).spSeq = NULL;	// handed over by the caller; a cached A.T() stays
 	}	
 	if(clearB && B.spSeq != NULL) {
 		delete B.spSeq;
-		B.spSeq = NULL;
+		const_cast< SpParMat<IU,NU2,UDERB> & >(B).spSeq = NULL;	// handed over by the caller; a cached B.T() stays
 	}
 
 	SpHelper::deallocate2D(ARecvSizes, UDERA::esscount);
@@ -443,11 +445,14 @@ IU EstimateFLOP
 /**
  * Broadcasts A multiple times (#phases) in order to save storage in the output
  * Only uses 1/phases of C memory if the threshold/max limits are proper
+ * @param[in] perProcessMemory {GB per process, from which the number of phases is estimated;
+ *		if not positive, the budget set with MemoryTracker::SetBudget is used instead, if any}
  */
 template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB>
-SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B,
+SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (const SpParMat<IU,NU1,UDERA> & A, const SpParMat<IU,NU2,UDERB> & B,
                                            int phases, NUO hardThreshold, IU selectNum, IU recoverNum, NUO recoverPct, int kselectVersion, int64_t perProcessMemory)
 {
+    MemoryTracker::Scope scope(MEM_SPGEMM);
     typedef typename UDERA::LocalIT LIA;
     typedef typename UDERB::LocalIT LIB;
     typedef typename UDERO::LocalIT LIC;
@@ -477,7 +482,8 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
     MPI_Barrier(A.getcommgrid()->GetWorld());
     t0 = MPI_Wtime();
 #endif
-    if(perProcessMemory>0) // estimate the number of phases permitted by memory
+    int64_t memoryBudget = (perProcessMemory > 0)? perProcessMemory*1000000000 : MemoryTracker::Budget();
+    if(memoryBudget>0) // estimate the number of phases permitted by memory
     {
         int p;
         MPI_Comm World = GridC->GetWorld();
@@ -491,6 +497,13 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
         int64_t gannz;
         MPI_Allreduce(&lannz, &gannz, 1, MPIType<int64_t>(), MPI_MAX, World);
         int64_t inputMem = gannz * perNNZMem_in * 4; // for four copies (two for SUMMA)
+        if(perProcessMemory <= 0)   // the tracker knows what the process already holds (inputs included), only the SUMMA copies come on top
+        {
+            int64_t lheld = MemoryTracker::CurrentBytes();
+            int64_t gheld;
+            MPI_Allreduce(&lheld, &gheld, 1, MPIType<int64_t>(), MPI_MAX, World);
+            inputMem = gheld + gannz * perNNZMem_in * 2;
+        }
         
         // max nnz(A^2) stored by SUMMA in a porcess
         int64_t asquareNNZ = EstPerProcessNnzSUMMA(A,B, false);
@@ -508,11 +521,12 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
         int64_t outputMem = outputNNZ * perNNZMem_in * 2;
         
         //inputMem + outputMem + asquareMem/phases + kselectmem/phases < memory
-        int64_t remainingMem = perProcessMemory*1000000000 - inputMem - outputMem;
+        int64_t remainingMem = memoryBudget - inputMem - outputMem;
         if(remainingMem > 0)
         {
             phases = 1 + (asquareMem+kselectmem) / remainingMem;
         }
+        MPI_Allreduce(MPI_IN_PLACE, &phases, 1, MPI_INT, MPI_MAX, World);   // budgets that differ by process must still agree on the phases
         
         
         if(myrank==0)
@@ -524,9 +538,9 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
 #ifdef SHOW_MEMORY_USAGE
             int64_t maxMemory = kselectmem/phases + inputMem + outputMem + asquareMem / phases;
             if(maxMemory>1000000000)
-            std::cout << "phases: " << phases << ": per process memory: " << perProcessMemory << " GB asquareMem: " << asquareMem/1000000000.00 << " GB" << " inputMem: " << inputMem/1000000000.00 << " GB" << " outputMem: " << outputMem/1000000000.00 << " GB" << " kselectmem: " << kselectmem/1000000000.00 << " GB" << std::endl;
+            std::cout << "phases: " << phases << ": per process memory: " << memoryBudget/1000000000.00 << " GB asquareMem: " << asquareMem/1000000000.00 << " GB" << " inputMem: " << inputMem/1000000000.00 << " GB" << " outputMem: " << outputMem/1000000000.00 << " GB" << " kselectmem: " << kselectmem/1000000000.00 << " GB" << std::endl;
             else
-            std::cout << "phases: " << phases << ": per process memory: " << perProcessMemory << " GB asquareMem: " << asquareMem/1000000.00 << " MB" << " inputMem: " << inputMem/1000000.00 << " MB" << " outputMem: " << outputMem/1000000.00 << " MB" << " kselectmem: " << kselectmem/1000000.00 << " MB" << std::endl;
+            std::cout << "phases: " << phases << ": per process memory: " << memoryBudget/1000000000.00 << " GB asquareMem: " << asquareMem/1000000.00 << " MB" << " inputMem: " << inputMem/1000000.00 << " MB" << " outputMem: " << outputMem/1000000.00 << " MB" << " kselectmem: " << kselectmem/1000000.00 << " MB" << std::endl;
 #endif
             
         }
@@ -591,6 +605,7 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
             t0 = MPI_Wtime();
 #endif
             SpParHelper::BCastMatrix(GridC->GetRowWorld(), *ARecv, ess, i);	// then, receive its elements
+            if(i != Aself) ARecv->ChooseLayout();	// lookups of the local multiply for the received piece (see SpDCCols::ChooseLayout)
 #ifdef TIMING
             MPI_Barrier(A.getcommgrid()->GetWorld());
             t1 = MPI_Wtime();
@@ -719,9 +734,9 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
             toconcatenate.push_back(OnePieceOfC_mat.seq());
         }
     }
-        //double vm_usage, resident_set;
-        //process_mem_usage(vm_usage, resident_set);
-        //if(myrank == 0) fprintf(stderr, "VmSize after %dth all phase: %lf %lf\n", dbg+1, vm_usage, resident_set);
+#ifdef SHOW_MEMORY_USAGE
+        MemoryTracker::Report(GridC->GetWorld(), "after all phases of MemEfficientSpGEMM");
+#endif
     }
     
     
@@ -735,7 +750,7 @@ SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<
 }
 
 template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB>
-int CalculateNumberOfPhases (SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B,
+int CalculateNumberOfPhases (const SpParMat<IU,NU1,UDERA> & A, const SpParMat<IU,NU2,UDERB> & B,
         NUO hardThreshold, IU selectNum, IU recoverNum, NUO recoverPct, int kselectVersion, int64_t perProcessMemory){
     
     int phases;
@@ -782,7 +797,8 @@ int CalculateNumberOfPhases (SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB>
     
     //inputMem + outputMem + asquareMem/phases + kselectmem/phases < memory
     //int64_t remainingMem = perProcessMemory*1000000000 - inputMem - outputMem;
-    int64_t remainingMem = perProcessMemory*1000000000 - inputMem; // if each phase result is discarded
+    int64_t memoryBudget = (perProcessMemory > 0)? perProcessMemory*1000000000 : MemoryTracker::Budget();
+    int64_t remainingMem = memoryBudget - inputMem; // if each phase result is discarded
     //if(remainingMem > 0)
     //{
         //phases = 1 + (asquareMem+kselectmem) / remainingMem;
@@ -802,9 +818,10 @@ int CalculateNumberOfPhases (SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB>
  **/  
 template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB> 
 SpParMat<IU,NUO,UDERO> Mult_AnXBn_DoubleBuff
-		(SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B, bool clearA = false, bool clearB = false )
+		(const SpParMat<IU,NU1,UDERA> & A, const SpParMat<IU,NU2,UDERB> & B, bool clearA = false, bool clearB = false )
 
 {
+	MemoryTracker::Scope scope(MEM_SPGEMM);
 	if(!CheckSpGEMMCompliance(A,B) )
 	{
 		return SpParMat< IU,NUO,UDERO >();
@@ -864,6 +881,7 @@ SpParMat<IU,NUO,UDERO> Mult_AnXBn_DoubleBuff
 			ARecv = new UDERA();				// first, create the object
 		}
 		SpParHelper::BCastMatrix(GridC->GetRowWorld(), *ARecv, ess, i);	// then, receive its elements	
+		if(i != Aself) ARecv->ChooseLayout();	// lookups of the local multiply for the received piece (see SpDCCols::ChooseLayout)
 		ess.clear();	
 		if(i == Bself)
 		{
@@ -929,6 +947,7 @@ SpParMat<IU,NUO,UDERO> Mult_AnXBn_DoubleBuff
 		}
 
 		SpParHelper::BCastMatrix(GridC->GetRowWorld(), *ARecv, ess, i);	// then, receive its elements	
+		if(i != Aself) ARecv->ChooseLayout();	// lookups of the local multiply for the received piece (see SpDCCols::ChooseLayout)
 		ess.clear();	
 		
 		if(i == Bself)
@@ -973,7 +992,7 @@ SpParMat<IU,NUO,UDERO> Mult_AnXBn_DoubleBuff
 	{
 		delete A2seq;
 		delete A.spSeq;
-		A.spSeq = NULL;
+		const_cast< SpParMat<IU,NU1,UDERA> & >(A).spSeq = NULL;	// handed over by the caller; a cached A.T() stays
 	}
 	else
 	{
@@ -985,7 +1004,7 @@ SpParMat<IU,NUO,UDERO> Mult_AnXBn_DoubleBuff
 	{
 		delete B2seq;
 		delete B.spSeq;
-		B.spSeq = NULL;	
+		const_cast< SpParMat<IU,NU2,UDERB> & >(B).spSeq = NULL;	// handed over by the caller; a cached B.T() stays
 	}
 	else
 	{
@@ -1002,54 +1021,6 @@ SpParMat<IU,NUO,UDERO> Mult_AnXBn_DoubleBuff
 }
 
 
-void process_mem_usage(double& vm_usage, double& resident_set)
-{
-   using std::ios_base;
-   using std::ifstream;
-   using std::string;
-
-   vm_usage     = 0.0;
-   resident_set = 0.0;
-
-   // 'file' stat seems to give the most reliable results
-   //
-   ifstream stat_stream("/proc/self/stat",ios_base::in);
-
-   // dummy vars for leading entries in stat that we don't care about
-   //
-   string pid, comm, state, ppid, pgrp, session, tty_nr;
-   string tpgid, flags, minflt, cminflt, majflt, cmajflt;
-   string utime, stime, cutime, cstime, priority, nice;
-   string O, itrealvalue, starttime;
-
-   // the two fields we want
-   //
-   unsigned long vsize;
-   long rss;
-
-   stat_stream >> pid >> comm >> state >> ppid >> pgrp >> session >> tty_nr
-               >> tpgid >> flags >> minflt >> cminflt >> majflt >> cmajflt
-               >> utime >> stime >> cutime >> cstime >> priority >> nice
-               >> O >> itrealvalue >> starttime >> vsize >> rss; // don't care about the rest
-
-   stat_stream.close();
-
-   long page_size_kb = sysconf(_SC_PAGE_SIZE) / 1024; // in case x86-64 is configured to use 2MB pages
-   //vm_usage     = vsize / (1024.0 * 1024 * 1024);
-   //resident_set = rss * page_size_kb/(1024 * 1024.0);
-   vm_usage     = vsize / (1024.0);
-   resident_set = rss * page_size_kb/(1.0);
-
-   double max_vm_usage;
-   double max_resident_set;
-   MPI_Allreduce(&vm_usage, &max_vm_usage, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
-   MPI_Allreduce(&resident_set, &max_resident_set, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
-   vm_usage = max_vm_usage;
-   resident_set = max_resident_set;
-}
-
-
-
 /**
  * Parallel A = B*C routine that uses only MPI-1 features
  * Relies on simple blocking broadcast
@@ -1057,9 +1028,10 @@ void process_mem_usage(double& vm_usage, double& resident_set)
  **/  
 template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB> 
 SpParMat<IU, NUO, UDERO> Mult_AnXBn_Synch 
-		(SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B, bool clearA = false, bool clearB = false )
+		(const SpParMat<IU,NU1,UDERA> & A, const SpParMat<IU,NU2,UDERB> & B, bool clearA = false, bool clearB = false )
 
 {
+    MemoryTracker::Scope scope(MEM_SPGEMM);
     int myrank;
     MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
 	if(!CheckSpGEMMCompliance(A,B) )
@@ -1112,6 +1084,7 @@ SpParMat<IU, NUO, UDERO> Mult_AnXBn_Synch
         double t0 = MPI_Wtime();
 #endif
 		SpParHelper::BCastMatrix(GridC->GetRowWorld(), *ARecv, ess, i);	// then, receive its elements	
+		if(i != Aself) ARecv->ChooseLayout();	// lookups of the local multiply for the received piece (see SpDCCols::ChooseLayout)
 #ifdef TIMING
         MPI_Barrier(A.getcommgrid()->GetWorld());
         double t1 = MPI_Wtime();
@@ -1173,12 +1146,12 @@ SpParMat<IU, NUO, UDERO> Mult_AnXBn_Synch
 	if(clearA && A.spSeq != NULL) 
 	{	
 		delete A.spSeq;
-		A.spSeq = NULL;
+		const_cast< SpParMat<IU,NU1,UDERA> & >(A).spSeq = NULL;	// handed over by the caller; a cached A.T() stays
 	}	
 	if(clearB && B.spSeq != NULL) 
 	{
 		delete B.spSeq;
-		B.spSeq = NULL;
+		const_cast< SpParMat<IU,NU2,UDERB> & >(B).spSeq = NULL;	// handed over by the caller; a cached B.T() stays
 	}
 
 	SpHelper::deallocate2D(ARecvSizes, UDERA::esscount);
@@ -1217,8 +1190,9 @@ SpParMat<IU, NUO, UDERO> Mult_AnXBn_Synch
     
 template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB> 
 SpParMat<IU, NUO, UDERO> Mult_AnXBn_Overlap 
-		(SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B, bool clearA = false, bool clearB = false )
+		(const SpParMat<IU,NU1,UDERA> & A, const SpParMat<IU,NU2,UDERB> & B, bool clearA = false, bool clearB = false )
 {
+    MemoryTracker::Scope scope(MEM_SPGEMM);
     int myrank;
     MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
 	if(!CheckSpGEMMCompliance(A,B) )
@@ -1316,11 +1290,11 @@ SpParMat<IU, NUO, UDERO> Mult_AnXBn_Overlap
 
 	if(clearA && A.spSeq != NULL) {	
 		delete A.spSeq;
-		A.spSeq = NULL;
+		const_cast< SpParMat<IU,NU1,UDERA> & >(A).spSeq = NULL;	// handed over by the caller; a cached A.T() stays
 	}	
 	if(clearB && B.spSeq != NULL) {
 		delete B.spSeq;
-		B.spSeq = NULL;
+		const_cast< SpParMat<IU,NU2,UDERB> & >(B).spSeq = NULL;	// handed over by the caller; a cached B.T() stays
 	}
 
     delete ARecv;
@@ -1348,7 +1322,7 @@ SpParMat<IU, NUO, UDERO> Mult_AnXBn_Overlap
   * @pre { Input matrices, A and B, should not alias }
   **/
 template <typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB>
-int64_t EstPerProcessNnzSUMMA(SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B, bool hashEstimate)  
+int64_t EstPerProcessNnzSUMMA(const SpParMat<IU,NU1,UDERA> & A, const SpParMat<IU,NU2,UDERB> & B, bool hashEstimate)  
 {
     	typedef typename UDERA::LocalIT LIA;
     	typedef typename UDERB::LocalIT LIB;
@@ -1407,6 +1381,7 @@ int64_t EstPerProcessNnzSUMMA(SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB>
             t0 = MPI_Wtime();
 #endif
             SpParHelper::BCastMatrix(GridC->GetRowWorld(), *ARecv, ess, i);    // then, receive its elements
+            if(i != Aself) ARecv->ChooseLayout();	// lookups of the local multiply for the received piece (see SpDCCols::ChooseLayout)
 #ifdef TIMING
             t1 = MPI_Wtime();
             sym_Abcasttime += t1-t0;
@@ -1567,18 +1542,29 @@ void TransposeVector(MPI_Comm & World, const FullyDistSpVec<IU,NV> & x, int32_t
 	// Copy them to 32 bit integers and transfer that to save 50% of off-node bandwidth
 	trxinds = new int32_t[trxlocnz];
 	int32_t * temp_xind = new int32_t[xlocnz];
+	NV * temp_xnum = NULL;
+	if(x.dense)	// pack straight from the bitmap, without switching x back to list form
+	{
+		if(!indexisvalue) temp_xnum = new NV[xlocnz];
+		x.DenseExtract(temp_xind, temp_xnum);
+	}
+	else
+	{
 #ifdef THREADED
 #pragma omp parallel for
 #endif
-	for(int i=0; i< xlocnz; ++i)
-        temp_xind[i] = (int32_t) x.ind[i];
+		for(int i=0; i< xlocnz; ++i)
+			temp_xind[i] = (int32_t) x.ind[i];
+	}
 	MPI_Sendrecv(temp_xind, xlocnz, MPIType<int32_t>(), diagneigh, TRI, trxinds, trxlocnz, MPIType<int32_t>(), diagneigh, TRI, World, &status);
 	delete [] temp_xind;
 	if(!indexisvalue)
 	{
 		trxnums = new NV[trxlocnz];
-		MPI_Sendrecv(const_cast<NV*>(SpHelper::p2a(x.num)), xlocnz, MPIType<NV>(), diagneigh, TRX, trxnums, trxlocnz, MPIType<NV>(), diagneigh, TRX, World, &status);
+		const NV * xnums = x.dense? temp_xnum : SpHelper::p2a(x.num);
+		MPI_Sendrecv(const_cast<NV*>(xnums), xlocnz, MPIType<NV>(), diagneigh, TRX, trxnums, trxlocnz, MPIType<NV>(), diagneigh, TRX, World, &status);
 	}
+	delete [] temp_xnum;
     
   std::transform(trxinds, trxinds+trxlocnz, trxinds, std::bind2nd(std::plus<int32_t>(), roffset)); // fullydist indexing (p pieces) -> matrix indexing (sqrt(p) pieces)
 }
@@ -1790,6 +1776,61 @@ void MergeContributions(int*  listSizes, std::vector<int32_t *> & indsvec, std::
 
 
 
+/**
+ * Accumulates the row neighbors' contributions into a bitmap + dense value array of length maxindex
+ * (the dense form of FullyDistSpVec). The index range is split at 64-element boundaries so that
+ * every bitmap word is owned by exactly one thread. Returns the number of distinct indices.
+ **/
+template <typename SR, typename IU, typename OVT>
+IU MergeContributionsDense(int * listSizes, std::vector<int32_t *> & indsvec, std::vector<OVT *> & numsvec, std::vector<uint64_t> & bmap, std::vector<OVT> & dnum, IU maxindex)
+{
+    int nlists = indsvec.size();
+    IU nwords = (maxindex + 63) / 64;
+    bmap.assign(nwords, 0);
+    dnum.resize(maxindex);
+
+    int nthreads=1;
+#ifdef THREADED
+#pragma omp parallel
+    {
+        nthreads = omp_get_num_threads();
+    }
+#endif
+    int nsplits = std::max(1, static_cast<int>(std::min(static_cast<IU>(4*nthreads), nwords))); // oversplit for load balance
+    IU nnz = 0;
+#ifdef THREADED
+#pragma omp parallel for schedule(dynamic) reduction(+:nnz)
+#endif
+    for(int s=0; s< nsplits; s++)
+    {
+        int32_t lo = static_cast<int32_t>(((nwords * s) / nsplits) * 64);
+        int32_t hi = static_cast<int32_t>(std::min(((nwords * (s+1)) / nsplits) * 64, maxindex));
+        for(int k=0; k< nlists; k++)
+        {
+            int32_t * first = std::lower_bound(indsvec[k], indsvec[k] + listSizes[k], lo);
+            int32_t * last = std::lower_bound(first, indsvec[k] + listSizes[k], hi);
+            for(int32_t * it = first; it != last; ++it)
+            {
+                int32_t i = *it;
+                OVT val = numsvec[k][it - indsvec[k]];
+                uint64_t mask = static_cast<uint64_t>(1) << BIT_OFFSET(i);
+                if(bmap[WORD_OFFSET(i)] & mask)
+                {
+                    dnum[i] = SR::add(dnum[i], val);
+                }
+                else
+                {
+                    bmap[WORD_OFFSET(i)] |= mask;
+                    dnum[i] = val;
+                    ++nnz;
+                }
+            }
+        }
+    }
+    return nnz;
+}
+
+
 template <typename SR, typename IU, typename OVT>
 void MergeContributions_threaded(int * & listSizes, std::vector<int32_t *> & indsvec, std::vector<OVT *> & numsvec, std::vector<IU> & mergedind, std::vector<OVT> & mergednum, IU maxindex)
 {
@@ -1947,6 +1988,7 @@ void SpMV (const SpParMat<IU,NUM,UDER> & A, const FullyDistSpVec<IU,IVT> & x, Fu
 
     if(x.commGrid->GetGridCols() == 1)
     {
+        y.ClearDense();
         y.ind.resize(sendcnt[0]);
         y.num.resize(sendcnt[0]);
 
@@ -1975,6 +2017,7 @@ void SpMV (const SpParMat<IU,NUM,UDER> & A, const FullyDistSpVec<IU,IVT> & x, Fu
 			DeleteAll(sendindbuf, sendnumbuf,sdispls);
 		}
 		delete [] sendcnt;
+        y.AutoFormat();
         return;
     }
 	int * rdispls = new int[rowneighs];
@@ -1997,14 +2040,14 @@ void SpMV (const SpParMat<IU,NUM,UDER> & A, const FullyDistSpVec<IU,IVT> & x, Fu
 #endif
 	if(optbuf.totmax > 0 )	// graph500 optimization enabled
 	{
-		MPI_Alltoallv(optbuf.inds, sendcnt, optbuf.dspls, MPIType<int32_t>(), recvindbuf, recvcnt, rdispls, MPIType<int32_t>(), RowWorld);
-		MPI_Alltoallv(optbuf.nums, sendcnt, optbuf.dspls, MPIType<OVT>(), recvnumbuf, recvcnt, rdispls, MPIType<OVT>(), RowWorld);
+		SpParHelper::Alltoallv(optbuf.inds, sendcnt, optbuf.dspls, recvindbuf, recvcnt, rdispls, RowWorld);
+		SpParHelper::Alltoallv(optbuf.nums, sendcnt, optbuf.dspls, recvnumbuf, recvcnt, rdispls, RowWorld);
 		delete [] sendcnt;
 	}
 	else
     {
-		MPI_Alltoallv(sendindbuf, sendcnt, sdispls, MPIType<int32_t>(), recvindbuf, recvcnt, rdispls, MPIType<int32_t>(), RowWorld);
-		MPI_Alltoallv(sendnumbuf, sendcnt, sdispls, MPIType<OVT>(), recvnumbuf, recvcnt, rdispls, MPIType<OVT>(), RowWorld);
+		SpParHelper::Alltoallv(sendindbuf, sendcnt, sdispls, recvindbuf, recvcnt, rdispls, RowWorld);
+		SpParHelper::Alltoallv(sendnumbuf, sendcnt, sdispls, recvnumbuf, recvcnt, rdispls, RowWorld);
 		DeleteAll(sendindbuf, sendnumbuf, sendcnt, sdispls);
 	}
 #ifdef TIMING
@@ -2017,6 +2060,7 @@ void SpMV (const SpParMat<IU,NUM,UDER> & A, const FullyDistSpVec<IU,IVT> & x, Fu
 #endif
     //MergeContributions<SR>(y,recvcnt, rdispls, recvindbuf, recvnumbuf, rowneighs);
     // free memory of y, in case it was aliased
+    y.ClearDense();
     std::vector<IU>().swap(y.ind);
     std::vector<OVT>().swap(y.num);
     
@@ -2031,11 +2075,24 @@ void SpMV (const SpParMat<IU,NUM,UDER> & A, const FullyDistSpVec<IU,IVT> & x, Fu
         indsvec[i] = recvindbuf+rdispls[i];
         numsvec[i] = recvnumbuf+rdispls[i];
     }
+    IU ylocsize = y.MyLocLength();
+    if(y.densethreshold <= 1.0 && totrecv >= y.densethreshold * ylocsize)
+    {
+        // contributions alone already reach the dense threshold: accumulate into
+        // bitmap + dense values directly and skip the k-way merge
+        y.dnnz = MergeContributionsDense<SR>(recvcnt, indsvec, numsvec, y.bmap, y.dnum, ylocsize);
+        y.dense = true;
+        y.AutoFormat();
+    }
+    else
+    {
 #ifdef THREADED
-    MergeContributions_threaded<SR>(recvcnt, indsvec, numsvec, y.ind, y.num, y.MyLocLength());
+        MergeContributions_threaded<SR>(recvcnt, indsvec, numsvec, y.ind, y.num, ylocsize);
 #else
-    MergeContributions<SR>(recvcnt, indsvec, numsvec, y.ind, y.num);
+        MergeContributions<SR>(recvcnt, indsvec, numsvec, y.ind, y.num);
 #endif
+        y.AutoFormat();
+    }
     
     DeleteAll(recvcnt, rdispls,recvindbuf, recvnumbuf);
 #ifdef TIMING
@@ -2172,6 +2229,7 @@ FullyDistSpVec<IU,typename promote_trait<NUM,NUV>::T_promote>  SpMV
 {
 	typedef typename promote_trait<NUM,NUV>::T_promote T_promote;
 	CheckSpMVCompliance(A, x);
+	x.ToList();
 
 	MPI_Comm World = x.commGrid->GetWorld();
 	MPI_Comm ColWorld = x.commGrid->GetColWorld();
@@ -2272,8 +2330,8 @@ FullyDistSpVec<IU,typename promote_trait<NUM,NUV>::T_promote>  SpMV
     std::copy(sendnum[i].begin(), sendnum[i].end(), sendnumbuf+sdispls[i]);
 		std::vector<T_promote>().swap(sendnum[i]);
 	}
-	MPI_Alltoallv(sendindbuf, sendcnt, sdispls, MPIType<IU>(), recvindbuf, recvcnt, rdispls, MPIType<IU>(), RowWorld);
-	MPI_Alltoallv(sendnumbuf, sendcnt, sdispls, MPIType<T_promote>(), recvnumbuf, recvcnt, rdispls, MPIType<T_promote>(), RowWorld);
+	SpParHelper::Alltoallv(sendindbuf, sendcnt, sdispls, recvindbuf, recvcnt, rdispls, RowWorld);
+	SpParHelper::Alltoallv(sendnumbuf, sendcnt, sdispls, recvnumbuf, recvcnt, rdispls, RowWorld);
 	
 	DeleteAll(sendindbuf, sendnumbuf);
 	DeleteAll(sendcnt, recvcnt, sdispls, rdispls);
@@ -2399,6 +2457,7 @@ FullyDistSpVec<IU,typename promote_trait<NU1,NU2>::T_promote> EWiseMult
 		}
 		else
 		{
+			V.ToList();
 			Product.glen = V.glen;
 			IU size= V.getlocnnz();
 			if(exclude)
@@ -2521,7 +2580,43 @@ FullyDistSpVec<IU,RET> EWiseApply_threaded
                 IU tStartIdx = perthread * curthread;
                 IU tNextIdx = perthread * (curthread+1);
                 
-                if (allowVNulls)
+                if (V.dense)    // bitmap scan over this thread's share of the words
+                {
+                    IU nwords = V.bmap.size();
+                    IU wbeg = (nwords * curthread) / nthreads;
+                    IU wend = (nwords * (curthread+1)) / nthreads;
+                    for(IU w = wbeg; w < wend; ++w)
+                    {
+                        uint64_t word = V.bmap[w];
+                        if (allowVNulls)
+                        {
+                            IU wlast = std::min(w*64 + 64, size);
+                            for(IU tIdx = w*64; tIdx < wlast; ++tIdx)
+                            {
+                                bool present = (word >> (tIdx - w*64)) & 1;
+                                const NU1 & vval = present? V.dnum[tIdx] : Vzero;
+                                if (_doOp(vval, W.arr[tIdx], !present, false))
+                                {
+                                    tProductInd[curthread].push_back(tIdx);
+                                    tProductVal[curthread].push_back (_binary_op(vval, W.arr[tIdx], !present, false));
+                                }
+                            }
+                        }
+                        else
+                        {
+                            for(; word; word &= (word - 1))
+                            {
+                                IU tIdx = w*64 + V.LowestBit(word);
+                                if (_doOp(V.dnum[tIdx], W.arr[tIdx], false, false))
+                                {
+                                    tProductInd[curthread].push_back(tIdx);
+                                    tProductVal[curthread].push_back (_binary_op(V.dnum[tIdx], W.arr[tIdx], false, false));
+                                }
+                            }
+                        }
+                    }
+                }
+                else if (allowVNulls)
                 {
                     if(curthread == nthreads-1) tNextIdx = size;
                     
@@ -2588,6 +2683,8 @@ FullyDistSpVec<IU,RET> EWiseApply_threaded
                 std::copy(tProductInd[curthread].begin(), tProductInd[curthread].end(), Product.ind.data() + tdisp[curthread]);
                 std::copy(tProductVal[curthread].begin() , tProductVal[curthread].end(), Product.num.data() + tdisp[curthread]);
             }
+            Product.densethreshold = V.densethreshold;
+            Product.AutoFormat();
 		}
 		return Product;
 	}
@@ -2641,6 +2738,7 @@ FullyDistSpVec<IU,RET> EWiseApply
         }
         else
         {
+            V.ToList();
             Product.glen = V.glen;
             IU size= W.LocArrSize();
             IU spsize = V.getlocnnz();
@@ -2737,6 +2835,8 @@ FullyDistSpVec<IU,RET> EWiseApply
 		}
 		else
 		{
+			V.ToList();
+			W.ToList();
 			Product.glen = V.glen;
 			typename std::vector< IU  >::const_iterator indV = V.ind.begin();
 			typename std::vector< NU1 >::const_iterator numV = V.num.begin();
@@ -3060,6 +3160,7 @@ EstPerProcessNnzSpMV(
 
 template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDER1, typename UDER2>
 SpParMat3D<IU,NUO,UDERO> Mult_AnXBn_SUMMA3D(SpParMat3D<IU,NU1,UDER1> & A, SpParMat3D<IU,NU2,UDER2> & B){
+    MemoryTracker::Scope scope(MEM_SPGEMM);
     int myrank;
     MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
     typedef typename UDERO::LocalIT LIC;
@@ -3291,7 +3392,7 @@ SpParMat3D<IU,NUO,UDERO> Mult_AnXBn_SUMMA3D(SpParMat3D<IU,NU1,UDER1> & A, SpParM
     for(int i = 0; i < A.getcommgrid3D()->GetGridLayers(); i++) recvcnt[i] = recvprfl[i*3];
     std::partial_sum(recvcnt, recvcnt+A.getcommgrid3D()->GetGridLayers()-1, rdispls+1);
     IU totrecv = std::accumulate(recvcnt,recvcnt+A.getcommgrid3D()->GetGridLayers(), static_cast<IU>(0));
-    std::tuple<LIC,LIC,NUO>* recvTuples = static_cast<std::tuple<LIC,LIC,NUO>*> (::operator new (sizeof(std::tuple<LIC,LIC,NUO>[totrecv])));
+    std::tuple<LIC,LIC,NUO>* recvTuples = static_cast<std::tuple<LIC,LIC,NUO>*> (Arena::Allocate(sizeof(std::tuple<LIC,LIC,NUO>) * totrecv));
 
 #ifdef TIMING
     t2 = MPI_Wtime();
@@ -3339,7 +3440,7 @@ SpParMat3D<IU,NUO,UDERO> Mult_AnXBn_SUMMA3D(SpParMat3D<IU,NU1,UDER1> & A, SpParM
 
     // Do not delete elements of recvChunks, because that would give segmentation fault due to double free
     //delete [] recvTuples;
-    ::operator delete(recvTuples);
+    Arena::Deallocate(recvTuples);
     for(int i = 0; i < recvChunks.size(); i++){
         recvChunks[i]->tuples_deleted = true; // Temporary patch to avoid memory leak and segfault
         delete recvChunks[i];
@@ -3363,6 +3464,7 @@ SpParMat3D<IU,NUO,UDERO> Mult_AnXBn_SUMMA3D(SpParMat3D<IU,NU1,UDER1> & A, SpParM
 template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB>
 SpParMat3D<IU, NUO, UDERO> MemEfficientSpGEMM3D(SpParMat3D<IU, NU1, UDERA> & A, SpParMat3D<IU, NU2, UDERB> & B,
            int phases, NUO hardThreshold, IU selectNum, IU recoverNum, NUO recoverPct, int kselectVersion, int64_t perProcessMemory){
+    MemoryTracker::Scope scope(MEM_SPGEMM);
     int myrank;
     MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
     typedef typename UDERA::LocalIT LIA;
@@ -3393,10 +3495,11 @@ SpParMat3D<IU, NUO, UDERO> MemEfficientSpGEMM3D(SpParMat3D<IU, NU1, UDERA> & A,
     t0 = MPI_Wtime();
 #endif
     /* 
-     * If per process memory is provided then calculate number of phases 
+     * If per process memory is provided (or a budget is set with MemoryTracker) then calculate number of phases 
      * Otherwise, proceed to multiplication.
      * */
-    if(perProcessMemory > 0) {
+    int64_t memoryBudget = (perProcessMemory > 0)? perProcessMemory*1000000000 : MemoryTracker::Budget();
+    if(memoryBudget > 0) {
         int p, calculatedPhases;
         MPI_Comm_size(A.getcommgrid3D()->GetLayerWorld(),&p);
         int64_t perNNZMem_in = sizeof(IU)*2 + sizeof(NU1);
@@ -3425,7 +3528,7 @@ SpParMat3D<IU, NUO, UDERO> MemEfficientSpGEMM3D(SpParMat3D<IU, NU1, UDERA> & A,
         //estimate output memory
         int64_t postKselectOutputNNZ = ceil(( (B.GetLayerMat()->getlocalcols() / B.getcommgrid3D()->GetGridLayers() ) * k)/sqrt(p)); // If kselect is run
         int64_t postKselectOutputMem = postKselectOutputNNZ * perNNZMem_out * 2;
-        double remainingMem = perProcessMemory*1000000000 - ginputMem - postKselectOutputMem;
+        double remainingMem = memoryBudget - ginputMem - postKselectOutputMem;
         int64_t kselectMem = B.GetLayerMat()->getlocalcols() * k * sizeof(NUO) * 3;
 
         //inputMem + outputMem + asquareMem/phases + kselectmem/phases < memory
@@ -3741,7 +3844,7 @@ SpParMat3D<IU, NUO, UDERO> MemEfficientSpGEMM3D(SpParMat3D<IU, NU1, UDERA> & A,
         for(int i = 0; i < A.getcommgrid3D()->GetGridLayers(); i++) recvcnt[i] = recvprfl[i*3];
         std::partial_sum(recvcnt, recvcnt+A.getcommgrid3D()->GetGridLayers()-1, rdispls+1);
         IU totrecv = std::accumulate(recvcnt,recvcnt+A.getcommgrid3D()->GetGridLayers(), static_cast<IU>(0));
-        std::tuple<LIC,LIC,NUO>* recvTuples = static_cast<std::tuple<LIC,LIC,NUO>*> (::operator new (sizeof(std::tuple<LIC,LIC,NUO>[totrecv])));
+        std::tuple<LIC,LIC,NUO>* recvTuples = static_cast<std::tuple<LIC,LIC,NUO>*> (Arena::Allocate(sizeof(std::tuple<LIC,LIC,NUO>) * totrecv));
 #ifdef TIMING
         t3 = MPI_Wtime();
         if(myrank == 0) fprintf(stderr, "[MemEfficientSpGEMM3D]\tPhase: %d\tAllocation of receive data: %lf\n", p, (t3-t2));
@@ -3811,7 +3914,7 @@ SpParMat3D<IU, NUO, UDERO> MemEfficientSpGEMM3D(SpParMat3D<IU, NU1, UDERA> & A,
         t0 = MPI_Wtime();
 #endif
         // Do not delete elements of recvChunks, because that would give segmentation fault due to double free
-        ::operator delete(recvTuples);
+        Arena::Deallocate(recvTuples);
         for(int i = 0; i < recvChunks.size(); i++){
             recvChunks[i]->tuples_deleted = true; // Temporary patch to avoid memory leak and segfault
             delete recvChunks[i]; // As the patch is used, now delete each element of recvChunks
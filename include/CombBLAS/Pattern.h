@@ -27,59 +27,43 @@
  */
 
 
-#ifndef _MEMORY_POOL_H
-#define _MEMORY_POOL_H
+#ifndef _PATTERN_H_
+#define _PATTERN_H_
 
-#include <iostream>
-#include <list>
-#include <new>			// For "placement new" (classes using this memory pool may need it)
-#include <fstream>
+#include <cstddef>
+#include <type_traits>
+#include "Arena.h"
 
 namespace combblas {
 
-//! EqualityComparable memory chunk object
-//! Two memory chunks are considered equal if either their beginaddr or the endaddr are the same (just to facilitate deallocation)
-class Memory
-{
-	public:
-	Memory(char * m_beg, size_t m_size): begin(m_beg),size(m_size)
-	{};
-	
-	char * begaddr() { return begin; }
-	char * endaddr() { return begin + size; }
-
-	bool operator < (const Memory & rhs) const
-	{ return (begin < rhs.begin); }
-	bool operator == (const Memory & rhs) const
-	{ return (begin == rhs.begin); }
-	
-	char * begin;
-	size_t size;
-};
-
-
 /**
-  * \invariant Available memory addresses will be sorted w.r.t. their starting positions
-  * \invariant At least one element exists in the freelist at any time.
-  * \invariant Defragment on the fly: at any time, NO two consecutive chunks with chunk1.endaddr equals chunk2.begaddr exist
-  */ 
-class MemoryPool
+ * Value type of pattern matrices, such as SpParMat<int64_t, Pattern, SpDCCols<int64_t, Pattern> >: every nonzero is true
+ * Pattern matrices are opt-in (boolean matrices keep their values, explicit false entries included). Their local
+ * matrices do not allocate value arrays (see pattern_trait), so the values are neither stored, nor sent, nor written
+ * Copies are user-provided no-ops, so std::copy of pattern "arrays" loops over nothing instead of calling memmove
+ */
+struct Pattern
 {
-public:
-	MemoryPool(void * m_beg, size_t m_size);
-
-	void * alloc(size_t size);
-	void dealloc (void * base, size_t size);
-
-	friend std::ofstream& operator<< (std::ofstream& outfile, const MemoryPool & mpool);	
-
-private:
-	// std::list is a doubly linked list (i.e., a Sequence that supports both forward and backward traversal)
-	std::list<Memory> freelist;
-	char * initbeg;
-	char * initend; 
+	Pattern() {}
+	template <typename T>
+	Pattern(const T &) {}	//!< converting a matrix to a pattern keeps its structure only
+	Pattern(const Pattern &) {}
+	Pattern & operator=(const Pattern &) { return *this; }
+	operator bool() const { return true; }
+	bool operator==(const Pattern &) const { return true; }
+	bool operator!=(const Pattern &) const { return false; }
+	bool operator<(const Pattern &) const { return false; }
 };
 
+//! Whether arrays of NT values are not allocated
+template <typename NT>
+struct is_pattern : std::is_same<NT, Pattern> {};
+
+//! Value array of a Dcsc (ArenaNew) or of a Csc (new []), NULL for patterns
+template <typename NT>
+inline NT * ArenaNewValues(size_t n) { return is_pattern<NT>::value ? NULL : ArenaNew<NT>(n); }
+template <typename NT>
+inline NT * NewValues(size_t n) { return is_pattern<NT>::value ? NULL : new NT[n]; }
 
 }
 
@@ -45,7 +45,7 @@ public:
     PreAllocatedSPA():initialized(false) {};   // hide default constructor
 
     template <class LMAT>
-    PreAllocatedSPA(LMAT & A):initialized(true)  // the one and only constructor
+    PreAllocatedSPA(const LMAT & A):initialized(true)  // the one and only constructor
 	{
         int64_t mA = A.getnrow();
         if( A.getnsplit() > 0)  // multithreaded
@@ -112,7 +112,7 @@ public:
     // for manual splitting. just a hack. need to be fixed
     
     template <class LMAT>
-    PreAllocatedSPA(LMAT & A, int splits):initialized(true)
+    PreAllocatedSPA(const LMAT & A, int splits):initialized(true)
     {
         buckets = splits;
         int64_t mA = A.getnrow();
@@ -224,6 +224,24 @@ public:
              		scramble(base_tgt, lgN, val0, val1));
 	}
 
+	/* Make a single edge of a Kronecker graph with an arbitrary initiator, using a pre-set MRG state: each level
+	 * picks one of the four quadrants with probabilities initiator[0..3] (there is no clip-and-flip, so the graph is directed) */
+	static inline void make_kronecker_edge(int lgN, mrg_state* st, const double initiator[4], int64_t & src, int64_t & tgt)
+	{
+		src = 0;
+		tgt = 0;
+		for(int level = 0; level < lgN; ++level)
+		{
+			double r = mrg_get_double_orig(st);
+			int square = 3;
+			if(r < initiator[0])	square = 0;
+			else if(r < initiator[0] + initiator[1])	square = 1;
+			else if(r < initiator[0] + initiator[1] + initiator[2])	square = 2;
+			src = 2*src + square / 2;
+			tgt = 2*tgt + square % 2;
+		}
+	}
+
 	static inline mrg_state MakeScrambleValues(uint64_t & val0, uint64_t & val1, const uint_fast32_t seed[])
 	{
 		mrg_state state;
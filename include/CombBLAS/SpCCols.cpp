@@ -411,23 +411,25 @@ SpCCols<IT, NT>::CreateImpl (IT size,
 
 
 
+// A pattern matrix has no values to communicate
 template <class IT, class NT>
 Arr<IT, NT>
 SpCCols<IT, NT>::GetArrays (void) const
 {
-	Arr<IT, NT> arr(2, 1);
+	bool pattern = pattern_trait< SpCCols<IT, NT> >::value;
+	Arr<IT, NT> arr(2, pattern ? 0 : 1);
 
 	if (nnz > 0)
 	{
 		arr.indarrs[0] = LocArr<IT, IT>(csc->jc, csc->n + 1);
 		arr.indarrs[1] = LocArr<IT, IT>(csc->ir, csc->nz);
-		arr.numarrs[0] = LocArr<NT, IT>(csc->num, csc->nz);
+		if (!pattern) arr.numarrs[0] = LocArr<NT, IT>(csc->num, csc->nz);
 	}
 	else
 	{
 		arr.indarrs[0] = LocArr<IT, IT>(NULL, 0);
 		arr.indarrs[1] = LocArr<IT, IT>(NULL, 0);
-		arr.numarrs[0] = LocArr<NT, IT>(NULL, 0);
+		if (!pattern) arr.numarrs[0] = LocArr<NT, IT>(NULL, 0);
 	}
 
 	return arr;
@@ -63,6 +63,7 @@ public:
     SpCCols<IT,NT> & operator+= (const SpCCols<IT, NT> & rhs);
 
     void RowSplit(int numsplits);
+    void ChooseLayout() {}	//!< Csc has a single layout (see SpDCCols::ChooseLayout)
     void ColSplit(int parts, std::vector< SpCCols<IT,NT> > & matrices); //!< \attention Destroys calling object (*this)
     
     void CreateImpl(const std::vector<IT> & essentials);
@@ -159,14 +160,14 @@ public:
         IT * curcptr;
    	};
     
-    SpColIter begcol()  // serial version
+    SpColIter begcol() const  // serial version
     {
         if( nnz > 0 )
             return SpColIter(csc->jc);
         else
             return SpColIter(NULL);
     }
-    SpColIter endcol()  //serial version
+    SpColIter endcol() const  //serial version
     {
         if( nnz > 0 )
             return SpColIter(csc->jc + n);  // (csc->jc+n) should never execute because SpColIter::colptrnext() would point invalid
@@ -174,14 +175,14 @@ public:
             return SpColIter(NULL);
     }
 
-    SpColIter begcol(int i)  // multithreaded version
+    SpColIter begcol(int i) const  // multithreaded version
     {
         if( cscarr[i] )
             return SpColIter(cscarr[i]->jc);
         else
             return SpColIter(NULL);
     }
-    SpColIter endcol(int i)  //multithreaded version
+    SpColIter endcol(int i) const  //multithreaded version
     {
         if( cscarr[i] )
             return SpColIter(cscarr[i]->jc + n);  // (csc->jc+n) should never execute because SpColIter::colptrnext() would point invalid
@@ -190,22 +191,22 @@ public:
     }
 
 
-    typename SpColIter::NzIter begnz(const SpColIter & ccol)	//!< Return the beginning iterator for the nonzeros of the current column
+    typename SpColIter::NzIter begnz(const SpColIter & ccol) const	//!< Return the beginning iterator for the nonzeros of the current column
     {
         return typename SpColIter::NzIter( csc->ir + ccol.colptr(), csc->num + ccol.colptr() );
     }
     
-    typename SpColIter::NzIter endnz(const SpColIter & ccol)	//!< Return the ending iterator for the nonzeros of the current column
+    typename SpColIter::NzIter endnz(const SpColIter & ccol) const	//!< Return the ending iterator for the nonzeros of the current column
     {
         return typename SpColIter::NzIter( csc->ir + ccol.colptrnext(), NULL );
     }
     
-    typename SpColIter::NzIter begnz(const SpColIter & ccol, int i)	//!< multithreaded version
+    typename SpColIter::NzIter begnz(const SpColIter & ccol, int i) const	//!< multithreaded version
     {
         return typename SpColIter::NzIter( cscarr[i]->ir + ccol.colptr(), cscarr[i]->num + ccol.colptr() );
     }
     
-    typename SpColIter::NzIter endnz(const SpColIter & ccol, int i)	//!< multithreaded version
+    typename SpColIter::NzIter endnz(const SpColIter & ccol, int i) const	//!< multithreaded version
     {
         return typename SpColIter::NzIter( cscarr[i]->ir + ccol.colptrnext(), NULL );
     }
@@ -334,6 +335,12 @@ struct create_trait< SpCCols<OIT, ONT> , NIT, NNT >
     typedef SpCCols<NIT,NNT> T_inferred;
 };
 
+template <class IT>
+struct pattern_trait< SpCCols<IT, Pattern> >
+{
+	static const bool value = true;
+};
+
 }
 
 #include "SpCCols.cpp"
@@ -99,6 +99,15 @@ SpDCCols<IT,NT>::SpDCCols(const SpDCCols<IT,NT> & rhs)
 	}
 }
 
+template <class IT, class NT>
+SpDCCols<IT,NT>::SpDCCols(SpDCCols<IT,NT> && rhs)
+: dcsc(rhs.dcsc), m(rhs.m), n(rhs.n), nnz(rhs.nnz), splits(rhs.splits)
+{
+	rhs.dcsc = NULL;	// also clears dcscarr
+	rhs.nnz = 0;
+	rhs.splits = 0;
+}
+
 /** 
  * Constructor for converting SpTuples matrix -> SpDCCols (may use a private memory heap)
  * @param[in] 	rhs if transpose=true, 
@@ -180,6 +189,7 @@ SpDCCols<IT,NT>::SpDCCols(const SpTuples<IT, NT> & rhs, bool transpose)
 			}		
 			dcsc->cp[jspos] = rhs.nnz;
 		}
+		ChooseLayout();
 	} 
 }
 
@@ -298,6 +308,7 @@ SpDCCols<IT,NT>::SpDCCols(IT nRow, IT nCol, IT nTuples, const std::tuple<IT, IT,
             dcsc->ir[i]  = std::get<0>(tuples[i]);
             dcsc->numx[i] = std::get<2>(tuples[i]);
         }
+        if(!transpose) ChooseLayout();
      }
     
     if(transpose) Transpose(); // this is not efficient, think to improve later. We included this parameter anyway to make this constructor different from another constracttor when the fourth argument is passed as 0.
@@ -392,6 +403,13 @@ SpDCCols<IT,NT> & SpDCCols<IT,NT>::operator=(const SpDCCols<IT,NT> & rhs)
 
 template <class IT, class NT>
 SpDCCols<IT,NT> & SpDCCols<IT,NT>::operator+= (const SpDCCols<IT,NT> & rhs)
+{
+	return AddAndAssign(rhs, std::plus<NT>());
+}
+
+template <class IT, class NT>
+template <typename _BinaryOperation>
+SpDCCols<IT,NT> & SpDCCols<IT,NT>::AddAndAssign (const SpDCCols<IT,NT> & rhs, _BinaryOperation __binary_op)
 {
 	// this pointer stores the address of the class instance
 	// check for self assignment using address comparison
@@ -410,8 +428,9 @@ SpDCCols<IT,NT> & SpDCCols<IT,NT>::operator+= (const SpDCCols<IT,NT> & rhs)
 			}
 			else
 			{
-				(*dcsc) += (*(rhs.dcsc));
+				dcsc->AddAndAssign(*(rhs.dcsc), __binary_op);
 				nnz = dcsc->nz;
+				if(!dcsc->IsCSC())	dcsc->ChooseColumnLayout(n);	// the union may be dense enough now
 			}		
 		}
 		else
@@ -783,38 +802,50 @@ SpDCCols<IT,NT>::operator SpDCCols<NIT,NNT> () const
 }
 
 
+/**
+ * Arrays to be communicated, i.e. everything but the (nonexistent) values of a pattern matrix
+ */
 template <class IT, class NT>
 Arr<IT,NT> SpDCCols<IT,NT>::GetArrays() const
 {
-	Arr<IT,NT> arr(3,1);
+	bool pattern = pattern_trait< SpDCCols<IT,NT> >::value;
+	Arr<IT,NT> arr(3, pattern? 0 : 1);
 
 	if(nnz > 0)
 	{
 		arr.indarrs[0] = LocArr<IT,IT>(dcsc->cp, dcsc->nzc+1);
 		arr.indarrs[1] = LocArr<IT,IT>(dcsc->jc, dcsc->nzc);
 		arr.indarrs[2] = LocArr<IT,IT>(dcsc->ir, dcsc->nz);
-		arr.numarrs[0] = LocArr<NT,IT>(dcsc->numx, dcsc->nz);
+		if(!pattern) arr.numarrs[0] = LocArr<NT,IT>(dcsc->numx, dcsc->nz);
 	}
 	else
 	{
 		arr.indarrs[0] = LocArr<IT,IT>(NULL, 0);
 		arr.indarrs[1] = LocArr<IT,IT>(NULL, 0);
 		arr.indarrs[2] = LocArr<IT,IT>(NULL, 0);
-		arr.numarrs[0] = LocArr<NT,IT>(NULL, 0);
+		if(!pattern) arr.numarrs[0] = LocArr<NT,IT>(NULL, 0);
 	
 	}
 	return arr;
 }
 
 /**
-  * O(nnz log(nnz)) time Transpose function
-  * \remarks Performs a lexicographical sort
+  * O(nnz + m) time Transpose function (threaded counting sort on rows), unless the matrix is hypersparse
+  * (m > nnz), in which case it is O(nnz log(nnz)) and performs a lexicographical sort
   * \remarks Mutator function (replaces the calling object with its transpose)
   */
 template <class IT, class NT>
 void SpDCCols<IT,NT>::Transpose()
 {
-	if(nnz > 0)
+	if(nnz > 0 && splits == 0 && m <= nnz)
+	{
+		Dcsc<IT,NT> * trans = dcsc->Transpose(m);
+		delete dcsc;
+		dcsc = trans;
+		std::swap(m, n);
+		ChooseLayout();
+	}
+	else if(nnz > 0)
 	{
 		SpTuples<IT,NT> Atuples(*this);
 		Atuples.SortRowBased();
@@ -830,13 +861,15 @@ void SpDCCols<IT,NT>::Transpose()
 
 
 /**
-  * O(nnz log(nnz)) time Transpose function
-  * \remarks Performs a lexicographical sort
+  * O(nnz + m) time Transpose function, O(nnz log(nnz)) if hypersparse (see Transpose())
   * \remarks Const function (doesn't mutate the calling object)
   */
 template <class IT, class NT>
 SpDCCols<IT,NT> SpDCCols<IT,NT>::TransposeConst() const
 {
+	if(nnz > 0 && splits == 0 && m <= nnz)
+		return SpDCCols<IT,NT>(n, m, dcsc->Transpose(m));
+
 	SpTuples<IT,NT> Atuples(*this);
 	Atuples.SortRowBased();
 
@@ -844,13 +877,15 @@ SpDCCols<IT,NT> SpDCCols<IT,NT>::TransposeConst() const
 }
 
 /**
- * O(nnz log(nnz)) time Transpose function
- * \remarks Performs a lexicographical sort
+ * O(nnz + m) time Transpose function, O(nnz log(nnz)) if hypersparse (see Transpose())
  * \remarks Const function (doesn't mutate the calling object)
  */
 template <class IT, class NT>
 SpDCCols<IT,NT> * SpDCCols<IT,NT>::TransposeConstPtr() const
 {
+	if(nnz > 0 && splits == 0 && m <= nnz)
+		return new SpDCCols<IT,NT>(n, m, dcsc->Transpose(m));
+
 	SpTuples<IT,NT> Atuples(*this);
 	Atuples.SortRowBased();
 	
@@ -1464,7 +1499,10 @@ SpDCCols<IT,NT>::SpDCCols(IT nRow, IT nCol, Dcsc<IT,NT> * mydcsc)
 	if (mydcsc == NULL) 
 		nnz = 0;
 	else
+	{
 		nnz = mydcsc->nz;
+		ChooseLayout();
+	}
 }
 
 //! Create a logical matrix from (row/column) indices array, used for indexing only
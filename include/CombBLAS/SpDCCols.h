@@ -39,7 +39,7 @@
 #include "dcsc.h"
 #include "Isect.h"
 #include "Semirings.h"
-#include "MemoryPool.h"
+#include "Arena.h"
 #include "LocArr.h"
 #include "Friends.h"
 #include "CombBLAS.h"
@@ -61,6 +61,7 @@ public:
     SpDCCols (IT nRow, IT nCol, IT nnz1, const std::tuple<IT, IT, NT> * rhs, bool transpose);
 
 	SpDCCols (const SpDCCols<IT,NT> & rhs);					// Actual copy constructor		
+	SpDCCols (SpDCCols<IT,NT> && rhs);					// Move constructor, rhs is left empty
 	~SpDCCols();
 
 	template <typename NNT> operator SpDCCols<IT,NNT> () const;		//!< NNT: New numeric type
@@ -69,6 +70,8 @@ public:
 	// Member Functions and Operators: 
 	SpDCCols<IT,NT> & operator= (const SpDCCols<IT, NT> & rhs);
 	SpDCCols<IT,NT> & operator+= (const SpDCCols<IT, NT> & rhs);
+	template <typename _BinaryOperation>
+	SpDCCols<IT,NT> & AddAndAssign (const SpDCCols<IT, NT> & rhs, _BinaryOperation __binary_op);	//!< operator+= where coinciding entries are combined with __binary_op
 	SpDCCols<IT,NT> operator() (IT ri, IT ci) const;	
 	SpDCCols<IT,NT> operator() (const std::vector<IT> & ri, const std::vector<IT> & ci) const;
 	bool operator== (const SpDCCols<IT, NT> & rhs) const
@@ -194,14 +197,14 @@ public:
 		IT * cid;
    	};
 	
-	SpColIter begcol()
+	SpColIter begcol() const
 	{
 		if( nnz > 0 )
 			return SpColIter(dcsc->cp, dcsc->jc); 
 		else	
 			return SpColIter(NULL, NULL);
 	}
-    SpColIter begcol(int i)  // multithreaded version
+    SpColIter begcol(int i) const  // multithreaded version
     {
         if( dcscarr[i] )
             return SpColIter(dcscarr[i]->cp, dcscarr[i]->jc);
@@ -209,7 +212,7 @@ public:
             return SpColIter(NULL, NULL);
     }
 
-	SpColIter endcol()
+	SpColIter endcol() const
 	{
 		if( nnz > 0 )
 			return SpColIter(dcsc->cp + dcsc->nzc, NULL);
@@ -217,7 +220,7 @@ public:
 			return SpColIter(NULL, NULL);
 	}
     
-    SpColIter endcol(int i)  //multithreaded version
+    SpColIter endcol(int i) const  //multithreaded version
     {
         if( dcscarr[i] )
             return SpColIter(dcscarr[i]->cp + dcscarr[i]->nzc, NULL);
@@ -225,22 +228,22 @@ public:
             return SpColIter(NULL, NULL);
     }
 
-	typename SpColIter::NzIter begnz(const SpColIter & ccol)	//!< Return the beginning iterator for the nonzeros of the current column
+	typename SpColIter::NzIter begnz(const SpColIter & ccol) const	//!< Return the beginning iterator for the nonzeros of the current column
 	{
 		return typename SpColIter::NzIter( dcsc->ir + ccol.colptr(), dcsc->numx + ccol.colptr() );
 	}
 
-	typename SpColIter::NzIter endnz(const SpColIter & ccol)	//!< Return the ending iterator for the nonzeros of the current column
+	typename SpColIter::NzIter endnz(const SpColIter & ccol) const	//!< Return the ending iterator for the nonzeros of the current column
 	{
 		return typename SpColIter::NzIter( dcsc->ir + ccol.colptrnext(), NULL );
 	}			
 
-    typename SpColIter::NzIter begnz(const SpColIter & ccol, int i)	//!< multithreaded version
+    typename SpColIter::NzIter begnz(const SpColIter & ccol, int i) const	//!< multithreaded version
     {
         return typename SpColIter::NzIter( dcscarr[i]->ir + ccol.colptr(), dcscarr[i]->numx + ccol.colptr() );
     }
     
-    typename SpColIter::NzIter endnz(const SpColIter & ccol, int i)	//!< multithreaded version
+    typename SpColIter::NzIter endnz(const SpColIter & ccol, int i) const	//!< multithreaded version
     {
         return typename SpColIter::NzIter( dcscarr[i]->ir + ccol.colptrnext(), NULL );
     }
@@ -275,6 +278,10 @@ public:
 	SpDCCols<IT,NT> TransposeConst() const;		//!< Const version, doesn't touch the existing object
 	SpDCCols<IT,NT> * TransposeConstPtr() const;
 
+	//! Picks the lookups of the kernels for the block: 16-bit row ids and CSC column layout (see Dcsc::NarrowRowIndices
+	//! and Dcsc::ChooseColumnLayout); the constructors and Transpose do this, as do the Dcsc members that change the block
+	void ChooseLayout() { if(dcsc != NULL) { dcsc->NarrowRowIndices(m); dcsc->ChooseColumnLayout(n); } }
+
 	void RowSplit(int numsplits)
 	{
 		BooleanRowSplit(*this, numsplits);	// only works with boolean arrays
@@ -368,6 +375,9 @@ private:
 	template <class IU, class NU>
 	friend class SpTuples;
 
+	template <class IU, class NU, class UDER>
+	friend class SpParMat;		// builds local matrices straight from a Dcsc
+
 	// AL: removed this because it appears illegal and causes this compiler warning:
 	// warning: dependent nested name specifier 'SpDCCols<IU, NU>::' for friend class declaration is not supported; turning off access control for 'SpDCCols'
 	//template <class IU, class NU>
@@ -471,6 +481,12 @@ struct create_trait< SpDCCols<OIT, ONT> , NIT, NNT >
      typedef SpDCCols<NIT,NNT> T_inferred;
 };
 
+template <class IT>
+struct pattern_trait< SpDCCols<IT, Pattern> >
+{
+	static const bool value = true;
+};
+
 }
 
 #include "SpDCCols.cpp"
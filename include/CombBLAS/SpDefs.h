@@ -75,6 +75,8 @@ namespace combblas {
 #define NOFILE 3004
 #define MATRIXALIAS 3005
 #define UNKNOWNMPITYPE 3006
+#define MEMORYBUDGET 3007
+#define PARSEERROR 3008
 
 // Enable bebug prints
 //#define SPREFDEBUG
@@ -108,6 +110,8 @@ namespace combblas {
 #define ROTATE 140
 #define PUPSIZE 141
 #define PUPDATA 142
+#define A2AKWAY 143
+#define A2ASPARSE 144
 
 enum Dim
 {
@@ -125,6 +129,66 @@ Row
 #define THRESHOLD 4	// if range1.size() / range2.size() < threshold, use scanning based indexing
 #endif
 
+#ifndef SPVEC_DENSE_THRESHOLD
+#define SPVEC_DENSE_THRESHOLD 2.0	// local nnz/length above which a FullyDistSpVec switches to bitmap+dense storage (> 1 disables)
+#endif
+
+#ifndef AGGREGATOR_CACHE_ENTRIES
+#define AGGREGATOR_CACHE_ENTRIES 65536	// remote entries a DistVecAggregator keeps across flushes within an epoch
+#endif
+
+#ifndef RADIXSORT_MAX_IMBALANCE
+#define RADIXSORT_MAX_IMBALANCE 4	// RadixPSort falls back to psort if a processor would receive more than this many times its share
+#endif
+
+#ifndef ALLTOALLV_MIN_PROCS
+#define ALLTOALLV_MIN_PROCS 64	// SpParHelper::Alltoallv calls MPI_Alltoallv directly on smaller communicators (default of SetAlltoallvMinProcs)
+#endif
+
+#ifndef ALLTOALLV_MAX_AGGREGATED_MSG
+#define ALLTOALLV_MAX_AGGREGATED_MSG 4096	// average message (bytes) above which aggregation does not pay off and MPI_Alltoallv is used
+#endif
+
+#ifndef ALLTOALLV_KWAY
+#define ALLTOALLV_KWAY 2	// radix of the hypercube exchange; must be a power of two (larger k: less volume, more messages)
+#endif
+
+#ifndef ALLTOALLV_NODE_SIZE
+#define ALLTOALLV_NODE_SIZE 0	// processors per node for the hierarchical exchange (0: detect with MPI_Comm_split_type; default of SetAlltoallvNodeSize)
+#endif
+
+#ifndef NARROW_ROW_INDICES
+#define NARROW_ROW_INDICES 1	// local DCSC blocks with at most 65536 rows also keep 16-bit row ids for SpMV and SpGEMM (0 disables)
+#endif
+
+#ifndef CSC_COLUMN_DENSITY
+#define CSC_COLUMN_DENSITY 0.5	// fraction of nonempty columns above which a DCSC block also keeps a dense column pointer, i.e. is CSC (> 1 disables)
+#endif
+
+#ifndef MMREADCHUNK
+#define MMREADCHUNK (64 * 1048576)	// bytes of its range of a Matrix Market file that a process reads, then parses with all its threads, at a time
+#endif
+
+#ifndef EDGEBLOCKSIZE
+#define EDGEBLOCKSIZE 65536	// edges per block of a compressed edge list, the unit of parallel seeking and decoding
+#endif
+
+#ifndef ARENA_THREAD_CACHE_BYTES
+#define ARENA_THREAD_CACHE_BYTES (32 * 1048576)	// freed blocks a thread keeps for its own reuse (see Arena.h)
+#endif
+
+#ifndef ARENA_SHARED_CACHE_BYTES
+#define ARENA_SHARED_CACHE_BYTES (1024 * 1048576L)	// freed blocks kept for all threads before memory is returned to the system
+#endif
+
+#ifndef ARENA_HUGEPAGE_BYTES
+#define ARENA_HUGEPAGE_BYTES (2 * 1048576)	// blocks at least this large are mapped directly and advised to use huge pages
+#endif
+
+#ifndef MEMTRACK_BATCH_BYTES
+#define MEMTRACK_BATCH_BYTES 65536	// bytes of allocations a thread charges to an operation before posting them to the rank's counters
+#endif
+
 #ifndef MEMORYINBYTES
 #define MEMORYINBYTES  (196 * 1048576)	// 196 MB, it is advised to define MEMORYINBYTES to be "at most" (1/4)th of available memory per core
 #endif
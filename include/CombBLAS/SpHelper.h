@@ -33,9 +33,12 @@
 
 #include <vector>
 #include <limits>
+#include <cstdlib>
+#include <cstring>
 #include <map>
 #include <string>
 #include <utility>
+#include <algorithm>
 #include "SpDefs.h"
 #include "StackEntry.h"
 #include "promote.h"
@@ -90,59 +93,6 @@ public:
         }
     }
     
-    static void ProcessLinesWithStringKeys(std::vector< std::map < std::string, uint64_t> > & allkeys, std::vector<std::string> & lines, int nprocs)
-    {
-    	std::string frstr, tostr;
-    	uint64_t frhash, tohash;    
-    	double vv;
-    	for (auto itr=lines.begin(); itr != lines.end(); ++itr)
-    	{
-		char fr[MAXVERTNAME];
-		char to[MAXVERTNAME];
-		sscanf(itr->c_str(), "%s %s %lg", fr, to, &vv);
-		frstr = std::string(fr);
-		tostr = std::string(to);
-		MurmurHash3_x64_64(frstr.c_str(),frstr.size(),0,&frhash);
-		MurmurHash3_x64_64(tostr.c_str(),tostr.size(),0,&tohash);	
-
-		double range_fr = static_cast<double>(frhash) * static_cast<double>(nprocs);
-		double range_to = static_cast<double>(tohash) * static_cast<double>(nprocs);
-    		size_t owner_fr = range_fr / static_cast<double>(std::numeric_limits<uint64_t>::max());
-    		size_t owner_to = range_to / static_cast<double>(std::numeric_limits<uint64_t>::max());
-
-		// cout << frstr << " with hash " << frhash << " is going to " << owner_fr << endl;
-		// cout << tostr << " with hash " << tohash << " is going to " << owner_to << endl;
-
-		allkeys[owner_fr].insert(std::make_pair(frstr, frhash)); 
-		allkeys[owner_to].insert(std::make_pair(tostr, tohash));
-   	}
-        lines.clear();	
-    }
-
-    template <typename IT1, typename NT1>
-    static void ProcessStrLinesNPermute(std::vector<IT1> & rows, std::vector<IT1> & cols, std::vector<NT1> & vals, std::vector<std::string> & lines, std::map<std::string, uint64_t> & ultperm)
-    {
-	char * fr = new char[MAXVERTNAME];
-    	char * to = new char[MAXVERTNAME];
-    	std::string frstr, tostr;
-    	double vv;
-    	for (auto itr=lines.begin(); itr != lines.end(); ++itr)
-    	{
-		sscanf(itr->c_str(), "%s %s %lg", fr, to, &vv);
-		frstr = std::string(fr);
-		tostr = std::string(to);
-	
-		rows.emplace_back((IT1) ultperm[frstr]);
-		cols.emplace_back((IT1) ultperm[tostr]); 
-		vals.emplace_back((NT1) vv);
-   	}
-	delete [] fr;
-	delete [] to;
-        lines.clear();	
-    }
-
-
-
     template <typename IT1, typename NT1>
     static void ProcessLines(std::vector<IT1> & rows, std::vector<IT1> & cols, std::vector<NT1> & vals, std::vector<std::string> & lines, int symmetric, int type, bool onebased = true)
     {
@@ -182,6 +132,224 @@ public:
         lines.clear();
     }
 
+    //! Parses a (possibly signed) decimal integer after skipping blanks
+    //! @return the position after the integer, or NULL if there is none before end
+    static const char * ParseInteger(const char * p, const char * end, int64_t & v)
+    {
+        while(p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+        bool neg = false;
+        if(p < end && (*p == '-' || *p == '+'))
+        {
+            neg = (*p == '-');
+            ++p;
+        }
+        const char * first = p;
+        uint64_t u = 0;
+        while(p < end && static_cast<unsigned>(*p - '0') < 10)
+        {
+            u = u * 10 + static_cast<unsigned>(*p - '0');
+            ++p;
+        }
+        if(p == first) return NULL;
+        v = neg ? -static_cast<int64_t>(u) : static_cast<int64_t>(u);
+        return p;
+    }
+
+    //! Finds the next blank-separated token
+    //! @return the position after the token, or NULL if there is none before end
+    static const char * ParseToken(const char * p, const char * end, const char * & token, size_t & length)
+    {
+        while(p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+        token = p;
+        while(p < end && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') ++p;
+        length = p - token;
+        return (length > 0)? p : NULL;
+    }
+
+    /**
+     * Parses a real number after skipping blanks
+     * Decimals with at most 19 significant digits and a power of ten up to 10^22 are converted exactly by one
+     * multiplication or division; anything else (longer mantissas, large exponents, inf, nan) falls back to strtod,
+     * so the text must be terminated by a character that is not part of a number
+     * @return the position after the number, or NULL if there is none before end
+     **/
+    static const char * ParseReal(const char * p, const char * end, double & v)
+    {
+        static const double pow10[] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+                                        1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22 };
+        while(p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+        if(p == end || *p == '\n') return NULL;
+        const char * start = p;
+        bool neg = false;
+        if(*p == '-' || *p == '+')
+        {
+            neg = (*p == '-');
+            ++p;
+        }
+        uint64_t mant = 0;
+        int sig = 0;        // significant digits in mant
+        int exp10 = 0;
+        bool anydigits = false;
+        for(bool fraction = false; p < end; ++p)
+        {
+            if(static_cast<unsigned>(*p - '0') < 10)
+            {
+                if(mant || *p != '0') ++sig;
+                mant = mant * 10 + static_cast<unsigned>(*p - '0');
+                if(fraction) --exp10;
+                anydigits = true;
+            }
+            else if(*p == '.' && !fraction) fraction = true;
+            else break;
+        }
+        if(anydigits && p < end && (*p == 'e' || *p == 'E'))
+        {
+            const char * q = p + 1;
+            bool eneg = false;
+            if(q < end && (*q == '-' || *q == '+'))
+            {
+                eneg = (*q == '-');
+                ++q;
+            }
+            const char * efirst = q;
+            int e = 0;
+            for(; q < end && static_cast<unsigned>(*q - '0') < 10; ++q)
+                if(e < 10000) e = e * 10 + (*q - '0');
+            if(q == efirst) anydigits = false;  // malformed exponent: let strtod decide
+            else
+            {
+                exp10 += eneg ? -e : e;
+                p = q;
+            }
+        }
+        if(!anydigits || sig > 19 || mant > (static_cast<uint64_t>(1) << 53) || exp10 > 22 || exp10 < -22)
+        {
+            char * stop;
+            v = strtod(start, &stop);
+            return (stop == start) ? NULL : stop;
+        }
+        double d = static_cast<double>(mant);
+        d = (exp10 < 0) ? d / pow10[-exp10] : d * pow10[exp10];
+        v = neg ? -d : d;
+        return p;
+    }
+
+    //! Skips blanks
+    //! @return the position of the first other character, or end
+    static const char * SkipBlanks(const char * p, const char * end)
+    {
+        while(p < end && (*p == ' ' || *p == '\t' || *p == '\r')) ++p;
+        return p;
+    }
+
+    //! The line that starts at line, without its line break, for error messages
+    static std::string LineAt(const char * line, const char * end)
+    {
+        const char * eol = static_cast<const char *>(memchr(line, '\n', end - line));
+        if(eol == NULL) eol = end;
+        if(eol > line && eol[-1] == '\r') --eol;
+        return std::string(line, eol);
+    }
+
+    /**
+     * Parses the Matrix Market coordinate lines in [begin, end), which starts at a line boundary, with the
+     * hand-written ParseInteger/ParseReal instead of the sscanf of ProcessLines; blank and comment lines are skipped
+     * Every other line must hold two indices and, unless type is pattern, a value, followed only by blanks
+     * @return the first line that is not such an entry (nothing after it is parsed), or NULL if there is none
+     **/
+    template <typename IT1, typename NT1>
+    static const char * ParseMMLines(const char * begin, const char * end, std::vector<IT1> & rows, std::vector<IT1> & cols, std::vector<NT1> & vals, int symmetric, int type, bool onebased = true)
+    {
+        for(const char * p = begin; p < end; )
+        {
+            const char * eol = static_cast<const char *>(memchr(p, '\n', end - p));
+            if(eol == NULL) eol = end;
+            const char * q = SkipBlanks(p, eol);
+            if(q < eol && *q != '%')    // not a blank or comment line
+            {
+                int64_t ii, jj;
+                int64_t iv = 1;
+                double rv = 0;
+                q = ParseInteger(q, eol, ii);
+                if(q != NULL)   q = ParseInteger(q, eol, jj);
+                if(q != NULL && type == 0)  q = ParseReal(q, eol, rv);      // real
+                else if(q != NULL && type == 1) q = ParseInteger(q, eol, iv);  // integer
+                if(q == NULL || q > eol || SkipBlanks(q, eol) != eol)
+                    return p;
+                if(type == 0)
+                    SpHelper::push_to_vectors(rows, cols, vals, ii, jj, rv, symmetric, onebased);
+                else
+                    SpHelper::push_to_vectors(rows, cols, vals, ii, jj, iv, symmetric, onebased);
+            }
+            p = eol + 1;
+        }
+        return NULL;
+    }
+
+
+    //! Appends v as a variable-byte integer: 7 bits per byte, least significant first, high bit set on all but the last byte
+    static void PutVarint(std::vector<unsigned char> & out, uint64_t v)
+    {
+        while(v >= 0x80)
+        {
+            out.push_back(static_cast<unsigned char>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<unsigned char>(v));
+    }
+
+    static const unsigned char * GetVarint(const unsigned char * p, uint64_t & v)
+    {
+        v = 0;
+        for(int shift = 0; ; shift += 7)
+        {
+            unsigned char b = *p++;
+            v |= static_cast<uint64_t>(b & 0x7f) << shift;
+            if(b < 0x80) return p;
+        }
+    }
+
+    /**
+     * Appends a block of the compressed edge list format: per edge, the varint column delta from the previous edge,
+     * then the varint row delta if the column is unchanged or the absolute row otherwise; the nedges values (ntsize
+     * bytes each, none if vals is NULL) follow the indices. Deltas wrap around, so any order can be encoded,
+     * but edges sorted by (column, row) take one or two bytes per index
+     **/
+    template <typename IT1>
+    static void EncodeEdgeBlock(const IT1 * rows, const IT1 * cols, const char * vals, size_t ntsize, size_t nedges, std::vector<unsigned char> & out)
+    {
+        uint64_t prevrow = 0, prevcol = 0;
+        for(size_t i=0; i<nedges; ++i)
+        {
+            uint64_t row = static_cast<uint64_t>(rows[i]);
+            uint64_t col = static_cast<uint64_t>(cols[i]);
+            PutVarint(out, col - prevcol);
+            PutVarint(out, (col == prevcol)? row - prevrow : row);
+            prevrow = row;
+            prevcol = col;
+        }
+        if(vals != NULL)    out.insert(out.end(), vals, vals + nedges * ntsize);
+    }
+
+    //! Decodes the indices of a block written by EncodeEdgeBlock
+    //! @return the position of the values of the block
+    template <typename IT1>
+    static const unsigned char * DecodeEdgeBlock(const unsigned char * p, size_t nedges, IT1 * rows, IT1 * cols)
+    {
+        uint64_t row = 0, col = 0;
+        for(size_t i=0; i<nedges; ++i)
+        {
+            uint64_t coldelta, rowcode;
+            p = GetVarint(p, coldelta);
+            p = GetVarint(p, rowcode);
+            col += coldelta;
+            row = (coldelta == 0)? row + rowcode : rowcode;
+            rows[i] = static_cast<IT1>(row);
+            cols[i] = static_cast<IT1>(col);
+        }
+        return p;
+    }
+
 
 	template <typename T>
 	static const T * p2a (const std::vector<T> & v)   // pointer to array
@@ -295,6 +463,23 @@ public:
 	static bool first_compare(std::pair<IT, IT> pair1, std::pair<IT, IT> pair2) 
 	{ return pair1.first < pair2.first; }
 
+	//! Split [0,n) into nparts contiguous ranges of roughly equal work, given the work prefix sums (size n+1)
+	//! Range t is [splits[t], splits[t+1])
+	template <typename IT>
+	static std::vector<IT> PartitionByWork(const std::vector<IT> & workprefix, int nparts)
+	{
+		IT n = static_cast<IT>(workprefix.size()) - 1;
+		std::vector<IT> splits(nparts+1, n);
+		splits[0] = 0;
+		double total = static_cast<double>(workprefix[n]);
+		for(int t=1; t < nparts; ++t)
+		{
+			IT target = static_cast<IT>((total * t) / nparts);
+			splits[t] = std::lower_bound(workprefix.begin(), workprefix.end(), target) - workprefix.begin();
+		}
+		return splits;
+	}
+
 };
 
 
@@ -172,20 +172,15 @@ void SpImpl<SR,IT,bool,IVT,OVT>::SpMXSpV(const Dcsc<IT,bool> & Adcsc, int32_t mA
 	IT sup = std::numeric_limits<IT>::max(); 
 	KNHeap< IT, IVT > sHeap(sup, inf); 	// max size: flops
 
-	IT k = 0; 	// index to indx vector
 	IT i = 0; 	// index to columns of matrix
-	while(i< Adcsc.nzc && k < veclen)
+	bool gallop = Adcsc.Gallop(veclen);	// columns of indx are looked up directly (CSC), by binary search, or by scanning
+	for(int32_t k=0; k < veclen; ++k)
 	{
-		if(Adcsc.jc[i] < indx[k]) ++i;
-		else if(indx[k] < Adcsc.jc[i]) ++k;
-		else
+		if(!Adcsc.FindCol(indx[k], i, gallop))	continue;
+
+		for(IT j=Adcsc.cp[i]; j < Adcsc.cp[i+1]; ++j)	// for all nonzeros in this column
 		{
-			for(IT j=Adcsc.cp[i]; j < Adcsc.cp[i+1]; ++j)	// for all nonzeros in this column
-			{
-				sHeap.insert(Adcsc.ir[j], numx[k]);	// row_id, num
-			}
-			++i;
-			++k;
+			sHeap.insert(Adcsc.ir[j], numx[k]);	// row_id, num
 		}
 	}
 
@@ -228,33 +223,33 @@ void SpImpl<SR,IT,bool,IVT,OVT>::SpMXSpV(const Dcsc<IT,bool> & Adcsc, int32_t mA
 	std::vector< std::vector<int32_t> > nzinds(p_c);	// nonzero indices		
 
 	int32_t perproc = mA / p_c;	
-	int32_t k = 0; 	// index to indx vector
-	IT i = 0; 	// index to columns of matrix
-	while(i< Adcsc.nzc && k < veclen)
+	auto accumulate = [&](const auto * rowids)	// Adcsc.ir, or Adcsc.ir16 if the block keeps it
 	{
-		if(Adcsc.jc[i] < indx[k]) ++i;
-		else if(indx[k] < Adcsc.jc[i]) ++k;
-		else
+		IT i = 0; 	// index to columns of matrix
+		bool gallop = Adcsc.Gallop(veclen);
+		for(int32_t k=0; k < veclen; ++k)
 		{
+			if(!Adcsc.FindCol(indx[k], i, gallop))	continue;
+
 			for(IT j=Adcsc.cp[i]; j < Adcsc.cp[i+1]; ++j)	// for all nonzeros in this column
 			{
-				int32_t rowid = (int32_t) Adcsc.ir[j];
+				int32_t rowid = (int32_t) rowids[j];
 				if(!isthere.get_bit(rowid))
 				{
 					int32_t owner = std::min(rowid / perproc, static_cast<int32_t>(p_c-1)); 			
 					localy[rowid] = numx[k];	// initial assignment, requires implicit conversion if IVT != OVT
 					nzinds[owner].push_back(rowid);
-                    isthere.set_bit(rowid);
+					isthere.set_bit(rowid);
 				}
 				else	
 				{
 					localy[rowid] = SR::add(localy[rowid], numx[k]);
 				}	
 			}
-			++i;
-			++k;
 		}
-	}
+	};
+	if(Adcsc.ir16 != NULL)	accumulate(Adcsc.ir16);
+	else	accumulate(Adcsc.ir);
 
 	for(int p = 0; p< p_c; ++p)
 	{
@@ -291,17 +286,17 @@ template <typename SR, typename IT, typename IVT, typename OVT>
 void SpImpl<SR,IT,bool,IVT,OVT>::SpMXSpV_ForThreading(const Dcsc<IT,bool> & Adcsc, int32_t mA, const int32_t * indx, const IVT * numx, int32_t veclen, std::vector<int32_t> & indy, std::vector<OVT> & numy, int32_t offset, std::vector<OVT> & localy, BitMap & isthere, std::vector<uint32_t> & nzinds)
 {
 	// The following piece of code is not general, but it's more memory efficient than FillColInds
-	int32_t k = 0; 	// index to indx vector
-	IT i = 0; 	// index to columns of matrix
-	while(i< Adcsc.nzc && k < veclen)
+	auto accumulate = [&](const auto * rowids)	// Adcsc.ir, or Adcsc.ir16 if the block keeps it
 	{
-		if(Adcsc.jc[i] < indx[k]) ++i;
-		else if(indx[k] < Adcsc.jc[i]) ++k;
-		else
+		IT i = 0; 	// index to columns of matrix
+		bool gallop = Adcsc.Gallop(veclen);
+		for(int32_t k=0; k < veclen; ++k)
 		{
+			if(!Adcsc.FindCol(indx[k], i, gallop))	continue;
+
 			for(IT j=Adcsc.cp[i]; j < Adcsc.cp[i+1]; ++j)	// for all nonzeros in this column
 			{
-				uint32_t rowid = (uint32_t) Adcsc.ir[j];
+				uint32_t rowid = (uint32_t) rowids[j];
 				if(!isthere.get_bit(rowid))
 				{
 					localy[rowid] = numx[k];	// initial assignment
@@ -313,9 +308,10 @@ void SpImpl<SR,IT,bool,IVT,OVT>::SpMXSpV_ForThreading(const Dcsc<IT,bool> & Adcs
 					localy[rowid] = SR::add(localy[rowid], numx[k]);
 				}	
 			}
-			++i; ++k;
 		}
-	}
+	};
+	if(Adcsc.ir16 != NULL)	accumulate(Adcsc.ir16);
+	else	accumulate(Adcsc.ir);
     int nnzy = nzinds.size();
     integerSort(nzinds.data(), nnzy);
 	indy.resize(nnzy);
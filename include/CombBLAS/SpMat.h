@@ -33,9 +33,12 @@
 #include <iostream>
 #include <vector>
 #include <utility>
+#include <algorithm>
+#include <type_traits>
 #include "CombBLAS.h"
 #include "SpDefs.h"
 #include "promote.h"
+#include "Pattern.h"
 #include "LocArr.h"
 
 namespace combblas {
@@ -44,6 +47,16 @@ namespace combblas {
 template <class IU, class NU>	
 class SpTuples;
 
+/**
+ ** Whether the local matrix type DER stores only a sparsity pattern, i.e. its values are of type Pattern
+ ** Such matrices have no value arrays, so values are not communicated or written out
+ **/
+template <class DER>
+struct pattern_trait
+{
+	static const bool value = false;
+};
+
 
 /**
  ** The abstract base class for all derived sequential sparse matrix classes
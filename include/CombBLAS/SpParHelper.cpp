@@ -27,7 +27,11 @@
  */
 
 
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
 #include "usort/parUtils.h"
+#include "PBBS/radixSort.h"
 
 namespace combblas {
 
@@ -48,39 +52,36 @@ void SpParHelper::ReDistributeToVector(int* & map_scnt, std::vector< std::vector
     	IT totmapsend = map_sdspl[nprocs-1] + map_scnt[nprocs-1];
     	IT totmaprecv = map_rdspl[nprocs-1] + map_rcnt[nprocs-1];
 
-    	// sendbuf is a pointer to array of MAXVERTNAME chars. 
-    	// Explicit grouping syntax is due to precedence of [] over *
-    	// char* sendbuf[MAXVERTNAME] would have declared a MAXVERTNAME-length array of char pointers
-    	char (*sendbuf)[MAXVERTNAME];	// each sendbuf[i] is type char[MAXVERTNAME]
-    	sendbuf = (char (*)[MAXVERTNAME]) malloc(sizeof(char[MAXVERTNAME])* totmapsend);	// notice that this is allocating a contiguous block of memory
-    
-    	IT * sendinds =  new IT[totmapsend];
-    	for(int i=0; i<nprocs; ++i)
-    	{	 
-	    int loccnt = 0;
-	    for(std::string s:data_send[i])
-	    {
-		    std::strcpy(sendbuf[map_sdspl[i]+loccnt], s.c_str());
-		    loccnt++;
-	    }
-	    std::vector<std::string>().swap(data_send[i]);	// free memory
-    	}
-    	for(int i=0; i<nprocs; ++i)	      // sanity check: received indices should be sorted by definition
-    	{ 
-          std::copy(locs_send[i].begin(), locs_send[i].end(), sendinds+map_sdspl[i]);
-        	std::vector<IT>().swap(locs_send[i]);	// free memory
-    	}
-
-    	char (*recvbuf)[MAXVERTNAME];	// recvbuf is of type char (*)[MAXVERTNAME]
-    	recvbuf = (char (*)[MAXVERTNAME]) malloc(sizeof(char[MAXVERTNAME])* totmaprecv);
-
-   	MPI_Datatype MPI_STRING;	// this is not necessary (we could just use char) but easier for bookkeeping
-   	MPI_Type_contiguous(sizeof(char[MAXVERTNAME]), MPI_CHAR, &MPI_STRING);
-    	MPI_Type_commit(&MPI_STRING);
-
-    	MPI_Alltoallv(sendbuf, map_scnt, map_sdspl, MPI_STRING, recvbuf, map_rcnt, map_rdspl, MPI_STRING, comm);
-    	free(sendbuf);	// can't delete[] so use free
-    	MPI_Type_free(&MPI_STRING);
+	// names travel null-terminated and back to back, so short names do not pay for MAXVERTNAME bytes
+	std::vector<int> byte_scnt(nprocs, 0), byte_rcnt(nprocs), byte_sdspl(nprocs, 0), byte_rdspl(nprocs, 0);
+	for(int i=0; i<nprocs; ++i)
+		for(const std::string & s : data_send[i])
+			byte_scnt[i] += s.size() + 1;
+	MPI_Alltoall(byte_scnt.data(), 1, MPI_INT, byte_rcnt.data(), 1, MPI_INT, comm);
+	std::partial_sum(byte_scnt.begin(), byte_scnt.end()-1, byte_sdspl.begin()+1);
+	std::partial_sum(byte_rcnt.begin(), byte_rcnt.end()-1, byte_rdspl.begin()+1);
+
+	std::vector<char> sendbuf(byte_sdspl[nprocs-1] + byte_scnt[nprocs-1]);
+	char * pos = sendbuf.data();
+	for(int i=0; i<nprocs; ++i)
+	{
+		for(const std::string & s : data_send[i])
+		{
+			std::memcpy(pos, s.c_str(), s.size() + 1);
+			pos += s.size() + 1;
+		}
+		std::vector<std::string>().swap(data_send[i]);	// free memory
+	}
+	IT * sendinds =  new IT[totmapsend];
+	for(int i=0; i<nprocs; ++i)
+	{
+		std::copy(locs_send[i].begin(), locs_send[i].end(), sendinds+map_sdspl[i]);
+		std::vector<IT>().swap(locs_send[i]);	// free memory
+	}
+
+	std::vector<char> recvbuf(byte_rdspl[nprocs-1] + byte_rcnt[nprocs-1]);
+	MPI_Alltoallv(sendbuf.data(), byte_scnt.data(), byte_sdspl.data(), MPI_CHAR, recvbuf.data(), byte_rcnt.data(), byte_rdspl.data(), MPI_CHAR, comm);
+	std::vector<char>().swap(sendbuf);
 
     	IT * recvinds = new IT[totmaprecv];
     	MPI_Alltoallv(sendinds, map_scnt, map_sdspl, MPIType<IT>(), recvinds, map_rcnt, map_rdspl, MPIType<IT>(), comm);
@@ -89,12 +90,15 @@ void SpParHelper::ReDistributeToVector(int* & map_scnt, std::vector< std::vector
     	if(!std::is_sorted(recvinds, recvinds+totmaprecv))
 	    	std::cout << "Assertion failed at proc " << myrank << ": Received indices are not sorted, this is unexpected" << std::endl;
 
-    	for(IT i=0; i< totmaprecv; ++i)
-    	{
+	const char * name = recvbuf.data();
+	for(IT i=0; i< totmaprecv; ++i)
+	{
 		assert(i == recvinds[i]);
-		std::copy(recvbuf[i], recvbuf[i]+MAXVERTNAME, distmapper_array[i].begin());
-    	}
-    	free(recvbuf);
+		size_t len = std::strlen(name);
+		std::copy(name, name + std::min(len, static_cast<size_t>(MAXVERTNAME)), distmapper_array[i].begin());
+		if(len < MAXVERTNAME)	distmapper_array[i][len] = '\0';	// null termination
+		name += len + 1;
+	}
     	delete [] recvinds;	
 }
 
@@ -275,6 +279,210 @@ std::vector<std::pair<KEY,VAL>> SpParHelper::KeyValuePSort(std::pair<KEY,VAL> *
 }
 
 
+template<typename KEY, typename VAL, typename IT>
+void SpParHelper::RadixPSort(std::pair<KEY,VAL> * array, IT length, IT * dist, const MPI_Comm & comm)
+{
+	RadixPSort(array, length, dist, comm, typename std::is_integral<KEY>::type());
+}
+
+template<typename KEY, typename VAL, typename IT>
+void SpParHelper::RadixPSort(std::pair<KEY,VAL> * array, IT length, IT * dist, const MPI_Comm & comm, std::false_type)
+{
+	MemoryEfficientPSort(array, length, dist, comm);
+}
+
+/**
+ * MSD radix sort on integer keys:
+ * 1) the top digit of every key is histogrammed (one histogram per thread) and the histograms are summed over comm
+ * 2) every bucket is sent, whole, to the processor whose share contains the bucket's midpoint in the global order,
+ *    so no splitters are sampled and a single all-to-all moves the data
+ * 3) received pairs are regrouped by bucket and the remaining bits of each bucket are sorted by PBBS' LSD radix sort,
+ *    one bucket per thread; equal keys are ordered by value, as in psort
+ * 4) the sorted sequence is shifted back to the distribution given by dist
+ * If a few keys dominate and buckets can not be balanced, the sort falls back to MemoryEfficientPSort
+ */
+template<typename KEY, typename VAL, typename IT>
+void SpParHelper::RadixPSort(std::pair<KEY,VAL> * array, IT length, IT * dist, const MPI_Comm & comm, std::true_type)
+{
+	typedef std::pair<KEY,VAL> PAIR;
+	int nprocs, myrank;
+	MPI_Comm_size(comm, &nprocs);
+	MPI_Comm_rank(comm, &myrank);
+	IT total = std::accumulate(dist, dist+nprocs, static_cast<IT>(0));
+	if(total == 0) return;
+
+	// order preserving map from keys to unsigned 64-bit integers
+	const uint64_t flip = std::is_signed<KEY>::value ? (static_cast<uint64_t>(1) << 63) : 0;
+	auto ukey = [flip](KEY key) { return static_cast<uint64_t>(static_cast<int64_t>(key)) ^ flip; };
+
+	uint64_t lmin = std::numeric_limits<uint64_t>::max();
+	uint64_t lmax = 0;
+#ifdef _OPENMP
+#pragma omp parallel for reduction(min:lmin) reduction(max:lmax)
+#endif
+	for(IT i=0; i< length; ++i)
+	{
+		uint64_t u = ukey(array[i].first);
+		lmin = std::min(lmin, u);
+		lmax = std::max(lmax, u);
+	}
+	uint64_t gmin, gmax;
+	MPI_Allreduce(&lmin, &gmin, 1, MPIType<uint64_t>(), MPI_MIN, comm);
+	MPI_Allreduce(&lmax, &gmax, 1, MPIType<uint64_t>(), MPI_MAX, comm);
+
+	int keybits = 0;
+	for(uint64_t range = gmax - gmin; range > 0; range >>= 1) ++keybits;
+	if(keybits == 0)	// all keys are equal, the values alone decide the order
+	{
+		MemoryEfficientPSort(array, length, dist, comm);
+		return;
+	}
+	int logp = 0;
+	while((1 << logp) < nprocs) ++logp;
+	int digit = std::min(keybits, std::min(16, logp + 6));	// ~64 buckets per processor
+	int shift = keybits - digit;
+	IT nbuckets = static_cast<IT>(1) << digit;
+	auto bucketof = [ukey, gmin, shift](const PAIR & p) { return static_cast<IT>((ukey(p.first) - gmin) >> shift); };
+
+	int nthreads = 1;
+#ifdef _OPENMP
+#pragma omp parallel
+	{
+		nthreads = omp_get_num_threads();
+	}
+#endif
+	std::vector<IT> tcounts(nthreads * nbuckets, 0);	// one histogram per thread, over a contiguous chunk of array
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		int t = 0;
+#ifdef _OPENMP
+		t = omp_get_thread_num();
+#endif
+		IT * mycounts = tcounts.data() + t * nbuckets;
+		for(IT i = length*t/nthreads; i < length*(t+1)/nthreads; ++i)
+			++mycounts[bucketof(array[i])];
+	}
+	std::vector<IT> lhist(nbuckets, 0);
+	std::vector<IT> ghist(nbuckets);
+	for(int t=0; t< nthreads; ++t)
+		for(IT k=0; k< nbuckets; ++k)
+			lhist[k] += tcounts[t*nbuckets + k];
+	MPI_Allreduce(lhist.data(), ghist.data(), static_cast<int>(nbuckets), MPIType<IT>(), MPI_SUM, comm);
+
+	// bucket owners are nondecreasing in k, so every processor gets a contiguous range of buckets
+	std::vector<int> bowner(nbuckets);
+	std::vector<IT> load(nprocs, 0);
+	IT before = 0;
+	for(IT k=0; k< nbuckets; ++k)
+	{
+		double mid = static_cast<double>(before) + static_cast<double>(ghist[k]) / 2.0;
+		bowner[k] = std::min(nprocs-1, static_cast<int>(mid * nprocs / static_cast<double>(total)));
+		load[bowner[k]] += ghist[k];
+		before += ghist[k];
+	}
+	if(*std::max_element(load.begin(), load.end()) > RADIXSORT_MAX_IMBALANCE * (total / nprocs + 1))
+	{
+		MemoryEfficientPSort(array, length, dist, comm);
+		return;
+	}
+
+	// stable scatter into bucket order: thread t places bucket k after the pairs of bucket k held by threads < t
+	std::vector<IT> tdisp(nthreads * nbuckets);
+	IT offset = 0;
+	for(IT k=0; k< nbuckets; ++k)
+	{
+		for(int t=0; t< nthreads; ++t)
+		{
+			tdisp[t*nbuckets + k] = offset;
+			offset += tcounts[t*nbuckets + k];
+		}
+	}
+	PAIR * sendbuf = new PAIR[length];
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		int t = 0;
+#ifdef _OPENMP
+		t = omp_get_thread_num();
+#endif
+		IT * mydisp = tdisp.data() + t * nbuckets;
+		for(IT i = length*t/nthreads; i < length*(t+1)/nthreads; ++i)
+			sendbuf[mydisp[bucketof(array[i])]++] = array[i];
+	}
+
+	int * sendcnt = new int[nprocs]();
+	int * recvcnt = new int[nprocs];
+	int * sdispls = new int[nprocs]();
+	int * rdispls = new int[nprocs]();
+	for(IT k=0; k< nbuckets; ++k)
+		sendcnt[bowner[k]] += static_cast<int>(lhist[k]);
+	MPI_Alltoall(sendcnt, 1, MPI_INT, recvcnt, 1, MPI_INT, comm);
+	std::partial_sum(sendcnt, sendcnt+nprocs-1, sdispls+1);
+	std::partial_sum(recvcnt, recvcnt+nprocs-1, rdispls+1);
+	IT totrecv = std::accumulate(recvcnt, recvcnt+nprocs, static_cast<IT>(0));
+	PAIR * recvbuf = new PAIR[totrecv];
+	SpParHelper::Alltoallv(sendbuf, sendcnt, sdispls, recvbuf, recvcnt, rdispls, comm);
+	delete [] sendbuf;
+
+	// regroup by bucket, keeping the arrival (i.e. rank) order inside each bucket
+	IT kbeg = std::lower_bound(bowner.begin(), bowner.end(), myrank) - bowner.begin();
+	IT kend = std::upper_bound(bowner.begin(), bowner.end(), myrank) - bowner.begin();
+	std::vector<IT> rbdisp(kend - kbeg + 1, 0);
+	for(IT k=kbeg; k< kend; ++k)
+		rbdisp[k-kbeg+1] = rbdisp[k-kbeg] + ghist[k];
+	std::vector<IT> fillpos(rbdisp.begin(), rbdisp.end()-1);
+	PAIR * grouped = new PAIR[totrecv];
+	for(IT i=0; i< totrecv; ++i)
+		grouped[fillpos[bucketof(recvbuf[i]) - kbeg]++] = recvbuf[i];
+	delete [] recvbuf;
+
+	const int window = 24;	// bits per LSD call; PBBS sorts are stable, so consecutive windows compose
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for(IT k=kbeg; k< kend; ++k)
+	{
+		PAIR * bucket = grouped + rbdisp[k-kbeg];
+		IT bsize = rbdisp[k-kbeg+1] - rbdisp[k-kbeg];
+		if(bsize < 2) continue;
+		for(int low=0; low < shift; low += window)
+		{
+			int bits = std::min(window, shift - low);
+			uint64_t mask = (static_cast<uint64_t>(1) << bits) - 1;
+			intSort::iSort(bucket, static_cast<int>(bsize), 1 << bits, [ukey, gmin, low, mask](const PAIR & p) { return static_cast<int>(((ukey(p.first) - gmin) >> low) & mask); });
+		}
+		for(IT i=0; i< bsize; )	// ties are ordered by value
+		{
+			IT j = i+1;
+			while(j < bsize && bucket[j].first == bucket[i].first) ++j;
+			if(j-i > 1) std::sort(bucket+i, bucket+j);
+			i = j;
+		}
+	}
+
+	// shift the globally sorted sequence back to the distribution in dist
+	IT myoffset = 0;
+	MPI_Exscan(&totrecv, &myoffset, 1, MPIType<IT>(), MPI_SUM, comm);
+	if(myrank == 0) myoffset = 0;
+	IT target = 0;
+	for(int i=0; i< nprocs; ++i)
+	{
+		IT lo = std::max(target, myoffset);
+		IT hi = std::min(target + dist[i], myoffset + totrecv);
+		sendcnt[i] = (hi > lo)? static_cast<int>(hi - lo) : 0;
+		target += dist[i];
+	}
+	MPI_Alltoall(sendcnt, 1, MPI_INT, recvcnt, 1, MPI_INT, comm);
+	std::partial_sum(sendcnt, sendcnt+nprocs-1, sdispls+1);
+	std::partial_sum(recvcnt, recvcnt+nprocs-1, rdispls+1);
+	SpParHelper::Alltoallv(grouped, sendcnt, sdispls, array, recvcnt, rdispls, comm);
+	DeleteAll(grouped, sendcnt, recvcnt, sdispls, rdispls);
+}
+
+
 template<typename KEY, typename VAL, typename IT>
 void SpParHelper::GlobalSelect(IT gl_rank, std::pair<KEY,VAL> * & low,  std::pair<KEY,VAL> * & upp, std::pair<KEY,VAL> * array, IT length, const MPI_Comm & comm)
 {
@@ -488,6 +696,461 @@ void SpParHelper::BipartiteSwap(std::pair<KEY,VAL> * low, std::pair<KEY,VAL> * a
 }
 
 
+/**
+ * Committed datatype that covers all arrays of a local matrix (as returned by GetArrays) at their absolute
+ * addresses, so that a whole matrix is sent or received as a single message from/to MPI_BOTTOM, without packing
+ * Empty arrays are skipped; the caller frees the datatype
+ **/
+template<typename IT, typename NT>
+MPI_Datatype SpParHelper::ArraysType(const Arr<IT,NT> & arrays)
+{
+	std::vector<int> blocklens;
+	std::vector<MPI_Aint> displs;
+	std::vector<MPI_Datatype> types;
+	for(auto & arr: arrays.indarrs)
+	{
+		if(arr.count == 0)	continue;
+		MPI_Aint addr;
+		MPI_Get_address(arr.addr, &addr);
+		blocklens.push_back(static_cast<int>(arr.count));
+		displs.push_back(addr);
+		types.push_back(MPIType<IT>());
+	}
+	for(auto & arr: arrays.numarrs)
+	{
+		if(arr.count == 0)	continue;
+		MPI_Aint addr;
+		MPI_Get_address(arr.addr, &addr);
+		blocklens.push_back(static_cast<int>(arr.count));
+		displs.push_back(addr);
+		types.push_back(MPIType<NT>());
+	}
+	MPI_Datatype datatype;
+	MPI_Type_create_struct(blocklens.size(), blocklens.data(), displs.data(), types.data(), &datatype);
+	MPI_Type_commit(&datatype);
+	return datatype;
+}
+
+/**
+ * Drop-in replacement for MPI_Alltoallv(sendbuf, sendcnt, sdispls, MPIType<T>(), recvbuf, recvcnt, rdispls, MPIType<T>(), comm)
+ * Unless forced by SetAlltoallvAlgorithm, the exchange is selected from global message counts and sizes
+ * (so every processor takes the same path):
+ * 1) Few messages per processor: point-to-point, skipping empty pairs
+ * 2) Many small messages, processors spread over several nodes: hierarchical exchange
+ *    (on-node aggregation, then an inter-node k-way exchange between processors with the same local rank)
+ * 3) Many small messages, one processor per node or a single node: k-way hypercube exchange over comm (power of two only)
+ * 4) Otherwise, or when comm is small (SetAlltoallvMinProcs), MPI_Alltoallv itself
+ **/
+template <typename T>
+void SpParHelper::Alltoallv(T * sendbuf, int * sendcnt, int * sdispls, T * recvbuf, int * recvcnt, int * rdispls, const MPI_Comm & comm)
+{
+	FreeDeferredComms();
+	const AlltoallvParams & params = AlltoallvSettings();
+	int nprocs, myrank;
+	MPI_Comm_size(comm, &nprocs);
+	MPI_Comm_rank(comm, &myrank);
+	if(params.algorithm == A2AV_MPI || (params.algorithm == A2AV_AUTO && nprocs < params.minprocs))
+	{
+		MPI_Alltoallv(sendbuf, sendcnt, sdispls, MPIType<T>(), recvbuf, recvcnt, rdispls, MPIType<T>(), comm);
+		return;
+	}
+	if(params.algorithm == A2AV_SPARSE)
+	{
+		AlltoallvSparse(sendbuf, sendcnt, sdispls, recvbuf, recvcnt, rdispls, comm);
+		return;
+	}
+
+	int64_t counts[2] = {0, 0};	// nonempty messages sent, bytes sent
+	for(int i=0; i<nprocs; ++i)
+	{
+		if(i != myrank && sendcnt[i] > 0)	++counts[0];
+		counts[1] += static_cast<int64_t>(sendcnt[i]) * sizeof(T);
+	}
+	int64_t totals[2];
+	MPI_Allreduce(counts, totals, 2, MPIType<int64_t>(), MPI_SUM, comm);
+	const AlltoallvTopology & topo = GetAlltoallvTopology(comm);	// collective on first use
+
+	bool pow2 = ((nprocs & (nprocs-1)) == 0) && ((ALLTOALLV_KWAY & (ALLTOALLV_KWAY-1)) == 0);
+	// aggregating exchanges count bytes in int; a processor never holds more than the total in flight
+	bool fits = totals[1] < std::numeric_limits<int>::max() / 2;
+	bool hierarchical = fits && topo.nodeWorld != MPI_COMM_NULL;
+	bool kway = fits && pow2;
+
+	if(params.algorithm == A2AV_HIERARCHICAL && hierarchical)
+		AlltoallvHierarchical(sendbuf, sendcnt, sdispls, recvbuf, recvcnt, rdispls, topo);
+	else if(params.algorithm == A2AV_KWAY && kway)
+		AlltoallvKway(sendbuf, sendcnt, sdispls, recvbuf, recvcnt, rdispls, comm, ALLTOALLV_KWAY);
+	else if(params.algorithm != A2AV_AUTO)
+		MPI_Alltoallv(sendbuf, sendcnt, sdispls, MPIType<T>(), recvbuf, recvcnt, rdispls, MPIType<T>(), comm);
+	else
+	{
+		bool aggregate = totals[0] > 0 && totals[1] / totals[0] <= ALLTOALLV_MAX_AGGREGATED_MSG;
+		if(totals[0] < static_cast<int64_t>(nprocs) * std::log2(nprocs))
+			AlltoallvSparse(sendbuf, sendcnt, sdispls, recvbuf, recvcnt, rdispls, comm);
+		else if(aggregate && hierarchical)
+			AlltoallvHierarchical(sendbuf, sendcnt, sdispls, recvbuf, recvcnt, rdispls, topo);
+		else if(aggregate && kway)
+			AlltoallvKway(sendbuf, sendcnt, sdispls, recvbuf, recvcnt, rdispls, comm, ALLTOALLV_KWAY);
+		else
+			MPI_Alltoallv(sendbuf, sendcnt, sdispls, MPIType<T>(), recvbuf, recvcnt, rdispls, MPIType<T>(), comm);
+	}
+}
+
+template <typename T>
+void SpParHelper::AlltoallvSparse(T * sendbuf, int * sendcnt, int * sdispls, T * recvbuf, int * recvcnt, int * rdispls, const MPI_Comm & comm)
+{
+	int nprocs, myrank;
+	MPI_Comm_size(comm, &nprocs);
+	MPI_Comm_rank(comm, &myrank);
+	std::vector<MPI_Request> requests;
+	for(int i=0; i<nprocs; ++i)
+	{
+		if(i != myrank && recvcnt[i] > 0)
+		{
+			requests.push_back(MPI_REQUEST_NULL);
+			MPI_Irecv(recvbuf + rdispls[i], recvcnt[i], MPIType<T>(), i, A2ASPARSE, comm, &requests.back());
+		}
+	}
+	for(int i=0; i<nprocs; ++i)
+	{
+		if(i != myrank && sendcnt[i] > 0)
+		{
+			requests.push_back(MPI_REQUEST_NULL);
+			MPI_Isend(sendbuf + sdispls[i], sendcnt[i], MPIType<T>(), i, A2ASPARSE, comm, &requests.back());
+		}
+	}
+	std::copy(sendbuf + sdispls[myrank], sendbuf + sdispls[myrank] + sendcnt[myrank], recvbuf + rdispls[myrank]);
+	MPI_Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+}
+
+/**
+ * k-way hypercube all-to-all (from usort), for a power of two number of processors and a power of two k
+ * In each of the log_k(p) rounds, the current range of processors is split into k subranges and every processor
+ * forwards, to its counterpart in each subrange, all blocks destined to that subrange.
+ * Blocks carry a (bytes, source) header so that they can be forwarded without the global count matrix.
+ * An increased value of k reduces the bandwidth cost, but increases the latency cost
+ **/
+template <typename T>
+void SpParHelper::AlltoallvKway(T * sendbuf, int * sendcnt, int * sdispls, T * recvbuf, int * recvcnt, int * rdispls, const MPI_Comm & comm, int kway)
+{
+	int nprocs, myrank;
+	MPI_Comm_size(comm, &nprocs);
+	MPI_Comm_rank(comm, &myrank);
+	if(nprocs == 1 || kway == 1)
+	{
+		MPI_Alltoallv(sendbuf, sendcnt, sdispls, MPIType<T>(), recvbuf, recvcnt, rdispls, MPIType<T>(), comm);
+		return;
+	}
+	const int header = 2*sizeof(int);
+
+	std::vector<int> s_cnt(nprocs), sdisp(nprocs+1, 0);	// bytes held for each destination in the current range
+	for(int i=0; i<nprocs; ++i)
+	{
+		s_cnt[i] = sendcnt[i] * sizeof(T) + header;
+		sdisp[i+1] = sdisp[i] + s_cnt[i];
+	}
+	char * sbuff = new char[sdisp[nprocs]];
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(int i=0; i<nprocs; ++i)
+	{
+		int * head = reinterpret_cast<int*>(sbuff + sdisp[i]);
+		head[0] = s_cnt[i];
+		head[1] = myrank;
+		std::memcpy(sbuff + sdisp[i] + header, sendbuf + sdispls[i], sendcnt[i] * sizeof(T));
+	}
+
+	int range[2] = {0, nprocs};
+	while(range[1] - range[0] > 1)
+	{
+		kway = std::min(kway, range[1] - range[0]);
+		std::vector<int> new_range(kway+1);
+		for(int i=0; i<=kway; ++i)
+			new_range[i] = range[0] + (range[1] - range[0]) / kway * i;
+		int p_class = std::upper_bound(new_range.begin(), new_range.end()-1, myrank) - new_range.begin() - 1;
+		int new_np = new_range[p_class+1] - new_range[p_class];	// the same for every subrange
+		int new_pid = myrank - new_range[p_class];
+
+		// exchange block sizes with the counterparts, then the blocks themselves
+		std::vector<int> r_cnt(new_np*kway), rdisp(new_np*kway+1, 0);
+		std::vector<MPI_Request> requests(2*kway);
+		for(int i=0; i<kway; ++i)
+		{
+			int partner = new_range[i] + new_pid;
+			MPI_Irecv(&r_cnt[new_np*i], new_np, MPI_INT, partner, A2AKWAY, comm, &requests[2*i]);
+			MPI_Isend(&s_cnt[new_range[i]-range[0]], new_np, MPI_INT, partner, A2AKWAY, comm, &requests[2*i+1]);
+		}
+		MPI_Waitall(2*kway, requests.data(), MPI_STATUSES_IGNORE);
+		for(int j=0; j<new_np*kway; ++j)
+			rdisp[j+1] = rdisp[j] + r_cnt[j];
+		char * rbuff = new char[rdisp[new_np*kway]];
+		for(int i=0; i<kway; ++i)
+		{
+			int partner = new_range[i] + new_pid;
+			int first = new_range[i] - range[0];
+			int last = new_range[i+1] - range[0];
+			MPI_Irecv(rbuff + rdisp[new_np*i], rdisp[new_np*(i+1)] - rdisp[new_np*i], MPI_BYTE, partner, A2AKWAY, comm, &requests[2*i]);
+			MPI_Isend(sbuff + sdisp[first], sdisp[last] - sdisp[first], MPI_BYTE, partner, A2AKWAY, comm, &requests[2*i+1]);
+		}
+		MPI_Waitall(2*kway, requests.data(), MPI_STATUSES_IGNORE);
+		delete [] sbuff;
+
+		// regroup by destination: everything for destination j, from all k counterparts, becomes contiguous
+		s_cnt.assign(new_np, 0);
+		sdisp.assign(new_np+1, 0);
+		for(int j=0; j<new_np; ++j)
+		{
+			for(int i=0; i<kway; ++i)
+				s_cnt[j] += r_cnt[i*new_np+j];
+			sdisp[j+1] = sdisp[j] + s_cnt[j];
+		}
+		sbuff = new char[sdisp[new_np]];
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+		for(int j=0; j<new_np; ++j)
+		{
+			char * dest = sbuff + sdisp[j];
+			for(int i=0; i<kway; ++i)
+			{
+				std::memcpy(dest, rbuff + rdisp[i*new_np+j], r_cnt[i*new_np+j]);
+				dest += r_cnt[i*new_np+j];
+			}
+		}
+		delete [] rbuff;
+		range[0] = new_range[p_class];
+		range[1] = new_range[p_class+1];
+	}
+
+	// sbuff now holds one block from every source, in arbitrary order
+	std::vector<char*> blocks(nprocs);
+	char * ptr = sbuff;
+	for(int i=0; i<nprocs; ++i)
+	{
+		blocks[i] = ptr;
+		ptr += reinterpret_cast<int*>(ptr)[0];
+	}
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(int i=0; i<nprocs; ++i)
+	{
+		int * head = reinterpret_cast<int*>(blocks[i]);
+		std::memcpy(recvbuf + rdispls[head[1]], blocks[i] + header, head[0] - header);
+	}
+	delete [] sbuff;
+}
+
+/**
+ * Two-level all-to-all on a communicator spread over nnodes nodes of nodesize processors each:
+ * 1) on-node aggregation: local processor l collects, from every processor on its node, the data destined to
+ *    local processor l of all nodes (one MPI_Alltoallv on the node communicator, which MPI serves from shared memory)
+ * 2) inter-node exchange: every lane (the processors with the same local rank) runs the k-way exchange over nodes,
+ *    moving one aggregated message per pair of nodes instead of nodesize^2 small ones
+ * 3) the blocks received for every (node, local) source are scattered to the caller's receive displacements
+ * Receive sizes are known from recvcnt, so only the on-node counts need to be exchanged
+ **/
+template <typename T>
+void SpParHelper::AlltoallvHierarchical(T * sendbuf, int * sendcnt, int * sdispls, T * recvbuf, int * recvcnt, int * rdispls, const AlltoallvTopology & topo)
+{
+	int nnodes = topo.nnodes;
+	int nodesize = topo.nodesize;
+	const std::vector<int> & ranks = topo.ranks;
+
+	// counts[l*nnodes+n]: elements from this processor to processor (n,l)
+	std::vector<int> nodesendcnt(nodesize*nnodes), noderecvcnt(nodesize*nnodes);
+	for(int l=0; l<nodesize; ++l)
+		for(int n=0; n<nnodes; ++n)
+			nodesendcnt[l*nnodes+n] = sendcnt[ranks[n*nodesize+l]];
+	MPI_Alltoall(nodesendcnt.data(), nnodes, MPI_INT, noderecvcnt.data(), nnodes, MPI_INT, topo.nodeWorld);
+
+	std::vector<int> sendcnt1(nodesize, 0), recvcnt1(nodesize, 0), sdispls1(nodesize+1, 0), rdispls1(nodesize+1, 0);
+	for(int l=0; l<nodesize; ++l)
+	{
+		for(int n=0; n<nnodes; ++n)
+		{
+			sendcnt1[l] += nodesendcnt[l*nnodes+n];
+			recvcnt1[l] += noderecvcnt[l*nnodes+n];
+		}
+		sdispls1[l+1] = sdispls1[l] + sendcnt1[l];
+		rdispls1[l+1] = rdispls1[l] + recvcnt1[l];
+	}
+	std::vector<T> packed(sdispls1[nodesize]);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(int l=0; l<nodesize; ++l)
+	{
+		T * dest = packed.data() + sdispls1[l];
+		for(int n=0; n<nnodes; ++n)
+		{
+			int r = ranks[n*nodesize+l];
+			dest = std::copy(sendbuf + sdispls[r], sendbuf + sdispls[r] + sendcnt[r], dest);
+		}
+	}
+	std::vector<T> aggregated(rdispls1[nodesize]);
+	MPI_Alltoallv(packed.data(), sendcnt1.data(), sdispls1.data(), MPIType<T>(), aggregated.data(), recvcnt1.data(), rdispls1.data(), MPIType<T>(), topo.nodeWorld);
+
+	// aggregated is ordered by (source local rank, destination node); the lane exchange needs (destination node, source local rank)
+	std::vector<int> blockdispls(nodesize*nnodes);
+	for(int l=0; l<nodesize; ++l)
+	{
+		int pos = rdispls1[l];
+		for(int n=0; n<nnodes; ++n)
+		{
+			blockdispls[l*nnodes+n] = pos;
+			pos += noderecvcnt[l*nnodes+n];
+		}
+	}
+	std::vector<int> sendcnt2(nnodes, 0), recvcnt2(nnodes, 0), sdispls2(nnodes+1, 0), rdispls2(nnodes+1, 0);
+	for(int n=0; n<nnodes; ++n)
+	{
+		for(int l=0; l<nodesize; ++l)
+		{
+			sendcnt2[n] += noderecvcnt[l*nnodes+n];
+			recvcnt2[n] += recvcnt[ranks[n*nodesize+l]];
+		}
+		sdispls2[n+1] = sdispls2[n] + sendcnt2[n];
+		rdispls2[n+1] = rdispls2[n] + recvcnt2[n];
+	}
+	packed.resize(sdispls2[nnodes]);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(int n=0; n<nnodes; ++n)
+	{
+		T * dest = packed.data() + sdispls2[n];
+		for(int l=0; l<nodesize; ++l)
+			dest = std::copy(aggregated.begin() + blockdispls[l*nnodes+n], aggregated.begin() + blockdispls[l*nnodes+n] + noderecvcnt[l*nnodes+n], dest);
+	}
+	std::vector<T>().swap(aggregated);
+
+	std::vector<T> received(rdispls2[nnodes]);
+	if((nnodes & (nnodes-1)) == 0 && (ALLTOALLV_KWAY & (ALLTOALLV_KWAY-1)) == 0)
+		AlltoallvKway(packed.data(), sendcnt2.data(), sdispls2.data(), received.data(), recvcnt2.data(), rdispls2.data(), topo.laneWorld, ALLTOALLV_KWAY);
+	else
+		MPI_Alltoallv(packed.data(), sendcnt2.data(), sdispls2.data(), MPIType<T>(), received.data(), recvcnt2.data(), rdispls2.data(), MPIType<T>(), topo.laneWorld);
+
+	// received from node n: the blocks of its processors (n,0), (n,1), ... in order
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(int n=0; n<nnodes; ++n)
+	{
+		int pos = rdispls2[n];
+		for(int l=0; l<nodesize; ++l)
+		{
+			int r = ranks[n*nodesize+l];
+			std::copy(received.begin() + pos, received.begin() + pos + recvcnt[r], recvbuf + rdispls[r]);
+			pos += recvcnt[r];
+		}
+	}
+}
+
+// Attribute delete callback: MPI may call it from within MPI_Comm_free or MPI_Finalize,
+// where freeing other communicators is not allowed, so their handles are only queued
+inline int SpParHelper::FreeAlltoallvTopology(MPI_Comm comm, int keyval, void * attr, void * extra)
+{
+	AlltoallvTopology * topo = static_cast<AlltoallvTopology*>(attr);
+	if(topo->nodeWorld != MPI_COMM_NULL)
+	{
+		std::lock_guard<std::mutex> lock(DeferredCommsMutex());
+		DeferredComms().push_back(topo->nodeWorld);
+		DeferredComms().push_back(topo->laneWorld);
+	}
+	delete topo;
+	return MPI_SUCCESS;
+}
+
+inline void SpParHelper::FreeDeferredComms()
+{
+	std::vector<MPI_Comm> comms;
+	{
+		std::lock_guard<std::mutex> lock(DeferredCommsMutex());
+		comms.swap(DeferredComms());
+	}
+	for(size_t i=0; i< comms.size(); ++i)
+		MPI_Comm_free(&comms[i]);
+}
+
+inline int SpParHelper::AlltoallvKeyval()
+{
+	static std::once_flag created;
+	static int keyval = MPI_KEYVAL_INVALID;
+	std::call_once(created, [](){ MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, FreeAlltoallvTopology, &keyval, NULL); });
+	return keyval;
+}
+
+/**
+ * Detects the node layout of comm on first use (collective) and caches it on comm, to be freed with it
+ * The hierarchical exchange needs every node to host the same number of processors; otherwise,
+ * or if there is a single node or a single processor per node, nodeWorld is MPI_COMM_NULL
+ * A change of the node size setting rebuilds the layout (collectively, as the setting is the same everywhere)
+ **/
+inline const SpParHelper::AlltoallvTopology & SpParHelper::GetAlltoallvTopology(const MPI_Comm & comm)
+{
+	int keyval = AlltoallvKeyval();
+	int nodesetting = AlltoallvSettings().nodesize;
+	AlltoallvTopology * topo;
+	int found;
+	MPI_Comm_get_attr(comm, keyval, &topo, &found);
+	if(found)
+	{
+		if(topo->requested == nodesetting)	return *topo;
+		MPI_Comm_delete_attr(comm, keyval);
+		FreeDeferredComms();
+	}
+
+	int nprocs, myrank;
+	MPI_Comm_size(comm, &nprocs);
+	MPI_Comm_rank(comm, &myrank);
+	MPI_Comm node;
+	if(nodesetting > 0)
+		MPI_Comm_split(comm, myrank / nodesetting, myrank, &node);
+	else
+		MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, myrank, MPI_INFO_NULL, &node);
+	int mine[2];	// (rank of the node's first processor, local rank)
+	MPI_Comm_rank(node, &mine[1]);
+	mine[0] = myrank;
+	MPI_Bcast(&mine[0], 1, MPI_INT, 0, node);
+	std::vector<int> all(2*nprocs);
+	MPI_Allgather(mine, 2, MPI_INT, all.data(), 2, MPI_INT, comm);
+
+	std::vector<int> leaders;
+	for(int i=0; i<nprocs; ++i)
+		if(all[2*i+1] == 0)	leaders.push_back(all[2*i]);
+	std::sort(leaders.begin(), leaders.end());
+
+	topo = new AlltoallvTopology();
+	topo->nnodes = leaders.size();
+	topo->nodesize = nprocs / topo->nnodes;
+	topo->requested = nodesetting;
+	topo->ranks.assign(nprocs, -1);
+	bool uniform = (topo->nnodes * topo->nodesize == nprocs);
+	for(int i=0; i<nprocs && uniform; ++i)
+	{
+		int n = std::lower_bound(leaders.begin(), leaders.end(), all[2*i]) - leaders.begin();
+		if(all[2*i+1] >= topo->nodesize)	uniform = false;
+		else	topo->ranks[n*topo->nodesize + all[2*i+1]] = i;
+	}
+	if(uniform && topo->nnodes > 1 && topo->nodesize > 1)	// same decision everywhere, as all inputs were gathered
+	{
+		topo->nodeWorld = node;
+		int mynode = std::lower_bound(leaders.begin(), leaders.end(), mine[0]) - leaders.begin();
+		MPI_Comm_split(comm, mine[1], mynode, &topo->laneWorld);
+	}
+	else
+	{
+		MPI_Comm_free(&node);
+		topo->nodeWorld = MPI_COMM_NULL;
+		topo->laneWorld = MPI_COMM_NULL;
+	}
+	MPI_Comm_set_attr(comm, keyval, topo);
+	return *topo;
+}
+
+
 template<typename KEY, typename VAL, typename IT>
 void SpParHelper::DebugPrintKeys(std::pair<KEY,VAL> * array, IT length, IT * dist, MPI_Comm & World)
 {
@@ -586,6 +1249,7 @@ void SpParHelper::BCastMatrix(MPI_Comm & comm1d, SpMat<IT,NT,DER> & Matrix, cons
 	MPI_Comm_rank(comm1d, &myrank);
 	if(myrank != root)
 	{
+		MemoryTracker::Scope scope(MEM_SPGEMM_BCAST);
 		Matrix.Create(essentials);		// allocate memory for arrays		
 	}
 
@@ -612,6 +1276,7 @@ void SpParHelper::IBCastMatrix(MPI_Comm & comm1d, SpMat<IT,NT,DER> & Matrix, con
 	MPI_Comm_rank(comm1d, &myrank);
 	if(myrank != root)
 	{
+		MemoryTracker::Scope scope(MEM_SPGEMM_BCAST);
 		Matrix.Create(essentials);		// allocate memory for arrays		
 	}
 
@@ -868,6 +1533,68 @@ inline void SpParHelper::check_newline(int *bytes_read, int bytes_requested, cha
 }
 
 
+/**
+ * Collective MPI_File_write_at_all (write = true) or MPI_File_read_at_all of bytes bytes at offset
+ * Accesses are split into batches whose counts fit in an int; every process takes part in every batch
+ **/
+inline void SpParHelper::FileAccessAll(MPI_File & fh, MPI_Offset offset, void * buf, int64_t bytes, bool write, MPI_Comm comm)
+{
+	const int64_t batchsize = 256 * 1024 * 1024;
+	int64_t batches = (bytes + batchsize - 1) / batchsize;
+	int64_t maxbatches;
+	MPI_Allreduce(&batches, &maxbatches, 1, MPIType<int64_t>(), MPI_MAX, comm);
+
+	char * cbuf = static_cast<char*>(buf);
+	for(int64_t b = 0; b < maxbatches; ++b)
+	{
+		int64_t done = std::min(b * batchsize, bytes);
+		int count = static_cast<int>(std::min(batchsize, bytes - done));
+		MPI_Status status;
+		if(write)
+			MPI_File_write_at_all(fh, offset + done, cbuf + done, count, MPI_BYTE, &status);
+		else
+			MPI_File_read_at_all(fh, offset + done, cbuf + done, count, MPI_BYTE, &status);
+	}
+}
+
+
+/**
+ * Maps the bytes [offset, offset+length) of a file read-only; pages are read from the file when first touched
+ * @return the address of byte offset, or NULL for an empty range
+ * @param[out] mapbase, maplength {the actual (page aligned) mapping, to be released with UnmapFileRange}
+ **/
+inline const char * SpParHelper::MapFileRange(const std::string & filename, int64_t offset, int64_t length, void * & mapbase, size_t & maplength)
+{
+	mapbase = NULL;
+	maplength = 0;
+	if(length <= 0)	return NULL;
+
+	int fd = open(filename.c_str(), O_RDONLY);
+	if(fd == -1)
+	{
+		std::cout << "COMBBLAS: File " << filename << " can not be opened" << std::endl;
+		MPI_Abort(MPI_COMM_WORLD, NOFILE);
+	}
+	int64_t pagesize = sysconf(_SC_PAGESIZE);
+	int64_t start = (offset / pagesize) * pagesize;		// mmap offsets must be page aligned
+	maplength = length + (offset - start);
+	mapbase = mmap(NULL, maplength, PROT_READ, MAP_PRIVATE, fd, start);
+	close(fd);	// the mapping stays valid
+	if(mapbase == MAP_FAILED)
+	{
+		std::cout << "COMBBLAS: File " << filename << " can not be mapped" << std::endl;
+		MPI_Abort(MPI_COMM_WORLD, NOFILE);
+	}
+	madvise(mapbase, maplength, MADV_SEQUENTIAL);
+	return static_cast<const char *>(mapbase) + (offset - start);
+}
+
+inline void SpParHelper::UnmapFileRange(void * mapbase, size_t maplength)
+{
+	if(mapbase != NULL)	munmap(mapbase, maplength);
+}
+
+
 inline bool SpParHelper::FetchBatch(MPI_File & infile, MPI_Offset & curpos, MPI_Offset end_fpos, bool firstcall, std::vector<std::string> & lines, int myrank)
 {
     size_t bytes2fetch = ONEMILLION;    // we might read more than needed but no problem as we won't process them
@@ -36,11 +36,15 @@
 
 #include <vector>
 #include <array>
+#include <type_traits>
+#include <limits>
+#include <mutex>
 #include <mpi.h>
 #include "LocArr.h"
 #include "CommGrid.h"
 #include "MPIType.h"
 #include "SpDefs.h"
+#include "MemoryTracker.h"
 #include "psort/psort.h"
 
 namespace combblas {
@@ -70,7 +74,30 @@ public:
 
     	template<typename KEY, typename VAL, typename IT>
     	static std::vector<std::pair<KEY,VAL>> KeyValuePSort(std::pair<KEY,VAL> * array, IT length, IT * dist, const MPI_Comm & comm);
+
+	// Same contract as MemoryEfficientPSort, but a histogram-driven MSD radix sort for integer keys
+	// Non-integer keys are forwarded to MemoryEfficientPSort
+	template<typename KEY, typename VAL, typename IT>
+	static void RadixPSort(std::pair<KEY,VAL> * array, IT length, IT * dist, const MPI_Comm & comm);
 	
+	template<typename IT, typename NT>
+	static MPI_Datatype ArraysType(const Arr<IT,NT> & arrays);
+
+	template <typename T>
+	static void Alltoallv(T * sendbuf, int * sendcnt, int * sdispls, T * recvbuf, int * recvcnt, int * rdispls, const MPI_Comm & comm);
+
+	//! Exchange used by Alltoallv: A2AV_AUTO picks one from the global message statistics,
+	//! the others force it (falling back to MPI_Alltoallv where it does not apply)
+	enum AlltoallvAlgorithm { A2AV_AUTO, A2AV_MPI, A2AV_SPARSE, A2AV_KWAY, A2AV_HIERARCHICAL };
+	//! Runtime Alltoallv settings, initialized from ALLTOALLV_MIN_PROCS and ALLTOALLV_NODE_SIZE;
+	//! they must be the same on every processor that takes part in an exchange
+	static void SetAlltoallvAlgorithm(AlltoallvAlgorithm algorithm) { AlltoallvSettings().algorithm = algorithm; }
+	static void SetAlltoallvMinProcs(int minprocs) { AlltoallvSettings().minprocs = minprocs; }
+	static void SetAlltoallvNodeSize(int nodesize) { AlltoallvSettings().nodesize = nodesize; }
+	//! Frees the node/lane communicators of topologies whose communicator has been freed
+	//! (the attribute delete callback only queues them); Alltoallv also does this on entry
+	static void FreeDeferredComms();
+
 	template<typename KEY, typename VAL, typename IT>
 	static void DebugPrintKeys(std::pair<KEY,VAL> * array, IT length, IT * dist, MPI_Comm & World);
 
@@ -109,9 +136,54 @@ public:
     	static void PrintFile(const std::string & s, const std::string & filename, MPI_Comm & world);
     	static void check_newline(int *bytes_read, int bytes_requested, char *buf);
    	static bool FetchBatch(MPI_File & infile, MPI_Offset & curpos, MPI_Offset end_fpos, bool firstcall, std::vector<std::string> & lines, int myrank);
+	static void FileAccessAll(MPI_File & fh, MPI_Offset offset, void * buf, int64_t bytes, bool write, MPI_Comm comm);
+	static const char * MapFileRange(const std::string & filename, int64_t offset, int64_t length, void * & mapbase, size_t & maplength);
+	static void UnmapFileRange(void * mapbase, size_t maplength);
     
 	static void WaitNFree(std::vector<MPI_Win> & arrwin);
 	static void FreeWindows(std::vector<MPI_Win> & arrwin);
+
+private:
+	// Node layout of a communicator, cached on it as an MPI attribute
+	// Processor "local" of node "node" has rank ranks[node*nodesize+local]
+	struct AlltoallvTopology
+	{
+		MPI_Comm nodeWorld;	// processors sharing a node (MPI_COMM_NULL if the layout is unusable)
+		MPI_Comm laneWorld;	// processors with the same local rank, one per node
+		int nnodes;
+		int nodesize;
+		int requested;		// the node size setting it was built for
+		std::vector<int> ranks;
+	};
+	struct AlltoallvParams
+	{
+		AlltoallvAlgorithm algorithm;
+		int minprocs;
+		int nodesize;
+	};
+	static AlltoallvParams & AlltoallvSettings()
+	{
+		static AlltoallvParams params = {A2AV_AUTO, ALLTOALLV_MIN_PROCS, ALLTOALLV_NODE_SIZE};
+		return params;
+	}
+	static const AlltoallvTopology & GetAlltoallvTopology(const MPI_Comm & comm);
+	static int AlltoallvKeyval();
+	static int FreeAlltoallvTopology(MPI_Comm comm, int keyval, void * attr, void * extra);
+	// communicators queued by FreeAlltoallvTopology, guarded by DeferredCommsMutex()
+	static std::vector<MPI_Comm> & DeferredComms() { static std::vector<MPI_Comm> comms; return comms; }
+	static std::mutex & DeferredCommsMutex() { static std::mutex mtx; return mtx; }
+
+	template <typename T>
+	static void AlltoallvSparse(T * sendbuf, int * sendcnt, int * sdispls, T * recvbuf, int * recvcnt, int * rdispls, const MPI_Comm & comm);
+	template <typename T>
+	static void AlltoallvKway(T * sendbuf, int * sendcnt, int * sdispls, T * recvbuf, int * recvcnt, int * rdispls, const MPI_Comm & comm, int kway);
+	template <typename T>
+	static void AlltoallvHierarchical(T * sendbuf, int * sendcnt, int * sdispls, T * recvbuf, int * recvcnt, int * rdispls, const AlltoallvTopology & topo);
+
+	template<typename KEY, typename VAL, typename IT>
+	static void RadixPSort(std::pair<KEY,VAL> * array, IT length, IT * dist, const MPI_Comm & comm, std::true_type);
+	template<typename KEY, typename VAL, typename IT>
+	static void RadixPSort(std::pair<KEY,VAL> * array, IT length, IT * dist, const MPI_Comm & comm, std::false_type);
 };
 
 }
@@ -109,12 +109,14 @@ SpParMat< IT,NT,DER >::SpParMat (MPI_Comm world)
 template <class IT, class NT, class DER>
 SpParMat< IT,NT,DER >::~SpParMat ()
 {
+	FreeTranspose();
 	if(spSeq != NULL) delete spSeq;
 }
 
 template <class IT, class NT, class DER>
 void SpParMat< IT,NT,DER >::FreeMemory ()
 {
+	FreeTranspose();
 	if(spSeq != NULL) delete spSeq;
 	spSeq = NULL;
 }
@@ -308,6 +310,7 @@ template <class IT, class NT, class DER>
 template <typename VT, typename GIT>	// GIT: global index type of vector
 bool SpParMat<IT,NT,DER>::Kselect2(FullyDistVec<GIT,VT> & rvec, IT k_limit) const
 { 
+    MemoryTracker::Scope scope(MEM_KSELECT);
     if(*rvec.commGrid != *commGrid)
     {
         SpParHelper::Print("Grids are not comparable, SpParMat::Kselect() fails!", commGrid->GetWorld());
@@ -636,6 +639,7 @@ SpParMat< IT,NT,DER > & SpParMat< IT,NT,DER >::operator=(const SpParMat< IT,NT,D
 			spSeq = new DER(*(rhs.spSeq));  // Deep copy of local block
 	
 		commGrid = rhs.commGrid;
+		FreeTranspose();	// only now, as rhs may be our own T()
 	}
 	return *this;
 }
@@ -648,6 +652,7 @@ SpParMat< IT,NT,DER > & SpParMat< IT,NT,DER >::operator+=(const SpParMat< IT,NT,
 		if(*commGrid == *rhs.commGrid)	
 		{
 			(*spSeq) += (*(rhs.spSeq));
+			FreeTranspose();	// after the addition, so that A += A.T() works
 		}
 		else
 		{
@@ -703,6 +708,7 @@ template <class IT, class NT, class DER>
 template <typename _BinaryOperation>	
 void SpParMat<IT,NT,DER>::DimApply(Dim dim, const FullyDistVec<IT, NT>& x, _BinaryOperation __binary_op)
 {
+	FreeTranspose();
 
 	if(!(*commGrid == *(x.commGrid))) 		
 	{
@@ -1022,6 +1028,7 @@ template <class IT, class NT, class DER>
 template <typename VT, typename GIT>
 bool SpParMat<IT,NT,DER>::Kselect(FullyDistSpVec<GIT,VT> & kth, IT k_limit, int kselectVersion) const
 {
+	MemoryTracker::Scope scope(MEM_KSELECT);
 #ifdef COMBBLAS_DEBUG
     FullyDistVec<GIT,VT> test1(kth.getcommgrid());
     FullyDistVec<GIT,VT> test2(kth.getcommgrid());
@@ -1062,6 +1069,7 @@ template <class IT, class NT, class DER>
 template <typename VT, typename GIT>
 bool SpParMat<IT,NT,DER>::Kselect(FullyDistVec<GIT,VT> & rvec, IT k_limit, int kselectVersion) const
 {
+	MemoryTracker::Scope scope(MEM_KSELECT);
 #ifdef COMBBLAS_DEBUG
     FullyDistVec<GIT,VT> test1(rvec.getcommgrid());
     FullyDistVec<GIT,VT> test2(rvec.getcommgrid());
@@ -1093,6 +1101,7 @@ template <class IT, class NT, class DER>
 template <typename VT, typename GIT, typename _UnaryOperation>	// GIT: global index type of vector
 bool SpParMat<IT,NT,DER>::Kselect1(FullyDistVec<GIT,VT> & rvec, IT k, _UnaryOperation __unary_op) const
 {
+    MemoryTracker::Scope scope(MEM_KSELECT);
     if(*rvec.commGrid != *commGrid)
     {
         SpParHelper::Print("Grids are not comparable, SpParMat::Kselect() fails!", commGrid->GetWorld());
@@ -1315,6 +1324,8 @@ template <class IT, class NT, class DER>
 template <typename VT, typename GIT, typename _UnaryOperation>	// GIT: global index type of vector
 bool SpParMat<IT,NT,DER>::Kselect1(FullyDistSpVec<GIT,VT> & rvec, IT k, _UnaryOperation __unary_op) const
 {
+    MemoryTracker::Scope scope(MEM_KSELECT);
+    rvec.ToList();
     int myrank;
     MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
 
@@ -1396,7 +1407,7 @@ bool SpParMat<IT,NT,DER>::Kselect1(FullyDistSpVec<GIT,VT> & rvec, IT k, _UnaryOp
     //vector<VT> sendbuf(nActiveCols*k);
     //VT * sendbuf = static_cast<VT *> (::operator new (n_thiscol*k*sizeof(VT)));
     //VT * sendbuf = static_cast<VT *> (::operator new (nActiveCols*k*sizeof(VT)));
-    VT * sendbuf = static_cast<VT *> (::operator new (maxPerProcMemory));
+    VT * sendbuf = static_cast<VT *> (Arena::Allocate(maxPerProcMemory));
 
     //displacement of local columns
     //local_coldisp is the displacement of all nonzeros per column
@@ -1428,7 +1439,7 @@ bool SpParMat<IT,NT,DER>::Kselect1(FullyDistSpVec<GIT,VT> & rvec, IT k, _UnaryOp
     // a copy of local part of the matrix
     // this can be avoided if we write our own local kselect function instead of using partial_sort
     //vector<VT> localmat(local_coldisp[n_thiscol]);
-    VT * localmat = static_cast<VT *> (::operator new (local_coldisp[n_thiscol]*sizeof(VT)));
+    VT * localmat = static_cast<VT *> (Arena::Allocate(local_coldisp[n_thiscol]*sizeof(VT)));
     
     
 #ifdef THREADED
@@ -1461,7 +1472,7 @@ bool SpParMat<IT,NT,DER>::Kselect1(FullyDistSpVec<GIT,VT> & rvec, IT k, _UnaryOp
     }
     
     //vector<VT>().swap(localmat);
-    ::operator delete(localmat);
+    Arena::Deallocate(localmat);
     std::vector<IT>().swap(local_coldisp);
     
     //VT * recvbuf = static_cast<VT *> (::operator new (n_thiscol*k*sizeof(VT)));
@@ -1471,8 +1482,8 @@ bool SpParMat<IT,NT,DER>::Kselect1(FullyDistSpVec<GIT,VT> & rvec, IT k, _UnaryOp
     //VT * tempbuf = static_cast<VT *> (::operator new ( nActiveCols*k*sizeof(VT)));
     
 
-    VT * recvbuf = static_cast<VT *> (::operator new (maxPerProcMemory));
-    VT * tempbuf = static_cast<VT *> (::operator new (maxPerProcMemory));
+    VT * recvbuf = static_cast<VT *> (Arena::Allocate(maxPerProcMemory));
+    VT * tempbuf = static_cast<VT *> (Arena::Allocate(maxPerProcMemory));
     //vector<VT> recvbuf(n_thiscol*k);
     //vector<VT> tempbuf(n_thiscol*k);
     std::vector<IT> recv_coldisp(n_thiscol+1);
@@ -1632,9 +1643,9 @@ bool SpParMat<IT,NT,DER>::Kselect1(FullyDistSpVec<GIT,VT> & rvec, IT k, _UnaryOp
     delete [] activeCols;
     delete [] numacc;
     
-    ::operator delete(sendbuf);
-    ::operator delete(recvbuf);
-    ::operator delete(tempbuf);
+    Arena::Deallocate(sendbuf);
+    Arena::Deallocate(recvbuf);
+    Arena::Deallocate(tempbuf);
     //delete [] activeCols;
     //delete [] numacc;
     
@@ -1772,6 +1783,7 @@ template <class IT, class NT, class DER>
 template <typename VT, typename GIT, typename _BinaryOperation, typename _UnaryOperation>	// GIT: global index type of vector
 void SpParMat<IT,NT,DER>::MaskedReduce(FullyDistVec<GIT,VT> & rvec, FullyDistSpVec<GIT,VT> & mask, Dim dim, _BinaryOperation __binary_op, VT id, _UnaryOperation __unary_op, bool exclude) const
 {
+    mask.ToList();
     MPI_Comm World = commGrid->GetWorld();
     MPI_Comm ColWorld = commGrid->GetColWorld();
     MPI_Comm RowWorld = commGrid->GetRowWorld();
@@ -1930,6 +1942,7 @@ template <class IT, class NT, class DER>
 template <typename PTNTBOOL, typename PTBOOLNT>
 SpParMat<IT,NT,DER> SpParMat<IT,NT,DER>::SubsRef_SR (const FullyDistVec<IT,IT> & ri, const FullyDistVec<IT,IT> & ci, bool inplace)
 {
+	if(inplace) FreeTranspose();
 	typedef typename DER::LocalIT LIT;
 
 	// infer the concrete type SpMat<LIT,LIT>
@@ -1956,6 +1969,26 @@ SpParMat<IT,NT,DER> SpParMat<IT,NT,DER>::SubsRef_SR (const FullyDistVec<IT,IT> &
 		throw outofrangeexception();
 	}
 
+	// Permutations (the common case: reorderings, matchings) are applied directly, with a single all-to-all of the nonzeros
+	// That only equals the products when the semirings just select (copy) the values, as the default ones do
+	if(IsSelectionSRing<PTNTBOOL, PTBOOLNT>() && ri.TotalLength() == totalm && ci.TotalLength() == totaln)
+	{
+		std::vector<IT> newrows, newcols;
+		bool rowperm = PermutationMap(ri, Row, newrows);
+		bool colperm = PermutationMap(ci, Column, newcols);
+		if(rowperm && colperm)
+		{
+			if(inplace)
+			{
+				PermuteInto(newrows, newcols, *this);
+				return SpParMat<IT,NT,DER>(commGrid);	// dummy return to match signature
+			}
+			SpParMat<IT,NT,DER> B(commGrid);
+			PermuteInto(newrows, newcols, B);
+			return B;
+		}
+	}
+
 	// The indices for FullyDistVec are offset'd to 1/p pieces
 	// The matrix indices are offset'd to 1/sqrt(p) pieces
 	// Add the corresponding offset before sending the data 
@@ -2163,6 +2196,7 @@ SpParMat<IT, NT, DER>::SubsRef_SR (
 	bool inplace
 	)
 {
+	if(inplace) FreeTranspose();
 	typedef typename DER::LocalIT LIT;
 	typedef typename create_trait<DER, LIT, bool>::T_inferred DER_IT;
 
@@ -2217,6 +2251,36 @@ SpParMat<IT, NT, DER>::SubsRef_SR (
 		break;
 	}
 
+	// Permutations are applied directly, with a single all-to-all of the nonzeros (the other dimension is untouched)
+	// when the semirings just select the values
+	if(IsSelectionSRing<PTNTBOOL, PTBOOLNT>() && v.TotalLength() == ((dim == Row)? totalm : totaln))
+	{
+		std::vector<IT> newrows, newcols;
+		bool isperm = PermutationMap(v, dim, (dim == Row)? newrows : newcols);
+		if(isperm)
+		{
+			IT rowoffset, coloffset;
+			GetPlaceInGlobalGrid(rowoffset, coloffset);
+			if(dim == Row)
+			{
+				newcols.resize(getlocalcols());
+				std::iota(newcols.begin(), newcols.end(), coloffset);
+			}
+			else
+			{
+				newrows.resize(getlocalrows());
+				std::iota(newrows.begin(), newrows.end(), rowoffset);
+			}
+			if(inplace)
+			{
+				PermuteInto(newrows, newcols, *this);
+				return SpParMat<IT,NT,DER>(commGrid);	// dummy return to match signature
+			}
+			SpParMat<IT,NT,DER> B(commGrid);
+			PermuteInto(newrows, newcols, B);
+			return B;
+		}
+	}
 
 	// find owner processes and fill in the vectors
 	std::vector<std::vector<IT>> rowid(rowneighs);
@@ -2326,9 +2390,443 @@ SpParMat<IT, NT, DER>::SubsRef_SR (
 								   
 
 
+/**
+ * For each local row (dim == Row) or column (dim == Column), the global index it moves to under A(perm,:) or A(:,perm)
+ * The owner of perm[i] sends (old local index, i) to one processor of the block holding perm[i], 
+ * which then shares what it has received with the rest of the processor row (column)
+ * @returns true iff perm is a permutation, i.e. every row (column) is hit exactly once, on all processors
+ */
+template <class IT, class NT, class DER>
+bool SpParMat<IT,NT,DER>::PermutationMap(const FullyDistVec<IT,IT> & perm, Dim dim, std::vector<IT> & newind) const
+{
+	bool rows = (dim == Row);
+	IT total = perm.TotalLength();
+	int nblocks = rows? commGrid->GetGridRows() : commGrid->GetGridCols();
+	int blockneighs = rows? commGrid->GetGridCols() : commGrid->GetGridRows();	// processors sharing the same block
+	MPI_Comm blockworld = rows? commGrid->GetRowWorld() : commGrid->GetColWorld();
+	IT perblock = total / nblocks;
+	int nprocs = commGrid->GetSize();
+
+	IT offset = perm.LengthUntil();
+	IT locsize = perm.LocArrSize();
+	std::vector<int> dest(locsize);
+	std::vector<IT> oldlocal(locsize);
+	std::vector<int> sendcnt(nprocs, 0);
+	for(IT i=0; i < locsize; ++i)
+	{
+		if(perm.arr[i] < 0 || perm.arr[i] >= total)	// out of range; the index it should have hit is reported missing
+		{
+			dest[i] = -1;
+			continue;
+		}
+		int block = (perblock != 0)? std::min(static_cast<int>(perm.arr[i] / perblock), nblocks-1) : (nblocks-1);
+		oldlocal[i] = perm.arr[i] - block * perblock;
+		int neigh = static_cast<int>(oldlocal[i] % blockneighs);	// spread each block's share over its processors
+		dest[i] = rows? commGrid->GetRank(block, neigh) : commGrid->GetRank(neigh, block);
+		++sendcnt[dest[i]];
+	}
+	std::vector<int> recvcnt(nprocs);
+	MPI_Alltoall(sendcnt.data(), 1, MPI_INT, recvcnt.data(), 1, MPI_INT, commGrid->GetWorld());
+	std::vector<int> sdispls(nprocs, 0);
+	std::vector<int> rdispls(nprocs, 0);
+	std::partial_sum(sendcnt.begin(), sendcnt.end()-1, sdispls.begin()+1);
+	std::partial_sum(recvcnt.begin(), recvcnt.end()-1, rdispls.begin()+1);
+	int totrecv = rdispls[nprocs-1] + recvcnt[nprocs-1];
+
+	std::vector< std::pair<IT,IT> > senddata(locsize);
+	std::vector<int> cursor(sdispls);
+	for(IT i=0; i < locsize; ++i)
+		if(dest[i] >= 0)	senddata[cursor[dest[i]]++] = std::make_pair(oldlocal[i], offset + i);
+	std::vector<int>().swap(dest);
+	std::vector<IT>().swap(oldlocal);
+	std::vector< std::pair<IT,IT> > recvdata(totrecv);
+	SpParHelper::Alltoallv(senddata.data(), sendcnt.data(), sdispls.data(), recvdata.data(), recvcnt.data(), rdispls.data(), commGrid->GetWorld());
+	std::vector< std::pair<IT,IT> >().swap(senddata);
+
+	std::vector<int> blockcnt(blockneighs);
+	std::vector<int> blockdispls(blockneighs, 0);
+	MPI_Allgather(&totrecv, 1, MPI_INT, blockcnt.data(), 1, MPI_INT, blockworld);
+	std::partial_sum(blockcnt.begin(), blockcnt.end()-1, blockdispls.begin()+1);
+	std::vector< std::pair<IT,IT> > blockdata(blockdispls[blockneighs-1] + blockcnt[blockneighs-1]);
+	MPI_Allgatherv(recvdata.data(), totrecv, MPIType< std::pair<IT,IT> >(), blockdata.data(), blockcnt.data(), blockdispls.data(), MPIType< std::pair<IT,IT> >(), blockworld);
+
+	newind.resize(rows? getlocalrows() : getlocalcols());
+	std::vector<bool> hit(newind.size(), false);
+	int bijective = static_cast<int>(blockdata.size() == newind.size());
+	for(typename std::vector< std::pair<IT,IT> >::size_type i=0; bijective && i < blockdata.size(); ++i)
+	{
+		if(hit[blockdata[i].first])
+		{
+			bijective = 0;	
+		}
+		else
+		{
+			hit[blockdata[i].first] = true;
+			newind[blockdata[i].first] = blockdata[i].second;
+		}
+	}
+	int allbijective;
+	MPI_Allreduce(&bijective, &allbijective, 1, MPI_INT, MPI_LAND, commGrid->GetWorld());
+	return static_cast<bool>(allbijective);
+}
+
+/**
+ * The local nonzeros are relabeled with their new global indices and sent to their new owners in one all-to-all,
+ * so the cost is about that of a transpose, regardless of how scattered the permutation is
+ * \pre{ri and ci are permutations of 0..m-1 and 0..n-1 respectively}
+ */
+template <class IT, class NT, class DER>
+void SpParMat<IT,NT,DER>::Permute(const FullyDistVec<IT,IT> & ri, const FullyDistVec<IT,IT> & ci)
+{
+	if((*(ri.commGrid) != *(commGrid)) || (*(ci.commGrid) != *(commGrid)))
+	{
+		SpParHelper::Print("Grids are not comparable, Permute fails !\n"); 
+		MPI_Abort(MPI_COMM_WORLD, GRIDMISMATCH);
+	}
+	if(ri.TotalLength() != getnrow() || ci.TotalLength() != getncol())
+	{
+		SpParHelper::Print("Permutation lengths do not match the matrix dimensions, Permute fails !\n"); 
+		MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+	}
+	std::vector<IT> newrows, newcols;
+	bool rowperm = PermutationMap(ri, Row, newrows);
+	bool colperm = PermutationMap(ci, Column, newcols);
+	if(!rowperm || !colperm)
+	{
+		SpParHelper::Print("Index vectors are not permutations, Permute fails !\n"); 
+		MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+	}
+	PermuteInto(newrows, newcols, *this);
+}
+
+/**
+ * B gets the local nonzero (i,j) of *this at global position (newrows[i], newcols[j]), with a single all-to-all
+ * B can be *this itself, in which case the old local matrix is freed as soon as it is packed
+ * \pre{newrows and newcols are maps returned by PermutationMap (or identities), so there are no duplicates}
+ */
+template <class IT, class NT, class DER>
+void SpParMat<IT,NT,DER>::PermuteInto(const std::vector<IT> & newrows, const std::vector<IT> & newcols, SpParMat<IT,NT,DER> & B)
+{
+	typedef typename DER::LocalIT LIT;
+	IT total_m = getnrow();
+	IT total_n = getncol();
+	int nprocs = commGrid->GetSize();
+
+	// two passes over the local matrix (count, then fill) pack the send buffer in place, without per-processor vectors
+	std::vector<int> sendcnt(nprocs, 0);
+	for(typename DER::SpColIter colit = spSeq->begcol(); colit != spSeq->endcol(); ++colit)
+	{
+		for(typename DER::SpColIter::NzIter nzit = spSeq->begnz(colit); nzit != spSeq->endnz(colit); ++nzit)
+		{
+			LIT lrow, lcol;
+			++sendcnt[Owner(total_m, total_n, newrows[nzit.rowid()], newcols[colit.colid()], lrow, lcol)];
+		}
+	}
+	std::vector<int> cursor(nprocs, 0);
+	std::partial_sum(sendcnt.begin(), sendcnt.end()-1, cursor.begin()+1);
+	std::tuple<LIT,LIT,NT> * senddata = new std::tuple<LIT,LIT,NT>[spSeq->getnnz()];
+	for(typename DER::SpColIter colit = spSeq->begcol(); colit != spSeq->endcol(); ++colit)
+	{
+		for(typename DER::SpColIter::NzIter nzit = spSeq->begnz(colit); nzit != spSeq->endnz(colit); ++nzit)
+		{
+			LIT lrow, lcol;
+			int owner = Owner(total_m, total_n, newrows[nzit.rowid()], newcols[colit.colid()], lrow, lcol);
+			senddata[cursor[owner]++] = std::make_tuple(lrow, lcol, nzit.value());
+		}
+	}
+	if(&B == this)
+		FreeTranspose();
+	delete B.spSeq;	// the old local matrix, if B is *this
+	B.spSeq = NULL;
+	B.SparseCommon(senddata, sendcnt, total_m, total_n, std::plus<NT>());	// a permutation creates no duplicates
+}
+
+/**
+ * Local matrix of this processor from (local) tuples in arbitrary order; frees tuples
+ * Duplicates are combined with BinOp in the order in which they appear in tuples, so the result does not
+ * depend on the number of threads. A threaded counting sort on columns (every thread counts a contiguous 
+ * range of the input and scatters it in order), followed by stable sorting and merging the rows of every 
+ * column independently, takes O(nnz + ncol) time; hypersparse blocks (ncol > nnz) are sorted by comparison 
+ * instead, where the O(ncol) count arrays would dominate
+ */
+template <class IT, class NT, class DER>
+template <typename LIT, typename _BinaryOperation>
+DER * SpParMat<IT,NT,DER>::BlockFromTuples(std::tuple<LIT,LIT,NT> * tuples, LIT nnz, IT total_m, IT total_n, _BinaryOperation BinOp) const
+{
+	int r = commGrid->GetGridRows();
+	int s = commGrid->GetGridCols();
+	IT m_perproc = total_m / r;
+	IT n_perproc = total_n / s;
+	int myprocrow = commGrid->GetRankInProcCol();
+	int myproccol = commGrid->GetRankInProcRow();
+	LIT locrows = (myprocrow != r-1)? m_perproc : (total_m - myprocrow * m_perproc);
+	LIT loccols = (myproccol != s-1)? n_perproc : (total_n - myproccol * n_perproc);
+
+	// moves the distinct rows of [first,last), sorted by row, to its front; returns their number
+	auto mergerows = [&BinOp](std::tuple<LIT,LIT,NT> * first, std::tuple<LIT,LIT,NT> * last)
+	{
+		std::tuple<LIT,LIT,NT> * out = first;
+		for(std::tuple<LIT,LIT,NT> * it = first+1; it < last; ++it)
+		{
+			if(std::get<0>(*it) == std::get<0>(*out))
+				std::get<2>(*out) = BinOp(std::get<2>(*out), std::get<2>(*it));
+			else
+				*(++out) = *it;
+		}
+		return static_cast<LIT>(out - first) + 1;
+	};
+
+	if(loccols > nnz)
+	{
+		if(nnz == 0)
+		{
+			delete [] tuples;
+			return new DER(SpTuples<LIT,NT>(0, locrows, loccols), false);
+		}
+		std::stable_sort(tuples, tuples+nnz, [](const std::tuple<LIT,LIT,NT> & a, const std::tuple<LIT,LIT,NT> & b)
+			{ return std::get<1>(a) < std::get<1>(b) || (std::get<1>(a) == std::get<1>(b) && std::get<0>(a) < std::get<0>(b)); });
+		LIT distinct = 0;
+		for(LIT i=0; i < nnz; )
+		{
+			LIT j = i+1;
+			while(j < nnz && std::get<1>(tuples[j]) == std::get<1>(tuples[i]))	++j;
+			LIT colnnz = mergerows(tuples+i, tuples+j);
+			std::copy(tuples+i, tuples+i+colnnz, tuples+distinct);
+			distinct += colnnz;
+			i = j;
+		}
+		SpTuples<LIT,NT> A(distinct, locrows, loccols, tuples, true);	// column sorted; it is ~SpTuples's job to deallocate
+		return new DER(A, false);
+	}
+
+	std::vector<LIT> colptr(loccols+1, 0);
+	std::vector<LIT> cursor(loccols);
+	std::tuple<LIT,LIT,NT> * sorted = new std::tuple<LIT,LIT,NT>[nnz];
+	std::vector<LIT> tcounts;	// tcounts[t*loccols+j]: entries of column j in the range of thread t, then its first slot
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		int nthreads = 1;
+		int t = 0;
+#ifdef _OPENMP
+		nthreads = omp_get_num_threads();
+		t = omp_get_thread_num();
+#endif
+#ifdef _OPENMP
+#pragma omp single
+#endif
+		tcounts.assign(static_cast<size_t>(nthreads) * loccols, 0);	// implicit barrier
+
+		LIT begin = static_cast<LIT>(static_cast<int64_t>(nnz) * t / nthreads);
+		LIT end = static_cast<LIT>(static_cast<int64_t>(nnz) * (t+1) / nthreads);
+		LIT * mycounts = tcounts.data() + static_cast<size_t>(t) * loccols;
+		for(LIT i=begin; i < end; ++i)
+			++mycounts[std::get<1>(tuples[i])];
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp for
+#endif
+		for(LIT j=0; j < loccols; ++j)	// column j gets the entries of threads 0,1,... in this order
+		{
+			LIT cnt = 0;
+			for(int u=0; u < nthreads; ++u)
+			{
+				LIT c = tcounts[static_cast<size_t>(u) * loccols + j];
+				tcounts[static_cast<size_t>(u) * loccols + j] = cnt;
+				cnt += c;
+			}
+			colptr[j+1] = cnt;
+		}
+#ifdef _OPENMP
+#pragma omp single
+#endif
+		for(LIT j=0; j < loccols; ++j)
+			colptr[j+1] += colptr[j];
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for(LIT j=0; j < loccols; ++j)
+			for(int u=0; u < nthreads; ++u)
+				tcounts[static_cast<size_t>(u) * loccols + j] += colptr[j];
+
+		for(LIT i=begin; i < end; ++i)	// in input order
+			sorted[mycounts[std::get<1>(tuples[i])]++] = tuples[i];
+	}
+	std::vector<LIT>().swap(tcounts);
+	delete [] tuples;
+
+	// cursor holds the number of distinct entries of every column, which are moved to its front
+	// the sort is stable, so duplicates keep their input order
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+	for(LIT j=0; j < loccols; ++j)
+	{
+		std::tuple<LIT,LIT,NT> * first = sorted + colptr[j];
+		std::tuple<LIT,LIT,NT> * last = sorted + colptr[j+1];
+		cursor[j] = 0;
+		if(first == last)	continue;
+		std::stable_sort(first, last, [](const std::tuple<LIT,LIT,NT> & a, const std::tuple<LIT,LIT,NT> & b)
+			{ return std::get<0>(a) < std::get<0>(b); });
+		cursor[j] = mergerows(first, last);
+	}
+	return AssembleBlock(sorted, colptr, cursor, locrows, loccols, std::is_same< DER, SpDCCols<LIT,NT> >());
+}
+
+/**
+ * DCSC block straight from column buckets: the distinct entries of column j are the first 
+ * colnnz[j] tuples of sorted[colptr[j]..colptr[j+1]), in increasing row order; frees sorted
+ */
+template <class IT, class NT, class DER>
+template <typename LIT>
+DER * SpParMat<IT,NT,DER>::AssembleBlock(std::tuple<LIT,LIT,NT> * sorted, const std::vector<LIT> & colptr, const std::vector<LIT> & colnnz, 
+					LIT locrows, LIT loccols, std::true_type) const
+{
+	LIT nzc = 0;
+	LIT nz = 0;
+	for(LIT j=0; j < loccols; ++j)
+	{
+		if(colnnz[j] > 0)	++nzc;
+		nz += colnnz[j];
+	}
+	if(nz == 0)
+	{
+		delete [] sorted;
+		return new DER(locrows, loccols, static_cast< Dcsc<LIT,NT>* >(NULL));
+	}
+	Dcsc<LIT,NT> * dcsc = new Dcsc<LIT,NT>(nz, nzc);
+	LIT k = 0;
+	dcsc->cp[0] = 0;
+	for(LIT j=0; j < loccols; ++j)
+	{
+		if(colnnz[j] > 0)
+		{
+			dcsc->jc[k] = j;
+			dcsc->cp[k+1] = dcsc->cp[k] + colnnz[j];
+			++k;
+		}
+	}
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+	for(LIT i=0; i < nzc; ++i)
+	{
+		const std::tuple<LIT,LIT,NT> * col = sorted + colptr[dcsc->jc[i]];
+		for(LIT l=0; l < dcsc->cp[i+1] - dcsc->cp[i]; ++l)
+		{
+			dcsc->ir[dcsc->cp[i] + l] = std::get<0>(col[l]);
+			dcsc->numx[dcsc->cp[i] + l] = std::get<2>(col[l]);
+		}
+	}
+	delete [] sorted;
+	return new DER(locrows, loccols, dcsc);
+}
+
+//! Any other local matrix type is converted from column sorted tuples
+template <class IT, class NT, class DER>
+template <typename LIT>
+DER * SpParMat<IT,NT,DER>::AssembleBlock(std::tuple<LIT,LIT,NT> * sorted, const std::vector<LIT> & colptr, const std::vector<LIT> & colnnz, 
+					LIT locrows, LIT loccols, std::false_type) const
+{
+	std::vector<LIT> newptr(loccols+1, 0);
+	std::partial_sum(colnnz.begin(), colnnz.end(), newptr.begin()+1);
+	std::tuple<LIT,LIT,NT> * packed = new std::tuple<LIT,LIT,NT>[newptr[loccols]];
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic, 64)
+#endif
+	for(LIT j=0; j < loccols; ++j)
+		std::copy(sorted + colptr[j], sorted + colptr[j] + colnnz[j], packed + newptr[j]);
+	delete [] sorted;
+	SpTuples<LIT,NT> A(newptr[loccols], locrows, loccols, packed, true);	// already column sorted
+	return new DER(A, false);
+}
+
+/**
+ * Permutation that deals the vertices, in decreasing order of degree, to the nblocks blocks of the 
+ * distribution in serpentine order (0,1,...,nblocks-1,nblocks-1,...,0,0,...), so every block gets its share of the hubs
+ * @returns perm such that the new index j is the old index perm[j]
+ */
+template <class IT, class NT, class DER>
+FullyDistVec<IT,IT> SpParMat<IT,NT,DER>::HubSpreadingPerm(const FullyDistVec<IT,IT> & degrees, int nblocks) const
+{
+	IT n = degrees.TotalLength();
+	FullyDistVec<IT,IT> sorted(degrees);
+	FullyDistVec<IT,IT> order = sorted.sort();	// order[k] is the vertex with the kth smallest degree
+
+	// rank (in decreasing degree) of the vertex that the new index j receives
+	// the first perblock*nblocks ranks are dealt, the remaining ones stay at the end of the last block
+	IT perblock = n / nblocks;
+	FullyDistVec<IT,IT> ranks(commGrid, n, 0);
+	IT offset = ranks.LengthUntil();
+	for(IT i=0; i < ranks.LocArrSize(); ++i)
+	{
+		IT j = offset + i;
+		IT k = j;
+		if(j < perblock * nblocks)
+		{
+			IT block = j / perblock;
+			IT round = j % perblock;
+			k = round * nblocks + ((round % 2 == 0)? block : (nblocks-1-block));
+		}
+		ranks.arr[i] = n-1-k;
+	}
+	return order(ranks);
+}
+
+/**
+ * Random permutations break the correlation between vertex ids and degrees that skewed inputs often have
+ * The degree-aware permutation also spreads the hubs (by nnz of their row and column) evenly over processor rows and columns
+ * Vectors follow the same permutations: if y = A*x, then y(rowperm) = A_new * x(colperm)
+ */
+template <class IT, class NT, class DER>
+void SpParMat<IT,NT,DER>::BalancePermute(FullyDistVec<IT,IT> & rowperm, FullyDistVec<IT,IT> & colperm, bool degreeaware)
+{
+	IT total_m = getnrow();
+	IT total_n = getncol();
+	bool symmetric = (total_m == total_n);
+	if(degreeaware)
+	{
+		FullyDistVec<IT,IT> rowdeg(commGrid);
+		FullyDistVec<IT,IT> coldeg(commGrid);
+		Reduce(rowdeg, Row, std::plus<IT>(), static_cast<IT>(0), [](NT x){ return static_cast<IT>(1); });
+		Reduce(coldeg, Column, std::plus<IT>(), static_cast<IT>(0), [](NT x){ return static_cast<IT>(1); });
+		if(symmetric)
+		{
+			rowdeg += coldeg;
+			rowperm = HubSpreadingPerm(rowdeg, commGrid->GetGridRows());
+			colperm = rowperm;
+		}
+		else
+		{
+			rowperm = HubSpreadingPerm(rowdeg, commGrid->GetGridRows());
+			colperm = HubSpreadingPerm(coldeg, commGrid->GetGridCols());
+		}
+	}
+	else
+	{
+		rowperm = FullyDistVec<IT,IT>(commGrid);
+		rowperm.iota(total_m, 0);
+		rowperm.RandPerm();
+		if(symmetric)
+		{
+			colperm = rowperm;
+		}
+		else
+		{
+			colperm = FullyDistVec<IT,IT>(commGrid);
+			colperm.iota(total_n, 0);
+			colperm.RandPerm();
+		}
+	}
+	Permute(rowperm, colperm);
+}
+
+
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::SpAsgn(const FullyDistVec<IT,IT> & ri, const FullyDistVec<IT,IT> & ci, SpParMat<IT,NT,DER> & B)
 {
+	FreeTranspose();
 	typedef PlusTimesSRing<NT, NT> PTRing;
 	
 	if((*(ri.commGrid) != *(B.commGrid)) || (*(ci.commGrid) != *(B.commGrid)))
@@ -2372,6 +2870,7 @@ void SpParMat<IT,NT,DER>::SpAsgn(const FullyDistVec<IT,IT> & ri, const FullyDist
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::Prune(const FullyDistVec<IT,IT> & ri, const FullyDistVec<IT,IT> & ci)
 {
+	FreeTranspose();
 	typedef PlusTimesSRing<NT, NT> PTRing;
 
 	if((*(ri.commGrid) != *(commGrid)) || (*(ci.commGrid) != *(commGrid)))
@@ -2408,6 +2907,7 @@ template <class IT, class NT, class DER>
 template <typename _BinaryOperation>
 SpParMat<IT,NT,DER> SpParMat<IT,NT,DER>::PruneColumn(const FullyDistVec<IT,NT> & pvals, _BinaryOperation __binary_op, bool inPlace)
 {
+	if(inPlace) FreeTranspose();
     int myrank;
     MPI_Comm_rank(MPI_COMM_WORLD,&myrank);
     //MPI_Barrier(MPI_COMM_WORLD);
@@ -2493,6 +2993,8 @@ template <class IT, class NT, class DER>
 template <typename _BinaryOperation>
 SpParMat<IT,NT,DER> SpParMat<IT,NT,DER>::PruneColumn(const FullyDistSpVec<IT,NT> & pvals, _BinaryOperation __binary_op, bool inPlace)
 {
+	if(inPlace) FreeTranspose();
+    pvals.ToList();
     //MPI_Barrier(MPI_COMM_WORLD);
     MPI_Comm World = pvals.commGrid->GetWorld();
     MPI_Barrier(World);
@@ -2567,6 +3069,7 @@ void SpParMat<IT,NT,DER>::EWiseMult (const SpParMat< IT,NT,DER >  & rhs, bool ex
 	if(*commGrid == *rhs.commGrid)	
 	{
 		spSeq->EWiseMult(*(rhs.spSeq), exclude);		// Dimension compatibility check performed by sequential function
+		FreeTranspose();	// rhs may be our own T()
 	}
 	else
 	{
@@ -2579,6 +3082,7 @@ void SpParMat<IT,NT,DER>::EWiseMult (const SpParMat< IT,NT,DER >  & rhs, bool ex
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::EWiseScale(const DenseParMat<IT, NT> & rhs)
 {
+	FreeTranspose();
 	if(*commGrid == *rhs.commGrid)	
 	{
 		spSeq->EWiseScale(rhs.array, rhs.m, rhs.n);	// Dimension compatibility check performed by sequential function
@@ -2650,84 +3154,154 @@ bool SpParMat<IT,NT,DER>::operator== (const SpParMat<IT,NT,DER> & rhs) const
 /**
  ** Private function that carries code common to different sparse() constructors
  ** Before this call, commGrid is already set
+ ** data[i] holds the (local) tuples destined to processor i; it is cleared as it is packed
  **/
 template <class IT, class NT, class DER>
 template <typename _BinaryOperation, typename LIT>
 void SpParMat< IT,NT,DER >::SparseCommon(std::vector< std::vector < std::tuple<LIT,LIT,NT> > > & data, LIT locsize, IT total_m, IT total_n, _BinaryOperation BinOp)
-//void SpParMat< IT,NT,DER >::SparseCommon(std::vector< std::vector < std::tuple<typename DER::LocalIT,typename DER::LocalIT,NT> > > & data, typename DER::LocalIT locsize, IT total_m, IT total_n, _BinaryOperation BinOp)
 {
-    //typedef typename DER::LocalIT LIT;
 	int nprocs = commGrid->GetSize();
-	int * sendcnt = new int[nprocs];
-	int * recvcnt = new int[nprocs];
+	std::vector<int> sendcnt(nprocs);
 	for(int i=0; i<nprocs; ++i)
-		sendcnt[i] = data[i].size();	// sizes are all the same
-
-	MPI_Alltoall(sendcnt, 1, MPI_INT, recvcnt, 1, MPI_INT, commGrid->GetWorld()); // share the counts
-	int * sdispls = new int[nprocs]();
-	int * rdispls = new int[nprocs]();
-	std::partial_sum(sendcnt, sendcnt+nprocs-1, sdispls+1);
-	std::partial_sum(recvcnt, recvcnt+nprocs-1, rdispls+1);
-	IT totrecv = std::accumulate(recvcnt,recvcnt+nprocs, static_cast<IT>(0));
-	IT totsent = std::accumulate(sendcnt,sendcnt+nprocs, static_cast<IT>(0));	
-	
-	assert((totsent < std::numeric_limits<int>::max()));	
-	assert((totrecv < std::numeric_limits<int>::max()));
-	
-
-#if 0 
-	ofstream oput;
-        commGrid->OpenDebugFile("Displacements", oput);
-	copy(sdispls, sdispls+nprocs, ostream_iterator<int>(oput, " "));   oput << endl;
-	copy(rdispls, rdispls+nprocs, ostream_iterator<int>(oput, " "));   oput << endl;
-	oput.close();
-	
-	IT * gsizes;
-	if(commGrid->GetRank() == 0) gsizes = new IT[nprocs];
-    	MPI_Gather(&totrecv, 1, MPIType<IT>(), gsizes, 1, MPIType<IT>(), 0, commGrid->GetWorld());
-	if(commGrid->GetRank() == 0) { std::copy(gsizes, gsizes+nprocs, std::ostream_iterator<IT>(std::cout, " "));   std::cout << std::endl; }
-	MPI_Barrier(commGrid->GetWorld());
-    	MPI_Gather(&totsent, 1, MPIType<IT>(), gsizes, 1, MPIType<IT>(), 0, commGrid->GetWorld());
-	if(commGrid->GetRank() == 0) { copy(gsizes, gsizes+nprocs, ostream_iterator<IT>(cout, " "));   cout << endl; }
-	MPI_Barrier(commGrid->GetWorld());
-	if(commGrid->GetRank() == 0) delete [] gsizes;
-#endif
+		sendcnt[i] = data[i].size();
 
-  	std::tuple<LIT,LIT,NT> * senddata = new std::tuple<LIT,LIT,NT>[locsize];	// re-used for both rows and columns
+  	std::tuple<LIT,LIT,NT> * senddata = new std::tuple<LIT,LIT,NT>[locsize];
+	LIT sdispl = 0;
 	for(int i=0; i<nprocs; ++i)
 	{
-		std::copy(data[i].begin(), data[i].end(), senddata+sdispls[i]);
-		data[i].clear();	// clear memory
-		data[i].shrink_to_fit();
+		std::copy(data[i].begin(), data[i].end(), senddata+sdispl);
+		sdispl += sendcnt[i];
+		std::vector< std::tuple<LIT,LIT,NT> >().swap(data[i]);	// clear memory
 	}
-	MPI_Datatype MPI_triple;
-	MPI_Type_contiguous(sizeof(std::tuple<LIT,LIT,NT>), MPI_CHAR, &MPI_triple);
-	MPI_Type_commit(&MPI_triple);
+	SparseCommon(senddata, sendcnt, total_m, total_n, BinOp);
+}
+
+/**
+ ** Exchanges a contiguous send buffer, packed by destination processor (sendcnt[i] tuples to processor i),
+ ** and builds the local matrix out of what is received, combining duplicates with BinOp; frees senddata
+ **/
+template <class IT, class NT, class DER>
+template <typename _BinaryOperation, typename LIT>
+void SpParMat< IT,NT,DER >::SparseCommon(std::tuple<LIT,LIT,NT> * senddata, std::vector<int> & sendcnt, IT total_m, IT total_n, _BinaryOperation BinOp)
+{
+	FreeTranspose();
+	int nprocs = commGrid->GetSize();
+	std::vector<int> recvcnt(nprocs);
+	MPI_Alltoall(sendcnt.data(), 1, MPI_INT, recvcnt.data(), 1, MPI_INT, commGrid->GetWorld()); // share the counts
+	std::vector<int> sdispls(nprocs, 0);
+	std::vector<int> rdispls(nprocs, 0);
+	std::partial_sum(sendcnt.begin(), sendcnt.end()-1, sdispls.begin()+1);
+	std::partial_sum(recvcnt.begin(), recvcnt.end()-1, rdispls.begin()+1);
+	IT totrecv = std::accumulate(recvcnt.begin(), recvcnt.end(), static_cast<IT>(0));
 
 	std::tuple<LIT,LIT,NT> * recvdata = new std::tuple<LIT,LIT,NT>[totrecv];	
-	MPI_Alltoallv(senddata, sendcnt, sdispls, MPI_triple, recvdata, recvcnt, rdispls, MPI_triple, commGrid->GetWorld());
+	SpParHelper::Alltoallv(senddata, sendcnt.data(), sdispls.data(), recvdata, recvcnt.data(), rdispls.data(), commGrid->GetWorld());
+	delete [] senddata;
 
-	DeleteAll(senddata, sendcnt, recvcnt, sdispls, rdispls);
-	MPI_Type_free(&MPI_triple);
+	spSeq = BlockFromTuples(recvdata, static_cast<LIT>(totrecv), total_m, total_n, BinOp);	// frees recvdata
+}
 
-	int r = commGrid->GetGridRows();
-	int s = commGrid->GetGridCols();
-	IT m_perproc = total_m / r;
-	IT n_perproc = total_n / s;
-	int myprocrow = commGrid->GetRankInProcCol();
-	int myproccol = commGrid->GetRankInProcRow();
-	IT locrows, loccols; 
-	if(myprocrow != r-1)	locrows = m_perproc;
-	else 	locrows = total_m - myprocrow * m_perproc;
-	if(myproccol != s-1)	loccols = n_perproc;
-	else	loccols = total_n - myproccol * n_perproc;
-    
-	SpTuples<LIT,NT> A(totrecv, locrows, loccols, recvdata);	// It is ~SpTuples's job to deallocate
-	
-    	// the previous constructor sorts based on columns-first (but that doesn't matter as long as they are sorted one way or another)
-    	A.RemoveDuplicates(BinOp);
-	
-  	spSeq = new DER(A,false);        // Convert SpTuples to DER
+/**
+ ** Contiguous send buffer for the tuples (rows[i], cols[i], valof(i)), packed by owner processor
+ ** @param[out] sendcnt number of tuples destined to each processor
+ **/
+template <class IT, class NT, class DER>
+template <typename LIT, typename _ValueOperation>
+std::tuple<LIT,LIT,NT> * SpParMat< IT,NT,DER >::PackByOwner(const std::vector<IT> & rows, const std::vector<IT> & cols, _ValueOperation valof, 
+								IT total_m, IT total_n, std::vector<int> & sendcnt) const
+{
+	return PackByOwner<LIT>(static_cast<IT>(rows.size()), [&rows, &cols](IT i){ return std::make_pair(rows[i], cols[i]); }, valof, total_m, total_n, sendcnt);
+}
+
+/**
+ ** Contiguous send buffer for the tuples (indof(i).first, indof(i).second, valof(i)) for i < locsize, packed by owner processor
+ ** Every thread counts, then fills, its own contiguous share of the input, so the packing preserves the input order
+ ** indof is called twice per tuple and valof once, so they can decode the input in place
+ ** Tuples whose row and column are both -1 (such as a deleted edge) are dropped; any other index outside 
+ ** the matrix is an error
+ ** @param[out] sendcnt number of tuples destined to each processor
+ **/
+template <class IT, class NT, class DER>
+template <typename LIT, typename _IndexOperation, typename _ValueOperation>
+std::tuple<LIT,LIT,NT> * SpParMat< IT,NT,DER >::PackByOwner(IT locsize, _IndexOperation indof, _ValueOperation valof, 
+								IT total_m, IT total_n, std::vector<int> & sendcnt) const
+{
+	int nprocs = commGrid->GetSize();
+	std::vector< std::vector<int> > tcounts;	// tcounts[t][i]: from thread t to processor i
+	std::tuple<LIT,LIT,NT> * senddata = new std::tuple<LIT,LIT,NT>[locsize];
+	sendcnt.assign(nprocs, 0);
+	IT badindex = locsize;	// smallest i with an index out of range
+	const IT deleted = static_cast<IT>(-1);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		int nthreads = 1;
+		int t = 0;
+#ifdef _OPENMP
+		nthreads = omp_get_num_threads();
+		t = omp_get_thread_num();
+#endif
+#ifdef _OPENMP
+#pragma omp single
+#endif
+		tcounts.assign(nthreads, std::vector<int>(nprocs, 0));	// implicit barrier
+
+		IT begin = locsize * t / nthreads;
+		IT end = locsize * (t+1) / nthreads;
+		std::vector<int> & mycounts = tcounts[t];
+		IT mybad = locsize;
+		for(IT i=begin; i<end; ++i)
+		{
+			LIT lrow, lcol;
+			std::pair<IT,IT> ind = indof(i);
+			if(ind.first >= 0 && ind.first < total_m && ind.second >= 0 && ind.second < total_n)
+				++mycounts[Owner(total_m, total_n, ind.first, ind.second, lrow, lcol)];
+			else if(!(ind.first == deleted && ind.second == deleted) && mybad == locsize)
+				mybad = i;
+		}
+#ifdef _OPENMP
+#pragma omp critical
+#endif
+		badindex = std::min(badindex, mybad);
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp single
+#endif
+		{
+			int displ = 0;	// exclusive scan, processor major: tcounts becomes the cursor of every thread
+			for(int p=0; p<nprocs; ++p)
+			{
+				for(int u=0; u<nthreads; ++u)
+				{
+					int cnt = tcounts[u][p];
+					tcounts[u][p] = displ;
+					displ += cnt;
+					sendcnt[p] += cnt;
+				}
+			}
+		}
+		for(IT i=begin; i<end; ++i)
+		{
+			LIT lrow, lcol;
+			std::pair<IT,IT> ind = indof(i);
+			if(ind.first >= 0 && ind.first < total_m && ind.second >= 0 && ind.second < total_n)
+			{
+				int owner = Owner(total_m, total_n, ind.first, ind.second, lrow, lcol);
+				senddata[mycounts[owner]++] = std::make_tuple(lrow, lcol, valof(i));
+			}
+		}
+	}
+	if(badindex < locsize)
+	{
+		std::pair<IT,IT> ind = indof(badindex);
+		std::ostringstream outs;
+		outs << "Processor " << commGrid->GetRank() << ": entry (" << ind.first << "," << ind.second << ") is outside the " 
+			<< total_m << "-by-" << total_n << " matrix" << std::endl;
+		std::cerr << outs.str();
+		MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+	}
+	return senddata;
 }
 
 
@@ -2748,23 +3322,16 @@ SpParMat< IT,NT,DER >::SpParMat (IT total_m, IT total_n, const FullyDistVec<IT,I
 	}
 
 	commGrid = distrows.commGrid;	
-	int nprocs = commGrid->GetSize();
-	std::vector< std::vector < std::tuple<IT,IT,NT> > > data(nprocs);
-
-	IT locsize = distrows.LocArrSize();
-	for(IT i=0; i<locsize; ++i)
-	{
-		IT lrow, lcol; 
-		int owner = Owner(total_m, total_n, distrows.arr[i], distcols.arr[i], lrow, lcol);
-		data[owner].push_back(std::make_tuple(lrow,lcol,distvals.arr[i]));	
-	}
+	typedef typename DER::LocalIT LIT;
+	std::vector<int> sendcnt;
+	std::tuple<LIT,LIT,NT> * senddata = PackByOwner<LIT>(distrows.arr, distcols.arr, [&distvals](IT i){ return distvals.arr[i]; }, total_m, total_n, sendcnt);
     if(SumDuplicates)
     {
-        SparseCommon(data, locsize, total_m, total_n, std::plus<NT>());
+        SparseCommon(senddata, sendcnt, total_m, total_n, std::plus<NT>());
     }
     else
     {
-        SparseCommon(data, locsize, total_m, total_n, maximum<NT>());
+        SparseCommon(senddata, sendcnt, total_m, total_n, maximum<NT>());
     }
 }
 
@@ -2785,23 +3352,16 @@ SpParMat< IT,NT,DER >::SpParMat (IT total_m, IT total_n, const FullyDistVec<IT,I
 		MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
 	}
 	commGrid = distrows.commGrid;
-	int nprocs = commGrid->GetSize();
-	std::vector< std::vector < std::tuple<IT,IT,NT> > > data(nprocs);
-
-	IT locsize = distrows.LocArrSize();
-	for(IT i=0; i<locsize; ++i)
-	{
-		IT lrow, lcol; 
-		int owner = Owner(total_m, total_n, distrows.arr[i], distcols.arr[i], lrow, lcol);
-		data[owner].push_back(std::make_tuple(lrow,lcol,val));	
-	}
+	typedef typename DER::LocalIT LIT;
+	std::vector<int> sendcnt;
+	std::tuple<LIT,LIT,NT> * senddata = PackByOwner<LIT>(distrows.arr, distcols.arr, [&val](IT i){ return val; }, total_m, total_n, sendcnt);
     if(SumDuplicates)
     {
-        SparseCommon(data, locsize, total_m, total_n, std::plus<NT>());
+        SparseCommon(senddata, sendcnt, total_m, total_n, std::plus<NT>());
     }
     else
     {
-        SparseCommon(data, locsize, total_m, total_n, maximum<NT>());
+        SparseCommon(senddata, sendcnt, total_m, total_n, maximum<NT>());
     }
 }
 
@@ -2923,9 +3483,69 @@ SpParMat< IT,NT,DER >::SpParMat (const DistEdgeList<DELIT> & DEL, bool removeloo
   	spSeq = new DER(A,false);        // Convert SpTuples to DER
 }
 
+/**
+ * Generates a Kronecker (R-MAT) graph with 2^log_numverts vertices and edgefactor edges per vertex straight into the matrix
+ * Unlike DistEdgeList::GenGraph500Data followed by PermEdges/RenameVertices, there is no edge list and no sort:
+ * every process makes its share of the edges with all its threads, each edge from its own skip of the random stream
+ * (so the graph does not depend on the number of processes or threads), optionally renames vertices with the
+ * Graph500 scrambling hash, and packs the edges by their owner in the 2D grid. Duplicates are combined with BinOp
+ * The seed is the Graph500 one (SEED environment variable), and edges get the value 1
+ **/
+template <class IT, class NT, class DER>
+template <typename _BinaryOperation>
+void SpParMat< IT,NT,DER >::GenGraph500Data(double initiator[4], int log_numverts, int edgefactor, bool scramble, bool removeloops, _BinaryOperation BinOp)
+{
+	IT nverts = static_cast<IT>(1) << log_numverts;
+	int64_t globaledges = static_cast<int64_t>(nverts) * static_cast<int64_t>(edgefactor);
+#ifdef DETERMINISTIC
+	uint64_t userseed = 0;
+#else
+	uint64_t userseed = static_cast<uint64_t>(RefGen21::init_random());
+#endif
+	uint_fast32_t seed[5];
+	make_mrg_seed(userseed, userseed, seed);
+	uint64_t val0, val1;	// values for scrambling
+	mrg_state state = RefGen21::MakeScrambleValues(val0, val1, seed);
+
+	int64_t start_edge, end_edge;
+	RefGen21::compute_edge_range(commGrid->GetRank(), commGrid->GetSize(), globaledges, &start_edge, &end_edge);
+	int64_t nedges = end_edge - start_edge;
+	std::vector<int64_t> edges(2*nedges);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(int64_t i=0; i< nedges; ++i)
+	{
+		mrg_state edgestate = state;
+		mrg_skip(&edgestate, 0, start_edge + i, 0);
+		int64_t src, tgt;
+		RefGen21::make_kronecker_edge(log_numverts, &edgestate, initiator, src, tgt);
+		if(scramble)
+		{
+			src = RefGen21::scramble(src, log_numverts, val0, val1);
+			tgt = RefGen21::scramble(tgt, log_numverts, val0, val1);
+		}
+		if(removeloops && src == tgt)	src = tgt = -1;		// PackByOwner drops it
+		edges[2*i] = src;
+		edges[2*i+1] = tgt;
+	}
+
+	typedef typename DER::LocalIT LIT;
+	std::vector<int> sendcnt;
+	std::tuple<LIT,LIT,NT> * senddata = PackByOwner<LIT>(static_cast<IT>(nedges),
+							[&edges](IT i){ return std::make_pair(static_cast<IT>(edges[2*i]), static_cast<IT>(edges[2*i+1])); },
+							[](IT i){ return static_cast<NT>(1); }, nverts, nverts, sendcnt);
+	std::vector<int64_t>().swap(edges);
+
+	FreeTranspose();
+	if(spSeq)   delete spSeq;
+	SparseCommon(senddata, sendcnt, nverts, nverts, BinOp);
+}
+
 template <class IT, class NT, class DER>
 IT SpParMat<IT,NT,DER>::RemoveLoops()
 {
+	FreeTranspose();
 	MPI_Comm DiagWorld = commGrid->GetDiagWorld();
 	IT totrem;
 	IT removed = 0;
@@ -2946,6 +3566,7 @@ IT SpParMat<IT,NT,DER>::RemoveLoops()
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::AddLoops(NT loopval, bool replaceExisting)
 {
+	FreeTranspose();
 	MPI_Comm DiagWorld = commGrid->GetDiagWorld();
 	if(DiagWorld != MPI_COMM_NULL) // Diagonal processors only
 	{
@@ -2963,6 +3584,7 @@ void SpParMat<IT,NT,DER>::AddLoops(NT loopval, bool replaceExisting)
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::AddLoops(FullyDistVec<IT,NT> loopvals, bool replaceExisting)
 {
+	FreeTranspose();
     
     
     if(*loopvals.commGrid != *commGrid)
@@ -3113,7 +3735,7 @@ void SpParMat<IT,NT,DER>::OptimizeForGraph500(OptBuf<LIT,OT> & optbuf)
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::ActivateThreading(int numsplits)
 {
-	spSeq->RowSplit(numsplits);
+	spSeq->RowSplit(numsplits);	// same matrix, different local layout: a cached T() stays valid
 }
 
 
@@ -3125,6 +3747,7 @@ template <class IT, class NT, class DER>
 template <typename SR>
 void SpParMat<IT,NT,DER>::Square ()
 {
+	FreeTranspose();
 	int stages, dummy; 	// last two parameters of productgrid are ignored for synchronous multiplication
 	std::shared_ptr<CommGrid> Grid = ProductGrid(commGrid.get(), commGrid.get(), stages, dummy, dummy);		
 
@@ -3194,71 +3817,150 @@ void SpParMat<IT,NT,DER>::Square ()
 }
 
 
+/**
+ * Off-diagonal blocks are swapped with the complement processor as-is: the raw arrays of the local block
+ * are sent straight from the sequential matrix, and received directly into a new one, as a single
+ * nonblocking message each way. Every processor then transposes the block it received locally.
+ */
 template <class IT, class NT, class DER>
 void SpParMat<IT,NT,DER>::Transpose()
 {
-	if(commGrid->myproccol == commGrid->myprocrow)	// Diagonal
+	MemoryTracker::Scope scope(MEM_TRANSPOSE);
+	if(patterntransposed != NULL)	// would be the pattern of A itself from now on
+	{
+		delete patterntransposed;
+		patterntransposed = NULL;
+	}
+	if(transposed != NULL)	// (A^T)^T = A: swap the local blocks with the cached transpose, no communication
+	{
+		std::swap(spSeq, transposed->spSeq);
+	}
+	else if(commGrid->myproccol == commGrid->myprocrow)	// Diagonal
 	{
 		spSeq->Transpose();			
 	}
 	else
 	{
 		typedef typename DER::LocalIT LIT;
-		SpTuples<LIT,NT> Atuples(*spSeq);
-		LIT locnnz = Atuples.getnnz();
-		LIT * rows = new LIT[locnnz];
-		LIT * cols = new LIT[locnnz];
-		NT * vals = new NT[locnnz];
-		for(LIT i=0; i < locnnz; ++i)
-		{
-			rows[i] = Atuples.colindex(i);	// swap (i,j) here
-			cols[i] = Atuples.rowindex(i);
-			vals[i] = Atuples.numvalue(i);
-		}
-		LIT locm = getlocalcols();
-		LIT locn = getlocalrows();
-		delete spSeq;
-
-		LIT remotem, remoten, remotennz;
-		std::swap(locm,locn);
 		int diagneigh = commGrid->GetComplementRank();
+		std::vector<LIT> essentials = spSeq->GetEssentials();
+		std::vector<LIT> remote(DER::esscount);
+		MPI_Sendrecv(essentials.data(), DER::esscount, MPIType<LIT>(), diagneigh, TRTAGNZ, remote.data(), DER::esscount, MPIType<LIT>(), diagneigh, TRTAGNZ, commGrid->GetWorld(), MPI_STATUS_IGNORE);
+
+		DER * recvd = new DER();
+		recvd->Create(remote);
+		MPI_Datatype sendtype = SpParHelper::ArraysType(spSeq->GetArrays());
+		MPI_Datatype recvtype = SpParHelper::ArraysType(recvd->GetArrays());
+		MPI_Request requests[2];
+		MPI_Irecv(MPI_BOTTOM, 1, recvtype, diagneigh, TRX, commGrid->GetWorld(), &requests[0]);
+		MPI_Isend(MPI_BOTTOM, 1, sendtype, diagneigh, TRX, commGrid->GetWorld(), &requests[1]);
+		MPI_Waitall(2, requests, MPI_STATUSES_IGNORE);
+		MPI_Type_free(&sendtype);
+		MPI_Type_free(&recvtype);
 
-		MPI_Status status;
-		MPI_Sendrecv(&locnnz, 1, MPIType<LIT>(), diagneigh, TRTAGNZ, &remotennz, 1, MPIType<LIT>(), diagneigh, TRTAGNZ, commGrid->GetWorld(), &status);
-		MPI_Sendrecv(&locn, 1, MPIType<LIT>(), diagneigh, TRTAGM, &remotem, 1, MPIType<LIT>(), diagneigh, TRTAGM, commGrid->GetWorld(), &status);
-		MPI_Sendrecv(&locm, 1, MPIType<LIT>(), diagneigh, TRTAGN, &remoten, 1, MPIType<LIT>(), diagneigh, TRTAGN, commGrid->GetWorld(), &status);
+		delete spSeq;
+		spSeq = recvd;
+		spSeq->Transpose();
+	}	
+}		
 
-		LIT * rowsrecv = new LIT[remotennz];
-		MPI_Sendrecv(rows, locnnz, MPIType<LIT>(), diagneigh, TRTAGROWS, rowsrecv, remotennz, MPIType<LIT>(), diagneigh, TRTAGROWS, commGrid->GetWorld(), &status);
-		delete [] rows;
 
-		LIT * colsrecv = new LIT[remotennz];
-		MPI_Sendrecv(cols, locnnz, MPIType<LIT>(), diagneigh, TRTAGCOLS, colsrecv, remotennz, MPIType<LIT>(), diagneigh, TRTAGCOLS, commGrid->GetWorld(), &status);
-		delete [] cols;
+/**
+ * Only the local block is exchanged with the complement rank, as in Transpose(), and the transpose
+ * of the incoming block is merged into the local one in place, so A^T is never formed as a whole
+ * \pre{the matrix and the processor grid are square}
+ */
+template <class IT, class NT, class DER>
+template <typename _BinaryOperation>
+void SpParMat<IT,NT,DER>::Symmetrize(_BinaryOperation __binary_op)
+{
+	if(getnrow() != getncol() || commGrid->GetGridRows() != commGrid->GetGridCols())
+	{
+		SpParHelper::Print("Symmetrize needs a square matrix on a square processor grid\n");
+		MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+	}
+	FreeTranspose();
+	DER * trans;
+	if(commGrid->myproccol == commGrid->myprocrow)	// Diagonal
+	{
+		trans = spSeq->TransposeConstPtr();
+	}
+	else
+	{
+		typedef typename DER::LocalIT LIT;
+		int diagneigh = commGrid->GetComplementRank();
+		std::vector<LIT> essentials = spSeq->GetEssentials();
+		std::vector<LIT> remote(DER::esscount);
+		MPI_Sendrecv(essentials.data(), DER::esscount, MPIType<LIT>(), diagneigh, TRTAGNZ, remote.data(), DER::esscount, MPIType<LIT>(), diagneigh, TRTAGNZ, commGrid->GetWorld(), MPI_STATUS_IGNORE);
+
+		trans = new DER();
+		trans->Create(remote);
+		MPI_Datatype sendtype = SpParHelper::ArraysType(spSeq->GetArrays());
+		MPI_Datatype recvtype = SpParHelper::ArraysType(trans->GetArrays());
+		MPI_Request requests[2];
+		MPI_Irecv(MPI_BOTTOM, 1, recvtype, diagneigh, TRX, commGrid->GetWorld(), &requests[0]);
+		MPI_Isend(MPI_BOTTOM, 1, sendtype, diagneigh, TRX, commGrid->GetWorld(), &requests[1]);
+		MPI_Waitall(2, requests, MPI_STATUSES_IGNORE);
+		MPI_Type_free(&sendtype);
+		MPI_Type_free(&recvtype);
+		trans->Transpose();
+	}
+	spSeq->AddAndAssign(*trans, __binary_op);
+	delete trans;
+}
 
-		NT * valsrecv = new NT[remotennz];
-		MPI_Sendrecv(vals, locnnz, MPIType<NT>(), diagneigh, TRTAGVALS, valsrecv, remotennz, MPIType<NT>(), diagneigh, TRTAGVALS, commGrid->GetWorld(), &status);
-		delete [] vals;
+/**
+ * The transpose is built lazily by the first call (which must be collective) and shares the grid of the matrix,
+ * so it can be handed to any SpMV or SpGEMM in place of a separately maintained A^T
+ * Member functions that change the matrix, and the non-const seq()/seqptr() (which hand out the local
+ * block for writing), drop it; const access, including the SpGEMM inputs, keeps it
+ */
+template <class IT, class NT, class DER>
+const SpParMat<IT,NT,DER> & SpParMat<IT,NT,DER>::T() const
+{
+	if(transposed == NULL)
+	{
+		SpParMat<IT,NT,DER> * trans = new SpParMat<IT,NT,DER>(*this);
+		trans->Transpose();
+		const_cast< SpParMat<IT,NT,DER> * >(this)->transposed = trans;
+	}
+	return *transposed;
+}
 
-		std::tuple<LIT,LIT,NT> * arrtuples = new std::tuple<LIT,LIT,NT>[remotennz];
-		for(LIT i=0; i< remotennz; ++i)
-		{
-			arrtuples[i] = std::make_tuple(rowsrecv[i], colsrecv[i], valsrecv[i]);
-		}	
-		DeleteAll(rowsrecv, colsrecv, valsrecv);
-		ColLexiCompare<LIT,NT> collexicogcmp;
-		sort(arrtuples , arrtuples+remotennz, collexicogcmp );	// sort w.r.t columns here
+//! Cheaper than T() when values are not needed: the values are dropped before the transpose is communicated
+template <class IT, class NT, class DER>
+const SpParMat<IT,bool,typename SpParMat<IT,NT,DER>::PatternDER> & SpParMat<IT,NT,DER>::PatternT() const
+{
+	if(patterntransposed == NULL)
+	{
+		SpParMat<IT,bool,PatternDER> * pattern = new SpParMat<IT,bool,PatternDER>(new PatternDER(*spSeq), commGrid);
+		pattern->Transpose();
+		const_cast< SpParMat<IT,NT,DER> * >(this)->patterntransposed = pattern;
+	}
+	return *patterntransposed;
+}
 
-		spSeq = new DER();
-		spSeq->Create( remotennz, remotem, remoten, arrtuples);		// the deletion of arrtuples[] is handled by SpMat::Create
-	}	
-}		
+template <class IT, class NT, class DER>
+void SpParMat<IT,NT,DER>::FreeTranspose()
+{
+	if(transposed != NULL)
+	{
+		delete transposed;
+		transposed = NULL;
+	}
+	if(patterntransposed != NULL)
+	{
+		delete patterntransposed;
+		patterntransposed = NULL;
+	}
+}
 
 
 template <class IT, class NT, class DER>
 template <class HANDLER>
 void SpParMat< IT,NT,DER >::SaveGathered(std::string filename, HANDLER handler, bool transpose) const
 {
+	MemoryTracker::Scope scope(MEM_IO);
 	int proccols = commGrid->GetGridCols();
 	int procrows = commGrid->GetGridRows();
 	IT totalm = getnrow();
@@ -3373,271 +4075,242 @@ void SpParMat< IT,NT,DER >::SaveGathered(std::string filename, HANDLER handler,
 }
 
 
-//! Private subroutine of ReadGeneralizedTuples
-//! totallength is the length of the dictionary, which we don't know in this labeled tuples format apriori
+//! Private subroutine of ReadGeneralizedTuples, collective over the grid
+//! Sends the distinct vertex names of a batch of lines to their owners in the distributed dictionary and appends 
+//! the edges of the batch, named by provisional ids: (id in the owner's dictionary) * nprocs + owner
 template <class IT, class NT, class DER>
-MPI_File SpParMat< IT,NT,DER >::TupleRead1stPassNExchange (const std::string & filename, TYPE2SEND * & senddata, IT & totsend, 
-							FullyDistVec<IT,STRASARRAY> & distmapper, uint64_t & totallength)
+void SpParMat< IT,NT,DER >::LabelTupleBatch(std::vector<std::string> & lines, StringDictionary & dictionary, 
+						std::vector<uint64_t> & rows, std::vector<uint64_t> & cols, std::vector<NT> & vals)
 {
-    int myrank = commGrid->GetRank();
-    int nprocs = commGrid->GetSize();     
-
-    MPI_Offset fpos, end_fpos;    
-    struct stat st;     // get file size
-    if (stat(filename.c_str(), &st) == -1)
-    {
-        MPI_Abort(MPI_COMM_WORLD, NOFILE);
-    }
-    int64_t file_size = st.st_size;
-    if(myrank == 0)    // the offset needs to be for this rank
-    {
-        std::cout << "File is " << file_size << " bytes" << std::endl;
-    }
-    fpos = myrank * file_size / nprocs;
-
-    if(myrank != (nprocs-1)) end_fpos = (myrank + 1) * file_size / nprocs;
-    else end_fpos = file_size;
-
-    MPI_File mpi_fh;
-    MPI_File_open (commGrid->commWorld, const_cast<char*>(filename.c_str()), MPI_MODE_RDONLY, MPI_INFO_NULL, &mpi_fh);
-
-    typedef std::map<std::string, uint64_t> KEYMAP; // due to potential (but extremely unlikely) collusions in MurmurHash, make the key to the std:map the string itself
-    std::vector< KEYMAP > allkeys(nprocs);	  // map keeps the outgoing data unique, we could have applied this to HipMer too
-
-    std::vector<std::string> lines;
-    bool finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, true, lines, myrank);
-    int64_t entriesread = lines.size();
-    SpHelper::ProcessLinesWithStringKeys(allkeys, lines,nprocs);
-
-    while(!finished)
-    {
-        finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, false, lines, myrank);
-
-        entriesread += lines.size();
-    	SpHelper::ProcessLinesWithStringKeys(allkeys, lines,nprocs);
-    }
-    int64_t allentriesread;
-    MPI_Reduce(&entriesread, &allentriesread, 1, MPIType<int64_t>(), MPI_SUM, 0, commGrid->commWorld);
-#ifdef COMBBLAS_DEBUG
-    if(myrank == 0)
-        std::cout << "Initial reading finished. Total number of entries read across all processors is " << allentriesread << std::endl;
-#endif
-
-    int * sendcnt = new int[nprocs];
-    int * recvcnt = new int[nprocs];
-    for(int i=0; i<nprocs; ++i)
-	sendcnt[i] = allkeys[i].size();
-
-    MPI_Alltoall(sendcnt, 1, MPI_INT, recvcnt, 1, MPI_INT, commGrid->GetWorld()); // share the counts
-    int * sdispls = new int[nprocs]();
-    int * rdispls = new int[nprocs]();
-    std::partial_sum(sendcnt, sendcnt+nprocs-1, sdispls+1);
-    std::partial_sum(recvcnt, recvcnt+nprocs-1, rdispls+1);
-    totsend = std::accumulate(sendcnt,sendcnt+nprocs, static_cast<IT>(0));
-    IT totrecv = std::accumulate(recvcnt,recvcnt+nprocs, static_cast<IT>(0));	
-
-    assert((totsend < std::numeric_limits<int>::max()));	
-    assert((totrecv < std::numeric_limits<int>::max()));
-
-    // The following are declared in SpParMat.h
-    // typedef std::array<char, MAXVERTNAME> STRASARRAY;
-    // typedef std::pair< STRASARRAY, uint64_t> TYPE2SEND;
-    senddata = new TYPE2SEND[totsend];	
-
-    #pragma omp parallel for
-    for(int i=0; i<nprocs; ++i)
-    {
-	size_t j = 0;
-	for(auto pobj:allkeys[i])
+	int nprocs = commGrid->GetSize();
+	std::unordered_map<std::string, uint64_t> batchnames;	// distinct names of this batch, and their index
+	std::vector<int> nameowner, namepos;	// owner of each distinct name, and its position among the names sent there
+	std::vector<int> sendcnt(nprocs, 0), namecnt(nprocs, 0);
+	std::vector< std::vector<char> > sendnames(nprocs);	// null-terminated names, back to back
+	auto lookup = [&](const char * name, size_t len)
 	{
-		// The naked C-style array type is not copyable or assignable, but pair will require it, hence used std::array
-		std::array<char, MAXVERTNAME> vname;
-		std::copy( pobj.first.begin(), pobj.first.end(), vname.begin() );  
-		if(pobj.first.length() < MAXVERTNAME)  vname[pobj.first.length()] = '\0';	// null termination		
-
-		senddata[sdispls[i]+j] = TYPE2SEND(vname, pobj.second);
-		j++;
+		auto ret = batchnames.emplace(std::string(name, len), nameowner.size());
+		if(ret.second)
+		{
+			int owner = StringDictionary::Owner(StringDictionary::Hash(name, len), nprocs);
+			nameowner.push_back(owner);
+			namepos.push_back(namecnt[owner]++);
+			sendnames[owner].insert(sendnames[owner].end(), name, name+len);
+			sendnames[owner].push_back('\0');
+		}
+		return ret.first->second;
+	};
+	size_t firstedge = rows.size();
+	for(const std::string & line : lines)
+	{
+		const char * p = line.c_str();
+		const char * eol = p + line.size();
+		const char * fr, * to;
+		size_t frlen, tolen;
+		p = SpHelper::ParseToken(p, eol, fr, frlen);
+		if(p != NULL)	p = SpHelper::ParseToken(p, eol, to, tolen);
+		if(p == NULL)	continue;	// blank or incomplete line
+		double vv = 1.0;
+		if(SpHelper::SkipBlanks(p, eol) != eol)	// the weight is optional, but must be a number if it is there
+		{
+			const char * q = SpHelper::ParseReal(p, eol, vv);
+			if(q == NULL || SpHelper::SkipBlanks(q, eol) != eol)
+			{
+				std::cerr << "COMBBLAS: Process " << commGrid->GetRank() << " can not parse the weight in line \"" << line << "\"" << std::endl;
+				MPI_Abort(MPI_COMM_WORLD, PARSEERROR);
+			}
+		}
+		rows.push_back(lookup(fr, frlen));
+		cols.push_back(lookup(to, tolen));
+		vals.push_back(static_cast<NT>(vv));
 	}
-    }
-    allkeys.clear();  // allkeys is no longer needed after this point
-
-    MPI_Datatype MPI_HASH;
-    MPI_Type_contiguous(sizeof(TYPE2SEND), MPI_CHAR, &MPI_HASH);
-    MPI_Type_commit(&MPI_HASH);
-
-    TYPE2SEND * recvdata = new TYPE2SEND[totrecv];	
-    MPI_Alltoallv(senddata, sendcnt, sdispls, MPI_HASH, recvdata, recvcnt, rdispls, MPI_HASH, commGrid->GetWorld());
-    // do not delete send buffers yet as we will use them to recv back the data
-    
-    std::set< std::pair<uint64_t, std::string>  > uniqsorted;
-    for(IT i=0; i< totrecv; ++i)
-    {
-	    auto locnull = std::find(recvdata[i].first.begin(), recvdata[i].first.end(), '\0'); // find the null character (or string::end)
-	    std::string strtmp(recvdata[i].first.begin(), locnull); // range constructor 
-	    
-	    uniqsorted.insert(std::make_pair(recvdata[i].second, strtmp));
-    }
-    uint64_t uniqsize = uniqsorted.size();
-    
-#ifdef COMBBLAS_DEBUG
-    if(myrank == 0)
-	    std::cout << "out of " << totrecv << " vertices received, " << uniqsize << " were unique" << std::endl;
-#endif
-    uint64_t sizeuntil = 0;
-    totallength = 0;
-    MPI_Exscan( &uniqsize, &sizeuntil, 1, MPIType<uint64_t>(), MPI_SUM, commGrid->GetWorld() );
-    MPI_Allreduce(&uniqsize, &totallength, 1,  MPIType<uint64_t>(), MPI_SUM, commGrid->GetWorld());
-    if(myrank == 0) sizeuntil = 0;  // because MPI_Exscan says the recvbuf in process 0 is undefined
-
-    distmapper =  FullyDistVec<IT,STRASARRAY>(commGrid, totallength,STRASARRAY{});	
-	
-    // invindex does not conform to FullyDistVec boundaries, otherwise its contents are essentially the same as distmapper    
-    KEYMAP invindex;	// KEYMAP is map<string, uint64_t>. 
-    uint64_t locindex = 0;
-    std::vector< std::vector< IT > > locs_send(nprocs);
-    std::vector< std::vector< std::string > > data_send(nprocs);
-    int * map_scnt = new int[nprocs]();	// send counts for this map only (to no confuse with the other sendcnt)        
-    for(auto itr = uniqsorted.begin(); itr != uniqsorted.end(); ++itr)
-    {
-	    uint64_t globalindex = sizeuntil + locindex;
-	    invindex.insert(std::make_pair(itr->second, globalindex));
-	    
-	    IT newlocid;	
-	    int owner = distmapper.Owner(globalindex, newlocid);
-
-	    //if(myrank == 0)
-	    //    std::cout << "invindex received " << itr->second << " with global index " << globalindex << " to be owned by " << owner << " with index " << newlocid << std::endl;
-
-	    locs_send[owner].push_back(newlocid);
-	    data_send[owner].push_back(itr->second);
-	    map_scnt[owner]++;
-	    locindex++;
-    }
-    uniqsorted.clear();	// clear memory
-
-
-    /* BEGIN: Redistributing the permutation vector to fit the FullyDistVec semantics */
-    SpParHelper::ReDistributeToVector(map_scnt, locs_send, data_send, distmapper.arr, commGrid->GetWorld());   // map_scnt is deleted here
-    /* END: Redistributing the permutation vector to fit the FullyDistVec semantics */ 
+	lines.clear();
 
-    for(IT i=0; i< totrecv; ++i)
-    {
-	    auto locnull = std::find(recvdata[i].first.begin(), recvdata[i].first.end(), '\0');
-	    std::string searchstr(recvdata[i].first.begin(), locnull); // range constructor 
-
-	    auto resp = invindex.find(searchstr); // recvdata[i] is of type pair< STRASARRAY, uint64_t>
-	    if (resp != invindex.end())
-	    {
-		recvdata[i].second = resp->second;	// now instead of random numbers, recvdata's second entry will be its new index
-	    }
-	    else
-		std::cout << "Assertion failed at proc " << myrank << ": the absence of the entry in invindex is unexpected!!!" << std::endl;
-    }
-    MPI_Alltoallv(recvdata, recvcnt, rdispls, MPI_HASH, senddata, sendcnt, sdispls, MPI_HASH, commGrid->GetWorld());    
-    DeleteAll(recvdata, sendcnt, recvcnt, sdispls, rdispls);
-    MPI_Type_free(&MPI_HASH);
+	std::vector<int> recvcnt(nprocs), sdispls(nprocs, 0), rdispls(nprocs, 0);
+	for(int i=0; i<nprocs; ++i)
+		sendcnt[i] = sendnames[i].size();
+	MPI_Alltoall(sendcnt.data(), 1, MPI_INT, recvcnt.data(), 1, MPI_INT, commGrid->GetWorld());
+	std::partial_sum(sendcnt.begin(), sendcnt.end()-1, sdispls.begin()+1);
+	std::partial_sum(recvcnt.begin(), recvcnt.end()-1, rdispls.begin()+1);
+	std::vector<char> sendbuf(sdispls[nprocs-1] + sendcnt[nprocs-1]);
+	for(int i=0; i<nprocs; ++i)
+	{
+		std::copy(sendnames[i].begin(), sendnames[i].end(), sendbuf.begin() + sdispls[i]);
+		std::vector<char>().swap(sendnames[i]);
+	}
+	std::vector<char> recvbuf(rdispls[nprocs-1] + recvcnt[nprocs-1]);
+	MPI_Alltoallv(sendbuf.data(), sendcnt.data(), sdispls.data(), MPI_CHAR, recvbuf.data(), recvcnt.data(), rdispls.data(), MPI_CHAR, commGrid->GetWorld());
+	std::vector<char>().swap(sendbuf);
 
-    // the following gets deleted here: allkeys
-    return mpi_fh;
+	// ids are returned in the order the names arrived
+	std::vector<uint64_t> ids;
+	std::vector<int> idcnt(nprocs, 0), iddispls(nprocs, 0), namedispls(nprocs, 0);
+	for(int i=0; i<nprocs; ++i)
+	{
+		const char * name = recvbuf.data() + rdispls[i];
+		const char * end = name + recvcnt[i];
+		for(; name < end; ++idcnt[i])
+		{
+			size_t len = std::strlen(name);
+			ids.push_back(dictionary.Insert(name, len, StringDictionary::Hash(name, len)));
+			name += len + 1;
+		}
+	}
+	std::partial_sum(idcnt.begin(), idcnt.end()-1, iddispls.begin()+1);
+	std::partial_sum(namecnt.begin(), namecnt.end()-1, namedispls.begin()+1);
+	std::vector<uint64_t> nameids(nameowner.size());
+	MPI_Alltoallv(ids.data(), idcnt.data(), iddispls.data(), MPIType<uint64_t>(), nameids.data(), namecnt.data(), namedispls.data(), MPIType<uint64_t>(), commGrid->GetWorld());
+
+	std::vector<uint64_t> provisional(nameowner.size());
+	for(size_t k=0; k< nameowner.size(); ++k)
+		provisional[k] = nameids[namedispls[nameowner[k]] + namepos[k]] * nprocs + nameowner[k];
+	for(size_t e = firstedge; e < rows.size(); ++e)
+	{
+		rows[e] = provisional[rows[e]];
+		cols[e] = provisional[cols[e]];
+	}
 }
 
 
-
-//! Handles all sorts of orderings as long as there are no duplicates
+//! Handles all sorts of orderings, even duplicates (what happens to them is determined by BinOp)
 //! Does not take matrix market banner (only tuples)
 //! Data can be load imbalanced and the vertex labels can be arbitrary strings
 //! Replaces ReadDistribute for imbalanced arbitrary input in tuples format
+//! The file is read once: every batch of lines sends its distinct vertex names to the process owning their hash,
+//! whose StringDictionary gives them ids. At the end, ids are made dense in (hash, name) order, which does not 
+//! depend on the number of processes, and the returned vector maps them back to the (truncated) names
 template <class IT, class NT, class DER>
 template <typename _BinaryOperation>
 FullyDistVec<IT,std::array<char, MAXVERTNAME> > SpParMat< IT,NT,DER >::ReadGeneralizedTuples (const std::string & filename, _BinaryOperation BinOp)
 {       
-    int myrank = commGrid->GetRank();
-    int nprocs = commGrid->GetSize();  
-    TYPE2SEND * senddata;
-    IT totsend;
-    uint64_t totallength;
-    FullyDistVec<IT,STRASARRAY> distmapper(commGrid); // choice of array<char, MAXVERTNAME> over string = array is required to be a contiguous container and an aggregate
-
-    MPI_File mpi_fh = TupleRead1stPassNExchange(filename, senddata, totsend, distmapper, totallength);
-
-    typedef std::map<std::string, uint64_t> KEYMAP;    
-    KEYMAP ultimateperm;	// the ultimate permutation
-    for(IT i=0; i< totsend; ++i)	
-    {
-	    auto locnull = std::find(senddata[i].first.begin(), senddata[i].first.end(), '\0');
-	    
-	    std::string searchstr(senddata[i].first.begin(), locnull);
-	    auto ret = ultimateperm.emplace(std::make_pair(searchstr, senddata[i].second));
-	    if(!ret.second)	// the second is the boolean that tells success
-	    {
-	        // remember, we only sent unique vertex ids in the first place so we are expecting unique values in return		
-		std::cout << "the duplication in ultimateperm is unexpected!!!" << std::endl;	
-	    }
-    }
-    delete [] senddata;
+	MemoryTracker::Scope scope(MEM_IO);
+	FreeTranspose();
+	int myrank = commGrid->GetRank();
+	int nprocs = commGrid->GetSize();  
 
-    // rename the data now, first reset file pointers    
-    MPI_Offset fpos, end_fpos;
-    struct stat st;     // get file size
-    if (stat(filename.c_str(), &st) == -1)
-    {
-        MPI_Abort(MPI_COMM_WORLD, NOFILE);
-    }
-    int64_t file_size = st.st_size;
-
-    fpos = myrank * file_size / nprocs;   
-
-    if(myrank != (nprocs-1)) end_fpos = (myrank + 1) * file_size / nprocs;
-    else end_fpos = file_size;
-
-    typedef typename DER::LocalIT LIT;
-    std::vector<LIT> rows;
-    std::vector<LIT> cols;
-    std::vector<NT> vals;
-
-    std::vector<std::string> lines;
-    bool finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, true, lines, myrank);
-    int64_t entriesread = lines.size();
-   
-    SpHelper::ProcessStrLinesNPermute(rows, cols, vals, lines, ultimateperm);
+	struct stat st;     // get file size
+	if (stat(filename.c_str(), &st) == -1)
+	{
+		MPI_Abort(MPI_COMM_WORLD, NOFILE);
+	}
+	int64_t file_size = st.st_size;
+	MPI_Offset fpos = myrank * file_size / nprocs;
+	MPI_Offset end_fpos = (myrank != (nprocs-1))? (myrank + 1) * file_size / nprocs : file_size;
+
+	MPI_File mpi_fh;
+	MPI_File_open (commGrid->commWorld, const_cast<char*>(filename.c_str()), MPI_MODE_RDONLY, MPI_INFO_NULL, &mpi_fh);
+
+	StringDictionary dictionary;		// this process' share of the vertex names
+	std::vector<uint64_t> rows, cols;	// provisional ids, see LabelTupleBatch
+	std::vector<NT> vals;
+	std::vector<std::string> lines;
+	bool finished = false;
+	int64_t entriesread = 0;
+	for(bool firstcall = true; ; firstcall = false)
+	{
+		if(!finished)	finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, firstcall, lines, myrank);
+		entriesread += lines.size();
+		LabelTupleBatch(lines, dictionary, rows, cols, vals);	// collective, so processes that are done keep calling it
 
-    while(!finished)
-    {
-        finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, false, lines, myrank);
-        entriesread += lines.size();
-    	SpHelper::ProcessStrLinesNPermute(rows, cols, vals, lines, ultimateperm);
-    }
-    int64_t allentriesread;
-    MPI_Reduce(&entriesread, &allentriesread, 1, MPIType<int64_t>(), MPI_SUM, 0, commGrid->commWorld);
+		int done = finished, alldone;
+		MPI_Allreduce(&done, &alldone, 1, MPI_INT, MPI_LAND, commGrid->GetWorld());
+		if(alldone)	break;
+	}
+	MPI_File_close(&mpi_fh);
+	int64_t allentriesread;
+	MPI_Reduce(&entriesread, &allentriesread, 1, MPIType<int64_t>(), MPI_SUM, 0, commGrid->commWorld);
 #ifdef COMBBLAS_DEBUG
-    if(myrank == 0)
-        std::cout << "Second reading finished. Total number of entries read across all processors is " << allentriesread << std::endl;
+	if(myrank == 0)
+		std::cout << "Reading finished. Total number of entries read across all processors is " << allentriesread << std::endl;
 #endif
 
-    MPI_File_close(&mpi_fh);
-    std::vector< std::vector < std::tuple<LIT,LIT,NT> > > data(nprocs);
-    
-    LIT locsize = rows.size();   // remember: locsize != entriesread (unless the matrix is unsymmetric)
-    for(LIT i=0; i<locsize; ++i)
-    {
-        LIT lrow, lcol;
-        int owner = Owner(totallength, totallength, rows[i], cols[i], lrow, lcol);
-        data[owner].push_back(std::make_tuple(lrow,lcol,vals[i]));
-    }
-    std::vector<LIT>().swap(rows);
-    std::vector<LIT>().swap(cols);
-    std::vector<NT>().swap(vals);	
+	// owners hold consecutive ranges of hash values, so sorting locally gives the global (hash, name) order
+	uint64_t uniqsize = dictionary.size();
+	std::vector<uint64_t> order(uniqsize);
+	std::iota(order.begin(), order.end(), 0);
+	std::sort(order.begin(), order.end(), [&dictionary](uint64_t a, uint64_t b){ return dictionary.Less(a, b); });
+	uint64_t sizeuntil = 0;
+	uint64_t totallength = 0;
+	MPI_Exscan( &uniqsize, &sizeuntil, 1, MPIType<uint64_t>(), MPI_SUM, commGrid->GetWorld() );
+	MPI_Allreduce(&uniqsize, &totallength, 1,  MPIType<uint64_t>(), MPI_SUM, commGrid->GetWorld());
+	if(myrank == 0) sizeuntil = 0;  // because MPI_Exscan says the recvbuf in process 0 is undefined
+
+	FullyDistVec<IT,STRASARRAY> distmapper(commGrid, totallength, STRASARRAY{});
+	std::vector<uint64_t> denseid(uniqsize);
+	std::vector< std::vector< IT > > locs_send(nprocs);
+	std::vector< std::vector< std::string > > data_send(nprocs);
+	int * map_scnt = new int[nprocs]();	// send counts for this map only
+	for(uint64_t k=0; k< uniqsize; ++k)
+	{
+		denseid[order[k]] = sizeuntil + k;
+		IT newlocid;
+		int owner = distmapper.Owner(sizeuntil + k, newlocid);
+		locs_send[owner].push_back(newlocid);
+		data_send[owner].push_back(dictionary.Key(order[k]));
+		map_scnt[owner]++;
+	}
+	std::vector<uint64_t>().swap(order);
+	dictionary = StringDictionary();
+	SpParHelper::ReDistributeToVector(map_scnt, locs_send, data_send, distmapper.arr, commGrid->GetWorld());   // map_scnt is deleted here
+
+	// ask the owners for the dense ids of the provisional ids in the local edges, once per distinct vertex
+	std::vector<uint64_t> uniqprov(rows);
+	uniqprov.insert(uniqprov.end(), cols.begin(), cols.end());
+	std::sort(uniqprov.begin(), uniqprov.end());
+	uniqprov.erase(std::unique(uniqprov.begin(), uniqprov.end()), uniqprov.end());
+
+	std::vector<int> sendcnt(nprocs, 0), recvcnt(nprocs), sdispls(nprocs, 0), rdispls(nprocs, 0);
+	for(uint64_t prov : uniqprov)
+		sendcnt[prov % nprocs]++;
+	MPI_Alltoall(sendcnt.data(), 1, MPI_INT, recvcnt.data(), 1, MPI_INT, commGrid->GetWorld());
+	std::partial_sum(sendcnt.begin(), sendcnt.end()-1, sdispls.begin()+1);
+	std::partial_sum(recvcnt.begin(), recvcnt.end()-1, rdispls.begin()+1);
+	std::vector<uint64_t> sendids(uniqprov.size());
+	std::vector<int> filled(sdispls);
+	for(uint64_t prov : uniqprov)
+		sendids[filled[prov % nprocs]++] = prov / nprocs;
+	std::vector<uint64_t> recvids(rdispls[nprocs-1] + recvcnt[nprocs-1]);
+	MPI_Alltoallv(sendids.data(), sendcnt.data(), sdispls.data(), MPIType<uint64_t>(), recvids.data(), recvcnt.data(), rdispls.data(), MPIType<uint64_t>(), commGrid->GetWorld());
+	for(uint64_t & id : recvids)
+		id = denseid[id];
+	MPI_Alltoallv(recvids.data(), recvcnt.data(), rdispls.data(), MPIType<uint64_t>(), sendids.data(), sendcnt.data(), sdispls.data(), MPIType<uint64_t>(), commGrid->GetWorld());
+	std::vector<uint64_t>().swap(recvids);
+	std::vector<uint64_t>().swap(denseid);
+
+	std::vector<uint64_t> dense(uniqprov.size());
+	std::copy(sdispls.begin(), sdispls.end(), filled.begin());
+	for(size_t k=0; k< uniqprov.size(); ++k)
+		dense[k] = sendids[filled[uniqprov[k] % nprocs]++];
+	std::vector<uint64_t>().swap(sendids);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(int64_t e=0; e < static_cast<int64_t>(rows.size()); ++e)
+	{
+		rows[e] = dense[std::lower_bound(uniqprov.begin(), uniqprov.end(), rows[e]) - uniqprov.begin()];
+		cols[e] = dense[std::lower_bound(uniqprov.begin(), uniqprov.end(), cols[e]) - uniqprov.begin()];
+	}
+	std::vector<uint64_t>().swap(uniqprov);
+	std::vector<uint64_t>().swap(dense);
+
+	typedef typename DER::LocalIT LIT;
+	std::vector<int> packcnt;
+	std::tuple<LIT,LIT,NT> * senddata = PackByOwner<LIT>(static_cast<IT>(rows.size()), 
+							[&rows, &cols](IT i){ return std::make_pair(static_cast<IT>(rows[i]), static_cast<IT>(cols[i])); },
+							[&vals](IT i){ return vals[i]; }, static_cast<IT>(totallength), static_cast<IT>(totallength), packcnt);
+	std::vector<uint64_t>().swap(rows);
+	std::vector<uint64_t>().swap(cols);
+	std::vector<NT>().swap(vals);
 
 #ifdef COMBBLAS_DEBUG
-    if(myrank == 0)
-        std::cout << "Packing to recipients finished, about to send..." << std::endl;
+	if(myrank == 0)
+		std::cout << "Packing to recipients finished, about to send..." << std::endl;
 #endif
     
-    if(spSeq)   delete spSeq;
-    SparseCommon(data, locsize, totallength, totallength, BinOp);
-    // PrintInfo();
-    // distmapper.ParallelWrite("distmapper.mtx", 1, CharArraySaveHandler());
-    return distmapper; 
+	if(spSeq)   delete spSeq;
+	SparseCommon(senddata, packcnt, static_cast<IT>(totallength), static_cast<IT>(totallength), BinOp);
+	// distmapper.ParallelWrite("distmapper.mtx", 1, CharArraySaveHandler());
+	return distmapper; 
 }
 
 
@@ -3649,6 +4322,8 @@ template <class IT, class NT, class DER>
 template <typename _BinaryOperation>
 void SpParMat< IT,NT,DER >::ParallelReadMM (const std::string & filename, bool onebased, _BinaryOperation BinOp)
 {
+	MemoryTracker::Scope scope(MEM_IO);
+	FreeTranspose();
     int32_t type = -1;
     int32_t symmetric = 0;
     int64_t nrows, ncols, nonzeros;
@@ -3737,43 +4412,128 @@ void SpParMat< IT,NT,DER >::ParallelReadMM (const std::string & filename, bool o
     MPI_File mpi_fh;
     MPI_File_open (commGrid->commWorld, const_cast<char*>(filename.c_str()), MPI_MODE_RDONLY, MPI_INFO_NULL, &mpi_fh);
 
-	 
-    typedef typename DER::LocalIT LIT;
-    std::vector<LIT> rows;
-    std::vector<LIT> cols;
+    int nthreads = 1;
+#ifdef _OPENMP
+    nthreads = omp_get_max_threads();
+#endif
+    std::vector<IT> rows;	// global, zero-based indices
+    std::vector<IT> cols;
     std::vector<NT> vals;
-
-    std::vector<std::string> lines;
-    bool finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, true, lines, myrank);
-    int64_t entriesread = lines.size();
-    SpHelper::ProcessLines(rows, cols, vals, lines, symmetric, type, onebased);
-    MPI_Barrier(commGrid->commWorld);
-
+    std::vector< std::vector<IT> > trows(nthreads);	// what every thread parsed from the current chunk
+    std::vector< std::vector<IT> > tcols(nthreads);
+    std::vector< std::vector<NT> > tvals(nthreads);
+    std::vector<const char *> badline(nthreads, NULL);
+
+    // A process parses the lines that start in [fpos, end_fpos); a partial first line belongs to the previous process
+    // Its range is read in chunks of MMREADCHUNK bytes, and the complete lines of each chunk are split among threads
+    std::vector<char> buf;
+    MPI_Offset bufpos = (myrank == 0)? fpos : fpos-1;	// file offset of buf[0]; the byte before fpos tells whether we start at the beginning of a line
+    MPI_Offset readpos = bufpos;
+    size_t carry = 0;	// bytes of an incomplete line kept from the previous chunk
+    bool skipfirst = (myrank != 0);
+    bool finished = (fpos >= end_fpos);
     while(!finished)
     {
-        finished = SpParHelper::FetchBatch(mpi_fh, fpos, end_fpos, false, lines, myrank);
-        entriesread += lines.size();
-        SpHelper::ProcessLines(rows, cols, vals, lines, symmetric, type, onebased);
+        int64_t toread = std::min(static_cast<int64_t>(MMREADCHUNK), static_cast<int64_t>(file_size - readpos));
+        buf.resize(carry + toread + 1);
+        MPI_Status status;
+        MPI_File_read_at(mpi_fh, readpos, buf.data() + carry, static_cast<int>(toread), MPI_CHAR, &status);
+        readpos += toread;
+        bool lastchunk = (readpos >= file_size);
+        size_t len = carry + toread;
+        buf[len] = '\0';	// stops strtod at the end of the buffer
+
+        size_t begin = 0;
+        if(skipfirst)
+        {
+            char * c = static_cast<char*>(memchr(buf.data(), '\n', len));
+            if(c == NULL && !lastchunk)
+            {
+                carry = len;	// keep looking in the next chunk
+                continue;
+            }
+            begin = (c == NULL)? len : (c - buf.data() + 1);
+            skipfirst = false;
+        }
+        size_t complete = len;	// end of the last complete line
+        if(!lastchunk)
+        {
+            while(complete > begin && buf[complete-1] != '\n') --complete;
+        }
+        size_t stop = complete;
+        MPI_Offset limit = end_fpos - bufpos;	// lines starting here or later belong to the next process
+        if(limit <= static_cast<MPI_Offset>(complete))
+        {
+            finished = true;
+            if(limit <= static_cast<MPI_Offset>(begin))	stop = begin;
+            else
+            {
+                char * c = static_cast<char*>(memchr(buf.data() + limit - 1, '\n', complete - (limit - 1)));
+                stop = (c == NULL)? complete : (c - buf.data() + 1);
+            }
+        }
+        if(lastchunk)	finished = true;
+
+#ifdef _OPENMP
+#pragma omp parallel num_threads(nthreads)
+#endif
+        {
+            int t = 0;
+#ifdef _OPENMP
+            t = omp_get_thread_num();
+#endif
+            // thread t parses the lines that start in its share of [begin, stop)
+            const char * lo = buf.data() + begin;
+            const char * hi = buf.data() + stop;
+            auto linestart = [lo, hi](const char * q)	// first line start at or after q
+            {
+                if(q == lo || q == hi || q[-1] == '\n')	return q;
+                const char * nl = std::find(q, hi, '\n');
+                return (nl == hi)? hi : nl+1;
+            };
+            const char * first = linestart(lo + (stop - begin) * t / nthreads);
+            const char * last = linestart(lo + (stop - begin) * (t+1) / nthreads);
+            if(first < last)
+                badline[t] = SpHelper::ParseMMLines(first, last, trows[t], tcols[t], tvals[t], symmetric, type, onebased);
+        }
+        for(int t=0; t<nthreads; ++t)	// the first bad line in file order
+        {
+            if(badline[t] != NULL)
+            {
+                std::cerr << "COMBBLAS: Process " << myrank << " can not parse the line at byte " << bufpos + (badline[t] - buf.data())
+                          << " of " << filename << ": \"" << SpHelper::LineAt(badline[t], buf.data() + stop) << "\"" << std::endl;
+                MPI_Abort(MPI_COMM_WORLD, PARSEERROR);
+            }
+        }
+        for(int t=0; t<nthreads; ++t)	// in file order
+        {
+            rows.insert(rows.end(), trows[t].begin(), trows[t].end());
+            cols.insert(cols.end(), tcols[t].begin(), tcols[t].end());
+            vals.insert(vals.end(), tvals[t].begin(), tvals[t].end());
+            trows[t].clear();
+            tcols[t].clear();
+            tvals[t].clear();
+        }
+        carry = len - complete;
+        std::copy(buf.begin() + complete, buf.begin() + len, buf.begin());
+        bufpos += complete;
     }
+    MPI_File_close(&mpi_fh);
+
+    int64_t entriesread = rows.size();
     int64_t allentriesread;
     MPI_Reduce(&entriesread, &allentriesread, 1, MPIType<int64_t>(), MPI_SUM, 0, commGrid->commWorld);
 #ifdef COMBBLAS_DEBUG
     if(myrank == 0)
-        std::cout << "Reading finished. Total number of entries read across all processors is " << allentriesread << std::endl;
+        std::cout << "Reading finished. Total number of entries (after symmetrization) across all processors is " << allentriesread << std::endl;
 #endif
 
-    std::vector< std::vector < std::tuple<LIT,LIT,NT> > > data(nprocs);
-    
-    LIT locsize = rows.size();   // remember: locsize != entriesread (unless the matrix is unsymmetric)
-    for(LIT i=0; i<locsize; ++i)
-    {
-        LIT lrow, lcol;
-        int owner = Owner(nrows, ncols, rows[i], cols[i], lrow, lcol);
-        data[owner].push_back(std::make_tuple(lrow,lcol,vals[i]));
-    }
-    std::vector<LIT>().swap(rows);
-    std::vector<LIT>().swap(cols);
-    std::vector<NT>().swap(vals);	
+    typedef typename DER::LocalIT LIT;
+    std::vector<int> sendcnt;
+    std::tuple<LIT,LIT,NT> * senddata = PackByOwner<LIT>(rows, cols, [&vals](IT i){ return vals[i]; }, nrows, ncols, sendcnt);
+    std::vector<IT>().swap(rows);
+    std::vector<IT>().swap(cols);
+    std::vector<NT>().swap(vals);
 
 #ifdef COMBBLAS_DEBUG
     if(myrank == 0)
@@ -3781,7 +4541,263 @@ void SpParMat< IT,NT,DER >::ParallelReadMM (const std::string & filename, bool o
 #endif
     
     if(spSeq)   delete spSeq;
-    SparseCommon(data, locsize, nrows, ncols, BinOp);
+    SparseCommon(senddata, sendcnt, nrows, ncols, BinOp);
+}
+
+
+/**
+ * Reads a file of fixed-size records that follow a header of headerbytes, without a master process:
+ * every process memory-maps its contiguous share of the records, which indof and valof decode in place
+ * (given the address of a record) straight into the send buffer of SparseCommon
+ **/
+template <class IT, class NT, class DER>
+template <typename _BinaryOperation, typename _IndexOperation, typename _ValueOperation>
+void SpParMat< IT,NT,DER >::ReadMappedRecords(const std::string & filename, int64_t headerbytes, int64_t recordbytes, IT total_m, IT total_n, 
+				_IndexOperation indof, _ValueOperation valof, _BinaryOperation BinOp)
+{
+	int myrank = commGrid->GetRank();
+	int nprocs = commGrid->GetSize();
+	struct stat st;
+	if (stat(filename.c_str(), &st) == -1)
+	{
+		SpParHelper::Print("COMBBLAS: Binary file " + filename + " can not be found\n");
+		MPI_Abort(MPI_COMM_WORLD, NOFILE);
+	}
+	int64_t nrecords = std::max(static_cast<int64_t>(st.st_size) - headerbytes, static_cast<int64_t>(0)) / recordbytes;
+	int64_t first = nrecords * myrank / nprocs;
+	int64_t last = nrecords * (myrank+1) / nprocs;
+
+	void * mapbase;
+	size_t maplength;
+	const char * records = SpParHelper::MapFileRange(filename, headerbytes + first * recordbytes, (last - first) * recordbytes, mapbase, maplength);
+
+	typedef typename DER::LocalIT LIT;
+	std::vector<int> sendcnt;
+	std::tuple<LIT,LIT,NT> * senddata = PackByOwner<LIT>(static_cast<IT>(last - first), 
+						[records, recordbytes, &indof](IT i){ return indof(records + i * recordbytes); },
+						[records, recordbytes, &valof](IT i){ return valof(records + i * recordbytes); }, total_m, total_n, sendcnt);
+	SpParHelper::UnmapFileRange(mapbase, maplength);
+
+	FreeTranspose();
+	if(spSeq)   delete spSeq;
+	SparseCommon(senddata, sendcnt, total_m, total_n, BinOp);
+}
+
+/**
+ * Reads a binary file with an HKDT header (see FileHeader.h) in parallel: the (row, column, value) records
+ * of IT, IT and NT that follow the header are memory-mapped by all processes and decoded in place
+ * Indices are zero-based, as in ReadDistribute; duplicates are combined with BinOp
+ * The object size in the header must be that of these records, and the file must hold exactly nnz of them
+ **/
+template <class IT, class NT, class DER>
+template <typename _BinaryOperation>
+void SpParMat< IT,NT,DER >::ParallelReadBinary(const std::string & filename, _BinaryOperation BinOp)
+{
+	MemoryTracker::Scope scope(MEM_IO);
+	int seeklength = 0;
+	uint64_t info[5] = {0, 0, 0, 0, 0};	// m, n, nnz, object size, file size
+	if(commGrid->GetRank() == 0)
+	{
+		FILE * binfile = NULL;
+		HeaderInfo hfile = ParseHeader(filename, binfile, seeklength);
+		if(hfile.headerexists)	fclose(binfile);
+		if(!hfile.headerexists || hfile.format != 0)	seeklength = 0;
+		struct stat st;
+		info[0] = hfile.m;
+		info[1] = hfile.n;
+		info[2] = hfile.nnz;
+		info[3] = hfile.objsize;
+		info[4] = (stat(filename.c_str(), &st) == 0) ? st.st_size : 0;
+	}
+	MPI_Bcast(&seeklength, 1, MPI_INT, 0, commGrid->GetWorld());
+	MPI_Bcast(info, 5, MPIType<uint64_t>(), 0, commGrid->GetWorld());
+	if(seeklength == 0)
+	{
+		SpParHelper::Print("COMBBLAS: " + filename + " is not a binary file with an HKDT header\n");
+		MPI_Abort(MPI_COMM_WORLD, NOFILE);
+	}
+	const uint64_t recordbytes = 2*sizeof(IT) + sizeof(NT);
+	if(info[3] != recordbytes)
+	{
+		std::ostringstream outs;
+		outs << "COMBBLAS: The records of " << filename << " are " << info[3] << " bytes, but (row, column, value) records of this matrix are "
+			<< recordbytes << " bytes (" << sizeof(IT) << " byte indices, " << sizeof(NT) << " byte values)" << std::endl;
+		SpParHelper::Print(outs.str());
+		MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+	}
+	if(info[4] != seeklength + info[2] * recordbytes)
+	{
+		std::ostringstream outs;
+		outs << "COMBBLAS: " << filename << " is " << info[4] << " bytes, but its header says " << info[2] << " records of " 
+			<< recordbytes << " bytes after " << seeklength << " header bytes; the file is truncated or corrupt" << std::endl;
+		SpParHelper::Print(outs.str());
+		MPI_Abort(MPI_COMM_WORLD, NOFILE);
+	}
+
+	ReadMappedRecords(filename, seeklength, recordbytes, static_cast<IT>(info[0]), static_cast<IT>(info[1]),
+		[](const char * rec)
+		{
+			IT row, col;	// records are packed, so they are not necessarily aligned
+			memcpy(&row, rec, sizeof(IT));
+			memcpy(&col, rec + sizeof(IT), sizeof(IT));
+			return std::make_pair(row, col);
+		},
+		[](const char * rec)
+		{
+			NT val;
+			memcpy(&val, rec + 2*sizeof(IT), sizeof(NT));
+			return val;
+		}, BinOp);
+}
+
+/**
+ * Reads a headerless binary edge list written by DistEdgeList::Dump64bit (indexbytes = 8) or Dump32bit (indexbytes = 4)
+ * The zero-based (source, destination) pairs are memory-mapped by all processes and decoded in place;
+ * every edge gets the value 1, deleted edges (negative or out of range indices) are skipped
+ **/
+template <class IT, class NT, class DER>
+template <typename _BinaryOperation>
+void SpParMat< IT,NT,DER >::ParallelReadEdgeList(const std::string & filename, IT total_m, IT total_n, int indexbytes, _BinaryOperation BinOp)
+{
+	MemoryTracker::Scope scope(MEM_IO);
+	auto one = [](const char * rec){ return static_cast<NT>(1); };
+	if(indexbytes == 8)
+	{
+		ReadMappedRecords(filename, 0, 2*sizeof(int64_t), total_m, total_n, [](const char * rec)
+		{
+			int64_t edge[2];
+			memcpy(edge, rec, sizeof(edge));
+			return std::make_pair(static_cast<IT>(edge[0]), static_cast<IT>(edge[1]));
+		}, one, BinOp);
+	}
+	else if(indexbytes == 4)
+	{
+		ReadMappedRecords(filename, 0, 2*sizeof(uint32_t), total_m, total_n, [](const char * rec)
+		{
+			uint32_t edge[2];
+			memcpy(edge, rec, sizeof(edge));
+			return std::make_pair(static_cast<IT>(edge[0]), static_cast<IT>(edge[1]));
+		}, one, BinOp);
+	}
+	else
+	{
+		SpParHelper::Print("COMBBLAS: Binary edge lists have 4 or 8 byte indices\n");
+		MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+	}
+}
+
+/**
+ * Writes the nonzeros in the block-compressed edge list format (see EdgeListHeader and SpHelper::EncodeEdgeBlock)
+ * Every process encodes its nonzeros, in the (column, row) order of the local storage, in blocks of EDGEBLOCKSIZE
+ * Values are stored uncompressed after the indices of each block, except for pattern matrices
+ **/
+template <class IT, class NT, class DER>
+void SpParMat< IT,NT,DER >::SaveCompressedEdges(const std::string & filename) const
+{
+	bool pattern = pattern_trait<DER>::value;
+	IT roffset = 0, coffset = 0;
+	GetPlaceInGlobalGrid(roffset, coffset);
+
+	EdgeListHeader header;
+	memset(&header, 0, sizeof(header));
+	header.ntsize = pattern? 0 : sizeof(NT);
+	header.m = getnrow();
+	header.n = getncol();
+
+	std::vector<IT> rows, cols;	// global indices
+	std::vector<char> vals;		// raw bytes of the values (also avoids std::vector<bool>)
+	rows.reserve(getlocalnnz());
+	cols.reserve(getlocalnnz());
+	for(typename DER::SpColIter colit = spSeq->begcol(); colit != spSeq->endcol(); ++colit)
+	{
+		for(typename DER::SpColIter::NzIter nzit = spSeq->begnz(colit); nzit != spSeq->endnz(colit); ++nzit)
+		{
+			rows.push_back(nzit.rowid() + roffset);
+			cols.push_back(colit.colid() + coffset);
+			if(!pattern)
+			{
+				NT value = nzit.value();
+				vals.insert(vals.end(), reinterpret_cast<const char *>(&value), reinterpret_cast<const char *>(&value) + sizeof(NT));
+			}
+		}
+	}
+
+	int64_t nblocks = (static_cast<int64_t>(rows.size()) + EDGEBLOCKSIZE - 1) / EDGEBLOCKSIZE;
+	std::vector< std::vector<unsigned char> > encoded(nblocks);
+	std::vector<uint64_t> blockbytes(nblocks), blockedges(nblocks);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for(int64_t b = 0; b < nblocks; ++b)
+	{
+		size_t start = b * EDGEBLOCKSIZE;
+		blockedges[b] = std::min(static_cast<size_t>(EDGEBLOCKSIZE), rows.size() - start);
+		SpHelper::EncodeEdgeBlock(rows.data() + start, cols.data() + start, pattern? NULL : vals.data() + start * sizeof(NT),
+					header.ntsize, blockedges[b], encoded[b]);
+		blockbytes[b] = encoded[b].size();
+	}
+	std::vector<unsigned char> blocks;
+	blocks.reserve(std::accumulate(blockbytes.begin(), blockbytes.end(), static_cast<uint64_t>(0)));
+	for(int64_t b = 0; b < nblocks; ++b)
+	{
+		blocks.insert(blocks.end(), encoded[b].begin(), encoded[b].end());
+		std::vector<unsigned char>().swap(encoded[b]);
+	}
+	WriteEdgeBlocks(filename, header, blocks, blockbytes, blockedges, commGrid->GetWorld());
+}
+
+/**
+ * Reads a block-compressed edge list, written by SaveCompressedEdges or DistEdgeList::DumpCompressed
+ * Every process maps its share of the blocks, decodes them with all its threads, and sends the edges to their owners
+ * Edges get the value 1 if the file stores no values; duplicates are combined with BinOp
+ **/
+template <class IT, class NT, class DER>
+template <typename _BinaryOperation>
+void SpParMat< IT,NT,DER >::ReadCompressedEdges(const std::string & filename, _BinaryOperation BinOp)
+{
+	EdgeListHeader header;
+	std::vector<uint64_t> blockoffsets, blockedges;
+	void * mapbase;
+	size_t maplength;
+	const unsigned char * blocks = MapEdgeBlocks(filename, header, blockoffsets, blockedges, mapbase, maplength, commGrid->GetWorld());
+	if(header.ntsize != 0 && header.ntsize != sizeof(NT))
+	{
+		SpParHelper::Print("COMBBLAS: Edge list " + filename + " stores values of a different type\n");
+		MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+	}
+
+	int64_t nblocks = blockedges.size();
+	std::vector<uint64_t> firstedge(nblocks+1, 0);
+	std::partial_sum(blockedges.begin(), blockedges.end(), firstedge.begin()+1);
+	std::vector<IT> rows(firstedge[nblocks]), cols(firstedge[nblocks]);
+	std::vector<char> vals(firstedge[nblocks] * header.ntsize);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(dynamic)
+#endif
+	for(int64_t b = 0; b < nblocks; ++b)
+	{
+		const unsigned char * values = SpHelper::DecodeEdgeBlock(blocks + blockoffsets[b], blockedges[b], rows.data() + firstedge[b], cols.data() + firstedge[b]);
+		if(header.ntsize > 0)
+			memcpy(vals.data() + firstedge[b] * sizeof(NT), values, blockedges[b] * sizeof(NT));
+	}
+	SpParHelper::UnmapFileRange(mapbase, maplength);
+
+	typedef typename DER::LocalIT LIT;
+	std::vector<int> sendcnt;
+	std::tuple<LIT,LIT,NT> * senddata = PackByOwner<LIT>(rows, cols, [&vals](IT i)
+								{
+									NT value = static_cast<NT>(1);
+									if(!vals.empty())	memcpy(&value, vals.data() + i * sizeof(NT), sizeof(NT));
+									return value;
+								},
+								static_cast<IT>(header.m), static_cast<IT>(header.n), sendcnt);
+	std::vector<IT>().swap(rows);
+	std::vector<IT>().swap(cols);
+	std::vector<char>().swap(vals);
+
+	FreeTranspose();
+	if(spSeq)   delete spSeq;
+	SparseCommon(senddata, sendcnt, static_cast<IT>(header.m), static_cast<IT>(header.n), BinOp);
 }
 
 
@@ -3789,16 +4805,18 @@ template <class IT, class NT, class DER>
 template <class HANDLER>
 void SpParMat< IT,NT,DER >::ParallelWriteMM(const std::string & filename, bool onebased, HANDLER handler)
 {
+    MemoryTracker::Scope scope(MEM_IO);
     int myrank = commGrid->GetRank();
     int nprocs = commGrid->GetSize();
     IT totalm = getnrow();
     IT totaln = getncol();
     IT totnnz = getnnz();
 
+    bool pattern = pattern_trait<DER>::value;	// values are implicit
     std::stringstream ss;
     if(myrank == 0)
     {
-        ss << "%%MatrixMarket matrix coordinate real general" << std::endl;
+        ss << "%%MatrixMarket matrix coordinate " << (pattern? "pattern" : "real") << " general" << std::endl;
         ss << totalm << " " << totaln << " " << totnnz << std::endl;
     }
     
@@ -3816,18 +4834,7 @@ void SpParMat< IT,NT,DER >::ParallelWriteMM(const std::string & filename, bool o
         coffset += 1;
     }
     
-    for(typename DER::SpColIter colit = spSeq->begcol(); colit != spSeq->endcol(); ++colit)    // iterate over nonempty subcolumns
-    {
-        for(typename DER::SpColIter::NzIter nzit = spSeq->begnz(colit); nzit != spSeq->endnz(colit); ++nzit)
-        {
-            IT glrowid = nzit.rowid() + roffset;
-            IT glcolid = colit.colid() + coffset;
-            ss << glrowid << '\t';
-            ss << glcolid << '\t';
-            handler.save(ss, nzit.value(), glrowid, glcolid);
-            ss << '\n';
-        }
-    }
+    WriteMMLines(ss, *spSeq, roffset, coffset, handler);
     std::string text = ss.str();
 
     int64_t * bytes = new int64_t[nprocs];
@@ -3872,6 +4879,270 @@ void SpParMat< IT,NT,DER >::ParallelWriteMM(const std::string & filename, bool o
 }
 
 
+/**
+ * Like ParallelWriteMM, but returns once the local block has been copied: the copy is formatted on a helper thread
+ * and written with nonblocking MPI-IO (see AsyncWrite), so the matrix can change, or go away, during the write
+ * The file is complete after the (collective) Wait of the returned handle
+ **/
+template <class IT, class NT, class DER>
+template <class HANDLER>
+AsyncWrite SpParMat< IT,NT,DER >::ParallelWriteMMAsync(const std::string & filename, bool onebased, HANDLER handler)
+{
+    MemoryTracker::Scope scope(MEM_IO);
+    IT totalm = getnrow();
+    IT totaln = getncol();
+    IT totnnz = getnnz();
+
+    std::stringstream ss;
+    if(commGrid->GetRank() == 0)
+    {
+        ss << "%%MatrixMarket matrix coordinate " << (pattern_trait<DER>::value? "pattern" : "real") << " general" << std::endl;
+        ss << totalm << " " << totaln << " " << totnnz << std::endl;
+    }
+    std::string header = ss.str();
+
+    IT roffset = 0;
+    IT coffset = 0;
+    GetPlaceInGlobalGrid(roffset, coffset);
+    if(onebased)
+    {
+        roffset += 1;
+        coffset += 1;
+    }
+    std::shared_ptr<DER> snapshot = std::make_shared<DER>(*spSeq);
+    return AsyncWrite(filename, [snapshot, header, roffset, coffset, handler](std::string & text) mutable
+    {
+        std::stringstream lines;
+        lines << header;
+        WriteMMLines(lines, *snapshot, roffset, coffset, handler);
+        text = lines.str();
+    }, commGrid->GetWorld());
+}
+
+//! Appends the nonzeros of a local block to os as Matrix Market lines, shifting indices by the offsets of the block
+template <class IT, class NT, class DER>
+template <class HANDLER>
+void SpParMat< IT,NT,DER >::WriteMMLines(std::ostream & os, DER & block, IT roffset, IT coffset, HANDLER & handler)
+{
+    bool pattern = pattern_trait<DER>::value;	// values are implicit
+    for(typename DER::SpColIter colit = block.begcol(); colit != block.endcol(); ++colit)    // iterate over nonempty subcolumns
+    {
+        for(typename DER::SpColIter::NzIter nzit = block.begnz(colit); nzit != block.endnz(colit); ++nzit)
+        {
+            IT glrowid = nzit.rowid() + roffset;
+            IT glcolid = colit.colid() + coffset;
+            os << glrowid << '\t';
+            os << glcolid;
+            if(!pattern)
+            {
+                os << '\t';
+                handler.save(os, nzit.value(), glrowid, glcolid);
+            }
+            os << '\n';
+        }
+    }
+}
+
+
+/**
+ * Reads (write = false) or writes the arrays of a local block, stored back to back from pos
+ * Collective: all processes pass the same number of arrays (those of the same DER)
+ * @return the number of bytes of the block
+ **/
+template <class IT, class NT, class DER>
+int64_t SpParMat< IT,NT,DER >::CheckpointArrays(MPI_File & fh, MPI_Offset pos, Arr<typename DER::LocalIT,NT> & arrinfo, bool write, MPI_Comm world)
+{
+	typedef typename DER::LocalIT LIT;
+	int64_t bytes = 0;
+	for(unsigned int i=0; i< arrinfo.indarrs.size(); ++i)	// index arrays
+	{
+		int64_t arrbytes = static_cast<int64_t>(arrinfo.indarrs[i].count) * sizeof(LIT);
+		SpParHelper::FileAccessAll(fh, pos + bytes, arrinfo.indarrs[i].addr, arrbytes, write, world);
+		bytes += arrbytes;
+	}
+	for(unsigned int i=0; i< arrinfo.numarrs.size(); ++i)	// numerical arrays
+	{
+		int64_t arrbytes = static_cast<int64_t>(arrinfo.numarrs[i].count) * sizeof(NT);
+		SpParHelper::FileAccessAll(fh, pos + bytes, arrinfo.numarrs[i].addr, arrbytes, write, world);
+		bytes += arrbytes;
+	}
+	return bytes;
+}
+
+/**
+ * Writes the matrix in the native binary checkpoint format: a CheckpointHeader, the arrays of
+ * every local block exactly as they are in memory (DCSC arrays for SpDCCols), and a block index
+ * All blocks are written with collective MPI-IO; the file is in native byte order and type sizes,
+ * which the header records together with the format version so that LoadCheckpoint can refuse a foreign file
+ **/
+template <class IT, class NT, class DER>
+void SpParMat< IT,NT,DER >::SaveCheckpoint(const std::string & filename) const
+{
+	MemoryTracker::Scope scope(MEM_IO);
+	typedef typename DER::LocalIT LIT;
+	int myrank = commGrid->GetRank();
+	int nprocs = commGrid->GetSize();
+	MPI_Comm World = commGrid->GetWorld();
+
+	CheckpointHeader header;
+	memset(&header, 0, sizeof(header));
+	strncpy(header.magic, "CBCKPT1", sizeof(header.magic));
+	header.byteorder = CHECKPOINT_BYTEORDER;
+	header.version = CHECKPOINT_VERSION;
+	header.itsize = sizeof(IT);
+	header.litsize = sizeof(LIT);
+	header.ntsize = pattern_trait<DER>::value ? 0 : sizeof(NT);
+	header.esscount = static_cast<uint32_t>(DER::esscount);
+	header.nprocs = nprocs;
+	header.gridrows = commGrid->GetGridRows();
+	header.gridcols = commGrid->GetGridCols();
+	header.m = getnrow();
+	header.n = getncol();
+	header.nnz = getnnz();
+
+	Arr<LIT,NT> arrinfo = spSeq->GetArrays();
+	int64_t blockbytes = 0;
+	for(unsigned int i=0; i< arrinfo.indarrs.size(); ++i)	blockbytes += static_cast<int64_t>(arrinfo.indarrs[i].count) * sizeof(LIT);
+	for(unsigned int i=0; i< arrinfo.numarrs.size(); ++i)	blockbytes += static_cast<int64_t>(arrinfo.numarrs[i].count) * sizeof(NT);
+
+	int64_t bytesuntil = 0;
+	MPI_Exscan(&blockbytes, &bytesuntil, 1, MPIType<int64_t>(), MPI_SUM, World);
+	if(myrank == 0) bytesuntil = 0;    // because MPI_Exscan says the recvbuf in process 0 is undefined
+	int64_t bytestotal = 0;
+	MPI_Allreduce(&blockbytes, &bytestotal, 1, MPIType<int64_t>(), MPI_SUM, World);
+	header.indexoffset = sizeof(CheckpointHeader) + bytestotal;
+
+	IT roffset = 0, coffset = 0;
+	GetPlaceInGlobalGrid(roffset, coffset);
+	std::vector<LIT> essentials = spSeq->GetEssentials();
+	std::vector<int64_t> record(3 + essentials.size());
+	record[0] = sizeof(CheckpointHeader) + bytesuntil;
+	record[1] = roffset;
+	record[2] = coffset;
+	std::copy(essentials.begin(), essentials.end(), record.begin()+3);
+	std::vector<int64_t> index;
+	if(myrank == 0)	index.resize(nprocs * record.size());
+	MPI_Gather(record.data(), record.size(), MPIType<int64_t>(), index.data(), record.size(), MPIType<int64_t>(), 0, World);
+
+	MPI_File thefile;
+	if(MPI_File_open(World, (char*) filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &thefile) != MPI_SUCCESS)
+	{
+		SpParHelper::Print("COMBBLAS: Checkpoint file " + filename + " can not be created\n");
+		MPI_Abort(MPI_COMM_WORLD, NOFILE);
+	}
+	MPI_File_set_size(thefile, 0);	// drop the contents of an older checkpoint
+	if(myrank == 0)
+	{
+		MPI_File_write_at(thefile, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+		MPI_File_write_at(thefile, header.indexoffset, index.data(), index.size(), MPIType<int64_t>(), MPI_STATUS_IGNORE);
+	}
+	CheckpointArrays(thefile, record[0], arrinfo, true, World);
+	MPI_File_close(&thefile);
+}
+
+/**
+ * Reads a checkpoint written by SaveCheckpoint, replacing the contents of this matrix
+ * On the grid it was written from, every process reads its block straight into the local arrays
+ * Otherwise the stored blocks are dealt round-robin, read, and redistributed to this grid
+ **/
+template <class IT, class NT, class DER>
+void SpParMat< IT,NT,DER >::LoadCheckpoint(const std::string & filename)
+{
+	MemoryTracker::Scope scope(MEM_IO);
+	typedef typename DER::LocalIT LIT;
+	int myrank = commGrid->GetRank();
+	int nprocs = commGrid->GetSize();
+	MPI_Comm World = commGrid->GetWorld();
+
+	MPI_File thefile;
+	if(MPI_File_open(World, (char*) filename.c_str(), MPI_MODE_RDONLY, MPI_INFO_NULL, &thefile) != MPI_SUCCESS)
+	{
+		SpParHelper::Print("COMBBLAS: Checkpoint file " + filename + " can not be found\n");
+		MPI_Abort(MPI_COMM_WORLD, NOFILE);
+	}
+	CheckpointHeader header;
+	memset(&header, 0, sizeof(header));
+	if(myrank == 0)
+		MPI_File_read_at(thefile, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+	MPI_Bcast(&header, sizeof(header), MPI_BYTE, 0, World);
+
+	header.magic[sizeof(header.magic)-1] = '\0';
+	if(strcmp(header.magic, "CBCKPT1") != 0)
+	{
+		SpParHelper::Print("COMBBLAS: " + filename + " is not a checkpoint file\n");
+		MPI_Abort(MPI_COMM_WORLD, NOFILE);
+	}
+	if(header.byteorder != CHECKPOINT_BYTEORDER)
+	{
+		SpParHelper::Print("COMBBLAS: Checkpoint " + filename + " was written on a host with a different byte order\n");
+		MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+	}
+	if(header.version != CHECKPOINT_VERSION)
+	{
+		std::ostringstream outs;
+		outs << "COMBBLAS: Checkpoint " << filename << " has format version " << header.version << ", this build reads version " << CHECKPOINT_VERSION << std::endl;
+		SpParHelper::Print(outs.str());
+		MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+	}
+	if(header.itsize != sizeof(IT) || header.litsize != sizeof(LIT) || header.esscount != static_cast<uint32_t>(DER::esscount)
+		|| header.ntsize != (pattern_trait<DER>::value ? 0 : sizeof(NT)))
+	{
+		SpParHelper::Print("COMBBLAS: Checkpoint " + filename + " was written with different index, value or storage types\n");
+		MPI_Abort(MPI_COMM_WORLD, DIMMISMATCH);
+	}
+
+	size_t recordlen = 3 + header.esscount;
+	std::vector<int64_t> index(header.nprocs * recordlen);
+	if(myrank == 0)
+		MPI_File_read_at(thefile, header.indexoffset, index.data(), index.size(), MPIType<int64_t>(), MPI_STATUS_IGNORE);
+	MPI_Bcast(index.data(), index.size(), MPIType<int64_t>(), 0, World);
+
+	FreeTranspose();
+	if(spSeq)   delete spSeq;
+	if(header.nprocs == static_cast<uint32_t>(nprocs) && header.gridrows == static_cast<uint32_t>(commGrid->GetGridRows())
+		&& header.gridcols == static_cast<uint32_t>(commGrid->GetGridCols()))
+	{
+		// same decomposition: the block stored by this rank is exactly our local block
+		int64_t * record = index.data() + myrank * recordlen;
+		spSeq = new DER();
+		spSeq->Create(std::vector<LIT>(record+3, record+recordlen));
+		Arr<LIT,NT> arrinfo = spSeq->GetArrays();
+		CheckpointArrays(thefile, record[0], arrinfo, false, World);
+		spSeq->ChooseLayout();	// the lookups are not stored
+	}
+	else
+	{
+		std::vector< std::vector < std::tuple<LIT,LIT,NT> > > data(nprocs);
+		LIT locsize = 0;
+		int rounds = (header.nprocs + nprocs - 1) / nprocs;
+		for(int r = 0; r < rounds; ++r)		// every process takes part in every round, with an empty block if it has none left
+		{
+			int stored = r * nprocs + myrank;
+			DER block;
+			int64_t * record = index.data() + stored * recordlen;
+			if(stored < static_cast<int>(header.nprocs))
+				block.Create(std::vector<LIT>(record+3, record+recordlen));
+			Arr<LIT,NT> arrinfo = block.GetArrays();
+			CheckpointArrays(thefile, (stored < static_cast<int>(header.nprocs)) ? record[0] : 0, arrinfo, false, World);
+			if(block.getnnz() == 0)	continue;
+
+			for(typename DER::SpColIter colit = block.begcol(); colit != block.endcol(); ++colit)
+			{
+				for(typename DER::SpColIter::NzIter nzit = block.begnz(colit); nzit != block.endnz(colit); ++nzit)
+				{
+					LIT lrow, lcol;
+					int owner = Owner(header.m, header.n, nzit.rowid() + record[1], colit.colid() + record[2], lrow, lcol);
+					data[owner].push_back(std::make_tuple(lrow, lcol, nzit.value()));
+					++locsize;
+				}
+			}
+		}
+		// stored blocks do not overlap, so there are no duplicates to combine
+		SparseCommon(data, locsize, static_cast<IT>(header.m), static_cast<IT>(header.n), [](const NT & a, const NT & b) { return a; });
+	}
+	MPI_File_close(&thefile);
+}
+
 
 //! Handles all sorts of orderings as long as there are no duplicates
 //! May perform better when the data is already reverse column-sorted (i.e. in decreasing order)
@@ -3880,6 +5151,8 @@ template <class IT, class NT, class DER>
 template <class HANDLER>
 void SpParMat< IT,NT,DER >::ReadDistribute (const std::string & filename, int master, bool nonum, HANDLER handler, bool transpose, bool pario)
 {
+	MemoryTracker::Scope scope(MEM_IO);
+	FreeTranspose();
 #ifdef TAU_PROFILE
    	TAU_PROFILE_TIMER(rdtimer, "ReadDistribute", "void SpParMat::ReadDistribute (const string & , int, bool, HANDLER, bool)", TAU_DEFAULT);
    	TAU_PROFILE_START(rdtimer);
@@ -47,6 +47,8 @@
 #include "Deleter.h"
 #include "SpHelper.h"
 #include "SpParHelper.h"
+#include "StringDictionary.h"
+#include "AsyncWrite.h"
 #include "DenseParMat.h"
 #include "FullyDistVec.h"
 #include "Friends.h"
@@ -72,6 +74,7 @@ public:
 	typedef typename DER::LocalNT LocalNT;
 	typedef IT GlobalIT;
 	typedef NT GlobalNT;
+	typedef typename create_trait<DER, LocalIT, bool>::T_inferred PatternDER;	//!< local storage of a boolean matrix with the same layout
 	
 	// Constructors
 	SpParMat ();
@@ -98,6 +101,16 @@ public:
 
 	float LoadImbalance() const;
 	void Transpose();
+	template <typename _BinaryOperation>
+	void Symmetrize(_BinaryOperation __binary_op);	//!< A = A + A^T, where __binary_op(A(i,j), A(j,i)) replaces "+" if both exist
+	void Symmetrize() { Symmetrize(std::plus<NT>()); }
+
+	//! A^T, built on first use (collective) and kept until the matrix is changed or FreeTranspose() is called
+	const SpParMat<IT,NT,DER> & T() const;
+	//! Nonzero pattern of A^T, for algorithms that only need its structure; cached like T()
+	const SpParMat<IT,bool,PatternDER> & PatternT() const;
+	bool HasTranspose() const { return (transposed != NULL || patterntransposed != NULL); }
+	void FreeTranspose();
 	void FreeMemory();
 	void EWiseMult (const SpParMat< IT,NT,DER >  & rhs, bool exclude);
 	void EWiseScale (const DenseParMat<IT,NT> & rhs);
@@ -144,6 +157,7 @@ public:
 	template <typename _UnaryOperation>
 	void Apply(_UnaryOperation __unary_op)
 	{
+		FreeTranspose();
 		spSeq->Apply(__unary_op);	
 	}
 
@@ -162,6 +176,7 @@ public:
 		GetPlaceInGlobalGrid(grow, gcol);
 		if (inPlace)
 		{
+			FreeTranspose();
 			spSeq->PruneI(__unary_op, inPlace, grow, gcol);
 			return SpParMat<IT,NT,DER>(getcommgrid()); // return blank to match signature
 		}
@@ -176,6 +191,7 @@ public:
 	{
 		if (inPlace)
 		{
+			FreeTranspose();
 			spSeq->Prune(__unary_op, inPlace);
 			return SpParMat<IT,NT,DER>(getcommgrid()); // return blank to match signature
 		}
@@ -231,6 +247,11 @@ public:
 						  BoolCopy2ndSRing<NT>>(v, dim, inplace);
 	}
 	
+	//! A = A(ri,ci) where ri and ci are permutations, by a single all-to-all of the nonzeros instead of SpGEMMs
+	void Permute(const FullyDistVec<IT,IT> & ri, const FullyDistVec<IT,IT> & ci);
+	//! Permute rows and columns (symmetrically if square) to balance nonzeros among processors; on return, A_new = A_old(rowperm, colperm)
+	void BalancePermute(FullyDistVec<IT,IT> & rowperm, FullyDistVec<IT,IT> & colperm, bool degreeaware = false);
+
 	void Prune(const FullyDistVec<IT,IT> & ri, const FullyDistVec<IT,IT> & ci);	//!< prune all entries whose row indices are in ri and column indices are in ci
 	void SpAsgn(const FullyDistVec<IT,IT> & ri, const FullyDistVec<IT,IT> & ci, SpParMat<IT,NT,DER> & B);
 	
@@ -273,9 +294,22 @@ public:
     template <class HANDLER>
     void ParallelWriteMM(const std::string & filename, bool onebased, HANDLER handler);
     void ParallelWriteMM(const std::string & filename, bool onebased) { ParallelWriteMM(filename, onebased, ScalarReadSaveHandler()); };
+    template <class HANDLER>
+    AsyncWrite ParallelWriteMMAsync(const std::string & filename, bool onebased, HANDLER handler);
+    AsyncWrite ParallelWriteMMAsync(const std::string & filename, bool onebased) { return ParallelWriteMMAsync(filename, onebased, ScalarReadSaveHandler()); };
 
     	template <typename _BinaryOperation>
     	FullyDistVec<IT,std::array<char, MAXVERTNAME>> ReadGeneralizedTuples(const std::string&, _BinaryOperation);
+
+	template <typename _BinaryOperation>
+	void ParallelReadBinary(const std::string & filename, _BinaryOperation BinOp);
+	template <typename _BinaryOperation>
+	void ParallelReadEdgeList(const std::string & filename, IT total_m, IT total_n, int indexbytes, _BinaryOperation BinOp);
+	void SaveCompressedEdges(const std::string & filename) const;
+	template <typename _BinaryOperation>
+	void ReadCompressedEdges(const std::string & filename, _BinaryOperation BinOp);
+	template <typename _BinaryOperation>
+	void GenGraph500Data(double initiator[4], int log_numverts, int edgefactor, bool scramble, bool removeloops, _BinaryOperation BinOp);
     
 	template <class HANDLER>
 	void ReadDistribute (const std::string & filename, int master, bool nonum, HANDLER handler, bool transpose = false, bool pario = false);
@@ -287,6 +321,9 @@ public:
 	template <class HANDLER>
 	void SaveGathered(std::string filename, HANDLER handler, bool transpose = false) const;
 	void SaveGathered(std::string filename) const { SaveGathered(filename, ScalarReadSaveHandler(), false); }
+
+	void SaveCheckpoint(const std::string & filename) const;
+	void LoadCheckpoint(const std::string & filename);
 	
 	std::ofstream& put(std::ofstream& outfile) const;
 
@@ -294,32 +331,36 @@ public:
 	typename DER::LocalIT getlocalrows() const { return spSeq->getnrow(); }
 	typename DER::LocalIT getlocalcols() const { return spSeq->getncol();} 
 	typename DER::LocalIT getlocalnnz() const { return spSeq->getnnz(); }
-	DER & seq() { return (*spSeq); }
-	DER * seqptr() { return spSeq; }
+	DER & seq() { FreeTranspose(); return (*spSeq); }	// the caller may modify the local block
+	DER * seqptr() { FreeTranspose(); return spSeq; }
+	const DER & seq() const { return (*spSeq); }	// read-only access keeps a cached T()
+	const DER * seqptr() const { return spSeq; }
     
     template <typename _BinaryOperation, typename LIT>
     void SparseCommon(std::vector< std::vector < std::tuple<LIT,LIT,NT> > > & data, LIT locsize, IT total_m, IT total_n, _BinaryOperation BinOp);
+    template <typename _BinaryOperation, typename LIT>
+    void SparseCommon(std::tuple<LIT,LIT,NT> * senddata, std::vector<int> & sendcnt, IT total_m, IT total_n, _BinaryOperation BinOp);
     //void SparseCommon(std::vector< std::vector < std::tuple<typename DER::LocalIT,typename DER::LocalIT,NT> > > & data, typename DER::LocalIT locsize, IT total_m, IT total_n, _BinaryOperation BinOp);
 
 	//! Friend declarations
 	template <typename SR, typename IU, typename NU1, typename NU2, typename UDER1, typename UDER2> 
 	friend IU
-	EstimateFLOP (SpParMat<IU,NU1,UDER1> & A, SpParMat<IU,NU2,UDER2> & B, bool clearA, bool clearB);
+	EstimateFLOP (const SpParMat<IU,NU1,UDER1> & A, const SpParMat<IU,NU2,UDER2> & B, bool clearA, bool clearB);
 
 	template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDER1, typename UDER2> 
 	friend SpParMat<IU, NUO, UDERO> 
-	Mult_AnXBn_DoubleBuff (SpParMat<IU,NU1,UDER1> & A, SpParMat<IU,NU2,UDER2> & B, bool clearA, bool clearB);
+	Mult_AnXBn_DoubleBuff (const SpParMat<IU,NU1,UDER1> & A, const SpParMat<IU,NU2,UDER2> & B, bool clearA, bool clearB);
 
 	template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDER1, typename UDER2> 
 	friend SpParMat<IU,NUO,UDERO> 
-	Mult_AnXBn_Synch (SpParMat<IU,NU1,UDER1> & A, SpParMat<IU,NU2,UDER2> & B, bool clearA, bool clearB);
+	Mult_AnXBn_Synch (const SpParMat<IU,NU1,UDER1> & A, const SpParMat<IU,NU2,UDER2> & B, bool clearA, bool clearB);
 
 	template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDER1, typename UDER2> 
 	friend SpParMat<IU,NUO,UDERO> 
-	Mult_AnXBn_Overlap (SpParMat<IU,NU1,UDER1> & A, SpParMat<IU,NU2,UDER2> & B, bool clearA, bool clearB);
+	Mult_AnXBn_Overlap (const SpParMat<IU,NU1,UDER1> & A, const SpParMat<IU,NU2,UDER2> & B, bool clearA, bool clearB);
     
     template <typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB>
-    friend int64_t EstPerProcessNnzSUMMA(SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B, bool hashEstimate);
+    friend int64_t EstPerProcessNnzSUMMA(const SpParMat<IU,NU1,UDERA> & A, const SpParMat<IU,NU2,UDERB> & B, bool hashEstimate);
 
 	template <typename SR, typename IU, typename NU1, typename NU2, typename UDER1, typename UDER2> 
 	friend SpParMat<IU,typename promote_trait<NU1,NU2>::T_promote,typename promote_trait<UDER1,UDER2>::T_promote> 
@@ -338,11 +379,11 @@ public:
 	Mult_AnXBn_SUMMA (SpParMat<IU,NU1,UDER1> & A, SpParMat<IU,NU2,UDER2> & B, bool clearA, bool clearB);
 
     template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB>
-    friend SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B,
+    friend SpParMat<IU,NUO,UDERO> MemEfficientSpGEMM (const SpParMat<IU,NU1,UDERA> & A, const SpParMat<IU,NU2,UDERB> & B,
                                                int phases, NUO hardThreshold, IU selectNum, IU recoverNum, NUO recoverPct, int kselectVersion, int64_t perProcessMem);
 
     template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDERA, typename UDERB>
-    friend int CalculateNumberOfPhases (SpParMat<IU,NU1,UDERA> & A, SpParMat<IU,NU2,UDERB> & B,
+    friend int CalculateNumberOfPhases (const SpParMat<IU,NU1,UDERA> & A, const SpParMat<IU,NU2,UDERB> & B,
                                                NUO hardThreshold, IU selectNum, IU recoverNum, NUO recoverPct, int kselectVersion, int64_t perProcessMem);
 
 	template <typename SR, typename IU, typename NUM, typename NUV, typename UDER> 
@@ -385,7 +426,6 @@ public:
 
 private:
 	typedef std::array<char, MAXVERTNAME> STRASARRAY;
-	typedef std::pair< STRASARRAY, uint64_t> TYPE2SEND;
 
 	class CharArraySaveHandler
 	{
@@ -400,7 +440,9 @@ private:
     		}
 	};
     
-	MPI_File TupleRead1stPassNExchange (const std::string & filename, TYPE2SEND * & senddata, IT & totsend, FullyDistVec<IT,STRASARRAY> & distmapper, uint64_t & totallength);
+	template <class HANDLER>
+	static void WriteMMLines(std::ostream & os, DER & block, IT roffset, IT coffset, HANDLER & handler);
+	void LabelTupleBatch(std::vector<std::string> & lines, StringDictionary & dictionary, std::vector<uint64_t> & rows, std::vector<uint64_t> & cols, std::vector<NT> & vals);
 
 	template <typename VT, typename GIT, typename _BinaryOperation, typename _UnaryOperation >
     	void Reduce(FullyDistVec<GIT,VT> & rvec, Dim dim, _BinaryOperation __binary_op, VT id, _UnaryOperation __unary_op, MPI_Op mympiop) const;
@@ -413,6 +455,30 @@ private:
                     IT coffset, const FullyDistVec<GIT,VT> & rvec) const;
     
     void GetPlaceInGlobalGrid(IT& rowOffset, IT& colOffset) const;
+	//! True for the semirings of operator(), with which indexing by a permutation just moves the values
+	template <typename SelectFirstSR, typename SelectSecondSR>
+	static constexpr bool IsSelectionSRing()
+	{
+		return std::is_same< SelectFirstSR, BoolCopy1stSRing<NT> >::value && std::is_same< SelectSecondSR, BoolCopy2ndSRing<NT> >::value;
+	}
+	bool PermutationMap(const FullyDistVec<IT,IT> & perm, Dim dim, std::vector<IT> & newind) const;
+	void PermuteInto(const std::vector<IT> & newrows, const std::vector<IT> & newcols, SpParMat<IT,NT,DER> & B);
+	static int64_t CheckpointArrays(MPI_File & fh, MPI_Offset pos, Arr<typename DER::LocalIT,NT> & arrinfo, bool write, MPI_Comm world);
+
+	template <typename LIT, typename _BinaryOperation>
+	DER * BlockFromTuples(std::tuple<LIT,LIT,NT> * tuples, LIT nnz, IT total_m, IT total_n, _BinaryOperation BinOp) const;
+	template <typename LIT>
+	DER * AssembleBlock(std::tuple<LIT,LIT,NT> * sorted, const std::vector<LIT> & colptr, const std::vector<LIT> & colnnz, LIT locrows, LIT loccols, std::true_type) const;
+	template <typename LIT>
+	DER * AssembleBlock(std::tuple<LIT,LIT,NT> * sorted, const std::vector<LIT> & colptr, const std::vector<LIT> & colnnz, LIT locrows, LIT loccols, std::false_type) const;
+	template <typename LIT, typename _ValueOperation>
+	std::tuple<LIT,LIT,NT> * PackByOwner(const std::vector<IT> & rows, const std::vector<IT> & cols, _ValueOperation valof, IT total_m, IT total_n, std::vector<int> & sendcnt) const;
+	template <typename LIT, typename _IndexOperation, typename _ValueOperation>
+	std::tuple<LIT,LIT,NT> * PackByOwner(IT locsize, _IndexOperation indof, _ValueOperation valof, IT total_m, IT total_n, std::vector<int> & sendcnt) const;
+	template <typename _BinaryOperation, typename _IndexOperation, typename _ValueOperation>
+	void ReadMappedRecords(const std::string & filename, int64_t headerbytes, int64_t recordbytes, IT total_m, IT total_n, 
+				_IndexOperation indof, _ValueOperation valof, _BinaryOperation BinOp);
+	FullyDistVec<IT,IT> HubSpreadingPerm(const FullyDistVec<IT,IT> & degrees, int nblocks) const;
 	
 	void HorizontalSend(IT * & rows, IT * & cols, NT * & vals, IT * & temprows, IT * & tempcols, NT * & tempvals, std::vector < std::tuple <IT,IT,NT> > & localtuples,
 						int * rcurptrs, int * rdispls, IT buffperrowneigh, int rowneighs, int recvcount, IT m_perproc, IT n_perproc, int rankinrow);
@@ -429,6 +495,8 @@ private:
 	
 	std::shared_ptr<CommGrid> commGrid; 
 	DER * spSeq;
+	SpParMat<IT,NT,DER> * transposed = NULL;	//!< cached by T()
+	SpParMat<IT,bool,PatternDER> * patterntransposed = NULL;	//!< cached by PatternT()
 	
 	template <class IU, class NU>
 	friend class DenseParMat;
@@ -438,14 +506,14 @@ private:
 };
 
 template <typename SR, typename NUO, typename UDERO, typename IU, typename NU1, typename NU2, typename UDER1, typename UDER2> 
-void PSpGEMM(SpParMat<IU,NU1,UDER1> & A, SpParMat<IU,NU2,UDER2> & B, SpParMat<IU,NUO,UDERO> & out, bool clearA = false, bool clearB = false)
+void PSpGEMM(const SpParMat<IU,NU1,UDER1> & A, const SpParMat<IU,NU2,UDER2> & B, SpParMat<IU,NUO,UDERO> & out, bool clearA = false, bool clearB = false)
 {
 	out = Mult_AnXBn_Synch<SR, NUO, UDERO> (A, B, clearA, clearB );
 }
 
 template <typename SR, typename IU, typename NU1, typename NU2, typename UDER1, typename UDER2> 
 SpParMat<IU,typename promote_trait<NU1,NU2>::T_promote,typename promote_trait<UDER2,UDER2>::T_promote>
-	PSpGEMM	(SpParMat<IU,NU1,UDER1> & A, SpParMat<IU,NU2,UDER2> & B, bool clearA = false, bool clearB = false)
+	PSpGEMM	(const SpParMat<IU,NU1,UDER1> & A, const SpParMat<IU,NU2,UDER2> & B, bool clearA = false, bool clearB = false)
 {
 	typedef typename promote_trait<NU1,NU2>::T_promote N_promote;
 	typedef typename promote_trait<UDER1,UDER2>::T_promote DER_promote;
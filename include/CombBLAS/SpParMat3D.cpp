@@ -54,14 +54,14 @@ namespace combblas
     }
 
     template <class IT, class NT, class DER>
-    SpParMat3D< IT,NT,DER >::SpParMat3D (DER * localMatrix, std::shared_ptr<CommGrid3D> grid3d, bool colsplit, bool special = false): commGrid3D(grid3d), colsplit(colsplit), special(special){
+    SpParMat3D< IT,NT,DER >::SpParMat3D (DER * localMatrix, std::shared_ptr<CommGrid3D> grid3d, bool colsplit, bool special): commGrid3D(grid3d), colsplit(colsplit), special(special){
         assert( (sizeof(IT) >= sizeof(typename DER::LocalIT)) );
         MPI_Comm_size(commGrid3D->fiberWorld, &nlayers);
         layermat.reset(new SpParMat<IT, NT, DER>(localMatrix, commGrid3D->layerWorld));
     }
 
     template <class IT, class NT, class DER>
-    SpParMat3D< IT,NT,DER >::SpParMat3D (const SpParMat< IT,NT,DER > & A2D, int nlayers, bool colsplit, bool special = false): nlayers(nlayers), colsplit(colsplit), special(special){
+    SpParMat3D< IT,NT,DER >::SpParMat3D (const SpParMat< IT,NT,DER > & A2D, int nlayers, bool colsplit, bool special): nlayers(nlayers), colsplit(colsplit), special(special){
         typedef typename DER::LocalIT LIT;
         auto commGrid2D = A2D.getcommgrid();
         int nprocs = commGrid2D->GetSize();
@@ -682,7 +682,7 @@ namespace combblas
                     //MPI_Bcast(Barrinfo.numarrs[idx].addr, Barrinfo.numarrs[idx].count, MPIType<NT>(), i, GridC->GetColWorld());
                 //}
                 Bbcast_nzc += Barrinfo.indarrs[1].count;
-                Bbcast_nnz += Barrinfo.numarrs[0].count;
+                Bbcast_nnz += Barrinfo.indarrs[2].count;
                 //MPI_Barrier(layermat->getcommgrid()->GetWorld());
                 t4 = MPI_Wtime();
                 MPI_Bcast(Barrinfo.indarrs[0].addr, Barrinfo.indarrs[0].count, MPIType<IT>(), i, GridC->GetColWorld());
@@ -707,7 +707,8 @@ namespace combblas
                 
                 //MPI_Barrier(layermat->getcommgrid()->GetWorld());
                 t4 = MPI_Wtime();
-                MPI_Bcast(Barrinfo.numarrs[0].addr, Barrinfo.numarrs[0].count, MPIType<NT>(), i, GridC->GetColWorld());
+                if(!Barrinfo.numarrs.empty())   // pattern matrices have no values to send
+                    MPI_Bcast(Barrinfo.numarrs[0].addr, Barrinfo.numarrs[0].count, MPIType<NT>(), i, GridC->GetColWorld());
                 //MPI_Barrier(layermat->getcommgrid()->GetWorld());
                 t5 = MPI_Wtime();
                 Bbcast_numarr_0_time += (t5-t4);
@@ -932,7 +933,7 @@ namespace combblas
             std::partial_sum(recvcnt, recvcnt+getcommgrid()->GetGridLayers()-1, rdispls+1);
             IT totrecv = std::accumulate(recvcnt,recvcnt+getcommgrid()->GetGridLayers(), static_cast<IT>(0));
             //std::tuple<LIT,LIT,NT>* recvTuples = new std::tuple<LIT,LIT,NT>[totrecv];
-            std::tuple<LIT,LIT,NT>* recvTuples = static_cast<std::tuple<LIT,LIT,NT>*> (::operator new (sizeof(std::tuple<LIT,LIT,NT>[totrecv])));
+            std::tuple<LIT,LIT,NT>* recvTuples = static_cast<std::tuple<LIT,LIT,NT>*> (Arena::Allocate(sizeof(std::tuple<LIT,LIT,NT>) * totrecv));
 #ifdef TIMING
             //MPI_Barrier(B.getcommgrid()->GetWorld());
             t3 = MPI_Wtime();
@@ -991,7 +992,7 @@ namespace combblas
 
             // Do not delete elements of recvChunks, because that would give segmentation fault due to double free
             //delete [] recvTuples;
-            ::operator delete(recvTuples);
+            Arena::Deallocate(recvTuples);
             for(int i = 0; i < recvChunks.size(); i++){
                 recvChunks[i]->tuples_deleted = true; // Temporary patch to avoid memory leak and segfault
                 delete recvChunks[i];
@@ -39,18 +39,18 @@ SpTuples<IT,NT>::SpTuples(int64_t size, IT nRow, IT nCol)
 {
 	if(nnz > 0)
 	{
-		tuples  = new std::tuple<IT, IT, NT>[nnz];
+		tuples  = ArenaNew< std::tuple<IT,IT,NT> >(nnz);
 	}
 	else
 	{
 		tuples = NULL;
 	}
-    isOperatorNew = false;
+    isArena = true;
 }
 
 template <class IT,class NT>
-SpTuples<IT,NT>::SpTuples (int64_t size, IT nRow, IT nCol, std::tuple<IT, IT, NT> * mytuples, bool sorted, bool isOpNew)
-:tuples(mytuples), m(nRow), n(nCol), nnz(size), isOperatorNew(isOpNew)
+SpTuples<IT,NT>::SpTuples (int64_t size, IT nRow, IT nCol, std::tuple<IT, IT, NT> * mytuples, bool sorted, bool arena)
+:tuples(mytuples), m(nRow), n(nCol), nnz(size), isArena(arena)
 {
     if(!sorted)
     {
@@ -69,10 +69,7 @@ SpTuples<IT,NT>::SpTuples (int64_t size, IT nRow, IT nCol, std::tuple<IT, IT, NT
 template <class IT, class NT>
 SpTuples<IT,NT>::SpTuples (int64_t maxnnz, IT nRow, IT nCol, std::vector<IT> & edges, bool removeloops):m(nRow), n(nCol)
 {
-	if(maxnnz > 0)
-	{
-		tuples  = new std::tuple<IT, IT, NT>[maxnnz];
-	}
+	tuples  = ArenaNew< std::tuple<IT,IT,NT> >(maxnnz);
 	for(int64_t i=0; i<maxnnz; ++i)
 	{
 		rowindex(i) = edges[2*i+0];
@@ -106,7 +103,7 @@ SpTuples<IT,NT>::SpTuples (int64_t maxnnz, IT nRow, IT nCol, std::vector<IT> & e
 		cnz = j;
 	}
 
-	std::tuple<IT, IT, NT> * ntuples = new std::tuple<IT,IT,NT>[nnz];
+	std::tuple<IT, IT, NT> * ntuples = ArenaNew< std::tuple<IT,IT,NT> >(nnz);
 	int64_t j = 0;
 	for(int64_t i=0; i<maxnnz; ++i)
 	{
@@ -117,9 +114,9 @@ SpTuples<IT,NT>::SpTuples (int64_t maxnnz, IT nRow, IT nCol, std::vector<IT> & e
 	}
 	assert(j == nnz);
 
-    delete [] tuples;
+    ArenaDelete(tuples);
 	tuples = ntuples;
-    isOperatorNew = false;
+    isArena = true;
 }
 
 
@@ -132,10 +129,10 @@ template <class IT, class NT>
 SpTuples<IT,NT>::SpTuples (int64_t size, IT nRow, IT nCol, StackEntry<NT, std::pair<IT,IT> > * & multstack)
 :m(nRow), n(nCol), nnz(size)
 {
-    isOperatorNew = false;
+    isArena = true;
 	if(nnz > 0)
 	{
-		tuples  = new std::tuple<IT, IT, NT>[nnz];
+		tuples  = ArenaNew< std::tuple<IT,IT,NT> >(nnz);
 	}
 	for(int64_t i=0; i<nnz; ++i)
 	{
@@ -153,10 +150,7 @@ SpTuples<IT,NT>::~SpTuples()
     // This tuples_deleted member is a temporary patch to avoid memory leak from MemEfficietnSpGEMM3D
 	if((nnz > 0) && (tuples_deleted != true))
 	{   
-        if(isOperatorNew)
-            ::operator delete(tuples);
-        else
-            delete [] tuples;
+        DeleteTuples();
 	}
 }
 
@@ -168,8 +162,8 @@ SpTuples<IT,NT>::~SpTuples()
 template <class IT,class NT>
 SpTuples<IT,NT>::SpTuples(const SpTuples<IT,NT> & rhs): m(rhs.m), n(rhs.n), nnz(rhs.nnz)
 {
-	tuples  = new std::tuple<IT, IT, NT>[nnz];
-    isOperatorNew = false;
+	tuples  = ArenaNew< std::tuple<IT,IT,NT> >(nnz);
+    isArena = true;
 	for(IT i=0; i< nnz; ++i)
 	{
 		tuples[i] = rhs.tuples[i];
@@ -184,7 +178,7 @@ SpTuples<IT,NT>::SpTuples (const SpDCCols<IT,NT> & rhs):  m(rhs.m), n(rhs.n), nn
 	{
 		FillTuples(rhs.dcsc);
 	}
-    isOperatorNew = false;
+    isArena = true;
 }
 
 
@@ -193,10 +187,10 @@ template <class IT, class NT>
 SpTuples<IT, NT>::SpTuples (const SpCCols<IT, NT> &rhs) :
 	m(rhs.m), n(rhs.n), nnz(rhs.nnz)
 {
-	isOperatorNew = false;
+	isArena = true;
 	if (nnz > 0)
 	{
-		tuples = new std::tuple<IT, IT, NT>[nnz];
+		tuples = ArenaNew< std::tuple<IT,IT,NT> >(nnz);
 		Csc<IT, NT> *csc = rhs.csc;
 		IT k = 0;
 		for (IT i = 0; i < csc->n; ++i)
@@ -216,7 +210,7 @@ SpTuples<IT, NT>::SpTuples (const SpCCols<IT, NT> &rhs) :
 template <class IT,class NT>
 inline void SpTuples<IT,NT>::FillTuples (Dcsc<IT,NT> * mydcsc)
 {
-	tuples  = new std::tuple<IT, IT, NT>[nnz];
+	tuples  = ArenaNew< std::tuple<IT,IT,NT> >(nnz);
 	IT k = 0;
 	for(IT i = 0; i< mydcsc->nzc; ++i)
 	{
@@ -241,19 +235,16 @@ SpTuples<IT,NT> & SpTuples<IT,NT>::operator=(const SpTuples<IT,NT> & rhs)
 		if(nnz > 0)
 		{
 			// make empty
-            if(isOperatorNew)
-                ::operator delete(tuples);
-            else
-                delete [] tuples;
+            DeleteTuples();
 		}
 		m = rhs.m;
 		n = rhs.n;
 		nnz = rhs.nnz;
-        isOperatorNew = false;
+        isArena = true;
 
 		if(nnz> 0)
 		{
-			tuples  = new std::tuple<IT, IT, NT>[nnz];
+			tuples  = ArenaNew< std::tuple<IT,IT,NT> >(nnz);
 			for(IT i=0; i< nnz; ++i)
 			{
 				tuples[i] = rhs.tuples[i];
@@ -287,12 +278,9 @@ void SpTuples<IT,NT>::RemoveDuplicates(BINFUNC BinOp)
 				
 			}
                 }
-        if(isOperatorNew)
-            ::operator delete(tuples);
-        else
-            delete [] tuples;
-		tuples  = new std::tuple<IT, IT, NT>[summed.size()];
-        isOperatorNew = false;
+        DeleteTuples();
+		tuples  = ArenaNew< std::tuple<IT,IT,NT> >(summed.size());
+        isArena = true;
     std::copy(summed.begin(), summed.end(), tuples);
 		nnz =  summed.size();
 	}
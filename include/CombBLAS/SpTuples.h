@@ -39,6 +39,7 @@
 #include "SpDefs.h"
 #include "StackEntry.h"
 #include "Compare.h"
+#include "Arena.h"
 
 namespace combblas {
 
@@ -67,7 +68,7 @@ class SpTuples: public SpMat<IT, NT, SpTuples<IT,NT> >
 public:
 	// Constructors 
 	SpTuples (int64_t size, IT nRow, IT nCol);
-	SpTuples (int64_t size, IT nRow, IT nCol, std::tuple<IT, IT, NT> * mytuples, bool sorted = false, bool isOpNew = false);
+	SpTuples (int64_t size, IT nRow, IT nCol, std::tuple<IT, IT, NT> * mytuples, bool sorted = false, bool arena = false);
 	SpTuples (int64_t maxnnz, IT nRow, IT nCol, std::vector<IT> & edges, bool removeloops = true);	// Graph500 contructor
 	SpTuples (int64_t size, IT nRow, IT nCol, StackEntry<NT, std::pair<IT,IT> > * & multstack);
 	SpTuples (const SpTuples<IT,NT> & rhs);	 	// Actual Copy constructor
@@ -130,7 +131,7 @@ public:
 			if(!existing[i])	missingindices.push_back(i);
 		}
 		IT toadd = n - loop;	// number of new entries needed (equals missingindices.size())
-		std::tuple<IT, IT, NT> * ntuples = new std::tuple<IT,IT,NT>[nnz+toadd];
+		std::tuple<IT, IT, NT> * ntuples = ArenaNew< std::tuple<IT,IT,NT> >(nnz+toadd);
 
     std::copy(tuples,tuples+nnz, ntuples);
 		
@@ -141,12 +142,9 @@ public:
 		{
 			ntuples[nnz+i] = std::make_tuple(missingindices[i], missingindices[i], loopval);
 		}
-        if(isOperatorNew)
-            ::operator delete(tuples);
-        else
-            delete [] tuples;
+        DeleteTuples();
 		tuples = ntuples;
-        isOperatorNew = false;
+        isArena = true;
 		nnz = nnz+toadd;
         
 		return loop;
@@ -179,7 +177,7 @@ public:
             if(!existing[i])	missingindices.push_back(i);
         }
         IT toadd = n - loop;	// number of new entries needed (equals missingindices.size())
-        std::tuple<IT, IT, NT> * ntuples = new std::tuple<IT,IT,NT>[nnz+toadd];
+        std::tuple<IT, IT, NT> * ntuples = ArenaNew< std::tuple<IT,IT,NT> >(nnz+toadd);
         
         std::copy(tuples,tuples+nnz, ntuples);
         
@@ -187,12 +185,9 @@ public:
         {
             ntuples[nnz+i] = std::make_tuple(missingindices[i], missingindices[i], loopvals[missingindices[i]]);
         }
-        if(isOperatorNew)
-            ::operator delete(tuples);
-        else
-            delete [] tuples;
+        DeleteTuples();
         tuples = ntuples;
-        isOperatorNew = false;
+        isArena = true;
         nnz = nnz+toadd;
         return loop;
     }
@@ -207,7 +202,7 @@ public:
 		{
 			if(joker::get<0>(tuples[i]) == joker::get<1>(tuples[i])) ++loop;
 		}
-		std::tuple<IT, IT, NT> * ntuples = new std::tuple<IT,IT,NT>[nnz-loop];
+		std::tuple<IT, IT, NT> * ntuples = ArenaNew< std::tuple<IT,IT,NT> >(nnz-loop);
 
 		IT ni = 0;
 		for(IT i=0; i< nnz; ++i)
@@ -217,12 +212,9 @@ public:
 				ntuples[ni++] = tuples[i];
 			}
 		}
-        if(isOperatorNew)
-            ::operator delete(tuples);
-        else
-            delete [] tuples;
+        DeleteTuples();
         tuples = ntuples;
-        isOperatorNew = false;
+        isArena = true;
 		nnz = nnz-loop;
 		return loop;
 	}
@@ -283,7 +275,15 @@ private:
 	IT m;
 	IT n;
 	int64_t nnz;
-    bool isOperatorNew; // if Operator New was used to allocate memory
+    bool isArena; // if tuples came from the arena (raw blocks from Arena::Allocate or arrays from ArenaNew) rather than new[]
+
+	void DeleteTuples()
+	{
+		if(isArena)
+			ArenaDelete(tuples);
+		else
+			delete [] tuples;
+	}
 
 	SpTuples (){};		// Default constructor does nothing, hide it
 	
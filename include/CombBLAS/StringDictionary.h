@@ -0,0 +1,125 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 6/15/2017 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc  --------------------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2017, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+#ifndef _STRING_DICTIONARY_H
+#define _STRING_DICTIONARY_H
+
+#include <vector>
+#include <string>
+#include <limits>
+#include <cstring>
+#include <algorithm>
+#include <stdint.h>
+#include "hash.hpp"
+
+namespace combblas {
+
+/**
+  * Open-addressing (linear probing) dictionary that maps strings to dense ids in insertion order
+  * Keys are stored back to back in one character array, so short vertex names cost only their length;
+  * the table itself holds ids and is rehashed from the stored hashes when it becomes half full
+  */
+class StringDictionary
+{
+public:
+	StringDictionary(): table(16, 0), offsets(1, 0) {};
+
+	static uint64_t Hash(const char * key, size_t len)
+	{
+		uint64_t hash;
+		MurmurHash3_x64_64(key, static_cast<int>(len), 0, &hash);
+		return hash;
+	}
+
+	//! The process that owns a key in a distributed dictionary: processes get equal ranges of hash values
+	static int Owner(uint64_t hash, int nprocs)
+	{
+		double range = static_cast<double>(hash) * static_cast<double>(nprocs);
+		int owner = static_cast<int>(range / static_cast<double>(std::numeric_limits<uint64_t>::max()));
+		return (owner < nprocs)? owner : nprocs-1;
+	}
+
+	//! Returns the id of the key, inserting it with the next id if it is not present
+	uint64_t Insert(const char * key, size_t len, uint64_t hash)
+	{
+		size_t mask = table.size()-1;
+		for(size_t slot = hash & mask; ; slot = (slot+1) & mask)
+		{
+			if(table[slot] == 0)
+			{
+				uint64_t id = hashes.size();
+				table[slot] = id+1;
+				hashes.push_back(hash);
+				keys.insert(keys.end(), key, key+len);
+				offsets.push_back(keys.size());
+				if(2*hashes.size() > table.size())	Grow();
+				return id;
+			}
+			uint64_t id = table[slot]-1;
+			if(hashes[id] == hash && KeyLength(id) == len && std::memcmp(KeyData(id), key, len) == 0)
+				return id;
+		}
+	}
+
+	size_t size() const { return hashes.size(); }
+	uint64_t KeyHash(uint64_t id) const { return hashes[id]; }
+	const char * KeyData(uint64_t id) const { return keys.data() + offsets[id]; }
+	size_t KeyLength(uint64_t id) const { return offsets[id+1] - offsets[id]; }
+	std::string Key(uint64_t id) const { return std::string(KeyData(id), KeyLength(id)); }
+
+	//! Ordering by (hash, key), which is the order of the dense ids given to a distributed dictionary
+	bool Less(uint64_t a, uint64_t b) const
+	{
+		if(hashes[a] != hashes[b])	return hashes[a] < hashes[b];
+		size_t lena = KeyLength(a), lenb = KeyLength(b);
+		int cmp = std::memcmp(KeyData(a), KeyData(b), std::min(lena, lenb));
+		return (cmp < 0) || (cmp == 0 && lena < lenb);
+	}
+
+private:
+	void Grow()
+	{
+		std::vector<uint64_t>(2*table.size(), 0).swap(table);
+		size_t mask = table.size()-1;
+		for(uint64_t id = 0; id < hashes.size(); ++id)
+		{
+			size_t slot = hashes[id] & mask;
+			while(table[slot] != 0)	slot = (slot+1) & mask;
+			table[slot] = id+1;
+		}
+	}
+
+	std::vector<uint64_t> table;	// ids plus one, or 0 for an empty slot
+	std::vector<uint64_t> hashes;	// hash of each id
+	std::vector<size_t> offsets;	// key of id i is keys[offsets[i]..offsets[i+1])
+	std::vector<char> keys;
+};
+
+}
+
+#endif
@@ -132,6 +132,7 @@ class SparseVectorLocalIterator: public VectorLocalIterator<IT, NT>
 	public:
 	SparseVectorLocalIterator(FullyDistSpVec<IT, NT>& in_v): v(in_v), iter_idx(0)
 	{
+		v.ToList();
 		if (v.ind.size() == 0)
 			iter_idx = -1;
 	}
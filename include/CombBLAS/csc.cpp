@@ -44,7 +44,7 @@ template <class IT, class NT>
 Csc<IT,NT>::Csc (IT size, IT nCol): nz(size),n(nCol)
 {
     assert(size != 0 && n != 0);
-    num = new NT[nz];
+    num = NewValues<NT>(nz);
     ir = new IT[nz];
     jc = new IT[n+1];
 }
@@ -55,7 +55,7 @@ Csc<IT,NT>::Csc (const Csc<IT,NT> & rhs): n(rhs.n), nz(rhs.nz)
     if(nz > 0)
     {
         ir	= new IT[nz];
-        num	= new NT[nz];
+        num	= NewValues<NT>(nz);
         std::copy(rhs.ir, rhs.ir+nz, ir); // copy(first, last, result)
         std::copy(rhs.num, rhs.num+nz, num);
     }
@@ -81,7 +81,7 @@ Csc<IT,NT> & Csc<IT,NT>::operator= (const Csc<IT,NT> & rhs)
         if(nz > 0)	// if the copied object is not empty
         {
             ir		= new IT[nz];
-            num	= new NT[nz];
+            num	= NewValues<NT>(nz);
             std::copy(rhs.ir, rhs.ir+nz, ir);
             std::copy(rhs.num, rhs.num+nz, num);
         }
@@ -121,7 +121,7 @@ void Csc<IT,NT>::Resize(IT nsize)
     
     NT * tmpnum = num;
     IT * tmpir = ir;
-    num	= new NT[nsize];
+    num	= NewValues<NT>(nsize);
     ir	= new IT[nsize];
     
     if(nsize > nz)	// Grow it
@@ -166,7 +166,7 @@ Csc<IT, NT>::PruneI (UnaryOperation unary_op,
 	NT	*oldnum = num;
 	jc			= new IT[n + 1];
 	ir			= new IT[prunednnz];
-	num			= new NT[prunednnz];
+	num			= NewValues<NT>(prunednnz);
 
 	IT	cnnz = 0;
 	jc[0]	 = 0;
@@ -36,6 +36,7 @@
 #include <cassert>
 #include "SpDefs.h"
 #include "SpHelper.h"
+#include "Pattern.h"
 
 namespace combblas {
 
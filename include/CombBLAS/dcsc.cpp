@@ -38,17 +38,17 @@
 namespace combblas {
 
 template <class IT, class NT>
-Dcsc<IT,NT>::Dcsc ():cp(NULL), jc(NULL), ir(NULL), numx(NULL),nz(0), nzc(0), memowned(true){}
+Dcsc<IT,NT>::Dcsc ():cp(NULL), jc(NULL), ir(NULL), numx(NULL), ir16(NULL), dcp(NULL), nz(0), nzc(0), ncol(0), memowned(true){}
 
 template <class IT, class NT>
-Dcsc<IT,NT>::Dcsc (IT nnz, IT nzcol): nz(nnz),nzc(nzcol),memowned(true)
+Dcsc<IT,NT>::Dcsc (IT nnz, IT nzcol): ir16(NULL), dcp(NULL), nz(nnz),nzc(nzcol), ncol(0), memowned(true)
 {
 	assert (nz != 0);
 	assert (nzc != 0);
-	cp = new IT[nzc+1];
-	jc = new IT[nzc];
-	ir = new IT[nz];
-	numx = new NT[nz];
+	cp = ArenaNew<IT>(nzc+1);
+	jc = ArenaNew<IT>(nzc);
+	ir = ArenaNew<IT>(nz);
+	numx = ArenaNewValues<NT>(nz);
 }
 
 //! GetIndices helper function for StackEntry arrays
@@ -183,7 +183,10 @@ Dcsc<IT,NT> & Dcsc<IT,NT>::AddAndAssign (StackEntry<NT, std::pair<IT,IT> > * mul
 		temp.cp[curnzc] = temp.cp[curnzc-1] + columncount;
 	}
 	temp.Resize(curnzc, curnz);
+	bool narrow = (ir16 != NULL);
+	IT cols = ncol;
 	*this = temp;
+	RebuildLookups(narrow, cols);
 	return *this;
 }
 
@@ -193,15 +196,15 @@ Dcsc<IT,NT> & Dcsc<IT,NT>::AddAndAssign (StackEntry<NT, std::pair<IT,IT> > * mul
   * \remark Complexity: O(nnz)
   */
 template <class IT, class NT>
-Dcsc<IT,NT>::Dcsc (StackEntry<NT, std::pair<IT,IT> > * multstack, IT mdim, IT ndim, IT nnz): nz(nnz),memowned(true)
+Dcsc<IT,NT>::Dcsc (StackEntry<NT, std::pair<IT,IT> > * multstack, IT mdim, IT ndim, IT nnz): ir16(NULL), dcp(NULL), nz(nnz), ncol(0), memowned(true)
 {
 	nzc = std::min(ndim, nnz);	// nzc can't exceed any of those
 
 	assert(nz != 0 );
-	cp = new IT[nzc+1];	// to be shrinked
-	jc = new IT[nzc];	// to be shrinked
-	ir = new IT[nz];
-	numx = new NT[nz];
+	cp = ArenaNew<IT>(nzc+1);	// to be shrinked
+	jc = ArenaNew<IT>(nzc);	// to be shrinked
+	ir = ArenaNew<IT>(nz);
+	numx = ArenaNewValues<NT>(nz);
 	
 	IT curnzc = 0;				// number of nonzero columns constructed so far
 	IT cindex = multstack[0].key.first;
@@ -236,13 +239,13 @@ Dcsc<IT,NT>::Dcsc (StackEntry<NT, std::pair<IT,IT> > * multstack, IT mdim, IT nd
   * \remark For these temporary matrices nz = nzc (which are both equal to nnz)
   */
 template <class IT, class NT>
-Dcsc<IT,NT>::Dcsc (IT nnz, const std::vector<IT> & indices, bool isRow): nz(nnz),nzc(nnz),memowned(true)
+Dcsc<IT,NT>::Dcsc (IT nnz, const std::vector<IT> & indices, bool isRow): ir16(NULL), dcp(NULL), nz(nnz),nzc(nnz), ncol(0), memowned(true)
 {
 	assert((nnz != 0) && (indices.size() == nnz));
-	cp = new IT[nnz+1];	
-	jc = new IT[nnz];
-	ir = new IT[nnz];
-	numx = new NT[nnz];
+	cp = ArenaNew<IT>(nnz+1);	
+	jc = ArenaNew<IT>(nnz);
+	ir = ArenaNew<IT>(nnz);
+	numx = ArenaNewValues<NT>(nnz);
 
 	SpHelper::iota(cp, cp+nnz+1, 0);  // insert sequential values {0,1,2,..}
 	std::fill_n(numx, nnz, static_cast<NT>(1));
@@ -273,6 +276,12 @@ Dcsc<IT,NT>::operator Dcsc<IT,NNT>() const
 	std::copy(ir, ir+nz, convert.ir);	// copy(first, last, result)
 	std::copy(jc, jc+nzc, convert.jc);
 	std::copy(cp, cp+nzc+1, convert.cp);
+	if(ir16 != NULL)
+	{
+		convert.ir16 = ArenaNew<uint16_t>(nz);
+		std::copy(ir16, ir16+nz, convert.ir16);
+	}
+	if(dcp != NULL)	convert.ChooseColumnLayout(ncol);
 	return convert;
 }
 
@@ -290,18 +299,29 @@ Dcsc<IT,NT>::operator Dcsc<NIT,NNT>() const
 		convert.jc[i] = static_cast<NIT>(jc[i]);
 	for(IT i=0; i<= nzc; ++i)
 		convert.cp[i] = static_cast<NIT>(cp[i]);
+	if(ir16 != NULL)
+	{
+		convert.ir16 = ArenaNew<uint16_t>(nz);
+		std::copy(ir16, ir16+nz, convert.ir16);
+	}
+	if(dcp != NULL)	convert.ChooseColumnLayout(ncol);
 	return convert;
 }
 
 template <class IT, class NT>
-Dcsc<IT,NT>::Dcsc (const Dcsc<IT,NT> & rhs): nz(rhs.nz), nzc(rhs.nzc),memowned(true)
+Dcsc<IT,NT>::Dcsc (const Dcsc<IT,NT> & rhs): ir16(NULL), dcp(NULL), nz(rhs.nz), nzc(rhs.nzc), ncol(0), memowned(true)
 {
 	if(nz > 0)
 	{
-		numx = new NT[nz];
-		ir = new IT[nz];
+		numx = ArenaNewValues<NT>(nz);
+		ir = ArenaNew<IT>(nz);
 		std::copy(rhs.numx, rhs.numx + nz, numx);	// numx can be a non-POD type
 		std::copy(rhs.ir, rhs.ir + nz, ir);
+		if(rhs.ir16 != NULL)
+		{
+			ir16 = ArenaNew<uint16_t>(nz);
+			std::copy(rhs.ir16, rhs.ir16 + nz, ir16);
+		}
 	}
 	else
 	{
@@ -310,10 +330,16 @@ Dcsc<IT,NT>::Dcsc (const Dcsc<IT,NT> & rhs): nz(rhs.nz), nzc(rhs.nzc),memowned(t
 	}
 	if(nzc > 0)
 	{
-		jc = new IT[nzc];
-		cp = new IT[nzc+1];
+		jc = ArenaNew<IT>(nzc);
+		cp = ArenaNew<IT>(nzc+1);
 		std::copy(rhs.jc, rhs.jc + nzc, jc);
 		std::copy(rhs.cp, rhs.cp + nzc + 1, cp);
+		if(rhs.dcp != NULL)
+		{
+			ncol = rhs.ncol;
+			dcp = ArenaNew<IT>(ncol+1);
+			std::copy(rhs.dcp, rhs.dcp + ncol + 1, dcp);
+		}
 	}
 	else
 	{
@@ -322,6 +348,20 @@ Dcsc<IT,NT>::Dcsc (const Dcsc<IT,NT> & rhs): nz(rhs.nz), nzc(rhs.nzc),memowned(t
 	}
 }
 
+template <class IT, class NT>
+Dcsc<IT,NT>::Dcsc (Dcsc<IT,NT> && rhs): cp(rhs.cp), jc(rhs.jc), ir(rhs.ir), numx(rhs.numx), ir16(rhs.ir16), dcp(rhs.dcp), nz(rhs.nz), nzc(rhs.nzc), ncol(rhs.ncol), memowned(rhs.memowned)
+{
+	rhs.cp = NULL;
+	rhs.jc = NULL;
+	rhs.ir = NULL;
+	rhs.numx = NULL;
+	rhs.ir16 = NULL;
+	rhs.dcp = NULL;
+	rhs.ncol = 0;
+	rhs.nz = 0;
+	rhs.nzc = 0;
+}
+
 /**
   * Assignment operator (called on an existing object)
   */
@@ -333,22 +373,29 @@ Dcsc<IT,NT> & Dcsc<IT,NT>::operator=(const Dcsc<IT,NT> & rhs)
 		// make empty first !
 		if(nz > 0)
 		{
-			delete[] numx;
-			delete[] ir;	
+			ArenaDelete(numx);
+			ArenaDelete(ir);	
 		}
 		if(nzc > 0)
 		{
-			delete[] jc;
-			delete[] cp;
+			ArenaDelete(jc);
+			ArenaDelete(cp);
 		}
+		DropNarrowRowIndices();
+		DropColumnLayout();
 		nz = rhs.nz;
 		nzc = rhs.nzc;
 		if(nz > 0)
 		{
-			numx = new NT[nz];
-			ir = new IT[nz];
+			numx = ArenaNewValues<NT>(nz);
+			ir = ArenaNew<IT>(nz);
 			std::copy(rhs.numx, rhs.numx + nz, numx);	// numx can be a non-POD type
 			std::copy(rhs.ir, rhs.ir + nz, ir);
+			if(rhs.ir16 != NULL)
+			{
+				ir16 = ArenaNew<uint16_t>(nz);
+				std::copy(rhs.ir16, rhs.ir16 + nz, ir16);
+			}
 		}
 		else
 		{
@@ -357,10 +404,16 @@ Dcsc<IT,NT> & Dcsc<IT,NT>::operator=(const Dcsc<IT,NT> & rhs)
 		}
 		if(nzc > 0)
 		{
-			jc = new IT[nzc];
-	                cp = new IT[nzc+1];
+			jc = ArenaNew<IT>(nzc);
+	                cp = ArenaNew<IT>(nzc+1);
         	        std::copy(rhs.jc, rhs.jc + nzc, jc);
                 	std::copy(rhs.cp, rhs.cp + nzc + 1, cp);
+			if(rhs.dcp != NULL)
+			{
+				ncol = rhs.ncol;
+				dcp = ArenaNew<IT>(ncol+1);
+				std::copy(rhs.dcp, rhs.dcp + ncol + 1, dcp);
+			}
 		}
 		else
 		{
@@ -374,44 +427,120 @@ Dcsc<IT,NT> & Dcsc<IT,NT>::operator=(const Dcsc<IT,NT> & rhs)
 template <class IT, class NT>
 Dcsc<IT, NT> & Dcsc<IT,NT>::operator+=(const Dcsc<IT,NT> & rhs)	// add and assign operator
 {
-	IT estnzc = nzc + rhs.nzc;
-	IT estnz  = nz + rhs.nz;
-	Dcsc<IT,NT> temp(estnz, estnzc);
+	return AddAndAssign(rhs, std::plus<NT>());	// might include zeros
+}
 
-	IT curnzc = 0;
-	IT curnz = 0;
+/**
+  * Union of the two nonzero structures, where entries that exist in both are combined as __binary_op(this, rhs)
+  * Two passes over ranges of merged columns with (roughly) equal nonzeros: count the size of each merged column, then fill
+  * \remarks Column indices of the merged columns are found by a sequential O(nzc + rhs.nzc) merge beforehand
+  */
+template <class IT, class NT>
+template <typename _BinaryOperation>
+Dcsc<IT,NT> & Dcsc<IT,NT>::AddAndAssign(const Dcsc<IT,NT> & rhs, _BinaryOperation __binary_op)
+{
+	if(rhs.nz == 0)	return *this;
+
+	// merged column k is column colA[k] of this and column colB[k] of rhs; nzc (resp. rhs.nzc) means it is empty there
+	std::vector<IT> mjc, colA, colB;
+	mjc.reserve(nzc + rhs.nzc);
+	colA.reserve(nzc + rhs.nzc);
+	colB.reserve(nzc + rhs.nzc);
 	IT i = 0;
 	IT j = 0;
-	temp.cp[0] = 0;
-	while(i< nzc && j<rhs.nzc)
+	while(i < nzc || j < rhs.nzc)
 	{
-		if(jc[i] > rhs.jc[j])
+		if(j == rhs.nzc || (i < nzc && jc[i] < rhs.jc[j]))
 		{
-			temp.jc[curnzc++] = rhs.jc[j++];
-			for(IT k = rhs.cp[j-1]; k< rhs.cp[j]; ++k)
-			{
-				temp.ir[curnz] 		= rhs.ir[k];
-				temp.numx[curnz++] 	= rhs.numx[k];
-			}
-			temp.cp[curnzc] = temp.cp[curnzc-1] + (rhs.cp[j] - rhs.cp[j-1]);
+			mjc.push_back(jc[i]);
+			colA.push_back(i++);
+			colB.push_back(rhs.nzc);
 		}
-		else if(jc[i] < rhs.jc[j])
+		else if(i == nzc || jc[i] > rhs.jc[j])
 		{
-			temp.jc[curnzc++] = jc[i++];
-			for(IT k = cp[i-1]; k< cp[i]; k++)
+			mjc.push_back(rhs.jc[j]);
+			colA.push_back(nzc);
+			colB.push_back(j++);
+		}
+		else
+		{
+			mjc.push_back(jc[i]);
+			colA.push_back(i++);
+			colB.push_back(j++);
+		}
+	}
+	IT mnzc = static_cast<IT>(mjc.size());
+	std::vector<IT> work(mnzc+1, 0);	// the merged cp before duplicates are accounted for
+	for(IT k=0; k < mnzc; ++k)
+	{
+		IT wk = 0;
+		if(colA[k] < nzc)	wk += cp[colA[k]+1] - cp[colA[k]];
+		if(colB[k] < rhs.nzc)	wk += rhs.cp[colB[k]+1] - rhs.cp[colB[k]];
+		work[k+1] = work[k] + wk;
+	}
+	int nthreads = 1;
+#ifdef _OPENMP
+	nthreads = omp_get_max_threads();
+#endif
+	std::vector<IT> splits = SpHelper::PartitionByWork(work, nthreads);
+
+	std::vector<IT> mcp(mnzc+1, 0);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+	for(int t=0; t < nthreads; ++t)
+	{
+		for(IT k=splits[t]; k < splits[t+1]; ++k)
+		{
+			if(colA[k] == nzc || colB[k] == rhs.nzc)
 			{
-				temp.ir[curnz] 		= ir[k];
-				temp.numx[curnz++] 	= numx[k];
+				mcp[k+1] = work[k+1] - work[k];
+				continue;
 			}
-			temp.cp[curnzc] = temp.cp[curnzc-1] + (cp[i] - cp[i-1]);
+			IT ii = cp[colA[k]];
+			IT jj = rhs.cp[colB[k]];
+			IT dups = 0;
+			while (ii < cp[colA[k]+1] && jj < rhs.cp[colB[k]+1])
+			{
+				if (ir[ii] < rhs.ir[jj])	++ii;
+				else if (ir[ii] > rhs.ir[jj])	++jj;
+				else
+				{
+					++dups; ++ii; ++jj;
+				}
+			}
+			mcp[k+1] = work[k+1] - work[k] - dups;
 		}
-		else
+	}
+	for(IT k=0; k < mnzc; ++k)
+		mcp[k+1] += mcp[k];
+
+	Dcsc<IT,NT> temp(mcp[mnzc], mnzc);
+	std::copy(mcp.begin(), mcp.end(), temp.cp);
+	std::copy(mjc.begin(), mjc.end(), temp.jc);
+#ifdef _OPENMP
+#pragma omp parallel for schedule(static, 1)
+#endif
+	for(int t=0; t < nthreads; ++t)
+	{
+		for(IT k=splits[t]; k < splits[t+1]; ++k)
 		{
-			temp.jc[curnzc++] = jc[i];
-			IT ii = cp[i];
-			IT jj = rhs.cp[j];
-			IT prevnz = curnz;		
-			while (ii < cp[i+1] && jj < rhs.cp[j+1])
+			IT curnz = mcp[k];
+			if(colB[k] == rhs.nzc)
+			{
+				std::copy(ir + cp[colA[k]], ir + cp[colA[k]+1], temp.ir + curnz);
+				std::copy(numx + cp[colA[k]], numx + cp[colA[k]+1], temp.numx + curnz);
+				continue;
+			}
+			if(colA[k] == nzc)
+			{
+				std::copy(rhs.ir + rhs.cp[colB[k]], rhs.ir + rhs.cp[colB[k]+1], temp.ir + curnz);
+				std::copy(rhs.numx + rhs.cp[colB[k]], rhs.numx + rhs.cp[colB[k]+1], temp.numx + curnz);
+				continue;
+			}
+			IT ii = cp[colA[k]];
+			IT jj = rhs.cp[colB[k]];
+			while (ii < cp[colA[k]+1] && jj < rhs.cp[colB[k]+1])
 			{
 				if (ir[ii] < rhs.ir[jj])
 				{
@@ -426,46 +555,29 @@ Dcsc<IT, NT> & Dcsc<IT,NT>::operator+=(const Dcsc<IT,NT> & rhs)	// add and assig
 				else
 				{
 					temp.ir[curnz] = ir[ii];
-                    temp.numx[curnz++] = numx[ii++] + rhs.numx[jj++];       // might include zeros
+					temp.numx[curnz++] = __binary_op(numx[ii++], rhs.numx[jj++]);
 				}
 			}
-			while (ii < cp[i+1])
+			while (ii < cp[colA[k]+1])
 			{
 				temp.ir[curnz] = ir[ii];
 				temp.numx[curnz++] = numx[ii++];
 			}
-			while (jj < rhs.cp[j+1])
+			while (jj < rhs.cp[colB[k]+1])
 			{
 				temp.ir[curnz] = rhs.ir[jj];
 				temp.numx[curnz++] = rhs.numx[jj++];
 			}
-			temp.cp[curnzc] = temp.cp[curnzc-1] + curnz-prevnz;
-			++i;
-			++j;
 		}
 	}
-	while(i< nzc)
-	{
-		temp.jc[curnzc++] = jc[i++];
-		for(IT k = cp[i-1]; k< cp[i]; ++k)
-		{
-			temp.ir[curnz] 	= ir[k];
-			temp.numx[curnz++] = numx[k];
-		}
-		temp.cp[curnzc] = temp.cp[curnzc-1] + (cp[i] - cp[i-1]);
-	}
-	while(j < rhs.nzc)
-	{
-		temp.jc[curnzc++] = rhs.jc[j++];
-		for(IT k = rhs.cp[j-1]; k< rhs.cp[j]; ++k)
-		{
-			temp.ir[curnz] 	= rhs.ir[k];
-			temp.numx[curnz++] 	= rhs.numx[k];
-		}
-		temp.cp[curnzc] = temp.cp[curnzc-1] + (rhs.cp[j] - rhs.cp[j-1]);
-	}
-	temp.Resize(curnzc, curnz);
-	*this = temp;
+	// take over the merged arrays, temp releases the old ones
+	std::swap(cp, temp.cp);
+	std::swap(jc, temp.jc);
+	std::swap(ir, temp.ir);
+	std::swap(numx, temp.numx);
+	std::swap(nz, temp.nz);
+	std::swap(nzc, temp.nzc);
+	RebuildLookups(ir16 != NULL, ncol);	// same dimensions, so the rows still fit
 	return *this;
 }
 
@@ -515,7 +627,14 @@ void Dcsc<IT,NT>::EWiseMult(const Dcsc<IT,NT> & rhs, bool exclude)
 {
 	// We have a class with a friend function and a member function with the same name. Calling the friend function from the member function 
 	// might (if the signature is the same) give compilation errors if not preceded by :: that denotes the global scope.
-	*this = combblas::EWiseMult((*this), &rhs, exclude);	// call the binary version
+	Dcsc<IT,NT> temp = combblas::EWiseMult((*this), &rhs, exclude);	// call the binary version
+	std::swap(cp, temp.cp);	// take over its arrays instead of copying them, temp releases the old ones
+	std::swap(jc, temp.jc);
+	std::swap(ir, temp.ir);
+	std::swap(numx, temp.numx);
+	std::swap(nz, temp.nz);
+	std::swap(nzc, temp.nzc);
+	RebuildLookups(ir16 != NULL, ncol);
 }
 
 
@@ -544,10 +663,10 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::PruneI(_UnaryOperation __unary_op, bool inPlace, Globa
 	IT * oldir = ir;	
 	NT * oldnumx = numx;	
 
-	cp = new IT[prunednzc+1];
-	jc = new IT[prunednzc];
-	ir = new IT[prunednnz];
-	numx = new NT[prunednnz];
+	cp = ArenaNew<IT>(prunednzc+1);
+	jc = ArenaNew<IT>(prunednzc);
+	ir = ArenaNew<IT>(prunednnz);
+	numx = ArenaNewValues<NT>(prunednnz);
 
 	IT cnzc = 0;
 	IT cnnz = 0;
@@ -574,9 +693,13 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::PruneI(_UnaryOperation __unary_op, bool inPlace, Globa
 	if (inPlace)
 	{
 		// delete the memory pointed by previous pointers
-		DeleteAll(oldnumx, oldir, oldjc, oldcp);
+		ArenaDelete(oldnumx);
+		ArenaDelete(oldir);
+		ArenaDelete(oldjc);
+		ArenaDelete(oldcp);
 		nz = cnnz;
 		nzc = cnzc;
+		RebuildLookups(ir16 != NULL, ncol);
 		return NULL;
 	}
 	else
@@ -589,6 +712,7 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::PruneI(_UnaryOperation __unary_op, bool inPlace, Globa
 		ret->numx = numx;
 		ret->nz = cnnz;
 		ret->nzc = cnzc;
+		ret->RebuildLookups(ir16 != NULL, ncol);
 
 		// put the previous pointers back		
 		cp = oldcp;
@@ -625,10 +749,10 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::Prune(_UnaryOperation __unary_op, bool inPlace)
 	IT * oldir = ir;	
 	NT * oldnumx = numx;	
 
-	cp = new IT[prunednzc+1];
-	jc = new IT[prunednzc];
-	ir = new IT[prunednnz];
-	numx = new NT[prunednnz];
+	cp = ArenaNew<IT>(prunednzc+1);
+	jc = ArenaNew<IT>(prunednzc);
+	ir = ArenaNew<IT>(prunednnz);
+	numx = ArenaNewValues<NT>(prunednnz);
 
 	IT cnzc = 0;
 	IT cnnz = 0;
@@ -655,9 +779,13 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::Prune(_UnaryOperation __unary_op, bool inPlace)
 	if (inPlace)
 	{
 		// delete the memory pointed by previous pointers
-		DeleteAll(oldnumx, oldir, oldjc, oldcp);
+		ArenaDelete(oldnumx);
+		ArenaDelete(oldir);
+		ArenaDelete(oldjc);
+		ArenaDelete(oldcp);
 		nz = cnnz;
 		nzc = cnzc;
+		RebuildLookups(ir16 != NULL, ncol);
 		return NULL;
 	}
 	else
@@ -670,6 +798,7 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::Prune(_UnaryOperation __unary_op, bool inPlace)
 		ret->numx = numx;
 		ret->nz = cnnz;
 		ret->nzc = cnzc;
+		ret->RebuildLookups(ir16 != NULL, ncol);
 
 		// put the previous pointers back		
 		cp = oldcp;
@@ -708,10 +837,10 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::PruneColumn(NT* pvals, _BinaryOperation __binary_op, b
     IT * oldir = ir;
     NT * oldnumx = numx;
     
-    cp = new IT[prunednzc+1];
-    jc = new IT[prunednzc];
-    ir = new IT[prunednnz];
-    numx = new NT[prunednnz];
+    cp = ArenaNew<IT>(prunednzc+1);
+    jc = ArenaNew<IT>(prunednzc);
+    ir = ArenaNew<IT>(prunednnz);
+    numx = ArenaNewValues<NT>(prunednnz);
     
     IT cnzc = 0;
     IT cnnz = 0;
@@ -738,9 +867,13 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::PruneColumn(NT* pvals, _BinaryOperation __binary_op, b
     if (inPlace)
     {
         // delete the memory pointed by previous pointers
-        DeleteAll(oldnumx, oldir, oldjc, oldcp);
+        ArenaDelete(oldnumx);
+        ArenaDelete(oldir);
+        ArenaDelete(oldjc);
+        ArenaDelete(oldcp);
         nz = cnnz;
         nzc = cnzc;
+        RebuildLookups(ir16 != NULL, ncol);
         return NULL;
     }
     else
@@ -753,6 +886,7 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::PruneColumn(NT* pvals, _BinaryOperation __binary_op, b
         ret->numx = numx;
         ret->nz = cnnz;
         ret->nzc = cnzc;
+        ret->RebuildLookups(ir16 != NULL, ncol);
         
         // put the previous pointers back		
         cp = oldcp;
@@ -802,10 +936,10 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::PruneColumn(IT* pinds, NT* pvals, _BinaryOperation __b
     IT * oldir = ir;
     NT * oldnumx = numx;
     
-    cp = new IT[prunednzc+1];
-    jc = new IT[prunednzc];
-    ir = new IT[prunednnz];
-    numx = new NT[prunednnz];
+    cp = ArenaNew<IT>(prunednzc+1);
+    jc = ArenaNew<IT>(prunednzc);
+    ir = ArenaNew<IT>(prunednnz);
+    numx = ArenaNewValues<NT>(prunednnz);
     
     IT cnzc = 0;
     IT cnnz = 0;
@@ -845,9 +979,13 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::PruneColumn(IT* pinds, NT* pvals, _BinaryOperation __b
     if (inPlace)
     {
         // delete the memory pointed by previous pointers
-        DeleteAll(oldnumx, oldir, oldjc, oldcp);
+        ArenaDelete(oldnumx);
+        ArenaDelete(oldir);
+        ArenaDelete(oldjc);
+        ArenaDelete(oldcp);
         nz = cnnz;
         nzc = cnzc;
+        RebuildLookups(ir16 != NULL, ncol);
         return NULL;
     }
     else
@@ -860,6 +998,7 @@ Dcsc<IT,NT>* Dcsc<IT,NT>::PruneColumn(IT* pinds, NT* pvals, _BinaryOperation __b
         ret->numx = numx;
         ret->nz = cnnz;
         ret->nzc = cnzc;
+        ret->RebuildLookups(ir16 != NULL, ncol);
         
         // put the previous pointers back
         cp = oldcp;
@@ -904,6 +1043,102 @@ void Dcsc<IT,NT>::UpdateDense(NT ** array, _BinaryOperation __binary_op) const
 	}
 }
 
+/**
+  * Counting sort of the entries by row: O(nnz + t*mdim) time, O(t*mdim) extra space for t threads
+  * Each thread takes a contiguous range of columns holding about nnz/t entries and counts its rows;
+  * a prefix over (row, thread) places every thread's part of a row after the parts of the threads
+  * on its left, so the in-order scatter leaves each new column sorted, with no atomics
+  * \remarks Const function; the returned Dcsc is owned by the caller
+  */
+template <class IT, class NT>
+Dcsc<IT,NT> * Dcsc<IT,NT>::Transpose(IT mdim) const
+{
+	Dcsc<IT,NT> * trans = NULL;
+	std::vector<IT> colsplit;	// thread t owns columns [colsplit[t], colsplit[t+1])
+	std::vector<IT> offsets;	// offsets[t*mdim+r]: entries of row r counted, then placed, by thread t
+	std::vector<IT> rowptr(mdim+1, 0);
+#ifdef _OPENMP
+#pragma omp parallel
+#endif
+	{
+		int t = 0;
+		int nthreads = 1;
+#ifdef _OPENMP
+		t = omp_get_thread_num();
+		nthreads = omp_get_num_threads();
+#pragma omp single
+#endif
+		{
+			colsplit.assign(nthreads+1, nzc);
+			for(int i=0; i < nthreads; ++i)
+			{
+				IT target = static_cast<IT>(static_cast<double>(nz) * i / nthreads);
+				colsplit[i] = (nzc > 0) ? (std::upper_bound(cp, cp+nzc, target) - cp - 1) : 0;
+			}
+			colsplit[0] = 0;
+			offsets.assign(static_cast<size_t>(nthreads) * mdim, 0);
+		}
+		IT * mycount = offsets.data() + static_cast<size_t>(t) * mdim;
+		for(IT i=colsplit[t]; i < colsplit[t+1]; ++i)
+			for(IT j=cp[i]; j < cp[i+1]; ++j)
+				++mycount[ir[j]];
+#ifdef _OPENMP
+#pragma omp barrier
+#pragma omp for
+#endif
+		for(IT r=0; r < mdim; ++r)
+		{
+			IT running = 0;
+			for(int i=0; i < nthreads; ++i)
+			{
+				IT count = offsets[static_cast<size_t>(i)*mdim + r];
+				offsets[static_cast<size_t>(i)*mdim + r] = running;
+				running += count;
+			}
+			rowptr[r+1] = running;
+		}
+#ifdef _OPENMP
+#pragma omp single
+#endif
+		{
+			IT nzr = 0;
+			for(IT r=0; r < mdim; ++r)
+			{
+				if(rowptr[r+1] > 0) ++nzr;
+				rowptr[r+1] += rowptr[r];
+			}
+			trans = new Dcsc<IT,NT>(nz, nzr);
+			IT k = 0;
+			for(IT r=0; r < mdim; ++r)
+			{
+				if(rowptr[r+1] > rowptr[r])
+				{
+					trans->jc[k] = r;
+					trans->cp[k++] = rowptr[r];
+				}
+			}
+			trans->cp[nzr] = nz;
+		}
+#ifdef _OPENMP
+#pragma omp for
+#endif
+		for(IT r=0; r < mdim; ++r)
+			for(int i=0; i < nthreads; ++i)
+				offsets[static_cast<size_t>(i)*mdim + r] += rowptr[r];
+
+		for(IT i=colsplit[t]; i < colsplit[t+1]; ++i)
+		{
+			for(IT j=cp[i]; j < cp[i+1]; ++j)
+			{
+				IT pos = mycount[ir[j]]++;
+				trans->ir[pos] = jc[i];
+				trans->numx[pos] = numx[j];
+			}
+		}
+	}
+	return trans;
+}
+
 /** 
   * Construct an index array called aux
   * Return the size of the contructed array
@@ -948,14 +1183,20 @@ void Dcsc<IT,NT>::Resize(IT nzcnew, IT nznew)
 {
 	if(nzcnew == 0)
 	{
-		delete[] jc;
-		delete[] cp;
+		ArenaDelete(jc);
+		ArenaDelete(cp);
+		DropColumnLayout();
+		jc = NULL;
+		cp = NULL;
 		nzc = 0;
 	}
 	if(nznew == 0)
 	{
-		delete[] ir;
-		delete[] numx;
+		ArenaDelete(ir);
+		ArenaDelete(numx);
+		DropNarrowRowIndices();
+		ir = NULL;
+		numx = NULL;
 		nz = 0;
 	}
 	if ( nzcnew == 0 && nznew == 0)
@@ -966,8 +1207,8 @@ void Dcsc<IT,NT>::Resize(IT nzcnew, IT nznew)
 	{
 		IT * tmpcp = cp; 
 		IT * tmpjc = jc;
-		cp = new IT[nzcnew+1];
-		jc = new IT[nzcnew];	
+		cp = ArenaNew<IT>(nzcnew+1);
+		jc = ArenaNew<IT>(nzcnew);	
 		if(nzcnew > nzc)	// Grow it (copy all of the old elements)
 		{
 			std::copy(tmpcp, tmpcp+nzc+1, cp);	// copy(first, end, result)
@@ -978,16 +1219,17 @@ void Dcsc<IT,NT>::Resize(IT nzcnew, IT nznew)
 			std::copy(tmpcp, tmpcp+nzcnew+1, cp);	
 			std::copy(tmpjc, tmpjc+nzcnew, jc);
 		}
-		delete[] tmpcp;	// delete the memory pointed by previous pointers
-		delete[] tmpjc;
+		ArenaDelete(tmpcp);	// delete the memory pointed by previous pointers
+		ArenaDelete(tmpjc);
 		nzc = nzcnew;
+		if(dcp != NULL)	ChooseColumnLayout(ncol);
 	}
 	if (nznew != nz)
 	{	
 		NT * tmpnumx = numx; 
 		IT * tmpir = ir;
-		numx = new NT[nznew];	
-		ir = new IT[nznew];
+		numx = ArenaNewValues<NT>(nznew);	
+		ir = ArenaNew<IT>(nznew);
 		if(nznew > nz)	// Grow it (copy all of the old elements)
 		{
 			std::copy(tmpnumx, tmpnumx+nz, numx);	// numx can be non-POD
@@ -998,12 +1240,71 @@ void Dcsc<IT,NT>::Resize(IT nzcnew, IT nznew)
 			std::copy(tmpnumx, tmpnumx+nznew, numx);	
 			std::copy(tmpir, tmpir+nznew, ir);
 		}
-		delete[] tmpnumx;	// delete the memory pointed by previous pointers
-		delete[] tmpir;
+		ArenaDelete(tmpnumx);	// delete the memory pointed by previous pointers
+		ArenaDelete(tmpir);
 		nz = nznew;
+		if(ir16 != NULL)	FillNarrowRowIndices();
 	}
 }
 
+/**
+  * Row ids of an mdim-by-x matrix fit in 16 bits if mdim <= 65536; kernels that stream row ids (SpMV, SpGEMM) 
+  * then read ir16 instead of ir, moving a quarter of the bytes for 64-bit indices
+  * \remark Called when a block is built or redistributed; the narrowing is kept by every member that rewrites ir
+ **/
+template <class IT, class NT>
+void Dcsc<IT,NT>::NarrowRowIndices(IT mdim)
+{
+	if(NARROW_ROW_INDICES && sizeof(IT) > sizeof(uint16_t) && nz > 0 && mdim <= static_cast<IT>(std::numeric_limits<uint16_t>::max()) + 1)
+		FillNarrowRowIndices();
+	else
+		DropNarrowRowIndices();
+}
+
+/**
+  * Columns of an x-by-ndim matrix are found by direct indexing into dcp if more than CSC_COLUMN_DENSITY of them are
+  * nonempty: such blocks are (nearly) CSC, and dcp costs at most as much as cp and jc do
+  * \remark Called when a block is built or redistributed, and after members that change its columns
+ **/
+template <class IT, class NT>
+void Dcsc<IT,NT>::ChooseColumnLayout(IT ndim)
+{
+	DropColumnLayout();
+	if(nzc == 0 || static_cast<double>(nzc) <= CSC_COLUMN_DENSITY * static_cast<double>(ndim))	return;
+	ncol = ndim;
+	dcp = ArenaNew<IT>(ncol+1);
+	IT k = 0;
+	for(IT c=0; c <= ncol; ++c)
+	{
+		while(k < nzc && jc[k] < c)	++k;
+		dcp[c] = k;
+	}
+}
+
+//! Remakes the lookups after the arrays of a block changed: ir16 if narrow, dcp (by density) if cols > 0
+template <class IT, class NT>
+void Dcsc<IT,NT>::RebuildLookups(bool narrow, IT cols)
+{
+	if(narrow)	FillNarrowRowIndices();
+	else	DropNarrowRowIndices();
+	if(cols > 0)	ChooseColumnLayout(cols);
+	else	DropColumnLayout();
+}
+
+//! (Re)builds ir16 from ir, whose entries are known to fit
+template <class IT, class NT>
+void Dcsc<IT,NT>::FillNarrowRowIndices()
+{
+	DropNarrowRowIndices();
+	if(nz == 0)	return;
+	ir16 = ArenaNew<uint16_t>(nz);
+#ifdef _OPENMP
+#pragma omp parallel for
+#endif
+	for(IT i=0; i < nz; ++i)
+		ir16[i] = static_cast<uint16_t>(ir[i]);
+}
+
 /**
   * The first part of the indexing algorithm described in the IPDPS'08 paper
   * @param[IT] colind {Column index to search}
@@ -1155,6 +1456,7 @@ void Dcsc<IT,NT>::Merge(const Dcsc<IT,NT> * A, const Dcsc<IT,NT> * B, IT cut)
 		// since numx is potentially non-POD, we use std::copy
 		std::copy(A->numx, A->numx + A->nz, numx);
 		std::copy(B->numx, B->numx + B->nz, numx + A->nz);
+		RebuildLookups(A->ir16 != NULL && B->ir16 != NULL, 0);	// both halves have the row dimension of this, the columns are up to the caller
 	}
 }
 
@@ -1199,6 +1501,10 @@ void Dcsc<IT,NT>::ColConcatenate(std::vector< Dcsc<IT,NT>* > & parts, std::vecto
         }
         // adjust the last pointer
         cp[run_nzc] = run_nz;
+        bool narrow = true;
+        for(size_t i=0; i< nmembers; ++i)
+            narrow = narrow && (parts[i]->ir16 != NULL);
+        RebuildLookups(narrow, 0);	// the number of columns is up to the caller
     }
 }
 
@@ -1206,50 +1512,32 @@ void Dcsc<IT,NT>::ColConcatenate(std::vector< Dcsc<IT,NT>* > & parts, std::vecto
  * param[in] nind { length(colsums), gives number of columns of A that contributes to C(:,i) }
  * Vector type VT is allowed to be different than matrix type (IT)
  * However, VT should be up-castable to IT (example: VT=int32_t, IT=int64_t)
+ * The lookup is chosen per block: direct indexing if the block has CSC layout (see IsCSC), aux based indexing
+ * if aux is given and the block is much denser than the request, and otherwise a merge of the two sorted lists 
+ * (galloping through jc with binary searches when the request is much shorter than jc)
  **/
 template<class IT, class NT>
 template<class VT>	
 void Dcsc<IT,NT>::FillColInds(const VT * colnums, IT nind, std::vector< std::pair<IT,IT> > & colinds, IT * aux, IT csize) const
 {
-	if ( aux == NULL || (nzc / nind) < THRESHOLD)   	// use scanning indexing
+	if(nind == 0)	return;
+	if ( IsCSC() || aux == NULL || (nzc / nind) < THRESHOLD)   	// use direct or scanning indexing
 	{
-		IT mink = std::min(nzc, nind);
-		std::pair<IT,IT> * isect = new std::pair<IT,IT>[mink];
-		std::pair<IT,IT> * range1 = new std::pair<IT,IT>[nzc];
-		std::pair<IT,IT> * range2 = new std::pair<IT,IT>[nind];
-		
-		for(IT i=0; i < nzc; ++i)
+		bool gallop = Gallop(nind);
+		IT i = 0;	// position in jc
+		for(IT j=0; j< nind; ++j)
 		{
-			range1[i] = std::make_pair(jc[i], i);	// get the actual nonzero value and the index to the ith nonzero
-		}
-		for(IT i=0; i < nind; ++i)
-		{
-			range2[i] = std::make_pair(static_cast<IT>(colnums[i]), 0);	// second is dummy as all the intersecting elements are copied from the first range
-		}
-
-		std::pair<IT,IT> * itr = set_intersection(range1, range1 + nzc, range2, range2+nind, isect, SpHelper::first_compare<IT> );
-		// isect now can iterate on a subset of the elements of range1
-		// meaning that the intersection can be accessed directly by isect[i] instead of range1[isect[i]]
-		// this is because the intersecting elements are COPIED to the output range "isect"
-
-		IT kisect = static_cast<IT>(itr-isect);		// size of the intersection 
-		for(IT j=0, i =0; j< nind; ++j)
-		{
-			// the elements represented by jc[isect[i]] are a subset of the elements represented by colnums[j]
-			if( i == kisect || isect[i].first != static_cast<IT>(colnums[j]))
+			if(FindCol(colnums[j], i, gallop))
 			{
-				// not found, signal by setting first = second
-				colinds[j].first = 0;
-				colinds[j].second = 0;	
+				colinds[j].first = cp[i];
+				colinds[j].second = cp[i+1];
 			}
-			else	// i < kisect && dcsc->jc[isect[i]] == colnums[j]
+			else 	// not found, signal by setting first = second
 			{
-				IT p = isect[i++].second;
-				colinds[j].first = cp[p];
-				colinds[j].second = cp[p+1];
+				colinds[j].first = 0;
+				colinds[j].second = 0;
 			}
 		}
-		DeleteAll(isect, range1, range2);
 	}
 	else	 	// use aux based indexing
 	{
@@ -1275,15 +1563,18 @@ void Dcsc<IT,NT>::FillColInds(const VT * colnums, IT nind, std::vector< std::pai
 template <class IT, class NT>
 Dcsc<IT,NT>::~Dcsc()
 {
+	ArenaDelete(ir16);		// always allocated by Dcsc itself
+	ArenaDelete(dcp);
+	if(!memowned)	return;		// arrays belong to the caller of the wrapping constructor
 	if(nz > 0)			// dcsc may be empty
 	{
-		delete[] numx;
-		delete[] ir;
+		ArenaDelete(numx);
+		ArenaDelete(ir);
 	}
 	if(nzc > 0)
 	{
-		delete[] jc;
-		delete[] cp;
+		ArenaDelete(jc);
+		ArenaDelete(cp);
 	}
 }
 
@@ -32,13 +32,15 @@
 #define _DCSC_H
 
 #include <cstdlib>
+#include <algorithm>
 #include <vector>
 #include <limits>
 #include <cassert>
 #include "SpDefs.h"
 #include "SpHelper.h"
+#include "Pattern.h"
 #include "StackEntry.h"
-#include "MemoryPool.h"
+#include "Arena.h"
 #include "promote.h"
 
 namespace combblas {
@@ -56,8 +58,11 @@ public:
 	Dcsc (StackEntry<NT, std::pair<IT,IT> > * multstack, IT mdim, IT ndim, IT nnz);
 
 	Dcsc (const Dcsc<IT,NT> & rhs);				// copy constructor
+	Dcsc (Dcsc<IT,NT> && rhs);				// move constructor, rhs is left empty
 	Dcsc<IT,NT> & operator=(const Dcsc<IT,NT> & rhs);	// assignment operator
 	Dcsc<IT,NT> & operator+=(const Dcsc<IT,NT> & rhs);	// add and assign operator
+	template <typename _BinaryOperation>
+	Dcsc<IT,NT> & AddAndAssign(const Dcsc<IT,NT> & rhs, _BinaryOperation __binary_op);	// add and assign, duplicates combined with __binary_op
 	~Dcsc();
 	
 	bool operator==(const Dcsc<IT,NT> & rhs);	
@@ -102,30 +107,72 @@ public:
 	void Merge(const Dcsc<IT,NT> * Adcsc, const Dcsc<IT,NT> * B, IT cut);	 //! \todo{special case of ColConcatenate, to be deprecated...}
 
 	IT ConstructAux(IT ndim, IT * & aux) const;
+	Dcsc<IT,NT> * Transpose(IT mdim) const;	//!< Transpose of the mdim-by-x matrix, by a threaded counting sort on rows
 	void Resize(IT nzcnew, IT nznew);
 
+	//! Keeps ir16 for an mdim-by-x matrix if its row ids fit in 16 bits (see NARROW_ROW_INDICES), drops it otherwise
+	void NarrowRowIndices(IT mdim);
+	void DropNarrowRowIndices() { ArenaDelete(ir16); ir16 = NULL; }
+
+	//! Keeps dcp for an x-by-ndim matrix if more than CSC_COLUMN_DENSITY of its columns are nonempty, drops it otherwise
+	void ChooseColumnLayout(IT ndim);
+	void DropColumnLayout() { ArenaDelete(dcp); dcp = NULL; ncol = 0; }
+
 	template<class VT>	
 	void FillColInds(const VT * colnums, IT nind, std::vector< std::pair<IT,IT> > & colinds, IT * aux, IT csize) const;
 
+	//! CSC layout: the block keeps the dense column pointer dcp, so columns are found by direct indexing
+	bool IsCSC() const { return dcp != NULL; }
+
+	//! Whether FindCol should binary search (rather than scan) for nind requested columns
+	bool Gallop(IT nind) const { return nind > 0 && (nzc / nind) >= THRESHOLD; }
+
+	/**
+	 * Looks up column c, for requests in increasing order: pos is a cursor into jc (start at 0), which is left at c's position
+	 * Direct indexing through dcp for CSC layout, otherwise scanning or binary searching (gallop) forward from pos
+	 */
+	template <class VT>
+	bool FindCol(VT c, IT & pos, bool gallop) const
+	{
+		IT col = static_cast<IT>(c);
+		if(IsCSC())
+		{
+			if(col >= ncol)	{ pos = nzc; return false; }
+			pos = dcp[col];
+			return dcp[col+1] > pos;
+		}
+		else if(gallop)
+			pos = std::lower_bound(jc + pos, jc + nzc, col) - jc;
+		else
+			while(pos < nzc && jc[pos] < col) ++pos;
+		return (pos < nzc && jc[pos] == col);
+	}
+
 	Dcsc<IT,NT> & AddAndAssign (StackEntry<NT, std::pair<IT,IT> > * multstack, IT mdim, IT ndim, IT nnz);
 
 	template <typename _BinaryOperation>
 	void UpdateDense(NT ** array, _BinaryOperation __binary_op) const;	// update dense 2D array's entries with __binary_op using elements of "this"
     
     //! wrap object around pre-allocated arrays (possibly RDMA registered)
+    //! owned arrays must come from ArenaNew (see Arena.h), like the ones Dcsc allocates itself
     Dcsc (IT * _cp, IT * _jc, IT * _ir, NT * _numx, IT _nz, IT _nzc, bool _memowned = true)
-    : cp(_cp), jc(_jc), ir(_ir), numx(_numx), nz(_nz), nzc(_nzc), memowned(_memowned) {};
+    : cp(_cp), jc(_jc), ir(_ir), numx(_numx), ir16(NULL), dcp(NULL), nz(_nz), nzc(_nzc), ncol(0), memowned(_memowned) {};
 
 	IT * cp;		//!<  The master array, size nzc+1 (keeps column pointers)
 	IT * jc ;		//!<  col indices, size nzc
 	IT * ir ;		//!<  row indices, size nz
 	NT * numx;		//!<  generic values, size nz
+	uint16_t * ir16;	//!<  ir narrowed to 16 bits, size nz, or NULL; members that rewrite ir keep it in sync
+	IT * dcp;		//!<  dense column pointer, size ncol+1, or NULL: column c is jc[dcp[c]] if dcp[c+1] > dcp[c], and empty otherwise
 	
 	IT nz;
 	IT nzc;			//!<  number of columns with at least one non-zero in them
+	IT ncol;		//!<  number of columns dcp covers (0 without dcp)
     bool memowned;
 
 private:
+	void FillNarrowRowIndices();
+	void RebuildLookups(bool narrow, IT cols);
 	void getindices (StackEntry<NT, std::pair<IT,IT> > * multstack, IT & rindex, IT & cindex, IT & j, IT nnz);
 };
 
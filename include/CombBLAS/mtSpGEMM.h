@@ -77,6 +77,7 @@ SpTuples<IT, NTO> * LocalSpGEMM
  const SpDCCols<IT, NT2> & B,
  bool clearA, bool clearB)
 {
+    MemoryTracker::Scope scope(MEM_SPGEMM_LOCAL);
     IT mdim = A.getnrow();
     IT ndim = B.getncol();
     IT nnzA = A.getnnz();
@@ -107,11 +108,11 @@ SpTuples<IT, NTO> * LocalSpGEMM
     IT* colptrC = prefixsum<IT>(colnnzC, Bdcsc->nzc, numThreads);
     delete [] colnnzC;
     IT nnzc = colptrC[Bdcsc->nzc];
-    std::tuple<IT,IT,NTO> * tuplesC = static_cast<std::tuple<IT,IT,NTO> *> (::operator new (sizeof(std::tuple<IT,IT,NTO>[nnzc])));
+    std::tuple<IT,IT,NTO> * tuplesC = static_cast<std::tuple<IT,IT,NTO> *> (Arena::Allocate(sizeof(std::tuple<IT,IT,NTO>) * nnzc));
 	
     // thread private space for heap and colinds
     std::vector<std::vector< std::pair<IT,IT>>> colindsVec(numThreads);
-    std::vector<std::vector<HeapEntry<IT,NT1>>> globalheapVec(numThreads);
+    std::vector<std::vector<HeapEntry<IT,NT1>, ArenaAllocator<HeapEntry<IT,NT1>>>> globalheapVec(numThreads);
     
     for(int i=0; i<numThreads; i++) //inital allocation per thread, may be an overestimate, but does not require more memoty than inputs
     {
@@ -216,7 +217,7 @@ SpTuples<IT, NTO> * LocalHybridSpGEMM
  const SpDCCols<IT, NT2> & B,
  bool clearA, bool clearB, IT * aux = nullptr)
 {
-
+    MemoryTracker::Scope scope(MEM_SPGEMM_LOCAL);
 
     IT mdim = A.getnrow();
     IT ndim = B.getncol();
@@ -269,14 +270,14 @@ SpTuples<IT, NTO> * LocalHybridSpGEMM
     // std::cout << "NNZ of A * B is " << nnzc << std::endl;
     // std::cout << "Compression ratio is " << compression_ratio << std::endl;
 
-    std::tuple<IT,IT,NTO> * tuplesC = static_cast<std::tuple<IT,IT,NTO> *> (::operator new (sizeof(std::tuple<IT,IT,NTO>[nnzc])));
+    std::tuple<IT,IT,NTO> * tuplesC = static_cast<std::tuple<IT,IT,NTO> *> (Arena::Allocate(sizeof(std::tuple<IT,IT,NTO>) * nnzc));
    //std::tuple<IT,IT,NTO> * tuplesC = new std::tuple<IT,IT,NTO>[nnzc];
        
     // thread private space for heap and colinds
     std::vector<std::vector< std::pair<IT,IT>>> colindsVec(numThreads);
    
-     std::vector<std::vector< std::pair<IT,NTO>>> globalHashVecAll(numThreads); 
-     std::vector<std::vector< HeapEntry<IT,NT1>>> globalHeapVecAll(numThreads);
+     std::vector<std::vector< std::pair<IT,NTO>, ArenaAllocator<std::pair<IT,NTO>>>> globalHashVecAll(numThreads); 
+     std::vector<std::vector< HeapEntry<IT,NT1>, ArenaAllocator<HeapEntry<IT,NT1>>>> globalHeapVecAll(numThreads);
     /*
     for(int i=0; i<numThreads; i++) //inital allocation per thread, may be an overestimate, but does not require more memoty than inputs
     {
@@ -392,35 +393,40 @@ SpTuples<IT, NTO> * LocalHybridSpGEMM
             }
             
             // Multiply and add on Hash table
-            for (size_t j=0; j < nnzcolB; ++j)
+            auto hashcolumn = [&](const auto * rowids)	// Adcsc->ir, or Adcsc->ir16 if the block keeps it
             {
-                IT t_bcol = Bdcsc->ir[Bdcsc->cp[i] + j];
-                NT2 t_bval = Bdcsc->numx[Bdcsc->cp[i] + j];
-                for (IT k = colinds[j].first; k < colinds[j].second; ++k)
+                for (size_t j=0; j < nnzcolB; ++j)
                 {
-                    NTO mrhs = SR::multiply(Adcsc->numx[k], t_bval);
-                    IT key = Adcsc->ir[k];
-                    IT hash = (key*hashScale) & (ht_size-1);
-                    while (1) //hash probing
+                    IT t_bcol = Bdcsc->ir[Bdcsc->cp[i] + j];
+                    NT2 t_bval = Bdcsc->numx[Bdcsc->cp[i] + j];
+                    for (IT k = colinds[j].first; k < colinds[j].second; ++k)
                     {
-                        if (globalHashVec[hash].first == key) //key is found in hash table
-                        {
-                            globalHashVec[hash].second = SR::add(mrhs, globalHashVec[hash].second);
-                            break;
-                        }
-                        else if (globalHashVec[hash].first == -1) //key is not registered yet
-                        {
-                            globalHashVec[hash].first = key;
-                            globalHashVec[hash].second = mrhs;
-                            break;
-                        }
-                        else //key is not found
+                        NTO mrhs = SR::multiply(Adcsc->numx[k], t_bval);
+                        IT key = rowids[k];
+                        IT hash = (key*hashScale) & (ht_size-1);
+                        while (1) //hash probing
                         {
-                            hash = (hash+1) & (ht_size-1);
+                            if (globalHashVec[hash].first == key) //key is found in hash table
+                            {
+                                globalHashVec[hash].second = SR::add(mrhs, globalHashVec[hash].second);
+                                break;
+                            }
+                            else if (globalHashVec[hash].first == -1) //key is not registered yet
+                            {
+                                globalHashVec[hash].first = key;
+                                globalHashVec[hash].second = mrhs;
+                                break;
+                            }
+                            else //key is not found
+                            {
+                                hash = (hash+1) & (ht_size-1);
+                            }
                         }
                     }
                 }
-            }
+            };
+            if(Adcsc->ir16 != NULL)	hashcolumn(Adcsc->ir16);
+            else	hashcolumn(Adcsc->ir);
             // gather non-zero elements from hash table, and then sort them by row indices
             size_t index = 0;
             for (size_t j=0; j < ht_size; ++j)
@@ -466,7 +472,7 @@ SpTuples<IT, NTO> * LocalHybridSpGEMM
      const SpDCCols<IT, NT2> & B,
      bool clearA, bool clearB, bool sort=true)
     {
-
+        MemoryTracker::Scope scope(MEM_SPGEMM_LOCAL);
         double t0=MPI_Wtime();
 
         IT mdim = A.getnrow();
@@ -512,8 +518,7 @@ SpTuples<IT, NTO> * LocalHybridSpGEMM
         // std::cout << "NNZ of A * B is " << nnzc << std::endl;
         // std::cout << "Compression ratio is " << compression_ratio << std::endl;
 
-        // std::tuple<IT,IT,NTO> * tuplesC = static_cast<std::tuple<IT,IT,NTO> *> (::operator new (sizeof(std::tuple<IT,IT,NTO>[nnzc])));
-        std::tuple<IT,IT,NTO> * tuplesC = new std::tuple<IT,IT,NTO>[nnzc];
+        std::tuple<IT,IT,NTO> * tuplesC = static_cast<std::tuple<IT,IT,NTO> *> (Arena::Allocate(sizeof(std::tuple<IT,IT,NTO>) * nnzc));
 
         // thread private space for heap and colinds
         std::vector<std::vector< std::pair<IT,IT>>> colindsVec(numThreads);
@@ -560,7 +565,7 @@ SpTuples<IT, NTO> * LocalHybridSpGEMM
             {
                 ht_size <<= 1;
             }
-            std::vector< std::pair<IT,NTO>> globalHashVec(ht_size);
+            std::vector< std::pair<IT,NTO>, ArenaAllocator<std::pair<IT,NTO>>> globalHashVec(ht_size);
 
             // colinds.first vector keeps indices to A.cp, i.e. it dereferences "colnums" vector (above),
             // colinds.second vector keeps the end indices (i.e. it gives the index to the last valid element of A.cpnack)
@@ -572,35 +577,40 @@ SpTuples<IT, NTO> * LocalHybridSpGEMM
             }
 
             // Multiply and add on Hash table
-            for (size_t j=0; j < nnzcolB; ++j)
+            auto hashcolumn = [&](const auto * rowids)	// Adcsc->ir, or Adcsc->ir16 if the block keeps it
             {
-                IT t_bcol = Bdcsc->ir[Bdcsc->cp[i] + j];
-                NT2 t_bval = Bdcsc->numx[Bdcsc->cp[i] + j];
-                for (IT k = colinds[j].first; k < colinds[j].second; ++k)
+                for (size_t j=0; j < nnzcolB; ++j)
                 {
-                    NTO mrhs = SR::multiply(Adcsc->numx[k], t_bval);
-                    IT key = Adcsc->ir[k];
-                    IT hash = (key*hashScale) & (ht_size-1);
-                    while (1) //hash probing
+                    IT t_bcol = Bdcsc->ir[Bdcsc->cp[i] + j];
+                    NT2 t_bval = Bdcsc->numx[Bdcsc->cp[i] + j];
+                    for (IT k = colinds[j].first; k < colinds[j].second; ++k)
                     {
-                        if (globalHashVec[hash].first == key) //key is found in hash table
-                        {
-                            globalHashVec[hash].second = SR::add(mrhs, globalHashVec[hash].second);
-                            break;
-                        }
-                        else if (globalHashVec[hash].first == -1) //key is not registered yet
-                        {
-                            globalHashVec[hash].first = key;
-                            globalHashVec[hash].second = mrhs;
-                            break;
-                        }
-                        else //key is not found
+                        NTO mrhs = SR::multiply(Adcsc->numx[k], t_bval);
+                        IT key = rowids[k];
+                        IT hash = (key*hashScale) & (ht_size-1);
+                        while (1) //hash probing
                         {
-                            hash = (hash+1) & (ht_size-1);
+                            if (globalHashVec[hash].first == key) //key is found in hash table
+                            {
+                                globalHashVec[hash].second = SR::add(mrhs, globalHashVec[hash].second);
+                                break;
+                            }
+                            else if (globalHashVec[hash].first == -1) //key is not registered yet
+                            {
+                                globalHashVec[hash].first = key;
+                                globalHashVec[hash].second = mrhs;
+                                break;
+                            }
+                            else //key is not found
+                            {
+                                hash = (hash+1) & (ht_size-1);
+                            }
                         }
                     }
                 }
-            }
+            };
+            if(Adcsc->ir16 != NULL)	hashcolumn(Adcsc->ir16);
+            else	hashcolumn(Adcsc->ir);
             
 	    if(sort)
             {
@@ -645,7 +655,7 @@ SpTuples<IT, NTO> * LocalHybridSpGEMM
         delete [] flopptr;
         delete [] aux;
 
-        SpTuples<IT, NTO>* spTuplesC = new SpTuples<IT, NTO> (nnzc, mdim, ndim, tuplesC, true, false);
+        SpTuples<IT, NTO>* spTuplesC = new SpTuples<IT, NTO> (nnzc, mdim, ndim, tuplesC, true, true);
 
         double t1=MPI_Wtime();
 
@@ -899,32 +909,37 @@ IT* estimateNNZ_Hash(const SpDCCols<IT, NT1> & A,const SpDCCols<IT, NT2> & B, IT
             globalHashVec[j] = -1;
         }
             
-        for (IT j=0; (unsigned)j < nnzcolB; ++j)
+        auto hashcolumn = [&](const auto * rowids)	// Adcsc->ir, or Adcsc->ir16 if the block keeps it
         {
-            IT t_bcol = Bdcsc->ir[Bdcsc->cp[i] + j];
-            for (IT k = colinds[j].first; (unsigned)k < colinds[j].second; ++k)
+            for (IT j=0; (unsigned)j < nnzcolB; ++j)
             {
-                IT key = Adcsc->ir[k];
-                IT hash = (key*hashScale) & (ht_size-1);
-                while (1) //hash probing
+                IT t_bcol = Bdcsc->ir[Bdcsc->cp[i] + j];
+                for (IT k = colinds[j].first; (unsigned)k < colinds[j].second; ++k)
                 {
-                    if (globalHashVec[hash] == key) //key is found in hash table
-                    {
-                        break;
-                    }
-                    else if (globalHashVec[hash] == -1) //key is not registered yet
-                    {
-                        globalHashVec[hash] = key;
-                        colnnzC[i] ++;
-                        break;
-                    }
-                    else //key is not found
+                    IT key = rowids[k];
+                    IT hash = (key*hashScale) & (ht_size-1);
+                    while (1) //hash probing
                     {
-                        hash = (hash+1) & (ht_size-1);
+                        if (globalHashVec[hash] == key) //key is found in hash table
+                        {
+                            break;
+                        }
+                        else if (globalHashVec[hash] == -1) //key is not registered yet
+                        {
+                            globalHashVec[hash] = key;
+                            colnnzC[i] ++;
+                            break;
+                        }
+                        else //key is not found
+                        {
+                            hash = (hash+1) & (ht_size-1);
+                        }
                     }
                 }
             }
-        }
+        };
+        if(Adcsc->ir16 != NULL)	hashcolumn(Adcsc->ir16);
+        else	hashcolumn(Adcsc->ir);
     }
     
     if(deleteAux)
@@ -1151,6 +1166,7 @@ LocalHybridSpGEMM (const SpCCols<IT, NT1>	&A,
 				   bool						 clearB
 				   )
 {
+	MemoryTracker::Scope scope(MEM_SPGEMM_LOCAL);
 	double t0 = MPI_Wtime();
 
 	IT mdim = A.getnrow();
@@ -1183,7 +1199,7 @@ LocalHybridSpGEMM (const SpCCols<IT, NT1>	&A,
 	double	compression_ratio = (double)flop / nnzc;
 	
 	std::tuple<IT, IT, NTO> *tuplesC = static_cast<std::tuple<IT, IT, NTO> *>
-		(::operator new (sizeof(std::tuple<IT, IT, NTO>[nnzc])));
+		(Arena::Allocate(sizeof(std::tuple<IT, IT, NTO>) * nnzc));
 
 	#ifdef THREADED
 	#pragma omp parallel for
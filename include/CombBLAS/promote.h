@@ -31,6 +31,7 @@
 #define _PROMOTE_H_
 
 #include "myenableif.h"
+#include "Pattern.h"
 
 namespace combblas {
 
@@ -48,6 +49,16 @@ template <class NT> struct promote_trait< bool , NT, typename combblas::disable_
 	typedef NT T_promote;                    
 };
 
+// A Pattern value is true, so it promotes like bool
+template <class NT> struct promote_trait< NT , Pattern, typename combblas::disable_if< combblas::is_boolean<NT>::value || is_pattern<NT>::value >::type >
+{
+	typedef NT T_promote;
+};
+template <class NT> struct promote_trait< Pattern , NT, typename combblas::disable_if< combblas::is_boolean<NT>::value || is_pattern<NT>::value >::type >
+{
+	typedef NT T_promote;
+};
+
 #define DECLARE_PROMOTE(A,B,C)                  \
     template <> struct promote_trait<A,B>       \
     {                                           \
@@ -71,6 +82,9 @@ DECLARE_PROMOTE(bool, float, float);
 DECLARE_PROMOTE(bool, double, double);
 DECLARE_PROMOTE(bool, unsigned long long, unsigned long long);
 DECLARE_PROMOTE(bool, bool, bool);
+DECLARE_PROMOTE(Pattern, bool, bool);
+DECLARE_PROMOTE(bool, Pattern, bool);
+DECLARE_PROMOTE(Pattern, Pattern, Pattern);
 DECLARE_PROMOTE(float, int, float);
 DECLARE_PROMOTE(double, int, double);
 DECLARE_PROMOTE(int, float, float);
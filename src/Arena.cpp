@@ -0,0 +1,246 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 6/15/2017 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc  --------------------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2017, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#include <cstdlib>
+#include <iostream>
+#include <vector>
+#include <mutex>
+#include <memory>
+#include <stdint.h>
+#include <sys/mman.h>
+#include "CombBLAS/Arena.h"
+#include "CombBLAS/MemoryTracker.h"
+#include "CombBLAS/SpDefs.h"
+
+namespace combblas {
+
+namespace {
+
+const size_t HEADERBYTES = 64;		// keeps blocks cache line aligned
+const int LOGMINBLOCK = 8;		// smallest block: 256 bytes, header included
+const int SUBCLASSES = 4;		// classes per power of two
+const int NUMCLASSES = (64 - LOGMINBLOCK) * SUBCLASSES + 1;
+const uint32_t BLOCKMAGIC = 0xA7E4A7E4;
+
+struct BlockHeader
+{
+	size_t requested;
+	uint32_t sizeclass;
+	uint32_t magic;
+	int32_t tag;		// operation the block is charged to (see MemoryTracker.h)
+};
+
+//! Smallest class whose blocks hold bytes: class 0 is the minimum block, then SUBCLASSES evenly spaced sizes in (2^k, 2^(k+1)]
+int SizeClass(size_t bytes)
+{
+	if(bytes <= (static_cast<size_t>(1) << LOGMINBLOCK))	return 0;
+	int k = 63 - __builtin_clzll(bytes - 1);		// 2^k < bytes <= 2^(k+1)
+	size_t step = (static_cast<size_t>(1) << k) / SUBCLASSES;
+	int sub = static_cast<int>((bytes - 1 - (static_cast<size_t>(1) << k)) / step);
+	return (k - LOGMINBLOCK) * SUBCLASSES + sub + 1;
+}
+
+size_t ClassBytes(int sizeclass)
+{
+	if(sizeclass == 0)	return static_cast<size_t>(1) << LOGMINBLOCK;
+	int k = (sizeclass - 1) / SUBCLASSES + LOGMINBLOCK;
+	int sub = (sizeclass - 1) % SUBCLASSES;
+	return (static_cast<size_t>(1) << k) + (sub + 1) * ((static_cast<size_t>(1) << k) / SUBCLASSES);
+}
+
+void * SystemAllocate(int sizeclass)
+{
+	size_t bytes = ClassBytes(sizeclass);
+	void * block = NULL;
+	if(bytes >= ARENA_HUGEPAGE_BYTES)
+	{
+		block = mmap(NULL, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if(block == MAP_FAILED)	throw std::bad_alloc();
+#ifdef MADV_HUGEPAGE
+		madvise(block, bytes, MADV_HUGEPAGE);
+#endif
+	}
+	else if(posix_memalign(&block, HEADERBYTES, bytes) != 0)
+	{
+		throw std::bad_alloc();
+	}
+	return block;
+}
+
+void SystemDeallocate(void * block, int sizeclass)
+{
+	size_t bytes = ClassBytes(sizeclass);
+	if(bytes >= ARENA_HUGEPAGE_BYTES)
+		munmap(block, bytes);
+	else
+		free(block);
+}
+
+//! Free blocks by class; the thread caches and the shared cache use the same structure
+struct BlockCache
+{
+	std::vector<void*> blocks[NUMCLASSES];
+	size_t bytes = 0;
+
+	void * Pop(int sizeclass)
+	{
+		if(blocks[sizeclass].empty())	return NULL;
+		void * block = blocks[sizeclass].back();
+		blocks[sizeclass].pop_back();
+		bytes -= ClassBytes(sizeclass);
+		return block;
+	}
+	void Push(void * block, int sizeclass)
+	{
+		blocks[sizeclass].push_back(block);
+		bytes += ClassBytes(sizeclass);
+	}
+	//! Returns blocks to the system, largest classes first, until at most limit bytes are kept
+	void Shrink(size_t limit)
+	{
+		for(int c = NUMCLASSES-1; c >= 0 && bytes > limit; --c)
+		{
+			while(!blocks[c].empty() && bytes > limit)
+				SystemDeallocate(Pop(c), c);
+		}
+	}
+};
+
+struct SharedCache
+{
+	std::mutex lock;
+	BlockCache cache;
+};
+
+//! Never destroyed, because thread caches flush into it when their threads exit (possibly after static destruction began)
+SharedCache & Shared()
+{
+	static SharedCache * shared = new SharedCache();
+	return *shared;
+}
+
+void SharedPush(void * block, int sizeclass)
+{
+	SharedCache & shared = Shared();
+	std::lock_guard<std::mutex> guard(shared.lock);
+	size_t bytes = ClassBytes(sizeclass);
+	if(bytes > ARENA_SHARED_CACHE_BYTES)
+	{
+		SystemDeallocate(block, sizeclass);
+		return;
+	}
+	shared.cache.Shrink(ARENA_SHARED_CACHE_BYTES - bytes);	// make room
+	shared.cache.Push(block, sizeclass);
+}
+
+struct ThreadCache
+{
+	BlockCache cache;
+	~ThreadCache()
+	{
+		for(int c = 0; c < NUMCLASSES; ++c)
+		{
+			while(!cache.blocks[c].empty())
+				SharedPush(cache.Pop(c), c);
+		}
+	}
+};
+
+thread_local ThreadCache threadcache;
+
+BlockHeader * HeaderOf(const void * ptr)
+{
+	return reinterpret_cast<BlockHeader*>(static_cast<char*>(const_cast<void*>(ptr)) - HEADERBYTES);
+}
+
+}
+
+void * Arena::Allocate(size_t bytes)
+{
+	int sizeclass = SizeClass(bytes + HEADERBYTES);
+	void * block = threadcache.cache.Pop(sizeclass);
+	if(block == NULL)
+	{
+		SharedCache & shared = Shared();
+		std::lock_guard<std::mutex> guard(shared.lock);
+		block = shared.cache.Pop(sizeclass);
+	}
+	if(block == NULL)
+		block = SystemAllocate(sizeclass);
+
+	BlockHeader * header = static_cast<BlockHeader*>(block);
+	header->requested = bytes;
+	header->sizeclass = sizeclass;
+	header->magic = BLOCKMAGIC;
+	header->tag = MemoryTracker::CurrentTag();
+	MemoryTracker::Charge(header->tag, ClassBytes(sizeclass));
+	return static_cast<char*>(block) + HEADERBYTES;
+}
+
+void Arena::Deallocate(void * ptr)
+{
+	if(ptr == NULL)	return;
+	BlockHeader * header = HeaderOf(ptr);
+	if(header->magic != BLOCKMAGIC)
+	{
+		std::cerr << "COMBBLAS: Arena::Deallocate called on memory that is not a live arena block" << std::endl;
+		std::abort();
+	}
+	int sizeclass = header->sizeclass;
+	header->magic = 0;	// catches double frees
+	MemoryTracker::Release(header->tag, ClassBytes(sizeclass));
+
+	BlockCache & cache = threadcache.cache;
+	if(cache.bytes + ClassBytes(sizeclass) <= ARENA_THREAD_CACHE_BYTES)
+		cache.Push(header, sizeclass);
+	else
+		SharedPush(header, sizeclass);
+}
+
+size_t Arena::Size(const void * ptr)
+{
+	return (ptr == NULL)? 0 : HeaderOf(ptr)->requested;
+}
+
+size_t Arena::CachedBytes()
+{
+	SharedCache & shared = Shared();
+	std::lock_guard<std::mutex> guard(shared.lock);
+	return threadcache.cache.bytes + shared.cache.bytes;
+}
+
+void Arena::Trim()
+{
+	threadcache.cache.Shrink(0);
+	SharedCache & shared = Shared();
+	std::lock_guard<std::mutex> guard(shared.lock);
+	shared.cache.Shrink(0);
+}
+
+}
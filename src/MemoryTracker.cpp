@@ -0,0 +1,286 @@
+/****************************************************************/
+/* Parallel Combinatorial BLAS Library (for Graph Computations) */
+/* version 1.6 -------------------------------------------------*/
+/* date: 6/15/2017 ---------------------------------------------*/
+/* authors: Ariful Azad, Aydin Buluc  --------------------------*/
+/****************************************************************/
+/*
+ Copyright (c) 2010-2017, The Regents of the University of California
+ 
+ Permission is hereby granted, free of charge, to any person obtaining a copy
+ of this software and associated documentation files (the "Software"), to deal
+ in the Software without restriction, including without limitation the rights
+ to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ copies of the Software, and to permit persons to whom the Software is
+ furnished to do so, subject to the following conditions:
+ 
+ The above copyright notice and this permission notice shall be included in
+ all copies or substantial portions of the Software.
+ 
+ THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+ THE SOFTWARE.
+ */
+
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <atomic>
+#include <memory>
+#include <unistd.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+#include "CombBLAS/MemoryTracker.h"
+#include "CombBLAS/SpDefs.h"
+
+namespace combblas {
+
+namespace {
+
+const int TOTAL = MEM_NUMTAGS;		// counters are indexed by tag, with the rank's total last
+
+std::atomic<int> currenttag(MEM_OTHER);
+std::atomic<int64_t> current[MEM_NUMTAGS+1];
+std::atomic<int64_t> peak[MEM_NUMTAGS+1];
+std::atomic<int64_t> budget(0);
+std::atomic_flag reporting = ATOMIC_FLAG_INIT;
+
+const char * tagnames[MEM_NUMTAGS] = {"other", "SpGEMM", "SpGEMM broadcast", "SpGEMM local", "merge", "Kselect", "transpose", "I/O"};
+
+void RaisePeak(std::atomic<int64_t> & counter, int64_t value)
+{
+	int64_t old = counter.load(std::memory_order_relaxed);
+	while(value > old && !counter.compare_exchange_weak(old, value, std::memory_order_relaxed));
+}
+
+double MB(int64_t bytes) { return static_cast<double>(bytes) / 1048576.0; }
+
+//! Blocks freed by another thread than the one that allocated them can make a counter dip below zero until that thread posts
+int64_t NonNegative(int64_t bytes) { return (bytes > 0)? bytes : 0; }
+
+//! Fails fast, naming the operation that crossed the budget and what this rank's memory is charged to
+void OverBudget(int tag, int64_t total, int64_t limit)
+{
+	if(reporting.test_and_set())	return;	// another thread is already aborting
+	int myrank = 0, initialized = 0;
+	MPI_Initialized(&initialized);
+	if(initialized)	MPI_Comm_rank(MPI_COMM_WORLD, &myrank);
+
+	std::ostringstream outs;
+	outs << std::fixed << std::setprecision(1);
+	outs << "COMBBLAS: rank " << myrank << " exceeds its memory budget of " << MB(limit) << " MB (" << MB(total);
+	outs << " MB charged) while allocating for " << MemoryTracker::TagName(tag) << "; charged by operation:";
+	for(int t = 0; t < MEM_NUMTAGS; ++t)
+	{
+		int64_t bytes = current[t].load(std::memory_order_relaxed);
+		if(bytes > 0)	outs << " " << tagnames[t] << " " << MB(bytes) << " MB,";
+	}
+	outs << " resident set " << MB(MemoryTracker::ResidentBytes()) << " MB" << std::endl;
+	std::cerr << outs.str() << std::flush;
+
+	if(initialized)	MPI_Abort(MPI_COMM_WORLD, MEMORYBUDGET);
+	std::abort();
+}
+
+void Post(int tag, int64_t delta)
+{
+	RaisePeak(peak[tag], current[tag].fetch_add(delta, std::memory_order_relaxed) + delta);
+	int64_t total = current[TOTAL].fetch_add(delta, std::memory_order_relaxed) + delta;
+	RaisePeak(peak[TOTAL], total);
+
+	int64_t limit = budget.load(std::memory_order_relaxed);
+	if(delta > 0 && limit > 0 && total > limit)
+		OverBudget(tag, total, limit);
+}
+
+//! Charges of one thread that are not posted yet
+struct PendingCharges
+{
+	int64_t delta[MEM_NUMTAGS] = {};
+
+	void Add(int tag, int64_t bytes)
+	{
+		delta[tag] += bytes;
+		if(delta[tag] >= MEMTRACK_BATCH_BYTES || delta[tag] <= -MEMTRACK_BATCH_BYTES)
+		{
+			Post(tag, delta[tag]);
+			delta[tag] = 0;
+		}
+	}
+	void Flush()
+	{
+		for(int t = 0; t < MEM_NUMTAGS; ++t)
+		{
+			if(delta[t] != 0)
+			{
+				Post(t, delta[t]);
+				delta[t] = 0;
+			}
+		}
+	}
+	~PendingCharges() { Flush(); }
+};
+
+thread_local PendingCharges pending;
+
+}
+
+MemoryTracker::Scope::Scope(MemTag tag)
+{
+#ifdef _OPENMP
+	active = !omp_in_parallel();	// scopes of concurrent threads would restore each other's tags out of order
+#else
+	active = true;
+#endif
+	if(active)
+	{
+		pending.Flush();	// what the thread allocated so far belongs to the enclosing operation's numbers
+		previous = currenttag.exchange(tag);
+	}
+}
+
+MemoryTracker::Scope::~Scope()
+{
+	if(active)
+	{
+		pending.Flush();
+		currenttag.store(previous);
+	}
+}
+
+MemTag MemoryTracker::CurrentTag()
+{
+	return static_cast<MemTag>(currenttag.load(std::memory_order_relaxed));
+}
+
+const char * MemoryTracker::TagName(int tag)
+{
+	return (tag >= 0 && tag < MEM_NUMTAGS)? tagnames[tag] : "total";
+}
+
+void MemoryTracker::Charge(int tag, int64_t bytes)
+{
+	pending.Add(tag, bytes);
+}
+
+void MemoryTracker::Release(int tag, int64_t bytes)
+{
+	pending.Add(tag, -bytes);
+}
+
+int64_t MemoryTracker::CurrentBytes()
+{
+	pending.Flush();
+	return NonNegative(current[TOTAL].load());
+}
+
+int64_t MemoryTracker::CurrentBytes(MemTag tag)
+{
+	pending.Flush();
+	return NonNegative(current[tag].load());
+}
+
+int64_t MemoryTracker::PeakBytes()
+{
+	pending.Flush();
+	return peak[TOTAL].load();
+}
+
+int64_t MemoryTracker::PeakBytes(MemTag tag)
+{
+	pending.Flush();
+	return peak[tag].load();
+}
+
+void MemoryTracker::ResetPeaks()
+{
+	pending.Flush();
+	for(int t = 0; t <= TOTAL; ++t)
+		peak[t].store(NonNegative(current[t].load()));
+}
+
+void MemoryTracker::SetBudget(int64_t bytes)
+{
+	budget.store(bytes > 0? bytes : 0);
+}
+
+int64_t MemoryTracker::Budget()
+{
+	return budget.load();
+}
+
+int64_t MemoryTracker::Available()
+{
+	int64_t limit = budget.load();
+	return (limit > 0)? (limit - CurrentBytes()) : INT64_MAX;
+}
+
+int64_t MemoryTracker::ResidentBytes()
+{
+	std::ifstream statm("/proc/self/statm");
+	int64_t vsize = 0, rss = 0;
+	if(!(statm >> vsize >> rss))	return 0;
+	return rss * sysconf(_SC_PAGESIZE);
+}
+
+int64_t MemoryTracker::PeakResidentBytes()
+{
+	std::ifstream status("/proc/self/status");
+	std::string line;
+	while(std::getline(status, line))
+	{
+		if(line.compare(0, 6, "VmHWM:") == 0)
+			return std::strtoll(line.c_str() + 6, NULL, 10) * 1024;
+	}
+	return 0;
+}
+
+void MemoryTracker::Report(MPI_Comm comm, const char * label)
+{
+	const int COUNTS = 2*(MEM_NUMTAGS+1) + 2;	// current and peak by tag, then resident set and its peak
+	int64_t local[COUNTS], maxes[COUNTS], sums[COUNTS];
+	pending.Flush();
+	for(int t = 0; t <= TOTAL; ++t)
+	{
+		local[t] = NonNegative(current[t].load());
+		local[MEM_NUMTAGS+1+t] = peak[t].load();
+	}
+	local[COUNTS-2] = ResidentBytes();
+	local[COUNTS-1] = PeakResidentBytes();
+	MPI_Allreduce(local, maxes, COUNTS, MPI_INT64_T, MPI_MAX, comm);
+	MPI_Allreduce(local, sums, COUNTS, MPI_INT64_T, MPI_SUM, comm);
+
+	int myrank, nprocs;
+	MPI_Comm_rank(comm, &myrank);
+	MPI_Comm_size(comm, &nprocs);
+	if(myrank != 0)	return;
+
+	std::ostringstream outs;
+	outs << std::fixed << std::setprecision(1);
+	outs << "Memory";
+	if(label != NULL)	outs << " " << label;
+	outs << " (MB, " << nprocs << " ranks";
+	if(Budget() > 0)	outs << ", budget " << MB(Budget()) << " per rank";
+	outs << ")" << std::endl;
+	outs << std::setw(18) << std::left << "operation" << std::right << std::setw(14) << "current max" << std::setw(14) << "current sum" << std::setw(14) << "peak max" << std::endl;
+	for(int t = 0; t <= TOTAL; ++t)
+	{
+		if(t < TOTAL && maxes[t] == 0 && maxes[MEM_NUMTAGS+1+t] == 0)	continue;
+		outs << std::setw(18) << std::left << TagName(t) << std::right << std::setw(14) << MB(maxes[t]) << std::setw(14) << MB(sums[t]) << std::setw(14) << MB(maxes[MEM_NUMTAGS+1+t]) << std::endl;
+	}
+	outs << std::setw(18) << std::left << "resident set" << std::right << std::setw(14) << MB(maxes[COUNTS-2]) << std::setw(14) << MB(sums[COUNTS-2]) << std::setw(14) << MB(maxes[COUNTS-1]) << std::endl;
+	std::cout << outs.str() << std::flush;
+}
+
+}